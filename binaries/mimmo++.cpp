@@ -60,6 +60,8 @@ struct InfoMimmoPP{
     bool optres;                /**< boolean to activate writing of execution optional results */
     bool expert;                /**< boolean to override mandatory ports checking */
     std::string optres_path;    /**< path to store optional results */
+    int nthreads;               /**< number of workers executing each chain */
+    std::string profile;        /**< file of the execution profile summary, empty if profiling is off */
     
     /*! Base constructor*/
     InfoMimmoPP(){
@@ -69,6 +71,8 @@ struct InfoMimmoPP{
         optres      = false;
         optres_path = ".";
         expert      = false;
+        nthreads    = 1;
+        profile     = "";
     }
     /*! Destructor */
     ~InfoMimmoPP(){};
@@ -86,6 +90,8 @@ struct InfoMimmoPP{
         optres = other.optres;
         optres_path = other.optres_path;
         expert = other.expert;
+        nthreads = other.nthreads;
+        profile = other.profile;
         return *this;
     }
 };
@@ -144,6 +150,14 @@ InfoMimmoPP readArguments(int argc, char*argv[] ){
         std::cout<<" "<<std::endl;
         std::cout<<"    --expert=yes                   : override mandatory ports connection checking.              "<<std::endl;
         std::cout<<" "<<std::endl;
+        std::cout<<"    --threads=<n>                  : number of workers executing independent blocks of each     "<<std::endl;
+        std::cout<<"                                     chain concurrently. 0 uses all hardware threads.           "<<std::endl;
+        std::cout<<"                                     Default is 1 (serial execution).                           "<<std::endl;
+        std::cout<<" "<<std::endl;
+        std::cout<<"    --profile=<file>               : profile the execution of each block (wall/cpu time, memory, "<<std::endl;
+        std::cout<<"                                     data exchanged by ports). A JSON summary is written in     "<<std::endl;
+        std::cout<<"                                     <file>, a Chrome trace-event timeline in <file>.trace.json "<<std::endl;
+        std::cout<<" "<<std::endl;
         std::cout<<" "<<std::endl;
         std::cout<<" "<<std::endl;
         std::cout<<"    For any problem, bug and malfunction please contact mimmo developers.                       "<<std::endl;
@@ -158,6 +172,8 @@ InfoMimmoPP readArguments(int argc, char*argv[] ){
     keymap[3] = "opt-res=";
     keymap[4] = "opt-res-path=";
     keymap[5] = "expert=";
+    keymap[6] = "threads=";
+    keymap[7] = "profile=";
     
     std::map<int, std::string> final_map;
     //visit input list and search for each key string  in key map. If an input string positively match a key, 
@@ -166,7 +182,7 @@ InfoMimmoPP readArguments(int argc, char*argv[] ){
     for(auto val: input){
         std::size_t pos = std::string::npos;
         int counter=0;
-        while (pos == std::string::npos && counter <6){
+        while (pos == std::string::npos && counter <8){
             pos = val.find(keymap[counter]);
             ++counter;
         }  
@@ -187,6 +203,11 @@ InfoMimmoPP readArguments(int argc, char*argv[] ){
     if(final_map.count(4)) result.optres_path = final_map[4];
     if(final_map.count(3)) result.optres = (final_map[3]=="yes");
     if(final_map.count(5)) result.expert = (final_map[5]=="yes");
+    if(final_map.count(6)){
+        std::stringstream ss(final_map[6]);
+        ss >> result.nthreads;
+    }
+    if(final_map.count(7)) result.profile = final_map[7];
     
     if(final_map.count(1)){
         int check = -1 + int(final_map[1]=="quiet") + 2*int(final_map[1]=="normal") + 3*int(final_map[1]=="full");
@@ -340,6 +361,8 @@ void mimmocore(const InfoMimmoPP & info) {
             (*m_log)<< "debug results:      "<<yesno[int(info.optres)]<<std::endl;
             (*m_log)<< "debug results path: "<<info.optres_path<<std::endl;
             (*m_log)<< "expert mode:        "<<yesno[int(info.expert)]<<std::endl;
+            (*m_log)<< "chain workers:      "<<info.nthreads<<std::endl;
+            (*m_log)<< "profile:            "<<(info.profile.empty() ? "no" : info.profile)<<std::endl;
             (*m_log)<< " "<<std::endl;
             (*m_log)<< " "<<std::endl;
         }
@@ -355,6 +378,18 @@ void mimmocore(const InfoMimmoPP & info) {
 		
 		auto &factory = Factory<BaseManipulation>::instance();
 		read_Dictionary(mapInst, mapConn, factory);
+
+		//blocks used as stages of a FusedDeformation are evaluated only by it: remove them from the chains.
+		{
+			std::unordered_set<std::string> stages;
+			for(auto &val : mapInst){
+				FusedDeformation * fused = dynamic_cast<FusedDeformation *>(val.second.get());
+				if(fused == NULL || fused->getStageNames().empty())	continue;
+				fused->resolveStages(mapConn);
+				for(const auto & name : fused->getStageNames())	stages.insert(name);
+			}
+			for(const auto & name : stages)	mapConn.erase(name);
+		}
         
         m_log->setPriority(bitpit::log::NORMAL);
 		(*m_log)<<"Creating Execution chains... ";
@@ -372,6 +407,11 @@ void mimmocore(const InfoMimmoPP & info) {
 		//Execute
         (*m_log)<<"Executing your workflow... "<<std::endl;
         m_log->setPriority(bitpit::log::DEBUG);
+
+        if(!info.profile.empty()){
+            mimmo::Profiler::instance().clear();
+            mimmo::Profiler::instance().setActive(true);
+        }
         
 		
 		for(auto &val : chainMap){
@@ -381,12 +421,20 @@ void mimmocore(const InfoMimmoPP & info) {
                 m_log->setPriority(bitpit::log::DEBUG);
                 val.second.setPlotDebugResults(info.optres);
                 val.second.setOutputDebugResults(info.optres_path);
+                val.second.setNumThreads(info.nthreads);
 				val.second.exec(false);
 			}
 		}
 		
 		m_log->setPriority(bitpit::log::NORMAL);
 		(*m_log)<<"Workflow DONE."<<std::endl;		
+
+        if(!info.profile.empty()){
+            mimmo::Profiler::instance().setActive(false);
+            mimmo::Profiler::instance().writeSummary(info.profile);
+            mimmo::Profiler::instance().writeTrace(info.profile + ".trace.json");
+            (*m_log)<<"Execution profile written in "<<info.profile<<std::endl;
+        }
 		//Done, now exiting;
         m_log->setPriority(bitpit::log::DEBUG);
 }
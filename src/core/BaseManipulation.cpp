@@ -542,17 +542,51 @@ BaseManipulation::exec(){
         }
     }
 
+    Profiler & profiler = Profiler::instance();
+    bool profiling = profiler.isActive();
+    BlockProfile profile;
+    if (profiling){
+        profile.name = m_name;
+        profile.id = getId();
+        profile.start = profiler.getTime();
+        profile.cpu = profiler.getCPUTime();
+        profile.rss = profiler.getPeakRSS();
+    }
+
     if (m_active) execute();
 
     for (std::unordered_map<PortID, PortOut*>::iterator i=m_portOut.begin(); i!=m_portOut.end(); i++){
         std::vector<BaseManipulation*>	linked = i->second->getLink();
         if (linked.size() > 0){
-            i->second->exec();
+            if (profiling){
+                PortProfile port;
+                port.port = i->first;
+                port.receivers = linked.size();
+                //size of the data is evaluated outside the timed span of the port
+                port.bytes = i->second->evalDataBytes();
+                port.start = profiler.getTime();
+                i->second->exec();
+                port.wall = profiler.getTime() - port.start;
+                profile.ports.push_back(port);
+            }else{
+                i->second->exec();
+            }
         }
     }
 
     if(isPlotInExecution())	plotOptionalResults();
     if(isApply()) apply();
+
+    if (profiling){
+        profile.wall = profiler.getTime() - profile.start;
+        profile.cpu = profiler.getCPUTime() - profile.cpu;
+        profile.rss = profiler.getPeakRSS() - profile.rss;
+        if (m_geometry != NULL){
+            profile.nvertices = m_geometry->getNVertex();
+            profile.ncells = m_geometry->getNCells();
+        }
+        profiler.addBlock(std::move(profile));
+    }
 }
 
 /*!
@@ -659,6 +693,16 @@ BaseManipulation::setBufferIn(PortID port, bitpit::IBinaryStream& input){
     m_portIn[port]->m_ibuffer = input;
 }
 
+/*!
+ * It sets the shared data handle of an input port of the object.
+ * \param[in] port ID of the port.
+ * \param[in] data shared handle to data communicated.
+ */
+void
+BaseManipulation::setDataIn(PortID port, std::shared_ptr<void> data){
+    m_portIn[port]->m_idata = std::move(data);
+}
+
 /*!
  * It reads the buffer stored in an input port of the object.
  * \param[in] port ID of the port that reads the buffer and stores the
@@ -879,5 +923,19 @@ std::vector<BaseManipulation*>    BaseManipulation::getSubBlocksEmbedded(){
     return std::vector<BaseManipulation *>();
 };
 
+/*!
+ * Method to return all the geometries read or modified by the execution of the current block.
+ * It is used by Chain to avoid running concurrently blocks working on the same geometries.
+ * By default this method returns the linked geometry, if any. It needs to be customized
+ * in derived classes accessing other geometries, e.g. geometries passed with fields or as
+ * auxiliary inputs.
+ * \return list of geometries involved in the execution
+ */
+std::vector<MimmoObject*>    BaseManipulation::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result;
+    if(m_geometry != NULL)  result.push_back(m_geometry);
+    return result;
+};
+
 };
 
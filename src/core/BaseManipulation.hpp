@@ -31,6 +31,7 @@
 #include "MimmoObject.hpp"
 #include "MimmoPiercedVector.hpp"
 #include "InOut.hpp"
+#include "Profiler.hpp"
 
 #include <string>
 #include <functional>
@@ -51,6 +52,7 @@ using namespace pin;
  * To execute an object derived from BaseManipulation call the
  * method exec() of the base class.
  * In the exec() function the pure virtual execute() method is called.
+ * If the mimmo::Profiler is active, exec() records the resources spent by the object.
  * Pure virtual execute() is the real working function of a manipulation object and has to be
  * implemented in each derived class. \n
  * A manipulation base object has a linked geometry, a MimmoObject, that is
@@ -115,6 +117,10 @@ class BaseManipulation{
      * see mimmo::setLogger
      */
     friend void mimmo::setLogger(std::string log);
+    /*!
+     * see Chain::execParallel
+     */
+    friend class Chain;
 
 public:
     //type definitions
@@ -206,6 +212,7 @@ public:
     virtual void flushSectionXML(bitpit::Config::Section & slotXML, std::string name= "");
     
     virtual std::vector<BaseManipulation*> getSubBlocksEmbedded();
+    virtual std::vector<MimmoObject*>      getInvolvedGeometries();
 protected:
 
     
@@ -232,6 +239,7 @@ protected:
     bool    createPortIn(O* obj, void (O::*setVar_)(T), PortID portR, bool mandatory = false, int family = 0);
 
     void    setBufferIn(PortID port, bitpit::IBinaryStream& input);
+    void    setDataIn(PortID port, std::shared_ptr<void> data);
     void    readBufferIn(PortID port);
     void    cleanBufferIn(PortID port);
 
@@ -30,6 +30,24 @@ using namespace bitpit;
 
 namespace mimmo{
 
+/*!
+ * Select the identifiers of a list according to a classification mask.
+ * \param[in] ids      list of identifiers
+ * \param[in] mask     classification mask, one entry per identifier
+ * \param[in] included true to select masked identifiers, false to select the unmasked ones
+ * \return selected identifiers
+ */
+static livector1D selectByMask(const livector1D & ids, const std::vector<uint8_t> & mask, bool included){
+    livector1D result;
+    result.reserve(ids.size());
+    for(std::size_t i=0; i<ids.size(); ++i){
+        if(bool(mask[i]) == included){
+            result.push_back(ids[i]);
+        }
+    }
+    return result;
+}
+
 
 /*! 
  * Basic Constructor 
@@ -341,142 +359,118 @@ livector1D BasicShape::excludeGeometry(mimmo::MimmoObject * geo){
 
 /*! 
  * Given a bitpit class bitpit::PatchKernel tessellation, return cell identifiers of those simplex inside the volume of
- * the BasicShape object. The method searches simplex one-by-one on the whole tesselation.
+ * the BasicShape object. The method classifies in batch all the simplex vertices of the whole tesselation.
  * \param[in] tri target tessellation
  * \return list-by-ids of simplicies included in the volumetric patch
  */
 livector1D BasicShape::includeGeometry(bitpit::PatchKernel * tri ){
 	
 	if(tri == NULL)	return livector1D(0);
-	livector1D result(tri->getCellCount());
-	long id;
-	int counter = 0;
+	livector1D ids;
+	ids.reserve(tri->getCellCount());
 	for(auto & cell : tri->getCells()){
-		id = cell.getId();
-		if(isSimplexIncluded(tri,id)){
-			result[counter] = id;
-			++counter;
-		}
-	}	
-	result.resize(counter);
-	return(result);
+		ids.push_back(cell.getId());
+	}
+	std::vector<uint8_t> mask;
+	classifyCells(tri, ids, mask);
+	return(selectByMask(ids, mask, true));
  
 };
 
 /*!
  * Given a bitpit class bitpit::PatchKernel tessellation, return cell identifiers of those simplex outside the volume of
- * the BasicShape object.The method searches simplex one-by-one on the whole tesselation. 
+ * the BasicShape object. The method classifies in batch all the simplex vertices of the whole tesselation. 
  * \param[in] tri target tesselation
  * \return list-by-ids of simplicies outside the volumetric patch
  */
 livector1D BasicShape::excludeGeometry(bitpit::PatchKernel * tri){
 	
 	if(tri == NULL)	return livector1D(0);
-	livector1D result(tri->getCellCount());
-	long id;
-	int counter = 0;
+	livector1D ids;
+	ids.reserve(tri->getCellCount());
 	for(auto & cell : tri->getCells()){
-		id = cell.getId();
-		if(!isSimplexIncluded(tri,id)){
-			result[counter] = id;
-			++counter;
-		}
-	}	
-	result.resize(counter);
-	return(result);
+		ids.push_back(cell.getId());
+	}
+	std::vector<uint8_t> mask;
+	classifyCells(tri, ids, mask);
+	return(selectByMask(ids, mask, false));
 	
 };
 
 /*! 
  * Given a list of vertices of a point cloud, return indices of those vertices included into 
- * the volume of the object. The method searches vertex one-by-one on the whole point cloud.  
+ * the volume of the object. The method classifies in batch the whole point cloud.  
  * \param[in] list list of cloud points
  * \return list-by-indices of vertices included in the volumetric patch
  */
 livector1D BasicShape::includeCloudPoints(const dvecarr3E & list){
 
 	if(list.empty())	return livector1D(0);
-	livector1D result(list.size());
-	int counter = 0;
-	long real = 0;
-	for(const auto & vert : list){
-		if(isPointIncluded(vert)){
-			result[counter] = real;
-			++counter;
-		}
-		++real;	
-	}	
-	result.resize(counter);
+	std::vector<uint8_t> mask = classifyPoints(list);
+	livector1D result;
+	result.reserve(list.size());
+	for(std::size_t i=0; i<list.size(); ++i){
+		if(mask[i])	result.push_back(long(i));
+	}
 	return(result);
 };
 
 /*! 
  * Given a list of vertices of a point cloud, return indices of those vertices outside 
- * the volume of BasicShape object 
+ * the volume of BasicShape object. The method classifies in batch the whole point cloud.
  * \param[in] list list of cloud points
  * \return list-by-indices of vertices outside the volumetric patch
  */
 livector1D BasicShape::excludeCloudPoints(const dvecarr3E & list){
 	if(list.empty())	return livector1D(0);
-	livector1D result(list.size());
-	long real = 0;
-	int counter = 0;
-	for(const auto & vert : list){
-		if(!isPointIncluded(vert)){
-			result[counter] = real;
-			++counter;
-		}
-		++real;	
-	}	
-	result.resize(counter);
+	std::vector<uint8_t> mask = classifyPoints(list);
+	livector1D result;
+	result.reserve(list.size());
+	for(std::size_t i=0; i<list.size(); ++i){
+		if(!mask[i])	result.push_back(long(i));
+	}
 	return(result);
 	
 };
 
 /*! 
  * Given a bitpit class bitpit::PatchKernel point cloud, return identifiers of those points inside the volume of
- * the BasicShape object. The method force a one-by-one vertex search.   
+ * the BasicShape object. The method classifies in batch all the vertices of the cloud.   
  * \param[in] tri pointer to bitpit::PatchKernel object retaining the cloud point
  * \return list-by-ids of vertices included in the volumetric patch
  */
 livector1D BasicShape::includeCloudPoints(bitpit::PatchKernel * tri){
 	
 	if(tri == NULL)		return livector1D(0);
-	livector1D result(tri->getVertexCount());
-	int counter = 0;
-	long id;
+	livector1D ids;
+	dvecarr3E points;
+	ids.reserve(tri->getVertexCount());
+	points.reserve(tri->getVertexCount());
 	for(auto & vert : tri->getVertices()){
-		id = vert.getId();
-		if(isPointIncluded(tri, id)){
-			result[counter] = id;
-			++counter;
-		}	
-	}	
-	result.resize(counter);
-	return(result);
+		ids.push_back(vert.getId());
+		points.push_back(vert.getCoords());
+	}
+	return(selectByMask(ids, classifyPoints(points), true));
 };
 
 /*! 
  * Given a bitpit class bitpit::PatchKernel point cloud, return identifiers of those points outside the volume of
- * the BasicShape object.The method force a one-by-one vertex search.     
+ * the BasicShape object. The method classifies in batch all the vertices of the cloud.     
  * \param[in] tri pointer to bitpit::PatchKernel object retaining the cloud point
  * \return list-by-ids of vertices outside the volumetric patch
  */
 livector1D BasicShape::excludeCloudPoints(bitpit::PatchKernel * tri){
 
 	if(tri == NULL)		return livector1D(0);
-	livector1D result(tri->getVertexCount());
-	int counter = 0;
-	long id;
+	livector1D ids;
+	dvecarr3E points;
+	ids.reserve(tri->getVertexCount());
+	points.reserve(tri->getVertexCount());
 	for(auto & vert : tri->getVertices()){
-		id = vert.getId();
-		if(!isPointIncluded(tri, id)){
-			result[counter] = id;
-		++counter;
-		}
-	}	
-	result.resize(counter);
-	return(result);
+		ids.push_back(vert.getId());
+		points.push_back(vert.getCoords());
+	}
+	return(selectByMask(ids, classifyPoints(points), false));
 	
 };
 
@@ -590,6 +584,107 @@ bool BasicShape::isPointIncluded(bitpit::PatchKernel * tri, const long int & ind
     return(isPointIncluded(tri->getVertex(indexV).getCoords()));
 };
 
+/*!
+ * Classify in batch a list of points, as included or not in the volume of the shape.
+ * See BasicShape::classifyPoints(long, const double *, const double *, const double *, std::ptrdiff_t, uint8_t *).
+ * \param[in] points list of points
+ * \return mask of the points, 1 if the point is included in the shape, 0 otherwise
+ */
+std::vector<uint8_t> BasicShape::classifyPoints(const dvecarr3E & points){
+
+    static_assert(sizeof(darray3E) == 3*sizeof(double), "darray3E is expected to be tightly packed");
+
+    std::vector<uint8_t> mask(points.size(), 0);
+    if(points.empty())  return mask;
+    classifyPoints(long(points.size()), &points[0][0], &points[0][1], &points[0][2], 3, mask.data());
+    return mask;
+};
+
+/*!
+ * Classify in batch a list of points, as included or not in the volume of the shape, with the same
+ * criterion of BasicShape::isPointIncluded. Coordinates are read from three strided arrays, so that
+ * both structure-of-arrays (stride 1, e.g. a CoordinatesView) and array-of-structures (stride 3, e.g. a dvecarr3E)
+ * layouts can be classified without copies. Points are split in blocks, distributed among the available threads
+ * (if mimmo is compiled with OpenMP support) and classified by the classifyBlock kernel of the shape.
+ * \param[in] n      number of points
+ * \param[in] x      x coordinate of the first point
+ * \param[in] y      y coordinate of the first point
+ * \param[in] z      z coordinate of the first point
+ * \param[in] stride distance between the coordinates of consecutive points
+ * \param[out] mask  mask of the points, 1 if the point is included in the shape, 0 otherwise; size n at least.
+ */
+void BasicShape::classifyPoints(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask){
+
+    const long blockSize = 1024;
+    long nblocks = (n + blockSize - 1) / blockSize;
+
+#pragma omp parallel for schedule(static) if(nblocks > 1)
+    for(long ib=0; ib<nblocks; ++ib){
+        long start = ib*blockSize;
+        long nb = std::min(blockSize, n - start);
+        classifyBlock(nb, x + start*stride, y + start*stride, z + start*stride, stride, mask + start);
+    }
+};
+
+/*!
+ * Classify a block of points as included or not in the volume of the shape.
+ * Default kernel tests the points one by one with BasicShape::isPointIncluded; shapes
+ * reimplement it with vectorizable transformations.
+ * \param[in] n      number of points
+ * \param[in] x      x coordinate of the first point
+ * \param[in] y      y coordinate of the first point
+ * \param[in] z      z coordinate of the first point
+ * \param[in] stride distance between the coordinates of consecutive points
+ * \param[out] mask  mask of the points, 1 if the point is included in the shape, 0 otherwise
+ */
+void BasicShape::classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask){
+
+    for(long i=0; i<n; ++i){
+        darray3E point = {{x[i*stride], y[i*stride], z[i*stride]}};
+        mask[i] = uint8_t(isPointIncluded(point));
+    }
+};
+
+/*!
+ * Classify a list of cells of a tessellation as included or not in the volume of the shape,
+ * with the same criterion of BasicShape::isSimplexIncluded. Vertex coordinates of all cells are
+ * gathered in a single list and classified in batch.
+ * \param[in] geo      pointer to the tessellation
+ * \param[in] cellIds  ids of the cells to classify
+ * \param[out] mask    mask of the cells, 1 if all the cell vertices are included in the shape, 0 otherwise
+ */
+void BasicShape::classifyCells(bitpit::PatchKernel * geo, const livector1D & cellIds, std::vector<uint8_t> & mask){
+
+    long nCells = cellIds.size();
+    livector1D offsets(nCells+1, 0);
+    for(long i=0; i<nCells; ++i){
+        offsets[i+1] = offsets[i] + geo->getCell(cellIds[i]).getVertexCount();
+    }
+
+    dvecarr3E points(offsets[nCells]);
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<nCells; ++i){
+        bitpit::ConstProxyVector<long> vIds = geo->getCell(cellIds[i]).getVertexIds();
+        long pos = offsets[i];
+        for(const auto & idV : vIds){
+            points[pos] = geo->getVertex(idV).getCoords();
+            ++pos;
+        }
+    }
+
+    std::vector<uint8_t> pointMask = classifyPoints(points);
+
+    mask.assign(nCells, 0);
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<nCells; ++i){
+        uint8_t included = 1;
+        for(long j=offsets[i]; j<offsets[i+1]; ++j){
+            included &= pointMask[j];
+        }
+        mask[i] = included;
+    }
+};
+
 
 
 /*!
@@ -612,7 +707,7 @@ darray3E BasicShape::checkNearestPointToAABBox(const darray3E &point, const darr
 
 /*!
  * Visit KdTree relative to a cloud points and extract possible vertex candidates included in the current shape.
- * Identifiers of extracted matches are collected in result structure
+ * Candidates are then classified in batch. Identifiers of extracted matches are collected in result structure
  *\param[in] tree           KdTree of cloud points
  *\param[in,out] result     list of KdNode labels, which are included in the shape.
  * 
@@ -644,19 +739,20 @@ void    BasicShape::searchKdTreeMatches(bitpit::KdTree<3,bitpit::Vertex,long> &
         }
     }
 
-    result.clear();
-    result.reserve(candidates.size());
-    for (const auto & idCand : candidates){
-        bitpit::KdNode<bitpit::Vertex, long> & target = tree.nodes[idCand];
-        if(isPointIncluded(target.object_->getCoords())){
-            result.push_back(target.label);
-        }
+    dvecarr3E points(candidates.size());
+    livector1D labels(candidates.size());
+    for (std::size_t i=0; i<candidates.size(); ++i){
+        bitpit::KdNode<bitpit::Vertex, long> & target = tree.nodes[candidates[i]];
+        points[i] = target.object_->getCoords();
+        labels[i] = target.label;
     }
+
+    result = selectByMask(labels, classifyPoints(points), true);
 };
 
 /*!
  * Visit SkdTree relative to a PatchKernel structure and extract possible simplex candidates included in the current shape.
- * Identifiers of extracted matches are collected in result structure
+ * Cells of the candidate leaves are then classified in batch. Identifiers of extracted matches are collected in result structure
  *\param[in] tree           SkdTree of PatchKernel simplicies
  *\param[in] geo            pointer to tessellation the tree refers to. 
  *\param[out] result        list of simplex-ids included in the shape.
@@ -700,17 +796,17 @@ void    BasicShape::searchBvTreeMatches(bitpit::PatchSkdTree & tree,  bitpit::Pa
         }
     }
 
-    result.clear();
-    result.reserve(toBeCandidates.size() + sureCells.size());
+    livector1D candidateCells;
     for (const auto & idCand : toBeCandidates){
         const SkdNode &node = tree.getNode(idCand);
         std::vector<long> cellids = node.getCells();
-        for(const auto & id : cellids){
-            if(isSimplexIncluded(geo, id)){
-                result.push_back(id);
-            }
-        }
+        candidateCells.insert(candidateCells.end(), cellids.begin(), cellids.end());
     }
+
+    std::vector<uint8_t> mask;
+    classifyCells(geo, candidateCells, mask);
+
+    result = selectByMask(candidateCells, mask, true);
     result.insert(result.end(), sureCells.begin(), sureCells.end());
 };
 
@@ -964,6 +1060,37 @@ bool Cube::intersectShapeAABBox(const darray3E &bMin, const darray3E &bMax){
 };
 
 
+/*!
+ * Classify a block of points as included or not in the volume of the cube.
+ * Points are transformed to the unitary cube reference system in a single vectorizable loop.
+ * \param[in] n      number of points
+ * \param[in] x      x coordinate of the first point
+ * \param[in] y      y coordinate of the first point
+ * \param[in] z      z coordinate of the first point
+ * \param[in] stride distance between the coordinates of consecutive points
+ * \param[out] mask  mask of the points, 1 if the point is included in the shape, 0 otherwise
+ */
+void Cube::classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask){
+
+    const double tol = 1.0E-12;
+    const double o0 = m_origin[0], o1 = m_origin[1], o2 = m_origin[2];
+    const double a00 = m_sdr[0][0], a01 = m_sdr[0][1], a02 = m_sdr[0][2];
+    const double a10 = m_sdr[1][0], a11 = m_sdr[1][1], a12 = m_sdr[1][2];
+    const double a20 = m_sdr[2][0], a21 = m_sdr[2][1], a22 = m_sdr[2][2];
+    const double s0 = m_scaling[0], s1 = m_scaling[1], s2 = m_scaling[2];
+
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double w0 = x[i*stride] - o0;
+        double w1 = y[i*stride] - o1;
+        double w2 = z[i*stride] - o2;
+        double b0 = (w0*a00 + w1*a01 + w2*a02)/s0 + 0.5;
+        double b1 = (w0*a10 + w1*a11 + w2*a12)/s1 + 0.5;
+        double b2 = (w0*a20 + w1*a21 + w2*a22)/s2 + 0.5;
+        mask[i] = uint8_t((b0 > -tol) & (b0 < 1.0+tol) & (b1 > -tol) & (b1 < 1.0+tol) & (b2 > -tol) & (b2 < 1.0+tol));
+    }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Cylinder IMPLEMENTATION 
 
@@ -1224,6 +1351,66 @@ bool Cylinder::intersectShapeAABBox(const darray3E &bMin, const darray3E &bMax){
 
 
 
+/*!
+ * Classify a block of points as included or not in the volume of the cylinder.
+ * Radial and height coordinates are tested in a vectorizable loop; the angular coordinate is
+ * evaluated only on the surviving points, and only if the cylinder is not a full one.
+ * \param[in] n      number of points
+ * \param[in] x      x coordinate of the first point
+ * \param[in] y      y coordinate of the first point
+ * \param[in] z      z coordinate of the first point
+ * \param[in] stride distance between the coordinates of consecutive points
+ * \param[out] mask  mask of the points, 1 if the point is included in the shape, 0 otherwise
+ */
+void Cylinder::classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask){
+
+    const double tol = 1.0E-12;
+    const double o0 = m_origin[0], o1 = m_origin[1], o2 = m_origin[2];
+    const double a00 = m_sdr[0][0], a01 = m_sdr[0][1], a02 = m_sdr[0][2];
+    const double a10 = m_sdr[1][0], a11 = m_sdr[1][1], a12 = m_sdr[1][2];
+    const double a20 = m_sdr[2][0], a21 = m_sdr[2][1], a22 = m_sdr[2][2];
+    const double s0 = m_scaling[0], s2 = m_scaling[2];
+    const double inf0 = m_infLimits[0];
+
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double w0 = x[i*stride] - o0;
+        double w1 = y[i*stride] - o1;
+        double w2 = z[i*stride] - o2;
+        double l0 = w0*a00 + w1*a01 + w2*a02;
+        double l1 = w0*a10 + w1*a11 + w2*a12;
+        double l2 = w0*a20 + w1*a21 + w2*a22;
+        double b0 = (std::sqrt(l0*l0 + l1*l1) - inf0)/s0;
+        double b2 = l2/s2 + 0.5;
+        mask[i] = uint8_t((b0 > -tol) & (b0 < 1.0+tol) & (b2 > -tol) & (b2 < 1.0+tol));
+    }
+
+    //angular coordinate lies in [0, 2*pi]: nothing to check on a full cylinder.
+    const double param = 2.0*M_PI;
+    const double span1 = m_span[1];
+    if(param/span1 < 1.0+tol)   return;
+
+    const double inf1 = m_infLimits[1];
+    for(long i=0; i<n; ++i){
+        if(!mask[i])    continue;
+        double w0 = x[i*stride] - o0;
+        double w1 = y[i*stride] - o1;
+        double w2 = z[i*stride] - o2;
+        double l0 = w0*a00 + w1*a01 + w2*a02;
+        double l1 = w0*a10 + w1*a11 + w2*a12;
+        double theta = 0.0;
+        if(!(l0 == 0.0 && l1 == 0.0)){
+            double pdum = std::atan2(l1,l0);
+            theta = pdum - (getSign(pdum)-1.0)*M_PI;
+        }
+        theta = theta - inf1;
+        if(theta < 0)       theta = param + theta;
+        if(theta > param)   theta = theta - param;
+        double b1 = theta/span1;
+        mask[i] = uint8_t((b1 > -tol) && (b1 < 1.0+tol));
+    }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Sphere IMPLEMENTATION 
 
@@ -1506,6 +1693,79 @@ bool Sphere::intersectShapeAABBox(const darray3E &bMin, const darray3E &bMax){
     
 };
 
+/*!
+ * Classify a block of points as included or not in the volume of the sphere.
+ * The radial coordinate is tested in a vectorizable loop; angular coordinates are
+ * evaluated only on the surviving points, and only if the sphere is not a full one along them.
+ * \param[in] n      number of points
+ * \param[in] x      x coordinate of the first point
+ * \param[in] y      y coordinate of the first point
+ * \param[in] z      z coordinate of the first point
+ * \param[in] stride distance between the coordinates of consecutive points
+ * \param[out] mask  mask of the points, 1 if the point is included in the shape, 0 otherwise
+ */
+void Sphere::classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask){
+
+    const double tol = 1.0E-12;
+    const double o0 = m_origin[0], o1 = m_origin[1], o2 = m_origin[2];
+    const double a00 = m_sdr[0][0], a01 = m_sdr[0][1], a02 = m_sdr[0][2];
+    const double a10 = m_sdr[1][0], a11 = m_sdr[1][1], a12 = m_sdr[1][2];
+    const double a20 = m_sdr[2][0], a21 = m_sdr[2][1], a22 = m_sdr[2][2];
+    const double s0 = m_scaling[0];
+    const double inf0 = m_infLimits[0];
+
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double w0 = x[i*stride] - o0;
+        double w1 = y[i*stride] - o1;
+        double w2 = z[i*stride] - o2;
+        double l0 = w0*a00 + w1*a01 + w2*a02;
+        double l1 = w0*a10 + w1*a11 + w2*a12;
+        double l2 = w0*a20 + w1*a21 + w2*a22;
+        double b0 = (std::sqrt(l0*l0 + l1*l1 + l2*l2) - inf0)/s0;
+        mask[i] = uint8_t((b0 > -tol) & (b0 < 1.0+tol));
+    }
+
+    //azimuthal coordinate lies in [0, 2*pi], polar one in [0, pi]: nothing to check on full ranges.
+    const double param = 2.0*M_PI;
+    const double span1 = m_span[1], span2 = m_span[2];
+    const double inf1 = m_infLimits[1], inf2 = m_infLimits[2];
+    bool checkTheta = !(param/span1 < 1.0+tol);
+    bool checkPhi = !(inf2 == 0.0 && M_PI/span2 < 1.0+tol);
+    if(!checkTheta && !checkPhi)    return;
+
+    for(long i=0; i<n; ++i){
+        if(!mask[i])    continue;
+        double w0 = x[i*stride] - o0;
+        double w1 = y[i*stride] - o1;
+        double w2 = z[i*stride] - o2;
+        double l0 = w0*a00 + w1*a01 + w2*a02;
+        double l1 = w0*a10 + w1*a11 + w2*a12;
+        double l2 = w0*a20 + w1*a21 + w2*a22;
+        double r = std::sqrt(l0*l0 + l1*l1 + l2*l2);
+        if(!(r > 0.0))  continue;
+
+        bool included = true;
+        if(checkTheta){
+            double theta = 0.0;
+            if(!(l0 == 0.0 && l1 == 0.0)){
+                double pdum = std::atan2(l1,l0);
+                theta = pdum - (getSign(pdum)-1.0)*M_PI;
+            }
+            theta = theta - inf1;
+            if(theta < 0)       theta = param + theta;
+            if(theta > param)   theta = theta - param;
+            double b1 = theta/span1;
+            included = (b1 > -tol) && (b1 < 1.0+tol);
+        }
+        if(included && checkPhi){
+            double b2 = (std::acos(l2/r) - inf2)/span2;
+            included = (b2 > -tol) && (b2 < 1.0+tol);
+        }
+        mask[i] = uint8_t(included);
+    }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Wedge IMPLEMENTATION 
 
@@ -74,6 +74,11 @@ enum class CoordType{
  * + Local Relative SDR: is the local reference system, not affected by Rigid Transformations as RotoTranslations or Scalings 
  * + basic SDR: local system remapping to unitary cube, not accounting of the shape type.  
  *   
+ * Inclusion of large sets of points is classified in batch, see BasicShape::classifyPoints:
+ * points are split in blocks, distributed among the available threads (if mimmo is compiled with
+ * OpenMP support), and each block is tested by the classifyBlock kernel of the shape.
+ * Cube, Cylinder and Sphere specialize the kernel, transforming contiguous coordinates
+ * to the local reference system in vectorizable loops; the other shapes test the points one by one.
  */
 class BasicShape {
 
@@ -139,6 +144,9 @@ public:
     bool        isPointIncluded(const darray3E &);
     bool        isPointIncluded(bitpit::PatchKernel * , const long int &indexV);
 
+    std::vector<uint8_t>    classifyPoints(const dvecarr3E & points);
+    void        classifyPoints(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask);
+
     /*!
      * Pure virtual method to get if the current shape an a given Axis Aligned Bounding Box intersects
      * \param[in] bMin min point of AABB
@@ -172,6 +180,9 @@ protected:
     uint32_t    intersectShapePlane(int level, const darray3E & target);
     darray3E    checkNearestPointToAABBox(const darray3E &point, const darray3E &bMin, const darray3E &bMax);
     void swap(BasicShape & ) noexcept;
+
+    virtual void    classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask);
+    void            classifyCells(bitpit::PatchKernel * geo, const livector1D & cellIds, std::vector<uint8_t> & mask);
     
 private:	
     /*!
@@ -257,6 +268,7 @@ private:
     bool        checkInfLimits(double &, int & dir);
     void        setScaling(const double &, const double &, const double &);
     void        getTempBBox();
+    void        classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask);
 };
 
 /*!
@@ -290,6 +302,7 @@ private:
     bool 		checkInfLimits( double &, int &);
     void 		setScaling(const double &, const double &, const double &);
     void		getTempBBox();
+    void		classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask);
 };
 
 
@@ -324,6 +337,7 @@ private:
     bool        checkInfLimits(double &, int &);
     void        setScaling(const double &, const double &, const double &);
     void        getTempBBox();
+    void        classifyBlock(long n, const double * x, const double * y, const double * z, std::ptrdiff_t stride, uint8_t * mask);
 };
 
 /*!
@@ -22,6 +22,12 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "Chain.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
 
 using namespace std;
 
@@ -41,6 +47,7 @@ Chain::Chain(){
     sm_chaincounter++;
     m_plotDebRes = false;
     m_outputDebRes = ".";
+    m_nthreads = 1;
     m_log = &bitpit::log::cout(MIMMO_LOG_FILE);
 };
 
@@ -63,6 +70,7 @@ Chain::Chain(const Chain & other){
     m_objcounter   = other.m_objcounter;
     m_plotDebRes   = other.m_plotDebRes;
     m_outputDebRes = other.m_outputDebRes;
+    m_nthreads     = other.m_nthreads;
     m_log = &bitpit::log::cout(MIMMO_LOG_FILE);
 };
 
@@ -256,18 +264,36 @@ std::string Chain::getOutputDebugResults(){
 }
 
 
+/*!
+ * Set the number of workers used to execute the chain.
+ * With 1 worker (default) the objects are executed serially in the chain order.
+ * With more workers, objects whose parents in the chain are all executed
+ * run concurrently. A value <= 0 uses all the available hardware threads.
+ * \param[in] nthreads number of workers
+ */
+void Chain::setNumThreads(int nthreads){
+    m_nthreads = nthreads;
+}
+
+/*!
+ * \return number of workers used to execute the chain, as set by setNumThreads.
+ */
+int Chain::getNumThreads(){
+    return m_nthreads;
+}
+
 /*!
  * It executes the chain, i.e. it executes all the manipulator objects
  * contained in the chain following the correct order.
  * In the case that a loop exists in the chain the execution doesn't start and
  * the process ends with an error.
+ * If more than one worker is set (see setNumThreads) independent objects of the
+ * chain are executed concurrently, otherwise the chain is executed serially.
  * \param[in]	debug boolean to activate verbose execution mode.
  */
 void
 Chain::exec(bool debug){
     m_log = &bitpit::log::cout(MIMMO_LOG_FILE);
-    vector<BaseManipulation*>::iterator it, itb = m_objects.begin();
-    vector<BaseManipulation*>::iterator itend = m_objects.end();
     if(debug)
         m_log->setPriority(bitpit::log::NORMAL);
     (*m_log) << " " << endl;
@@ -279,17 +305,18 @@ Chain::exec(bool debug){
         (*m_log) << " Results will be stored in the directory: "<<m_outputDebRes<< std::endl;
         (*m_log) << "--------------------------------------------------" << std::endl;
     }
+    int nworkers = m_nthreads;
+    if (nworkers <= 0) nworkers = std::max(1, int(std::thread::hardware_concurrency()));
+    nworkers = std::min(nworkers, int(m_objects.size()));
+    if (nworkers > 1){
+        (*m_log) << " Parallel execution on " << nworkers << " workers" << std::endl;
+    }
     (*m_log) << " " << std::endl;
     checkLoops();
-    int i = 1;
-    for (it = itb; it != itend; ++it){
-        (*m_log) << " execution object " << i << "	: " << (*it)->getName() << std::endl;
-        if(m_plotDebRes){
-            (*it)->setPlotInExecution(m_plotDebRes);
-            (*it)->setOutputPlot(m_outputDebRes);
-        }    
-        (*it)->exec();
-        i++;
+    if (nworkers > 1){
+        execParallel(nworkers);
+    }else{
+        execSerial();
     }
 
     (*m_log) << " " << std::endl;
@@ -298,6 +325,174 @@ Chain::exec(bool debug){
     m_log->setPriority(bitpit::log::DEBUG);
 }
 
+/*!
+ * Execute the object in position idx of the chain, applying the plot settings
+ * of debug results of the chain.
+ * \param[in] idx position of the object in the chain.
+ */
+void
+Chain::execObject(int idx){
+    BaseManipulation * obj = m_objects[idx];
+    if(m_plotDebRes){
+        obj->setPlotInExecution(m_plotDebRes);
+        obj->setOutputPlot(m_outputDebRes);
+    }
+    obj->exec();
+}
+
+/*!
+ * Execute serially all the objects of the chain, in the chain order.
+ */
+void
+Chain::execSerial(){
+    for (int i=0; i<(int)m_objects.size(); i++){
+        (*m_log) << " execution object " << i+1 << "	: " << m_objects[i]->getName() << std::endl;
+        execObject(i);
+    }
+}
+
+/*!
+ * Execute the objects of the chain as a task graph on a pool of workers.
+ * The dependencies are given by the parent/child relations among the objects
+ * of the chain; an object is ready as soon as all its parents are executed and
+ * its input ports are filled. Ready objects are picked in chain order.
+ * Objects involving the same geometries (see BaseManipulation::getInvolvedGeometries)
+ * are never executed at the same time, since the lazy structures of a geometry
+ * (search trees, coordinates view) are built on demand by the objects using it.
+ * Each worker writes the messages of the object in execution, and of its geometries,
+ * on its own logger, <MIMMO_LOG_FILE>_worker<i>.
+ * The calling thread takes part to the execution. If an object throws,
+ * no other object is started and the first exception is rethrown once the
+ * running objects are completed.
+ * \param[in] nworkers number of workers
+ */
+void
+Chain::execParallel(int nworkers){
+
+    int nobjects = m_objects.size();
+    std::unordered_map<BaseManipulation*, int> position;
+    for (int i=0; i<nobjects; i++){
+        position[m_objects[i]] = i;
+    }
+
+    //dependencies graph, restricted to the objects of the chain.
+    std::vector<ivector1D> children(nobjects);
+    ivector1D nparents(nobjects, 0);
+    for (int i=0; i<nobjects; i++){
+        for (int j=0; j<m_objects[i]->getNChild(); j++){
+            auto itchild = position.find(m_objects[i]->getChild(j));
+            if (itchild != position.end()){
+                children[i].push_back(itchild->second);
+                nparents[itchild->second]++;
+            }
+        }
+    }
+
+    std::set<int> ready;
+    for (int i=0; i<nobjects; i++){
+        if (nparents[i] == 0) ready.insert(i);
+    }
+
+    //loggers of the workers, created before any worker is started.
+    std::vector<bitpit::Logger*> loggers(nworkers);
+    for (int i=0; i<nworkers; i++){
+        loggers[i] = &bitpit::log::cout(MIMMO_LOG_FILE + "_worker" + std::to_string(i));
+        bitpit::log::setConsoleVerbosity((*loggers[i]), bitpit::log::NORMAL);
+        bitpit::log::setFileVerbosity((*loggers[i]), bitpit::log::DEBUG);
+        (*loggers[i]) << bitpit::log::context("mimmo");
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::exception_ptr error;
+    int executed = 0;
+    std::set<MimmoObject*> busy;
+
+    //first ready object, in chain order, whose geometries are not in use.
+    auto pick = [&](std::vector<MimmoObject*> & geometries){
+        for (int idx : ready){
+            std::vector<MimmoObject*> candidate = m_objects[idx]->getInvolvedGeometries();
+            bool available = true;
+            for (MimmoObject * geo : candidate){
+                available = available && (busy.count(geo) == 0);
+            }
+            if (available){
+                geometries.clear();
+                for (MimmoObject * geo : candidate){
+                    if (std::find(geometries.begin(), geometries.end(), geo) == geometries.end()) geometries.push_back(geo);
+                }
+                return idx;
+            }
+        }
+        return -1;
+    };
+
+    auto worker = [&](int iworker){
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true){
+            int idx = -1;
+            std::vector<MimmoObject*> geometries;
+            cv.wait(lock, [&]{ return error || executed == nobjects || (idx = pick(geometries)) >= 0; });
+            if (error || executed == nobjects) break;
+
+            ready.erase(idx);
+            busy.insert(geometries.begin(), geometries.end());
+            BaseManipulation * obj = m_objects[idx];
+            (*m_log) << " execution object " << idx+1 << "	: " << obj->getName() << std::endl;
+            lock.unlock();
+
+            //object and geometries are used by this worker only, until released.
+            bitpit::Logger * objLog = obj->m_log;
+            std::vector<bitpit::Logger*> geoLogs;
+            obj->m_log = loggers[iworker];
+            for (MimmoObject * geo : geometries){
+                geoLogs.push_back(geo->m_log);
+                geo->m_log = loggers[iworker];
+            }
+
+            std::exception_ptr failure;
+            try{
+                execObject(idx);
+            }catch(...){
+                failure = std::current_exception();
+            }
+
+            obj->m_log = objLog;
+            for (std::size_t i=0; i<geometries.size(); i++){
+                geometries[i]->m_log = geoLogs[i];
+            }
+
+            lock.lock();
+            for (MimmoObject * geo : geometries){
+                busy.erase(geo);
+            }
+            if (failure){
+                if (!error) error = failure;
+                cv.notify_all();
+                continue;
+            }
+            executed++;
+            for (int child : children[idx]){
+                nparents[child]--;
+                if (nparents[child] == 0) ready.insert(child);
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(nworkers-1);
+    for (int i=1; i<nworkers; i++){
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread & thread : pool){
+        thread.join();
+    }
+
+    if (error) std::rethrow_exception(error);
+}
+
 /*!
  * It executes one manipulator object contained in the chain singularly.
  * \param[in] idobj ID of the target manipulator object.
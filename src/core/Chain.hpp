@@ -44,6 +44,15 @@ namespace mimmo{
  * conflicts in parent/child dependencies.
  * Closed connections loops in the chain are not allowed.
  *
+ * By default the objects are executed one after the other on the calling thread.
+ * Setting a number of workers greater than 1 (see setNumThreads) the chain is executed
+ * as a task graph: each object is scheduled as soon as all its parents in the chain
+ * have been executed, so that independent branches of the workflow run concurrently.
+ * Objects involving the same geometries are never executed at the same time, but
+ * objects not linked by ports are not ordered by the scheduler: if their order matters
+ * (e.g. two blocks applying their deformation to the same geometry) link them or run
+ * the chain with a single worker.
+ *
  */
 class Chain{
 protected:
@@ -57,6 +66,7 @@ protected:
 
     bool                            m_plotDebRes;       /**<boolean to activate plotting of debug intermediate results */
     std::string                     m_outputDebRes;     /**<directory path to store the debug intermediate results, if plot is enabled*/
+    int                             m_nthreads;         /**<number of workers executing the chain. 1 serial, <=0 all hardware threads */
 	//static members
 	static	uint8_t					sm_chaincounter;	/**<Current global number of chain in the instance. */
 
@@ -83,7 +93,10 @@ public:
     void            setOutputDebugResults(std::string path);
     bool            isPlottingDebugResults();
     std::string     getOutputDebugResults();
-    
+
+    void            setNumThreads(int nthreads);
+    int             getNumThreads();
+
 	//relationship methods
 	void 		exec(bool debug = false);
 	void 		exec(int idobj);
@@ -91,6 +104,9 @@ public:
 private:
 	//check methods
 	void		checkLoops();
+	void		execObject(int idx);
+	void		execSerial();
+	void		execParallel(int nworkers);
 
 };
 
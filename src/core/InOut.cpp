@@ -23,6 +23,7 @@
 \*---------------------------------------------------------------------------*/
 #include "InOut.hpp"
 #include "BaseManipulation.hpp"
+#include <mutex>
 
 using namespace std;
 
@@ -1010,6 +1011,7 @@ bool DataType::operator==(const DataType & other){
  */
 PortOut::PortOut(){
     m_objLink.clear();
+    m_nbytes = 0;
 };
 
 /*!
@@ -1025,6 +1027,7 @@ PortOut::PortOut(const PortOut & other){
     m_obuffer	= other.m_obuffer;
     m_portLink	= other.m_portLink;
     m_datatype	= other.m_datatype;
+    m_nbytes    = other.m_nbytes;
     return;
 };
 
@@ -1072,6 +1075,30 @@ PortOut::getDataType(){
 void
 mimmo::PortOut::cleanBuffer(){
     m_obuffer.seekg(0);
+    m_odata.reset();
+}
+
+/*!
+ * \return size in bytes of the data streamed in the last execution of the port.
+ * If data were passed to the receivers through shared handle, 0 is returned (see evalDataBytes).
+ */
+long
+mimmo::PortOut::getStreamedBytes(){
+    return m_nbytes;
+}
+
+/*!
+ * Evaluate the size in bytes of the data communicated by the port, as they would be streamed.
+ * Data are fetched from the owner and streamed in a temporary buffer, so the cost is
+ * comparable to a streamed execution of the port; it is meant for profiling only.
+ * \return size in bytes of the streamed data
+ */
+long
+mimmo::PortOut::evalDataBytes(){
+    writeData();
+    long nbytes = getDataBytes();
+    cleanBuffer();
+    return nbytes;
 }
 
 /*!
@@ -1099,16 +1126,52 @@ mimmo::PortOut::clear(int j){
  * Execution of the PIN.
  * All the pins are called in execution of the sending owner after its own execution.
  * Reading stage of pin linked receivers is automatically performed within this execution.
+ * Data are passed to receivers through a shared handle, unless binary streaming is forced
+ * (see mimmo::setPortStreaming) or a receiver port does not share the C++ data type of the sender.
  */
 void
 mimmo::PortOut::exec(){
+    m_nbytes = 0;
     if (m_objLink.size() > 0){
-        writeBuffer();
-        bitpit::IBinaryStream input(m_obuffer.data(), m_obuffer.getSize());
-        cleanBuffer();
+
+        bool streaming = MIMMO_PORT_STREAMING;
+        int last = -1;
         for (int j=0; j<(int)m_objLink.size(); j++){
             if (m_objLink[j] != NULL){
-                m_objLink[j]->setBufferIn(m_portLink[j], input);
+                streaming = streaming || (m_objLink[j]->m_portIn[m_portLink[j]]->getTypeInfo() != getTypeInfo());
+                last = j;
+            }
+        }
+
+        //receivers can be fed concurrently by parents running on different
+        //workers of a Chain: delivery into the receivers is serialized.
+        static std::mutex deliveryMutex;
+
+        if (streaming){
+            writeBuffer();
+            bitpit::IBinaryStream input(m_obuffer.data(), m_obuffer.getSize());
+            m_nbytes = m_obuffer.getSize();
+            cleanBuffer();
+            std::lock_guard<std::mutex> lock(deliveryMutex);
+            for (int j=0; j<(int)m_objLink.size(); j++){
+                if (m_objLink[j] != NULL){
+                    m_objLink[j]->setBufferIn(m_portLink[j], input);
+                    m_objLink[j]->readBufferIn(m_portLink[j]);
+                    m_objLink[j]->cleanBufferIn(m_portLink[j]);
+                }
+            }
+            return;
+        }
+
+        writeData();
+        std::shared_ptr<void> data = m_odata;
+        cleanBuffer();
+        std::lock_guard<std::mutex> lock(deliveryMutex);
+        for (int j=0; j<=last; j++){
+            if (m_objLink[j] != NULL){
+                //last receiver becomes the only owner of data.
+                if (j == last)  m_objLink[j]->setDataIn(m_portLink[j], std::move(data));
+                else            m_objLink[j]->setDataIn(m_portLink[j], data);
                 m_objLink[j]->readBufferIn(m_portLink[j]);
                 m_objLink[j]->cleanBufferIn(m_portLink[j]);
             }
@@ -1215,6 +1278,7 @@ mimmo::PortIn::clear(int j){
 void
 mimmo::PortIn::cleanBuffer(){
     m_ibuffer.seekg(0);
+    m_idata.reset();
 }
 
 }
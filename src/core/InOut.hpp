@@ -30,6 +30,8 @@
 #include "MimmoPiercedVector.hpp"
 #include "TrackingPointer.hpp"
 #include <functional>
+#include <memory>
+#include <typeinfo>
 
 namespace mimmo{
 
@@ -101,14 +103,22 @@ public:
 * 
 * The execution of the output PortT will automatically
 * exchange the buffer data, pass it to the input ports connected and makes them reading and decoding the data.
+*
+* Within the same process, data are not serialized by default: the sender wraps them in a reference-counted
+* shared handle (m_odata) that is passed as is to all the receivers of the same C++ type. The last receiver
+* takes the ownership of the data by moving them, the others get a copy. Binary streaming through m_obuffer is
+* still employed if one of the receivers does not match the data type of the sender, or if forced
+* globally with mimmo::setPortStreaming (e.g. MPI or out-of-process communications).
 */
 class PortOut{
 public:
     //members
     bitpit::OBinaryStream           m_obuffer;	/**<Output buffer to communicate data.*/
+    std::shared_ptr<void>           m_odata;    /**<Shared handle to data communicated without streaming.*/
     std::vector<BaseManipulation*>  m_objLink;	/**<Outputs object to which communicate the data.*/
     std::vector<PortID>             m_portLink;	/**<ID of the input ports of the linked objects.*/
     DataType                        m_datatype;	/**<TAG of type of data communicated.*/
+    long                            m_nbytes;   /**<Bytes streamed in the last execution (see getStreamedBytes).*/
 
 public:
     PortOut();
@@ -120,11 +130,25 @@ public:
     std::vector<BaseManipulation*>	getLink();
     std::vector<PortID>				getPortLink();
     DataType						getDataType();
+    long                            getStreamedBytes();
+    long                            evalDataBytes();
 
     /*!
      * Pure virtual function to write a buffer.
      */
     virtual void	writeBuffer() = 0;
+    /*!
+     * Pure virtual function to write the shared data handle.
+     */
+    virtual void    writeData() = 0;
+    /*!
+     * Pure virtual function returning the size in bytes of the data in the shared handle, once streamed.
+     */
+    virtual long    getDataBytes() = 0;
+    /*!
+     * Pure virtual function returning the C++ type of data communicated.
+     */
+    virtual const std::type_info & getTypeInfo() = 0;
     void 			cleanBuffer();
 
     void clear();
@@ -181,6 +205,9 @@ public:
     bool operator==(const PortOutT & other);
 
     void writeBuffer();
+    void writeData();
+    long getDataBytes();
+    const std::type_info & getTypeInfo();
 
 };
 
@@ -206,11 +233,13 @@ public:
 * and read as a buffer stream m_ibuffer. This class is responsible to decode the data and handle with the problem to manage multiple data 
 * coming from multiple senders and makes it available (how to read the data, handle with its multiplicity and makes it available its still
 * not specified in this abstract class).
+* Same-process senders may pass a shared data handle (m_idata) instead of a buffer stream. See PortOut.
 */
 class PortIn{
 public:
     //members
     bitpit::IBinaryStream               m_ibuffer;          /**<input buffer to recover data.*/
+    std::shared_ptr<void>               m_idata;            /**<shared handle to data received without streaming.*/
     std::vector<BaseManipulation*>      m_objLink;          /**<Input objects from which recover the data. */
     DataType                            m_datatype;         /**<TAG of type of data communicated.*/
     bool                                m_mandatory;        /**<Does the port have to be mandatorily linked?.*/
@@ -237,6 +266,10 @@ public:
      * Pure virtual function to read a buffer.
      */
     virtual void    readBuffer() = 0;
+    /*!
+     * Pure virtual function returning the C++ type of data communicated.
+     */
+    virtual const std::type_info & getTypeInfo() = 0;
     void            cleanBuffer();
 
 };
@@ -290,6 +323,7 @@ public:
     bool operator==(const PortInT & other);
 
     void readBuffer();
+    const std::type_info & getTypeInfo();
 
 };
 
@@ -138,6 +138,47 @@ PortOutT<T,O>::writeBuffer(){
     }
 }
 
+/*!
+* It wraps the data to be communicated in the shared handle m_odata, with no serialization.
+* It uses the linked get function if the member pointer m_getVar_ is not NULL.
+* Alternatively it uses a copy of m_var_ (if not NULL).
+*/
+template<typename T, typename O>
+void
+PortOutT<T,O>::writeData(){
+    m_odata.reset();
+    if (m_getVar_ != NULL){
+        m_odata = std::make_shared<T>((m_obj_->*m_getVar_)());
+        return;
+    }
+    if (m_var_ != NULL){
+        m_odata = std::make_shared<T>(*m_var_);
+    }
+}
+
+/*!
+* Evaluate the size of the data wrapped in the shared handle m_odata, streaming them
+* in a temporary buffer.
+* \return size in bytes of the streamed data, 0 if no data are wrapped.
+*/
+template<typename T, typename O>
+long
+PortOutT<T,O>::getDataBytes(){
+    if (!m_odata) return 0;
+    bitpit::OBinaryStream buffer;
+    buffer << *(std::static_pointer_cast<T>(m_odata));
+    return long(buffer.getSize());
+}
+
+/*!
+* \return C++ type of the data communicated by the port.
+*/
+template<typename T, typename O>
+const std::type_info &
+PortOutT<T,O>::getTypeInfo(){
+    return typeid(T);
+}
+
 
 
 /*!
@@ -248,10 +289,35 @@ bool  PortInT<T, O>::operator==(const PortInT<T, O> & other){
 /*!
  * It reads the buffer of the output port with the data to be communicated.
  * It stores the read values in the linked m_var_ by casting in the stream operator.
+ * If a shared data handle was received instead, data are passed to m_var_ or set method
+ * with no deserialization.
  */
 template<typename T, typename O>
 void
 PortInT<T, O>::readBuffer(){
+    if (m_idata){
+        //direct exchange: steal data if this port is the only owner of the handle, copy them otherwise.
+        std::shared_ptr<T> data = std::static_pointer_cast<T>(m_idata);
+        m_idata.reset();
+        if (data.use_count() == 1){
+            if (m_setVar_ != NULL){
+                (m_obj_->*m_setVar_)(std::move(*data));
+                return;
+            }
+            if (m_var_ != NULL){
+                (*m_var_) = std::move(*data);
+            }
+        }else{
+            if (m_setVar_ != NULL){
+                (m_obj_->*m_setVar_)(*data);
+                return;
+            }
+            if (m_var_ != NULL){
+                (*m_var_) = *data;
+            }
+        }
+        return;
+    }
     T temp;
     m_ibuffer >> temp;
     if (m_setVar_ != NULL){
@@ -263,4 +329,13 @@ PortInT<T, O>::readBuffer(){
     }
 }
 
+/*!
+* \return C++ type of the data communicated by the port.
+*/
+template<typename T, typename O>
+const std::type_info &
+PortInT<T, O>::getTypeInfo(){
+    return typeid(T);
+}
+
 }
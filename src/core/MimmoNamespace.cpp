@@ -4,6 +4,8 @@
 std::string mimmo::MIMMO_LOG_FILE = "mimmo"; /**<Default name of logger file.*/
 bool        mimmo::MIMMO_EXPERT = false;    /**<Flag that defines expert mode (true) or safe mode (false).
                                                 In case of expert mode active the mandatory ports are not checked. */
+bool        mimmo::MIMMO_PORT_STREAMING = false; /**<Flag that forces data exchange between ports through binary streams (true),
+                                                     instead of shared data handles (false).*/
 
 namespace mimmo{
 
@@ -178,6 +180,16 @@ void setExpertMode(bool flag){
     MIMMO_EXPERT = flag;
 }
 
+/*!
+ * Force/release binary streaming of data exchanged between ports.
+ * By default, ports of blocks living in the same process pass their data through shared handles,
+ * with no serialization. Streaming can be forced, for example, for MPI or out-of-process communications.
+ * \param[in] flag true to force binary streaming, false to allow direct data exchange.
+ */
+void setPortStreaming(bool flag){
+    MIMMO_PORT_STREAMING = flag;
+}
+
 
 /*!Maximum value function for MimmoPiercedVector<double>.
  * \param[in] field MimmoPiercedVector<double>
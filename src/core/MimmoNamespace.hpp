@@ -102,6 +102,12 @@ extern bool MIMMO_EXPERT; /**<Flag that defines expert mode (true) or safe mode
 
 void setExpertMode(bool flag = true);
 
+//port data exchange variable
+extern bool MIMMO_PORT_STREAMING; /**<Flag that forces data exchange between ports through binary streams (true),
+                                       instead of passing shared data handles between blocks of the same process (false).*/
+
+void setPortStreaming(bool flag = true);
+
 //miscellanea
 double  maxvalmp(const MimmoPiercedVector<double> & field);
 
@@ -23,8 +23,13 @@
 \*---------------------------------------------------------------------------*/
 
 #include "MimmoObject.hpp"
+#include "MimmoPiercedVector.hpp"
 #include "Operators.hpp"
 #include "SkdTreeUtils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <set>
 
 using namespace std;
@@ -32,6 +37,359 @@ using namespace bitpit;
 
 namespace mimmo{
 
+/*!
+ * \return a new geometry revision stamp, unique among all MimmoObject instances.
+ */
+static unsigned long nextRevision(){
+    static std::atomic<unsigned long> counter(0);
+    return ++counter;
+}
+
+/*!
+ * Sort a list of vertices in the insertion order of a balanced bitpit::KdTree,
+ * i.e. the pre-order visit of a tree splitting, at each level, the vertices
+ * on the median coordinate along the axis level%3.
+ * Sub-lists are sorted concurrently as OpenMP tasks, if the caller runs in a parallel region.
+ * \param[in] begin iterator to the first vertex of the list
+ * \param[in] end iterator past the last vertex of the list
+ * \param[in] level level of the tree of the first vertex of the list
+ */
+static void
+sortKdTreeInsertion(std::vector<bitpit::Vertex*>::iterator begin, std::vector<bitpit::Vertex*>::iterator end, int level)
+{
+    std::ptrdiff_t size = end - begin;
+    if (size <= 1) return;
+
+    int dir = level % 3;
+    std::vector<bitpit::Vertex*>::iterator median = begin + size/2;
+    std::nth_element(begin, median, end, [dir](const bitpit::Vertex * a, const bitpit::Vertex * b){
+        return a->getCoords()[dir] < b->getCoords()[dir];
+    });
+    //median is the root of the current sub-tree, followed by the left and the right sub-trees.
+    std::rotate(begin, median, median+1);
+    std::vector<bitpit::Vertex*>::iterator split = begin + 1 + size/2;
+
+#pragma omp task if(size > 8192)
+    sortKdTreeInsertion(begin+1, split, level+1);
+    sortKdTreeInsertion(split, end, level+1);
+#pragma omp taskwait
+}
+
+/*!
+ * \struct CleanBucketEntry
+ * Vertex of a spatial hashing grid: packed integer coordinates of its bucket and dense position of the vertex.
+ */
+struct CleanBucketEntry{
+    uint64_t    key;    /**< bucket coordinates, packed in 21 bits each */
+    long        pos;    /**< dense position of the vertex */
+
+    /*!
+     * Ordering by bucket, then by position.
+     * \param[in] other entry to compare with
+     * \return true if the entry precedes other
+     */
+    bool operator<(const CleanBucketEntry & other) const{
+        return (key < other.key) || (key == other.key && pos < other.pos);
+    }
+};
+
+/*!
+ * Sort a list of bucket entries. Halves are sorted concurrently as OpenMP tasks,
+ * if the caller runs in a parallel region, then merged.
+ * \param[in] begin iterator to the first entry of the list
+ * \param[in] end iterator past the last entry of the list
+ */
+static void
+sortCleanBuckets(std::vector<CleanBucketEntry>::iterator begin, std::vector<CleanBucketEntry>::iterator end)
+{
+    std::ptrdiff_t size = end - begin;
+    if (size <= 8192){
+        std::sort(begin, end);
+        return;
+    }
+    std::vector<CleanBucketEntry>::iterator half = begin + size/2;
+#pragma omp task
+    sortCleanBuckets(begin, half);
+    sortCleanBuckets(half, end);
+#pragma omp taskwait
+    std::inplace_merge(begin, half, end);
+}
+
+/*!
+ * Find coincident vertices in a coordinates view, i.e. vertices closer than a tolerance.
+ * Vertices are hashed in a grid of buckets sized on the mean vertex spacing, and never smaller
+ * than the tolerance, so that the candidates of each vertex lie in its bucket or in the neighbour
+ * ones; a neighbour bucket is visited only if the vertex is closer than the tolerance to the
+ * bucket face shared with it. Candidates are searched in parallel, if OpenMP is enabled.
+ * Each vertex is merged into the first vertex, in dense order, closer than the tolerance;
+ * chains of merges are collapsed on their first vertex, so that the result does not depend
+ * on the number of threads.
+ * \param[in] view coordinates of the vertices
+ * \param[in] tol tolerance on the distance of coincident vertices
+ * \return dense position of the vertex each vertex is merged into (its own position if not merged)
+ */
+static std::vector<long>
+findCoincidentVertices(const CoordinatesView & view, double tol)
+{
+    long nVertices = view.size();
+    std::vector<long> master(nVertices);
+    if(nVertices == 0) return master;
+
+    //buckets span the bounding box of the vertices; their size is not smaller than the mean
+    //spacing, so that there are at most cbrt(nVertices)+1 buckets along each direction.
+    std::array<double,3> origin;
+    double h;
+    {
+        auto rx = std::minmax_element(view.x.begin(), view.x.end());
+        auto ry = std::minmax_element(view.y.begin(), view.y.end());
+        auto rz = std::minmax_element(view.z.begin(), view.z.end());
+        origin = {{*rx.first, *ry.first, *rz.first}};
+        double diagonal = std::max({*rx.second - *rx.first, *ry.second - *ry.first, *rz.second - *rz.first});
+        h = std::max(tol, diagonal/std::cbrt(double(nVertices)));
+        if(h <= 0.0)    h = 1.0;
+    }
+    const long maxBucket = (1L << 21) - 1;
+    double tol2 = tol*tol;
+    auto packKey = [](long bx, long by, long bz){
+        return (uint64_t(bx) << 42) | (uint64_t(by) << 21) | uint64_t(bz);
+    };
+
+    std::vector<CleanBucketEntry> entries(nVertices);
+    std::vector<long> sorted(nVertices);
+#pragma omp parallel
+    {
+#pragma omp for schedule(static)
+        for(long i=0; i<nVertices; ++i){
+            entries[i].key = packKey(long((view.x[i] - origin[0])/h), long((view.y[i] - origin[1])/h), long((view.z[i] - origin[2])/h));
+            entries[i].pos = i;
+        }
+#pragma omp single
+        sortCleanBuckets(entries.begin(), entries.end());
+
+#pragma omp for schedule(static)
+        for(long k=0; k<nVertices; ++k){
+            sorted[entries[k].pos] = k;
+        }
+
+        //first candidate in dense order closer than tolerance
+#pragma omp for schedule(dynamic, 1024)
+        for(long i=0; i<nVertices; ++i){
+            long best = i;
+            std::array<double,3> coords = {{view.x[i], view.y[i], view.z[i]}};
+            std::array<long,3> bucket, lower, upper;
+            for(int j=0; j<3; ++j){
+                double local = coords[j] - origin[j];
+                bucket[j] = long(local/h);
+                lower[j] = std::max(0L, bucket[j] - long(local - tol < double(bucket[j])*h));
+                upper[j] = std::min(maxBucket, bucket[j] + long(local + tol >= double(bucket[j]+1)*h));
+            }
+            uint64_t key = packKey(bucket[0], bucket[1], bucket[2]);
+            for(long bx=lower[0]; bx<=upper[0]; ++bx){
+                for(long by=lower[1]; by<=upper[1]; ++by){
+                    for(long bz=lower[2]; bz<=upper[2]; ++bz){
+                        CleanBucketEntry first;
+                        first.key = packKey(bx, by, bz);
+                        first.pos = std::numeric_limits<long>::min();
+                        std::vector<CleanBucketEntry>::const_iterator it;
+                        if(first.key == key){
+                            //own bucket: vertices preceding i are the ones before it in the sorted list.
+                            it = entries.cbegin() + sorted[i];
+                            while(it != entries.cbegin() && (it-1)->key == key) --it;
+                        }else{
+                            it = std::lower_bound(entries.cbegin(), entries.cend(), first);
+                        }
+                        for(; it != entries.cend() && it->key == first.key && it->pos < best; ++it){
+                            double ddx = view.x[it->pos] - coords[0];
+                            double ddy = view.y[it->pos] - coords[1];
+                            double ddz = view.z[it->pos] - coords[2];
+                            if(ddx*ddx + ddy*ddy + ddz*ddz <= tol2)  best = it->pos;
+                        }
+                    }
+                }
+            }
+            master[i] = best;
+        }
+    }
+
+    //collapse chains: candidates precede their vertex, so their master is already final.
+    for(long i=0; i<nVertices; ++i){
+        master[i] = master[master[i]];
+    }
+    return master;
+}
+
+/*!
+ * Renumber the vertices of a cell connectivity, according to its element type
+ * (polygons and polyhedra store vertex counts along with vertex ids).
+ * \param[in,out] cell target cell
+ * \param[in] renumber map from old to new vertex ids; ids not in the map are kept
+ */
+static void
+renumberCellVertices(bitpit::Cell & cell, const std::unordered_map<long,long> & renumber)
+{
+    long * conn = cell.getConnect();
+    auto remap = [&renumber](long & id){
+        auto it = renumber.find(id);
+        if(it != renumber.end())    id = it->second;
+    };
+    switch(cell.getType()){
+        case bitpit::ElementType::POLYGON:
+            for(long j=1; j<=conn[0]; ++j)  remap(conn[j]);
+            break;
+        case bitpit::ElementType::POLYHEDRON:
+        {
+            long pos = 1;
+            for(long f=0; f<conn[0]; ++f){
+                long nv = conn[pos];
+                for(long j=pos+1; j<=pos+nv; ++j)  remap(conn[j]);
+                pos += nv+1;
+            }
+        }
+            break;
+        default:
+        {
+            int size = cell.getConnectSize();
+            for(int j=0; j<size; ++j)  remap(conn[j]);
+        }
+            break;
+    }
+}
+
+/*!
+ * Evaluate the unsigned distances of a list of points from a surface, restricted to a narrow band.
+ * Points are first culled against the leaf boxes of the surface skdTree, inflated by the band width:
+ * points are binned in a uniform grid spanning their bounding box, and each inflated leaf box marks
+ * the grid buckets it overlaps (whole buckets if fully covered, the points inside the box otherwise).
+ * Exact distances are then evaluated, with the batched skdTreeUtils::distance, only on the
+ * surviving points. Leaf boxes are processed in parallel, if OpenMP is enabled.
+ * \param[in] points coordinates of the points
+ * \param[in] tree skdTree of the target surface
+ * \param[in] maxdist width of the narrow band
+ * \return distances of the points from the surface, 1.0e+18 for points outside the narrow band
+ */
+static std::vector<double>
+narrowBandDistances(const dvecarr3E & points, bitpit::PatchSkdTree * tree, double maxdist)
+{
+    long nPoints = long(points.size());
+    std::vector<double> result(nPoints, 1.0e+18);
+    if(nPoints == 0 || tree == nullptr || tree->getNodeCount() == 0) return result;
+
+    //inflated leaf boxes
+    std::vector<std::array<darray3E,2> > boxes;
+    double meanExtent = 0.0;
+    for(std::size_t i=0; i<tree->getNodeCount(); ++i){
+        const bitpit::SkdNode & node = tree->getNode(i);
+        if(!node.isLeaf())  continue;
+        std::array<darray3E,2> box = {{node.getBoxMin() - maxdist, node.getBoxMax() + maxdist}};
+        meanExtent += std::max({box[1][0] - box[0][0], box[1][1] - box[0][1], box[1][2] - box[0][2]});
+        boxes.push_back(box);
+    }
+    long nBoxes = long(boxes.size());
+    if(nBoxes == 0) return result;
+    meanExtent /= double(nBoxes);
+
+    //uniform grid of points: buckets sized on the mean spacing of points, and on the boxes, so that
+    //each box overlaps a few buckets.
+    darray3E pmin = points[0], pmax = points[0];
+    for(const darray3E & p : points){
+        for(int j=0; j<3; ++j){
+            pmin[j] = std::min(pmin[j], p[j]);
+            pmax[j] = std::max(pmax[j], p[j]);
+        }
+    }
+    double diagonal = std::max({pmax[0] - pmin[0], pmax[1] - pmin[1], pmax[2] - pmin[2]});
+    double h = std::max(diagonal/std::cbrt(double(nPoints)), 0.5*meanExtent);
+    if(h <= 0.0)    h = 1.0;
+    std::array<long,3> nBuckets;
+    for(int j=0; j<3; ++j){
+        nBuckets[j] = std::min(long((pmax[j] - pmin[j])/h) + 1, long(std::cbrt(double(nPoints))) + 1);
+    }
+    std::array<double,3> spacing;
+    for(int j=0; j<3; ++j){
+        spacing[j] = std::max((pmax[j] - pmin[j])/double(nBuckets[j]), std::numeric_limits<double>::min());
+    }
+    auto bucketOf = [&](double coord, int j){
+        return std::max(0L, std::min(nBuckets[j] - 1, long(std::floor((coord - pmin[j])/spacing[j]))));
+    };
+    long nTotalBuckets = nBuckets[0]*nBuckets[1]*nBuckets[2];
+
+    //bucket contents in CSR layout (counting sort)
+    std::vector<long> pointBucket(nPoints);
+    std::vector<long> bucketOffsets(nTotalBuckets + 1, 0);
+    for(long i=0; i<nPoints; ++i){
+        pointBucket[i] = (bucketOf(points[i][0], 0)*nBuckets[1] + bucketOf(points[i][1], 1))*nBuckets[2] + bucketOf(points[i][2], 2);
+        ++bucketOffsets[pointBucket[i] + 1];
+    }
+    for(long b=0; b<nTotalBuckets; ++b)  bucketOffsets[b+1] += bucketOffsets[b];
+    std::vector<long> bucketPoints(nPoints);
+    {
+        std::vector<long> fill(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for(long i=0; i<nPoints; ++i)    bucketPoints[fill[pointBucket[i]]++] = i;
+    }
+
+    //cull points by inflated boxes
+    std::vector<char> bucketInside(nTotalBuckets, 0);
+    std::vector<char> pointInside(nPoints, 0);
+#pragma omp parallel for schedule(dynamic)
+    for(long k=0; k<nBoxes; ++k){
+        const std::array<darray3E,2> & box = boxes[k];
+        bool outside = false;
+        std::array<long,3> first, last;
+        for(int j=0; j<3; ++j){
+            outside = outside || (box[1][j] < pmin[j]) || (box[0][j] > pmax[j]);
+            first[j] = bucketOf(box[0][j], j);
+            last[j] = bucketOf(box[1][j], j);
+        }
+        if(outside) continue;
+        for(long bx=first[0]; bx<=last[0]; ++bx){
+            for(long by=first[1]; by<=last[1]; ++by){
+                for(long bz=first[2]; bz<=last[2]; ++bz){
+                    long b = (bx*nBuckets[1] + by)*nBuckets[2] + bz;
+                    char alreadyInside;
+#pragma omp atomic read
+                    alreadyInside = bucketInside[b];
+                    if(alreadyInside) continue;
+                    std::array<long,3> bucket = {{bx, by, bz}};
+                    bool covered = true;
+                    for(int j=0; j<3; ++j){
+                        covered = covered && (box[0][j] <= pmin[j] + double(bucket[j])*spacing[j])
+                                          && (box[1][j] >= pmin[j] + double(bucket[j]+1)*spacing[j]);
+                    }
+                    if(covered){
+#pragma omp atomic write
+                        bucketInside[b] = 1;
+                        continue;
+                    }
+                    for(long pos=bucketOffsets[b]; pos<bucketOffsets[b+1]; ++pos){
+                        const darray3E & p = points[bucketPoints[pos]];
+                        if(p[0] >= box[0][0] && p[0] <= box[1][0] && p[1] >= box[0][1] && p[1] <= box[1][1]
+                           && p[2] >= box[0][2] && p[2] <= box[1][2]){
+#pragma omp atomic write
+                            pointInside[bucketPoints[pos]] = 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //exact distances of surviving points
+    livector1D survivors;
+    for(long i=0; i<nPoints; ++i){
+        if(pointInside[i] || bucketInside[pointBucket[i]])   survivors.push_back(i);
+    }
+    dvecarr3E candidates(survivors.size());
+    for(std::size_t i=0; i<survivors.size(); ++i){
+        candidates[i] = points[survivors[i]];
+    }
+    livector1D ids;
+    std::vector<double> distances = skdTreeUtils::distance(candidates, tree, ids, maxdist);
+    for(std::size_t i=0; i<survivors.size(); ++i){
+        result[survivors[i]] = distances[i];
+    }
+    return result;
+}
+
 /*!
  * MimmoSurfUnstructured default constructor
  */
@@ -180,7 +538,12 @@ MimmoObject::MimmoObject(int type){
 
     m_skdTreeSupported = (m_type != 3);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
     m_AdjBuilt = false;
     m_IntBuilt = false;
 }
@@ -256,7 +619,12 @@ MimmoObject::MimmoObject(int type, dvecarr3E & vertex, livector2D * connectivity
 
     m_skdTreeSupported = (m_type != 3);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
     m_AdjBuilt = false;
     m_IntBuilt = false;
 
@@ -387,7 +755,12 @@ MimmoObject::MimmoObject(int type, bitpit::PatchKernel* geometry){
 
     m_skdTreeSupported = (m_type != 3);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
 
     //check if adjacencies and interfaces are built.
     {
@@ -507,7 +880,12 @@ MimmoObject::MimmoObject(int type, std::unique_ptr<bitpit::PatchKernel> & geomet
 
     m_skdTreeSupported = (m_type != 3);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
 
     //check if adjacencies and interfaces are built.
     {
@@ -563,7 +941,12 @@ MimmoObject::MimmoObject(const MimmoObject & other){
     m_IntBuilt          = other.m_IntBuilt;
 
     m_skdTreeSync    = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync    = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
 
     //instantiate empty trees:
     switch(m_type){
@@ -619,7 +1002,13 @@ void MimmoObject::swap(MimmoObject & x) noexcept
     std::swap(m_skdTree, x.m_skdTree);
     std::swap(m_kdTree, x.m_kdTree);
     std::swap(m_skdTreeSync, x.m_skdTreeSync);
+    std::swap(m_skdTreeTopoSync, x.m_skdTreeTopoSync);
+    std::swap(m_skdTreeStamp, x.m_skdTreeStamp);
     std::swap(m_kdTreeSync, x.m_kdTreeSync);
+    std::swap(m_coordsView, x.m_coordsView);
+    std::swap(m_coordsViewSync, x.m_coordsViewSync);
+    std::swap(m_coordsViewTopoSync, x.m_coordsViewTopoSync);
+    std::swap(m_revision, x.m_revision);
 }
 
 
@@ -1067,6 +1456,16 @@ MimmoObject::isSkdTreeSync(){
     return m_skdTreeSync;
 }
 
+/*!
+ * \return true if the skdTree ordering structure for cells is built on the current
+ * connectivity of your geometry, i.e. only vertex coordinates are eventually modified
+ * since its build and the tree can be refitted instead of rebuilt.
+ */
+bool
+MimmoObject::isSkdTreeTopologySync(){
+    return m_skdTreeTopoSync;
+}
+
 /*!
  * \return pointer to geometry skdTree search structure
  */
@@ -1104,6 +1503,79 @@ MimmoObject::isKdTreeSync(){
     return m_kdTreeSync;
 }
 
+/*!
+ * \return true if the structure-of-arrays coordinates view is synchronized
+ * with your current geometry
+ */
+bool
+MimmoObject::isCoordinatesViewSync(){
+    return m_coordsViewSync && m_coordsViewTopoSync;
+}
+
+/*!
+ * Get the revision stamp of the geometry. The stamp is unique among all MimmoObject instances
+ * and changes whenever vertices or cells are added, moved or removed through MimmoObject methods,
+ * so that results derived from the geometry can be cached and checked for validity.
+ * Modifications made directly on the linked bitpit::PatchKernel are not tracked.
+ * \return revision stamp of the current geometry
+ */
+unsigned long
+MimmoObject::getRevision(){
+    return m_revision;
+}
+
+/*!
+ * Get the structure-of-arrays view of the vertex coordinates, for flat loops on vertices
+ * in place of the iteration on the vertex container.
+ * The view is built on first call and then cached: it is refreshed only after the geometry
+ * is modified through MimmoObject methods, while its vertex ordering (ids and index) is rebuilt
+ * only if vertices are added or removed.
+ * Modifications made directly on the linked bitpit::PatchKernel are not tracked.
+ * \return reference to the synchronized coordinates view
+ */
+const CoordinatesView &
+MimmoObject::getCoordinatesView(){
+    syncCoordinatesView();
+    return m_coordsView;
+}
+
+/*!
+ * Get the structure-of-arrays view of the vertex coordinates to modify them.
+ * Coordinates written in the view are not seen by the geometry
+ * until they are written back with commitCoordinatesView.
+ * Vertex ordering (ids and index members) must not be altered.
+ * \return reference to the synchronized coordinates view
+ */
+CoordinatesView &
+MimmoObject::editCoordinatesView(){
+    syncCoordinatesView();
+    return m_coordsView;
+}
+
+/*!
+ * Write back the coordinates of the structure-of-arrays view (see editCoordinatesView)
+ * to the geometry vertices. The view stays synchronized, search trees are marked
+ * as not synchronized as for vertices moved by modifyVertex.
+ * \return false if the view is not built on the current vertices of the geometry.
+ */
+bool
+MimmoObject::commitCoordinatesView(){
+
+    if(!m_coordsViewTopoSync || m_coordsView.size() != getNVertex())    return false;
+
+    long pos = 0;
+    for(bitpit::Vertex & vertex : getVertices()){
+        vertex.setCoords(m_coordsView.getCoords(pos));
+        ++pos;
+    }
+
+    m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_kdTreeSync = false;
+    m_coordsViewSync = true;
+    return true;
+}
+
 /*!
  * \return pointer to geometry KdTree internal structure
  */
@@ -1168,7 +1640,12 @@ MimmoObject::addVertex(const darray3E & vertex, const long idtag){
     }
 
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+
+    m_skdTreeTopoSync = false;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
     return true;
 };
 
@@ -1197,13 +1674,19 @@ MimmoObject::addVertex(const bitpit::Vertex & vertex, const long idtag){
     }
 
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+
+    m_skdTreeTopoSync = false;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
     return true;
 };
 
 
 /*!
  * It modifies the coordinates of a pre-existent vertex.
+ * Connectivity is untouched, so the skdTree is only marked to be refitted (see buildSkdTree).
  * \param[in] vertex new vertex coordinates
  * \param[in] id unique-id of the vertex meant to be modified
  * \return false if no geometry is present or vertex id does not exist.
@@ -1215,10 +1698,74 @@ MimmoObject::modifyVertex(const darray3E & vertex, const long & id){
     bitpit::Vertex &vert = getPatch()->getVertex(id);
     vert.setCoords(vertex);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
     return true;
 };
 
+/*!
+ * It moves the vertices of the geometry by a displacement field, in one pass over the vertex storage:
+ * each vertex with id in the field is moved by scale times its displacement.
+ * Vertices not included in the field are untouched.
+ * The field is visited in lockstep with the vertices, so that no id lookup is needed when it shares
+ * the ordering of the geometry vertices (e.g. built iterating on them); vertices are then moved
+ * concurrently, if OpenMP is enabled.
+ * Connectivity is untouched, so the skdTree is only marked to be refitted (see buildSkdTree),
+ * while a synchronized coordinates view (see getCoordinatesView) is moved along with the vertices.
+ * \param[in] displacements displacement field of vertices
+ * \param[in] scale scaling factor of the displacements
+ * \return false if the geometry is empty.
+ */
+bool
+MimmoObject::applyDisplacements(const MimmoPiercedVector<darray3E> & displacements, double scale){
+
+    if(isEmpty())   return false;
+
+    bitpit::PiercedVector<bitpit::Vertex> & vertices = getVertices();
+    std::vector<std::pair<bitpit::Vertex*, const darray3E*> > targets;
+    targets.reserve(std::min(vertices.size(), displacements.size()));
+
+    //a synchronized coordinates view is moved along with the vertices.
+    bool moveView = m_coordsViewSync && m_coordsViewTopoSync;
+    livector1D positions;
+    if(moveView)    positions.reserve(targets.capacity());
+
+    auto itD = displacements.cbegin();
+    auto itDend = displacements.cend();
+    long pos = -1;
+    for(bitpit::Vertex & vertex : vertices){
+        ++pos;
+        long id = vertex.getId();
+        if(itD == itDend || itD.getId() != id){
+            //not aligned: find the vertex in the field and resume the lockstep from there.
+            itD = displacements.find(id);
+            if(itD == itDend)   continue;
+        }
+        targets.push_back(std::make_pair(&vertex, &(*itD)));
+        if(moveView)    positions.push_back(pos);
+        ++itD;
+    }
+
+    long ntargets = targets.size();
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<ntargets; ++i){
+        darray3E coords = targets[i].first->getCoords();
+        const darray3E & displ = *(targets[i].second);
+        for(int j=0; j<3; ++j){
+            coords[j] += scale*displ[j];
+        }
+        targets[i].first->setCoords(coords);
+        if(moveView)    m_coordsView.setCoords(positions[i], coords);
+    }
+
+    m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_kdTreeSync = false;
+    m_coordsViewSync = moveView;
+    return true;
+}
+
 /*!
  * Sets the cell structure of the geometry, clearing any previous cell list stored.
  * Does not do anything if class type is a point cloud (mesh type 3).
@@ -1305,6 +1852,9 @@ MimmoObject::addConnectedCell(const livector1D & conn, bitpit::ElementType type,
     m_pidsTypeWNames.insert(std::make_pair( 0, "") );
 
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+
+    m_skdTreeTopoSync = false;
     m_AdjBuilt = false;
     m_IntBuilt = false;
     return true;
@@ -1354,6 +1904,8 @@ MimmoObject::addConnectedCell(const livector1D & conn, bitpit::ElementType type,
 
     setPIDCell(checkedID, PID);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
     m_AdjBuilt = false;
     m_IntBuilt = false;
     return true;
@@ -1498,7 +2050,12 @@ void MimmoObject::setHARDCopy(const MimmoObject * other){
 
     m_skdTreeSupported = other->m_skdTreeSupported;
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
 
     //copy data
     const bitpit::PiercedVector<bitpit::Vertex> & pvert = other->getVertices();
@@ -1542,15 +2099,94 @@ std::unique_ptr<MimmoObject> MimmoObject::clone(){
 
 /*!
  * It cleans geometry duplicated and, in case of connected tessellations, all orphan/isolated vertices.
+ * Vertices closer than the tolerance of the patch are merged into the first of them, in the order of
+ * the vertex container (see findCoincidentVertices); cell connectivities of any geometry type are
+ * renumbered in parallel, if OpenMP is enabled, while orphan vertices are removed only for connected
+ * tessellations. Cells, with their ids, PIDs and PID names, are preserved.
+ * Adjacencies and interfaces, if built, are rebuilt when vertices are merged.
+ * Merge statistics are reported in the log.
  * \return false if the geometry member pointer is NULL.
  */
 bool
 MimmoObject::cleanGeometry(){
     auto patch = getPatch();
-    patch->deleteCoincidentVertices();
-    if(m_skdTreeSupported)  patch->deleteOrphanVertices();
+    if(patch == nullptr)    return false;
+
+    const CoordinatesView & view = getCoordinatesView();
+    long nVertices = view.size();
+    std::vector<long> master = findCoincidentVertices(view, patch->getTol());
+
+    std::unordered_map<long,long> renumber;
+    for(long i=0; i<nVertices; ++i){
+        if(master[i] != i)  renumber[view.ids[i]] = view.ids[master[i]];
+    }
+    long nMerged = long(renumber.size());
+
+    //vertices to be deleted: merged ones and, for connected tessellations, unused ones.
+    std::vector<char> deleted(nVertices, 0);
+    for(long i=0; i<nVertices; ++i){
+        deleted[i] = char(master[i] != i);
+    }
+    std::vector<bitpit::Cell *> cells;
+    cells.reserve(patch->getCellCount());
+    for(bitpit::Cell & cell : patch->getCells()){
+        cells.push_back(&cell);
+    }
+    long nCells = long(cells.size());
+
+    //cells referring to merged vertices are always renumbered, whatever the geometry type.
+    if(nMerged > 0){
+#pragma omp parallel for schedule(static)
+        for(long i=0; i<nCells; ++i){
+            renumberCellVertices(*cells[i], renumber);
+        }
+    }
+
+    long nOrphans = 0;
+    if(m_skdTreeSupported){
+        std::vector<char> used(nVertices, 0);
+#pragma omp parallel for schedule(static)
+        for(long i=0; i<nCells; ++i){
+            for(long id : cells[i]->getVertexIds()){
+                long pos = view.index.at(id);
+#pragma omp atomic write
+                used[pos] = 1;
+            }
+        }
+        for(long i=0; i<nVertices; ++i){
+            if(!used[i] && !deleted[i]){
+                deleted[i] = 1;
+                ++nOrphans;
+            }
+        }
+    }
+
+    livector1D toDelete;
+    toDelete.reserve(nMerged + nOrphans);
+    for(long i=0; i<nVertices; ++i){
+        if(deleted[i])  toDelete.push_back(view.ids[i]);
+    }
+    for(long id : toDelete){
+        patch->deleteVertex(id);
+    }
+
+    if(nMerged > 0){
+        if(m_AdjBuilt)  patch->buildAdjacencies();
+        if(m_IntBuilt)  patch->buildInterfaces();
+    }
 
+    (*m_log)<<"MimmoObject::cleanGeometry : merged "<<nMerged<<" coincident vertices and removed "<<nOrphans
+            <<" orphan vertices, "<<nVertices - nMerged - nOrphans<<" vertices left"<<std::endl;
+
+    if(nMerged > 0 || nOrphans > 0){
+        //the skd-tree refers to deleted vertices and renumbered cells: it cannot be refitted.
+        m_skdTreeSync = false;
+        m_skdTreeTopoSync = false;
+    }
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
+    m_revision = nextRevision();
     return true;
 };
 
@@ -1869,33 +2505,135 @@ void MimmoObject::getBoundingBox(std::array<double,3> & pmin, std::array<double,
  *\param[in] value build the minimum leaf of the tree as a bounding box containing value elements at most.
  */
 void MimmoObject::buildBvTree(int value){
-    if(!m_skdTreeSupported || isEmpty())   return;
-
-    if (!m_skdTreeSync){
-        m_skdTree->clear();
-        m_skdTree->build(value);
-        m_skdTreeSync = true;
-    }
-    return;
+    buildSkdTree(value);
 }
 
 /*!
  * Reset and build again cell skdTree of your geometry (if supports connectivity elements).
+ * If only vertex coordinates are modified since the last build (see modifyVertex), the tree
+ * is not rebuilt but refitted, i.e. its node bounding boxes are updated keeping the cell partition
+ * of the last build (value is not considered).
  *\param[in] value build the minimum leaf of the tree as a bounding box containing value elements at most.
  */
 void MimmoObject::buildSkdTree(int value){
     if(!m_skdTreeSupported || isEmpty())   return;
 
     if (!m_skdTreeSync){
-        m_skdTree->clear();
-        m_skdTree->build(value);
+        //cells edited directly on the patch are not tracked by the sync flags: check them too.
+        if (m_skdTreeTopoSync && evalCellsStamp() == m_skdTreeStamp){
+            refitSkdTree();
+        }else{
+            m_skdTree->clear();
+            m_skdTree->build(value);
+            m_skdTreeStamp = evalCellsStamp();
+        }
         m_skdTreeSync = true;
+        m_skdTreeTopoSync = true;
     }
     return;
 }
 
+/*!
+ * Evaluate a stamp of the cells of the patch, mixing their number, ids and positions in the
+ * cell storage. The skdTree refers to cells by storage position: it can be refitted only if
+ * the stamp is unchanged since its build, i.e. no cell was added or deleted, even directly
+ * on the patch (see getPatch).
+ * \return stamp of the cells
+ */
+std::size_t MimmoObject::evalCellsStamp(){
+    const bitpit::PiercedVector<bitpit::Cell> & cells = getPatch()->getCells();
+    std::size_t stamp = cells.size();
+    for (auto it = cells.cbegin(); it != cells.cend(); ++it){
+        std::size_t value = std::hash<long>()(it.getId()) ^ (std::size_t(it.getRawIndex()) << 1);
+        stamp ^= value + std::size_t(0x9e3779b97f4a7c15ULL) + (stamp << 6) + (stamp >> 2);
+    }
+    return stamp;
+}
+
+/*!
+ * Write the bounding box of a node of a skdTree.
+ * bitpit gives read-only access to the nodes of a tree; the nodes are owned by the non-const tree
+ * passed here, so writing their boxes is well defined. This is the only write access to the nodes,
+ * used by refitSkdTree.
+ * \param[in,out] tree skdTree
+ * \param[in] id index of the node
+ * \param[in] bMin minimum point of the box
+ * \param[in] bMax maximum point of the box
+ */
+static void setSkdNodeBox(bitpit::PatchSkdTree & tree, std::size_t id, const darray3E & bMin, const darray3E & bMax){
+    const bitpit::SkdNode & node = tree.getNode(id);
+    const_cast<darray3E &>(node.getBoxMin()) = bMin;
+    const_cast<darray3E &>(node.getBoxMax()) = bMax;
+}
+
+/*!
+ * Refit the cell skdTree to the current vertex coordinates, when connectivity is
+ * unchanged since the last build. Bounding boxes of the leaves are evaluated from the
+ * vertices of their cells, then bounding boxes of the other nodes are updated bottom-up
+ * merging the boxes of their children. The partition of the cells in the nodes is retained:
+ * the tree stays valid for any search, although it could be less balanced than a new build
+ * after large deformations.
+ */
+void MimmoObject::refitSkdTree(){
+
+    bitpit::PatchSkdTree * tree = m_skdTree.get();
+    if (tree->getNodeCount() == 0) return;
+    const bitpit::PatchKernel & patch = tree->getPatch();
+
+    //nodes sorted by level, parents before children.
+    std::vector<std::size_t> nodes;
+    nodes.reserve(tree->getNodeCount());
+    nodes.push_back(0);
+    for (std::size_t k = 0; k < nodes.size(); ++k){
+        const bitpit::SkdNode & node = tree->getNode(nodes[k]);
+        for (int i = bitpit::SkdNode::CHILD_BEGIN; i != bitpit::SkdNode::CHILD_END; ++i) {
+            std::size_t childId = node.getChildId(static_cast<bitpit::SkdNode::ChildLocation>(i));
+            if (childId != bitpit::SkdNode::NULL_ID) nodes.push_back(childId);
+        }
+    }
+
+    //leaves
+#pragma omp parallel for schedule(dynamic, 64)
+    for (long k = 0; k < long(nodes.size()); ++k){
+        const bitpit::SkdNode & node = tree->getNode(nodes[k]);
+        if (!node.isLeaf()) continue;
+        darray3E bMin, bMax;
+        bMin.fill(std::numeric_limits<double>::max());
+        bMax.fill(-std::numeric_limits<double>::max());
+        for (long cellId : node.getCells()){
+            for (long vertexId : patch.getCell(cellId).getVertexIds()){
+                const darray3E & coords = patch.getVertexCoords(vertexId);
+                for (int j = 0; j < 3; ++j){
+                    bMin[j] = std::min(bMin[j], coords[j]);
+                    bMax[j] = std::max(bMax[j], coords[j]);
+                }
+            }
+        }
+        setSkdNodeBox(*tree, nodes[k], bMin, bMax);
+    }
+
+    //other nodes, children before parents
+    for (long k = long(nodes.size()) - 1; k >= 0; --k){
+        const bitpit::SkdNode & node = tree->getNode(nodes[k]);
+        if (node.isLeaf()) continue;
+        darray3E bMin, bMax;
+        bMin.fill(std::numeric_limits<double>::max());
+        bMax.fill(-std::numeric_limits<double>::max());
+        for (int i = bitpit::SkdNode::CHILD_BEGIN; i != bitpit::SkdNode::CHILD_END; ++i) {
+            std::size_t childId = node.getChildId(static_cast<bitpit::SkdNode::ChildLocation>(i));
+            if (childId == bitpit::SkdNode::NULL_ID) continue;
+            for (int j = 0; j < 3; ++j){
+                bMin[j] = std::min(bMin[j], tree->getNode(childId).getBoxMin()[j]);
+                bMax[j] = std::max(bMax[j], tree->getNode(childId).getBoxMax()[j]);
+            }
+        }
+        setSkdNodeBox(*tree, nodes[k], bMin, bMax);
+    }
+}
+
 /*!
  * Reset and build again vertex kdTree of your geometry.
+ * Vertices are inserted in the order of a balanced tree, computed in parallel if OpenMP is enabled.
  */
 void MimmoObject::buildKdTree(){
     if( getNVertex() == 0)  return;
@@ -1905,9 +2643,21 @@ void MimmoObject::buildKdTree(){
         cleanKdTree();
         m_kdTree->nodes.resize(getNVertex() + m_kdTree->MAXSTK);
 
+        //insert vertices in median order, to get a balanced tree whatever is the ordering of the mesh.
+        std::vector<bitpit::Vertex*> vertices;
+        vertices.reserve(getNVertex());
         for(auto & val : getVertices()){
-            label = val.getId();
-            m_kdTree->insert(&val, label);
+            vertices.push_back(&val);
+        }
+#pragma omp parallel
+        {
+#pragma omp single
+            sortKdTreeInsertion(vertices.begin(), vertices.end(), 0);
+        }
+
+        for(bitpit::Vertex * val : vertices){
+            label = val->getId();
+            m_kdTree->insert(val, label);
         }
         m_kdTreeSync = true;
     }
@@ -1922,6 +2672,42 @@ void	MimmoObject::cleanKdTree(){
     m_kdTree->nodes.clear();
 }
 
+/*!
+ * Synchronize the structure-of-arrays coordinates view with the current geometry.
+ * Vertex ordering is rebuilt only if vertices are added or removed since the last build,
+ * otherwise coordinates only are refreshed.
+ */
+void MimmoObject::syncCoordinatesView(){
+
+    if(m_coordsViewSync && m_coordsViewTopoSync) return;
+
+    const bitpit::PiercedVector<bitpit::Vertex> & vertices = getVertices();
+    long nVertices = vertices.size();
+
+    if(!m_coordsViewTopoSync){
+        m_coordsView.ids.resize(nVertices);
+        m_coordsView.index.clear();
+        m_coordsView.index.reserve(nVertices);
+        long pos = 0;
+        for(auto it = vertices.cbegin(); it != vertices.cend(); ++it){
+            m_coordsView.ids[pos] = it.getId();
+            m_coordsView.index[it.getId()] = pos;
+            ++pos;
+        }
+        m_coordsView.x.resize(nVertices);
+        m_coordsView.y.resize(nVertices);
+        m_coordsView.z.resize(nVertices);
+        m_coordsViewTopoSync = true;
+    }
+
+    long pos = 0;
+    for(const bitpit::Vertex & vertex : vertices){
+        m_coordsView.setCoords(pos, vertex.getCoords());
+        ++pos;
+    }
+    m_coordsViewSync = true;
+}
+
 /*!
  * \return true if cell-cell adjacency is built for your current mesh.
  */
@@ -2079,7 +2865,12 @@ void MimmoObject::reset(int type){
 
     m_skdTreeSupported = (m_type != 3);
     m_skdTreeSync = false;
+    m_revision = nextRevision();
+    m_skdTreeTopoSync = false;
+    m_skdTreeStamp = 0;
     m_kdTreeSync = false;
+    m_coordsViewSync = false;
+    m_coordsViewTopoSync = false;
     m_AdjBuilt = false;
     m_IntBuilt = false;
 }
@@ -2323,7 +3114,8 @@ MimmoObject::elementsMap(bitpit::PatchKernel & obj){
 };
 
 /*!
- * Get all the cells of the current mesh whose center is within a prescribed distance maxdist w.r.t to a target surface body
+ * Get all the cells of the current mesh whose center is within a prescribed distance maxdist w.r.t to a target surface body.
+ * Cell centers are culled by the leaf boxes of the surface skdTree before evaluating their distances (see narrowBandDistances).
  * \param[in] surface MimmoObject of type surface.
  * \param[in] maxdist threshold distance.
  * \param[out] idList list of cell IDs within maxdistance
@@ -2334,20 +3126,18 @@ MimmoObject::getCellsNarrowBandToExtSurface(MimmoObject & surface, const double
     if(surface.isEmpty() || surface.getType() != 1) return;
     if(isEmpty() || getType() == 3)  return ;
 
+    livector1D cellIds;
+    std::vector<double> distances = evalCellsNarrowBandDistances(surface, maxdist, cellIds);
     idList.clear();
-    idList.reserve(getNCells());
-    darray3E pp;
-    double distance, maxdistance(maxdist);
-    long idsuppsurf;
-    for(const auto & cell : getCells()){
-        pp = getPatch()->evalCellCentroid(cell.getId());
-        distance = mimmo::skdTreeUtils::distance(&pp, surface.getSkdTree(),idsuppsurf,maxdistance);
-        if(distance < maxdist)  idList.push_back(cell.getId());
+    idList.reserve(cellIds.size());
+    for(std::size_t i=0; i<cellIds.size(); ++i){
+        if(distances[i] < maxdist)  idList.push_back(cellIds[i]);
     }
 };
 
 /*!
- * Get all the cells of the current mesh whose center is within a prescribed distance maxdist w.r.t to a target surface body
+ * Get all the cells of the current mesh whose center is within a prescribed distance maxdist w.r.t to a target surface body.
+ * Cell centers are culled by the leaf boxes of the surface skdTree before evaluating their distances (see narrowBandDistances).
  * \param[in] surface MimmoObject of type surface.
  * \param[in] maxdist threshold distance.
  * \param[out] distList distances of vertices positive matching within maxdistance
@@ -2357,20 +3147,18 @@ MimmoObject::getCellsNarrowBandToExtSurface(MimmoObject & surface, const double
     if(surface.isEmpty() || surface.getType() != 1) return;
     if(isEmpty() || getType() == 3)  return ;
 
-    darray3E pp;
-    double distance, maxdistance(maxdist);
+    livector1D cellIds;
+    std::vector<double> distances = evalCellsNarrowBandDistances(surface, maxdist, cellIds);
     distList.clear();
-    distList.reserve(getNVertex());
-    long idsuppsurf;
-    for(const auto & cell : getCells()){
-        pp = getPatch()->evalCellCentroid(cell.getId());
-        distance = mimmo::skdTreeUtils::distance(&pp, surface.getSkdTree(),idsuppsurf,maxdistance);
-        if(distance < maxdist)  distList.insert(cell.getId(),distance);
+    distList.reserve(cellIds.size());
+    for(std::size_t i=0; i<cellIds.size(); ++i){
+        if(distances[i] < maxdist)  distList.insert(cellIds[i], distances[i]);
     }
 };
 
 /*!
- * Get all the vertices of the current mesh within a prescribed distance maxdist w.r.t to a target surface body
+ * Get all the vertices of the current mesh within a prescribed distance maxdist w.r.t to a target surface body.
+ * Vertices are culled by the leaf boxes of the surface skdTree before evaluating their distances (see narrowBandDistances).
  * \param[in] surface MimmoObject of type surface.
  * \param[in] maxdist threshold distance.
  * \param[out] idList list of vertex IDs within maxdistance
@@ -2381,20 +3169,18 @@ MimmoObject::getVerticesNarrowBandToExtSurface(MimmoObject & surface, const doub
     if(surface.isEmpty() || surface.getType() != 1) return;
     if(isEmpty())  return ;
 
+    livector1D vertexIds;
+    std::vector<double> distances = evalVerticesNarrowBandDistances(surface, maxdist, vertexIds);
     idList.clear();
-    idList.reserve(getNVertex());
-    darray3E pp;
-    double distance, maxdistance(maxdist);
-    long idsuppsurf;
-    for(const auto & vertex : getVertices()){
-        pp = vertex.getCoords();
-        distance = mimmo::skdTreeUtils::distance(&pp, surface.getSkdTree(),idsuppsurf,maxdistance);
-        if(distance < maxdist)  idList.push_back(vertex.getId());
+    idList.reserve(vertexIds.size());
+    for(std::size_t i=0; i<vertexIds.size(); ++i){
+        if(distances[i] < maxdist)  idList.push_back(vertexIds[i]);
     }
 };
 
 /*!
- * Get all the vertices of the current mesh within a prescribed distance maxdist w.r.t to a target surface body
+ * Get all the vertices of the current mesh within a prescribed distance maxdist w.r.t to a target surface body.
+ * Vertices are culled by the leaf boxes of the surface skdTree before evaluating their distances (see narrowBandDistances).
  * \param[in] surface MimmoObject of type surface.
  * \param[in] maxdist threshold distance.
  * \param[out] distList map of vertex IDs-distances positive matches within maxdistance
@@ -2404,18 +3190,59 @@ MimmoObject::getVerticesNarrowBandToExtSurface(MimmoObject & surface, const doub
     if(surface.isEmpty() || surface.getType() != 1) return;
     if(isEmpty())  return ;
 
-    darray3E pp;
-    double distance, maxdistance(maxdist);
-    long idsuppsurf;
+    livector1D vertexIds;
+    std::vector<double> distances = evalVerticesNarrowBandDistances(surface, maxdist, vertexIds);
     distList.clear();
-    distList.reserve(getNVertex());
-    for(const auto & vertex : getVertices()){
-        pp = vertex.getCoords();
-        distance = mimmo::skdTreeUtils::distance(&pp, surface.getSkdTree(),idsuppsurf,maxdistance);
-        if(distance < maxdist)  distList.insert(vertex.getId(),distance);
+    distList.reserve(vertexIds.size());
+    for(std::size_t i=0; i<vertexIds.size(); ++i){
+        if(distances[i] < maxdist)  distList.insert(vertexIds[i], distances[i]);
     }
 };
 
+/*!
+ * Evaluate the distances of the cell centers of the current mesh from a target surface body, within a narrow band.
+ * \param[in] surface MimmoObject of type surface.
+ * \param[in] maxdist width of the narrow band.
+ * \param[out] cellIds IDs of the cells, in the order of the cell container.
+ * \return distances of the cell centers, 1.0e+18 outside the narrow band.
+ */
+std::vector<double>
+MimmoObject::evalCellsNarrowBandDistances(MimmoObject & surface, double maxdist, livector1D & cellIds){
+
+    auto patch = getPatch();
+    cellIds.clear();
+    cellIds.reserve(getNCells());
+    for(const auto & cell : getCells()){
+        cellIds.push_back(cell.getId());
+    }
+    long nCells = long(cellIds.size());
+    dvecarr3E centroids(nCells);
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<nCells; ++i){
+        centroids[i] = patch->evalCellCentroid(cellIds[i]);
+    }
+    return narrowBandDistances(centroids, surface.getSkdTree(), maxdist);
+};
+
+/*!
+ * Evaluate the distances of the vertices of the current mesh from a target surface body, within a narrow band.
+ * \param[in] surface MimmoObject of type surface.
+ * \param[in] maxdist width of the narrow band.
+ * \param[out] vertexIds IDs of the vertices, in the order of the vertex container.
+ * \return distances of the vertices, 1.0e+18 outside the narrow band.
+ */
+std::vector<double>
+MimmoObject::evalVerticesNarrowBandDistances(MimmoObject & surface, double maxdist, livector1D & vertexIds){
+
+    const CoordinatesView & view = getCoordinatesView();
+    long nVertices = view.size();
+    vertexIds = view.ids;
+    dvecarr3E points(nVertices);
+    for(long i=0; i<nVertices; ++i){
+        points[i] = view.getCoords(i);
+    }
+    return narrowBandDistances(points, surface.getSkdTree(), maxdist);
+};
 
 /*!
  * Get a minimal inverse connectivity of a target geometry mesh.
@@ -96,6 +96,42 @@ protected:
 };
 
 
+/*!
+* \class CoordinatesView
+* \brief Structure-of-arrays copy of the vertex coordinates of a MimmoObject.
+*
+* Coordinates are stored in three contiguous arrays x, y, z, indexed by the dense position
+* of the vertex in the geometry vertex container (the same compact indexing of MimmoObject::getMapData).
+* ids holds the unique-id of the vertex at each dense position, index is its inverse map.
+* The view is owned and kept synchronized by MimmoObject, see MimmoObject::getCoordinatesView.
+*/
+class CoordinatesView{
+public:
+    dvector1D                       x;      /**< x coordinates of vertices */
+    dvector1D                       y;      /**< y coordinates of vertices */
+    dvector1D                       z;      /**< z coordinates of vertices */
+    livector1D                      ids;    /**< unique-id of the vertex at each dense position */
+    std::unordered_map<long,long>   index;  /**< dense position of each vertex unique-id */
+
+    /*!
+     * \return number of vertices in the view
+     */
+    long        size() const { return long(ids.size()); };
+
+    /*!
+     * \param[in] i dense position of the vertex
+     * \return coordinates of the vertex
+     */
+    darray3E    getCoords(long i) const { return {{x[i], y[i], z[i]}}; };
+
+    /*!
+     * Set coordinates of a vertex in the view.
+     * \param[in] i dense position of the vertex
+     * \param[in] coords new coordinates
+     */
+    void        setCoords(long i, const darray3E & coords){ x[i] = coords[0]; y[i] = coords[1]; z[i] = coords[2]; };
+};
+
 /*!
 * \class MimmoObject
 * \brief MimmoObject is the basic geometry container for mimmo library
@@ -109,6 +145,16 @@ protected:
 */
 class MimmoObject{
 
+    /*!
+     * see Chain::execParallel
+     */
+    friend class Chain;
+
+    /*!
+     * see BinaryGeometryFile::materialize
+     */
+    friend class BinaryGeometryFile;
+
 private:
     std::unique_ptr<bitpit::PatchKernel>    m_patch;           /**<Reference to INTERNAL bitpit patch handling geometry. */
     bitpit::PatchKernel *                   m_extpatch;        /**<Reference to EXTERNALLY linked patch handling geometry. */
@@ -122,11 +168,17 @@ protected:
     std::unique_ptr<bitpit::PatchSkdTree>                   m_skdTree;         /**< ordered tree of geometry simplicies for fast searching purposes */
     std::unique_ptr<bitpit::KdTree<3,bitpit::Vertex,long> > m_kdTree;          /**< ordered tree of geometry vertices for fast searching purposes */
     bool                                                    m_skdTreeSync;      /**< track correct building of bvtree. Set false if any geometry modifications occur */
+    bool                                                    m_skdTreeTopoSync;  /**< track building of bvtree on current connectivity. Set false if topology modifications occur, not if only vertices are moved */
+    std::size_t                                             m_skdTreeStamp;     /**< stamp of the cells (ids and storage positions) the bvtree was built on, see evalCellsStamp */
     bool                                                    m_kdTreeSync;     /**< track correct building of kdtree. Set false if any geometry modifications occur*/
+    CoordinatesView                                         m_coordsView;       /**< structure-of-arrays view of vertex coordinates */
+    bool                                                    m_coordsViewSync;   /**< track coordinates of the view. Set false if any geometry modifications occur */
+    bool                                                    m_coordsViewTopoSync; /**< track vertex ordering of the view. Set false if vertices are added or removed, not if only moved */
     bool                                                    m_skdTreeSupported; /**< Flag for geometries not supporting bvTree building*/
 
     bool                                                    m_AdjBuilt;     /**< track correct building of adjacencies along with geometry modifications */
     bool                                                    m_IntBuilt;     /**< track correct building of interfaces  along with geometry modifications */
+    unsigned long                                           m_revision;     /**< revision stamp of the geometry, renewed at each geometry modification */
     bitpit::Logger*                                         m_log;          /**<Pointer to logger.*/
 
 public:
@@ -175,13 +227,21 @@ public:
     BITPIT_DEPRECATED(bool                          isKdTreeBuilt());
     BITPIT_DEPRECATED(bool                          isBvTreeSync());
     bool                          isSkdTreeSync();
+    bool                          isSkdTreeTopologySync();
     bool                          isKdTreeSync();
+    bool                          isCoordinatesViewSync();
+    unsigned long                 getRevision();
+
+    const CoordinatesView &       getCoordinatesView();
+    CoordinatesView &             editCoordinatesView();
+    bool                          commitCoordinatesView();
 
 
     bool        setVertices(const bitpit::PiercedVector<bitpit::Vertex> & vertices);
     bool        addVertex(const darray3E & vertex, const long idtag = bitpit::Vertex::NULL_ID);
     bool        addVertex(const bitpit::Vertex & vertex, const long idtag = bitpit::Vertex::NULL_ID);
     bool        modifyVertex(const darray3E & vertex, const long & id);
+    bool        applyDisplacements(const MimmoPiercedVector<darray3E> & displacements, double scale = 1.0);
     bool        setCells(const bitpit::PiercedVector<bitpit::Cell> & cells);
     bool        addConnectedCell(const livector1D & locConn, bitpit::ElementType type, long idtag = bitpit::Cell::NULL_ID);
     bool        addConnectedCell(const livector1D & locConn, bitpit::ElementType type, long PID, long idtag);
@@ -254,6 +314,11 @@ protected:
 private:
     bool    checkCellConnCoherence(const bitpit::ElementType & type, const livector1D & conn_);
     void    cleanKdTree();
+    void    refitSkdTree();
+    std::size_t evalCellsStamp();
+    void    syncCoordinatesView();
+    std::vector<double> evalCellsNarrowBandDistances(MimmoObject & surface, double maxdist, livector1D & cellIds);
+    std::vector<double> evalVerticesNarrowBandDistances(MimmoObject & surface, double maxdist, livector1D & vertexIds);
 
 };
 
@@ -74,6 +74,7 @@ public:
     virtual ~MimmoPiercedVector();
     //copy constructors and operators
     MimmoPiercedVector(const MimmoPiercedVector<mpv_t> & other);
+    MimmoPiercedVector(MimmoPiercedVector<mpv_t> && other);
     MimmoPiercedVector & operator=(MimmoPiercedVector<mpv_t> other);
     MimmoPiercedVector & operator=(bitpit::PiercedVector<mpv_t, long int> other);
     
@@ -56,6 +56,18 @@ MimmoPiercedVector<mpv_t>::MimmoPiercedVector(const MimmoPiercedVector<mpv_t> &
     m_log = &bitpit::log::cout(MIMMO_LOG_FILE);
 };
 
+/*!
+ * Move Constructor. Contents of other are stolen, leaving it empty.
+ *\param[in] other MimmoPiercedVector object
+ */
+template<typename mpv_t>
+MimmoPiercedVector<mpv_t>::MimmoPiercedVector(MimmoPiercedVector<mpv_t> && other):bitpit::PiercedVector<mpv_t,long int>(){
+    m_geometry = NULL;
+    m_loc = MPVLocation::UNDEFINED;
+    m_log = &bitpit::log::cout(MIMMO_LOG_FILE);
+    this->swap(other);
+};
+
 /*! 
  * Assignment Operator. 
  * \param[in] other MimmoPiercedVector object
@@ -0,0 +1,296 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#include "Profiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <sys/resource.h>
+
+namespace mimmo{
+
+/*!
+ * Write a string as a JSON string literal, escaping quotes, backslashes and control characters.
+ * \param[in] out target stream
+ * \param[in] str string to be written
+ */
+static void
+writeJSONString(std::ostream & out, const std::string & str){
+    out << '"';
+    for (char c : str){
+        switch (c){
+        case '"'  : out << "\\\""; break;
+        case '\\' : out << "\\\\"; break;
+        case '\n' : out << "\\n"; break;
+        case '\t' : out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+            else out << c;
+            break;
+        }
+    }
+    out << '"';
+}
+
+/*!
+ * Default constructor of PortProfile.
+ */
+PortProfile::PortProfile(){
+    receivers = 0;
+    bytes = 0;
+    start = 0.0;
+    wall = 0.0;
+}
+
+/*!
+ * Default constructor of BlockProfile.
+ */
+BlockProfile::BlockProfile(){
+    id = -1;
+    thread = 0;
+    start = 0.0;
+    wall = 0.0;
+    cpu = 0.0;
+    rss = 0;
+    nvertices = -1;
+    ncells = -1;
+}
+
+/*!
+ * Private constructor of the singleton. Profiling is not active by default.
+ */
+Profiler::Profiler(){
+    m_active.store(false);
+    m_origin = std::chrono::steady_clock::now();
+}
+
+/*!
+ * Activate/deactivate the profiling of the blocks execution.
+ * Activation resets the origin of the recorded times.
+ * \param[in] active true to activate the profiling
+ */
+void
+Profiler::setActive(bool active){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (active && !m_active.load()) m_origin = std::chrono::steady_clock::now();
+    m_active.store(active);
+}
+
+/*!
+ * \return true if the profiling is active.
+ */
+bool
+Profiler::isActive(){
+    return m_active.load();
+}
+
+/*!
+ * Remove all the recorded profiles.
+ */
+void
+Profiler::clear(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_blocks.clear();
+    m_threads.clear();
+}
+
+/*!
+ * \return wall time [s] elapsed from the activation of the profiler.
+ */
+double
+Profiler::getTime(){
+    std::chrono::steady_clock::time_point origin;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        origin = m_origin;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/*!
+ * \return cpu time [s] (user + system) spent by the process, i.e. by all its threads.
+ */
+double
+Profiler::getCPUTime(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+           + 1.e-6*double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/*!
+ * \return peak resident set size [kB] of the process, shared by all its threads.
+ */
+long
+Profiler::getPeakRSS(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return long(usage.ru_maxrss);
+}
+
+/*!
+ * Record the profile of a block execution. The thread index of the profile
+ * is assigned here, according to the calling thread.
+ * \param[in] block profile of the block execution
+ */
+void
+Profiler::addBlock(BlockProfile block){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_threads.find(std::this_thread::get_id());
+    if (it == m_threads.end()){
+        it = m_threads.emplace(std::this_thread::get_id(), int(m_threads.size())).first;
+    }
+    block.thread = it->second;
+    m_blocks.push_back(std::move(block));
+}
+
+/*!
+ * \return recorded profiles, in order of completion of the blocks execution.
+ */
+std::vector<BlockProfile>
+Profiler::getBlocks(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_blocks;
+}
+
+/*!
+ * Write a JSON summary of the recorded profiles. The summary contains the list
+ * of all the blocks executions and, for each block name, the totals of calls, wall time,
+ * cpu time, peak memory increase and bytes exchanged, sorted by decreasing wall time.
+ * Cpu time and peak memory increase are written as processCPU and processPeakRSSDeltaKB,
+ * since they are measured on the whole process.
+ * \param[in] filename path of the output file
+ */
+void
+Profiler::writeSummary(const std::string & filename){
+
+    std::vector<BlockProfile> blocks = getBlocks();
+
+    std::ofstream out(filename);
+    if (!out.is_open()){
+        throw std::runtime_error("Profiler : cannot open file " + filename);
+    }
+    out << std::setprecision(9);
+
+    struct Total{
+        int calls = 0;
+        double wall = 0.0, cpu = 0.0, portWall = 0.0;
+        long rss = 0, bytes = 0;
+    };
+    std::map<std::string, Total> totals;
+    double wall = 0.0;
+
+    out << "{" << std::endl;
+    out << "  \"blocks\": [" << std::endl;
+    for (std::size_t i=0; i<blocks.size(); ++i){
+        const BlockProfile & block = blocks[i];
+        Total & total = totals[block.name];
+        total.calls++;
+        total.wall += block.wall;
+        total.cpu += block.cpu;
+        total.rss += block.rss;
+        wall = std::max(wall, block.start + block.wall);
+
+        out << "    {\"name\": ";
+        writeJSONString(out, block.name);
+        out << ", \"id\": " << block.id << ", \"thread\": " << block.thread
+            << ", \"start\": " << block.start << ", \"wall\": " << block.wall
+            << ", \"processCPU\": " << block.cpu << ", \"processPeakRSSDeltaKB\": " << block.rss
+            << ", \"vertices\": " << block.nvertices << ", \"cells\": " << block.ncells
+            << ", \"ports\": [";
+        for (std::size_t j=0; j<block.ports.size(); ++j){
+            const PortProfile & port = block.ports[j];
+            total.bytes += port.bytes;
+            total.portWall += port.wall;
+            out << (j ? ", " : "") << "{\"port\": ";
+            writeJSONString(out, port.port);
+            out << ", \"receivers\": " << port.receivers << ", \"bytes\": " << port.bytes
+                << ", \"wall\": " << port.wall << "}";
+        }
+        out << "]}" << (i+1 < blocks.size() ? "," : "") << std::endl;
+    }
+    out << "  ]," << std::endl;
+
+    std::vector<std::pair<std::string, Total> > sorted(totals.begin(), totals.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const std::pair<std::string, Total> & a, const std::pair<std::string, Total> & b){
+            return a.second.wall > b.second.wall;
+        });
+
+    out << "  \"totals\": [" << std::endl;
+    for (std::size_t i=0; i<sorted.size(); ++i){
+        const Total & total = sorted[i].second;
+        out << "    {\"name\": ";
+        writeJSONString(out, sorted[i].first);
+        out << ", \"calls\": " << total.calls << ", \"wall\": " << total.wall
+            << ", \"processCPU\": " << total.cpu << ", \"processPeakRSSDeltaKB\": " << total.rss
+            << ", \"portBytes\": " << total.bytes << ", \"portWall\": " << total.portWall
+            << "}" << (i+1 < sorted.size() ? "," : "") << std::endl;
+    }
+    out << "  ]," << std::endl;
+    out << "  \"wall\": " << wall << std::endl;
+    out << "}" << std::endl;
+}
+
+/*!
+ * Write the recorded profiles as a timeline in Chrome trace-event format.
+ * Each block execution is a complete event on the track of the thread that executed it,
+ * port exchanges are nested events of their owner block.
+ * \param[in] filename path of the output file
+ */
+void
+Profiler::writeTrace(const std::string & filename){
+
+    std::vector<BlockProfile> blocks = getBlocks();
+
+    std::ofstream out(filename);
+    if (!out.is_open()){
+        throw std::runtime_error("Profiler : cannot open file " + filename);
+    }
+    out << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    out << "{\"traceEvents\": [" << std::endl;
+    for (const BlockProfile & block : blocks){
+        out << (first ? "" : ",\n") << "  {\"name\": ";
+        writeJSONString(out, block.name);
+        out << ", \"cat\": \"block\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << block.thread
+            << ", \"ts\": " << 1.e6*block.start << ", \"dur\": " << 1.e6*block.wall
+            << ", \"args\": {\"id\": " << block.id << ", \"processCPU\": " << block.cpu
+            << ", \"processPeakRSSDeltaKB\": " << block.rss << ", \"vertices\": " << block.nvertices
+            << ", \"cells\": " << block.ncells << "}}";
+        first = false;
+        for (const PortProfile & port : block.ports){
+            out << ",\n  {\"name\": ";
+            writeJSONString(out, port.port);
+            out << ", \"cat\": \"port\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << block.thread
+                << ", \"ts\": " << 1.e6*port.start << ", \"dur\": " << 1.e6*port.wall
+                << ", \"args\": {\"receivers\": " << port.receivers << ", \"bytes\": " << port.bytes << "}}";
+        }
+    }
+    out << std::endl << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+}
+
+}
@@ -0,0 +1,132 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __PROFILER_HPP__
+#define __PROFILER_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mimmo{
+
+/*!
+ * \struct PortProfile
+ * \ingroup core
+ * \brief Timing and size of the data exchanged by an output port of an executable block.
+ */
+struct PortProfile{
+    std::string port;       /**< ID of the output port */
+    int         receivers;  /**< number of linked receivers */
+    long        bytes;      /**< bytes exchanged with the receivers, as streamed */
+    double      start;      /**< start of the exchange [s] from the profiler activation */
+    double      wall;       /**< wall time of the exchange [s] */
+
+    PortProfile();
+};
+
+/*!
+ * \struct BlockProfile
+ * \ingroup core
+ * \brief Resources spent by a single execution of an executable block.
+ */
+struct BlockProfile{
+    std::string name;       /**< name of the block */
+    int         id;         /**< id of the block */
+    int         thread;     /**< index of the thread executing the block */
+    double      start;      /**< start of the execution [s] from the profiler activation */
+    double      wall;       /**< wall time of the execution [s] */
+    double      cpu;        /**< cpu time of the process during the execution [s] */
+    long        rss;        /**< increase of the process peak resident set size [kB] */
+    long        nvertices;  /**< number of vertices of the target geometry, -1 if no geometry is linked */
+    long        ncells;     /**< number of cells of the target geometry, -1 if no geometry is linked */
+    std::vector<PortProfile> ports; /**< data exchanged by the output ports */
+
+    BlockProfile();
+};
+
+/*!
+ * \class Profiler
+ * \ingroup core
+ * \brief Singleton collecting the execution profile of the executable blocks.
+ *
+ * When active, each call to BaseManipulation::exec records a BlockProfile with wall time,
+ * cpu time, increase of peak memory and size of the target geometry of the block, together
+ * with the time spent and the bytes exchanged by each of its linked output ports.
+ * Cpu time and peak memory are measured on the whole process, so they include the work of
+ * concurrent blocks when a Chain is executed on more than one worker, and of the OpenMP threads
+ * of the block; they are written as process totals (processCPU, processPeakRSSDeltaKB).
+ * Bytes exchanged by a port are the size of its data once streamed, also when data are passed
+ * to the receivers through shared handle.
+ *
+ * Collected profiles can be written as a JSON summary (writeSummary) or as a timeline
+ * in the Chrome trace-event format (writeTrace), to be loaded in chrome://tracing or
+ * similar viewers. Recording is thread-safe.
+ */
+class Profiler{
+
+private:
+    std::atomic<bool>           m_active;   /**< true if profiling is active */
+    std::chrono::steady_clock::time_point m_origin; /**< origin of the recorded times */
+    std::vector<BlockProfile>   m_blocks;   /**< recorded profiles */
+    std::unordered_map<std::thread::id, int> m_threads; /**< map of threads to compact indices */
+    std::mutex                  m_mutex;    /**< guard of the recorded profiles */
+
+    /*!Private constructor of the singleton*/
+    Profiler();
+    /*!Prevent copy-construction for singleton*/
+    Profiler(const Profiler&);
+    /*!Prevent assignment for singleton*/
+    Profiler& operator=(const Profiler&);
+    /*! Destructor */
+    ~Profiler(){};
+
+public:
+    /*! Instance the singleton */
+    static Profiler& instance(){
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void    setActive(bool active = true);
+    bool    isActive();
+    void    clear();
+
+    double  getTime();
+    double  getCPUTime();
+    long    getPeakRSS();
+
+    void    addBlock(BlockProfile block);
+    std::vector<BlockProfile> getBlocks();
+
+    void    writeSummary(const std::string & filename);
+    void    writeTrace(const std::string & filename);
+};
+
+}
+
+#endif /* __PROFILER_HPP__ */
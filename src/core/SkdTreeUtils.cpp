@@ -26,7 +26,9 @@
 # include "MimmoCGUtils.hpp"
 # include "bitpit_patchkernel.hpp"
 # include "mimmoTypeDef.hpp"
+# include <algorithm>
 # include <cmath>
+# include <limits>
 
 using namespace bitpit;
 
@@ -34,6 +36,76 @@ namespace mimmo{
 
 namespace skdTreeUtils{
 
+/*!
+ * Evaluate the signed distance of a point from a cell of a surface patch, given the
+ * cell previously found as the closest one. See signedDistance.
+ * \param[in] P coordinates of the point.
+ * \param[in] spatch pointer to the surface patch.
+ * \param[in] id label of the closest cell.
+ * \param[out] n pseudo-normal of the cell w.r.t. the point.
+ * \return signed distance of the point from the cell.
+ */
+static double signedDistanceToCell(const std::array<double,3> &P, const bitpit::SurfUnstructured *spatch, long id, std::array<double,3> &n)
+{
+    double h;
+
+    //signed distance only for 2D element patches(quads, pixels, triangles or segments)
+    const bitpit::Cell & cell = spatch->getCell(id);
+    bitpit::ConstProxyVector<long> vertIds = cell.getVertexIds();
+    dvecarr3E VS(vertIds.size());
+    int count = 0;
+    for (const auto & iV: vertIds){
+        VS[count] = spatch->getVertexCoords(iV);
+        ++count;
+    }
+ 
+    darray3E xP = {{0.0,0.0,0.0}};
+    darray3E normal= {{0.0,0.0,0.0}};
+
+    if ( vertIds.size() == 3 ){ //TRIANGLE
+        darray3E lambda;
+        h = bitpit::CGElem::distancePointTriangle(P, VS[0], VS[1], VS[2],lambda);
+        int count = 0;
+        for(const auto &val: lambda){
+            normal += val * spatch->evalVertexNormal(id,count) ;
+            xP += val * VS[count];
+            ++count;
+        }
+    }else if ( vertIds.size() == 2 ){ //LINE/SEGMENT
+        darray2E lambda;
+        h = bitpit::CGElem::distancePointSegment(P, VS[0], VS[1], lambda);
+        int count = 0;
+        for(const auto &val: lambda){
+            normal += val * spatch->evalVertexNormal(id,count) ;
+            xP += val * VS[count];
+            ++count;
+        }
+    }else{ //GENERAL POLYGON
+        std::vector<double> lambda;
+        h = bitpit::CGElem::distancePointPolygon(P, VS,lambda);
+        int count = 0;
+        for(const auto &val: lambda){
+            normal += val * spatch->evalVertexNormal(id,count) ;
+            xP += val * VS[count];
+            ++count;
+        }
+    }
+
+    double s =  sign( dotProduct(normal, P - xP) );
+    if(s == 0.0)    s =1.0;
+    h = s * h;
+    //pseudo-normal (direction P and xP closest point on triangle)
+    n = s * (P - xP);
+    double normX = norm2(n);
+    if(normX < 1.E-15){
+        n = normal/norm2(normal);
+    }else{
+        n /= norm2(n);
+    }
+    return h;
+
+}
+
 /*!
  * It computes the unsigned distance of a point to a geometry linked in a SkdTree
  * object. The geometry has to be a surface mesh, in particular an object of type
@@ -98,61 +170,7 @@ double signedDistance(std::array<double,3> *P_, bitpit::PatchSkdTree *bvtree_, l
 
     static_cast<bitpit::SurfaceSkdTree*>(bvtree_)->findPointClosestCell(*P_, r, &id, &h);
 
-    //signed distance only for 2D element patches(quads, pixels, triangles or segments)
-    const bitpit::Cell & cell = spatch->getCell(id);
-    bitpit::ConstProxyVector<long> vertIds = cell.getVertexIds();
-    dvecarr3E VS(vertIds.size());
-    int count = 0;
-    for (const auto & iV: vertIds){
-        VS[count] = spatch->getVertexCoords(iV);
-        ++count;
-    }
- 
-    darray3E xP = {{0.0,0.0,0.0}};
-    darray3E normal= {{0.0,0.0,0.0}};
-
-    if ( vertIds.size() == 3 ){ //TRIANGLE
-        darray3E lambda;
-        h = bitpit::CGElem::distancePointTriangle((*P_), VS[0], VS[1], VS[2],lambda);
-        int count = 0;
-        for(const auto &val: lambda){
-            normal += val * spatch->evalVertexNormal(id,count) ;
-            xP += val * VS[count];
-            ++count;
-        }
-    }else if ( vertIds.size() == 2 ){ //LINE/SEGMENT
-        darray2E lambda;
-        h = bitpit::CGElem::distancePointSegment((*P_), VS[0], VS[1], lambda);
-        int count = 0;
-        for(const auto &val: lambda){
-            normal += val * spatch->evalVertexNormal(id,count) ;
-            xP += val * VS[count];
-            ++count;
-        }
-    }else{ //GENERAL POLYGON
-        std::vector<double> lambda;
-        h = bitpit::CGElem::distancePointPolygon((*P_), VS,lambda);
-        int count = 0;
-        for(const auto &val: lambda){
-            normal += val * spatch->evalVertexNormal(id,count) ;
-            xP += val * VS[count];
-            ++count;
-        }
-    }
-
-    double s =  sign( dotProduct(normal, (*P_) - xP) );
-    if(s == 0.0)    s =1.0;
-    h = s * h;
-    //pseudo-normal (direction P and xP closest point on triangle)
-    n = s * ((*P_) - xP);
-    double normX = norm2(n);
-    if(normX < 1.E-15){
-        n = normal/norm2(normal);
-    }else{
-        n /= norm2(n);
-    }
-    return h;
-
+    return signedDistanceToCell(*P_, spatch, id, n);
 }
 
 /*!
@@ -409,9 +427,217 @@ long locatePointOnPatch(const std::array<double, 3> &point, bitpit::PatchSkdTree
     return id;
 }
 
+/*!
+ * Number of consecutive points, in spatial order, sharing the warm start of the queries in batched queries.
+ */
+static const std::size_t BATCH_BLOCK_SIZE = 64;
 
+/*!
+ * Run a query kernel on a list of points in a spatially coherent order. Points are sorted
+ * along a Morton curve and split in blocks of BATCH_BLOCK_SIZE consecutive points. The kernel is
+ * called as kernel(i, previous), where i is the index of the current point and previous the index of
+ * the point processed just before in the same block (std::numeric_limits<std::size_t>::max() for the
+ * first point of a block), that can be used to warm start the query.
+ * Points are processed serially: the queries of a bitpit tree share its traversal state, so that
+ * a tree cannot be queried concurrently.
+ * \param[in] points list of query points
+ * \param[in] kernel query functor
+ */
+template<typename Kernel>
+static void runBatch(const std::vector<std::array<double,3> > &points, Kernel kernel)
+{
+    std::vector<std::size_t> order = spatialOrder(points);
+    std::size_t previous = std::numeric_limits<std::size_t>::max();
+    for (std::size_t k = 0; k < order.size(); ++k){
+        if (k % BATCH_BLOCK_SIZE == 0) previous = std::numeric_limits<std::size_t>::max();
+        kernel(order[k], previous);
+        previous = order[k];
+    }
+}
+
+/*!
+ * Search radius guaranteed to contain the closest cell to a point, given the distance
+ * of a neighbour point from the same patch (triangular inequality).
+ * \param[in] P coordinates of the point.
+ * \param[in] Q coordinates of the neighbour point.
+ * \param[in] distQ unsigned distance of the neighbour point from the patch.
+ * \return search radius.
+ */
+static double warmRadius(const std::array<double,3> &P, const std::array<double,3> &Q, double distQ)
+{
+    return (distQ + norm2(P - Q))*(1.0 + 1.0e-06) + 1.0e-12;
+}
+
+/*!
+ * Sort a list of points along a Morton (Z-order) curve spanning their bounding box,
+ * so that points close in the sorted list are close in space.
+ * \param[in] points list of points
+ * \return indices of the points in spatial order.
+ */
+std::vector<std::size_t> spatialOrder(const std::vector<std::array<double,3> > &points)
+{
+    std::size_t np = points.size();
+    std::vector<std::size_t> order(np);
+    for (std::size_t i = 0; i < np; ++i) order[i] = i;
+    if (np < 2) return order;
+
+    std::array<double,3> pmin = points[0], pmax = points[0];
+    for (const std::array<double,3> & p : points){
+        for (int j = 0; j < 3; ++j){
+            pmin[j] = std::min(pmin[j], p[j]);
+            pmax[j] = std::max(pmax[j], p[j]);
+        }
+    }
+
+    //interleave 21 bits of quantized coordinates for each direction.
+    const double nbins = double((1 << 21) - 1);
+    std::vector<uint64_t> codes(np);
+#pragma omp parallel for
+    for (long i = 0; i < long(np); ++i){
+        uint64_t code = 0;
+        for (int j = 0; j < 3; ++j){
+            double span = pmax[j] - pmin[j];
+            uint64_t q = (span > 0.0) ? uint64_t((points[i][j] - pmin[j]) / span * nbins) : 0;
+            for (int bit = 0; bit < 21; ++bit){
+                code |= ((q >> bit) & uint64_t(1)) << (3*bit + j);
+            }
+        }
+        codes[i] = code;
+    }
 
+    std::sort(order.begin(), order.end(), [&codes](std::size_t a, std::size_t b){
+        return (codes[a] < codes[b]) || (codes[a] == codes[b] && a < b);
+    });
+    return order;
+}
 
+/*!
+ * Batched version of distance. Unsigned distances of a list of points are evaluated
+ * processing points in spatially coherent order; the search radius of each point
+ * is narrowed with the distance of the previous point in the same block, without affecting the result.
+ * \param[in] points coordinates of input points.
+ * \param[in] bvtree_ Pointer to Boundary Volume Hierarchy tree that stores the geometry.
+ * \param[out] ids labels of the elements found as minimum distance elements, bitpit::Cell::NULL_ID if none is found.
+ * \param[in] r radius of the sphere used to search.
+ * \return unsigned distances of the input points (1.0e+18 if none element is found in the search radius).
+ */
+std::vector<double> distance(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, std::vector<long> &ids, double r)
+{
+    if(!bvtree_ ){
+        throw std::runtime_error("Invalid use of skdTreeUtils::distance method: a void tree is detected.");
+    }
+    if(!dynamic_cast<const bitpit::SurfUnstructured*>(&(bvtree_->getPatch()))){
+        throw std::runtime_error("Invalid use of skdTreeUtils::distance method: a not surface patch tree is detected.");
+    }
+    bitpit::SurfaceSkdTree * tree = static_cast<bitpit::SurfaceSkdTree*>(bvtree_);
+
+    std::vector<double> dist(points.size(), 1.0E+18);
+    ids.assign(points.size(), bitpit::Cell::NULL_ID);
+
+    runBatch(points, [&](std::size_t i, std::size_t previous){
+        double radius = r;
+        if (previous < points.size() && dist[previous] < 1.0E+18){
+            radius = std::min(r, warmRadius(points[i], points[previous], dist[previous]));
+        }
+        tree->findPointClosestCell(points[i], radius, &ids[i], &dist[i]);
+        if (dist[i] >= 1.0E+18 && radius < r){
+            tree->findPointClosestCell(points[i], r, &ids[i], &dist[i]);
+        }
+    });
+
+    return dist;
+}
+
+/*!
+ * Batched version of signedDistance. Signed distances of a list of points are evaluated
+ * processing points in spatially coherent order; the search radius of each point
+ * is narrowed with the distance of the previous point in the same block, without affecting the result.
+ * \param[in] points coordinates of input points.
+ * \param[in] bvtree_ Pointer to Boundary Volume Hierarchy tree that stores the geometry.
+ * \param[out] ids labels of the elements found as minimum distance elements, bitpit::Cell::NULL_ID if none is found.
+ * \param[out] normals pseudo-normals of the elements w.r.t. the points (see signedDistance).
+ * \param[in] r radius of the sphere used to search.
+ * \return signed distances of the input points (1.0e+18 if none element is found in the search radius).
+ */
+std::vector<double> signedDistance(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, std::vector<long> &ids, std::vector<std::array<double,3> > &normals, double r)
+{
+    if(!bvtree_ ){
+        throw std::runtime_error("Invalid use of skdTreeUtils::signedDistance method: a void tree is detected.");
+    }
+    const bitpit::SurfUnstructured *spatch = dynamic_cast<const bitpit::SurfUnstructured*>(&(bvtree_->getPatch()));
+    if(!spatch){
+        throw std::runtime_error("Invalid use of skdTreeUtils::signedDistance method: a not surface patch tree is detected.");
+    }
+    bitpit::SurfaceSkdTree * tree = static_cast<bitpit::SurfaceSkdTree*>(bvtree_);
+
+    std::vector<double> dist(points.size(), 1.0E+18);
+    ids.assign(points.size(), bitpit::Cell::NULL_ID);
+    normals.assign(points.size(), std::array<double,3>({{0.0,0.0,0.0}}));
+
+    runBatch(points, [&](std::size_t i, std::size_t previous){
+        double radius = r;
+        if (previous < points.size() && std::abs(dist[previous]) < 1.0E+18){
+            radius = std::min(r, warmRadius(points[i], points[previous], std::abs(dist[previous])));
+        }
+        double h = 1.0E+18;
+        tree->findPointClosestCell(points[i], radius, &ids[i], &h);
+        if (h >= 1.0E+18 && radius < r){
+            tree->findPointClosestCell(points[i], r, &ids[i], &h);
+        }
+        if (h < 1.0E+18){
+            dist[i] = signedDistanceToCell(points[i], spatch, ids[i], normals[i]);
+        }
+    });
+
+    return dist;
+}
+
+/*!
+ * Batched version of projectPoint. Projections of a list of points are evaluated
+ * processing points in spatially coherent order.
+ * \param[in] points coordinates of input points.
+ * \param[in] bvtree_ Pointer to Boundary Volume Hierarchy tree that stores the geometry.
+ * \param[in] r_ Initial length of the sphere radius used to search, increased until an element is found.
+ * \return coordinates of the projected points.
+ */
+std::vector<std::array<double,3> > projectPoints(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, double r_)
+{
+    std::vector<long> ids;
+    std::vector<std::array<double,3> > normals;
+    std::vector<double> dist = signedDistance(points, bvtree_, ids, normals, r_);
+
+    std::vector<std::array<double,3> > projected(points.size());
+    for (long i = 0; i < long(points.size()); ++i){
+        if (std::abs(dist[i]) >= 1.0e+18){
+            //none element in the initial radius, fall back to the growing radius search.
+            std::array<double,3> P = points[i];
+            projected[i] = projectPoint(&P, bvtree_, 1.5*r_);
+        }else{
+            projected[i] = points[i] - dist[i]*normals[i];
+        }
+    }
+    return projected;
+}
+
+/*!
+ * Batched version of locatePointOnPatch. Points are located processing them
+ * in spatially coherent order.
+ * \param[in] points coordinates of input points.
+ * \param[in] tree reference to SkdTree relative to the target surface geometry.
+ * \return ids of the geometry cells the points are into, bitpit::Cell::NULL_ID for points not located.
+ */
+std::vector<long> locatePointsOnPatch(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree &tree)
+{
+    if(!dynamic_cast<const bitpit::SurfUnstructured*>(&(tree.getPatch()))){
+        throw std::runtime_error("Invalid use of skdTreeUtils::locatePointsOnPatch method: a non surface patch or void patch was detected.");
+    }
+    std::vector<long> ids(points.size(), bitpit::Cell::NULL_ID);
+    runBatch(points, [&](std::size_t i, std::size_t previous){
+        BITPIT_UNUSED(previous);
+        ids[i] = locatePointOnPatch(points[i], tree);
+    });
+    return ids;
+}
 
 }
 
@@ -45,6 +45,13 @@ namespace skdTreeUtils{
     std::array<double,3> projectPoint(std::array<double,3> *P_, bitpit::PatchSkdTree *bvtree_, double r_ = 1.0e+18);
     long locatePointOnPatch(const std::array<double, 3> &point, bitpit::PatchSkdTree &tree);
 
+    std::vector<double> distance(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, std::vector<long> &ids, double r);
+    std::vector<double> signedDistance(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, std::vector<long> &ids, std::vector<std::array<double,3> > &normals, double r);
+    std::vector<std::array<double,3> > projectPoints(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree *bvtree_, double r_ = 1.0e+18);
+    std::vector<long> locatePointsOnPatch(const std::vector<std::array<double,3> > &points, bitpit::PatchSkdTree &tree);
+
+    std::vector<std::size_t> spatialOrder(const std::vector<std::array<double,3> > &points);
+
 }; //end namespace skdTreeUtils
 
 } //end namespace mimmo
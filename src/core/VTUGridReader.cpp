@@ -23,12 +23,171 @@
 \*---------------------------------------------------------------------------*/
 
 #include "VTUGridReader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
 
 using namespace std;
 using namespace bitpit;
 
 namespace mimmo{
 
+/*!
+ * \return size in bytes of a VTK data type, 0 if the type is not a numeric one.
+ * \param[in] datatype VTK data type
+ */
+static std::size_t vtkDataTypeSize(bitpit::VTKDataType datatype)
+{
+    switch(datatype){
+        case bitpit::VTKDataType::Int8 :
+        case bitpit::VTKDataType::UInt8 :
+            return 1;
+        case bitpit::VTKDataType::Int16 :
+        case bitpit::VTKDataType::UInt16 :
+            return 2;
+        case bitpit::VTKDataType::Int32 :
+        case bitpit::VTKDataType::UInt32 :
+        case bitpit::VTKDataType::Float32 :
+            return 4;
+        case bitpit::VTKDataType::Int64 :
+        case bitpit::VTKDataType::UInt64 :
+        case bitpit::VTKDataType::Float64 :
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/*!
+ * Convert a raw buffer of values of type T in values of type U.
+ * Values are copied byte-wise, so that the buffer does not need any alignment.
+ * \param[in] data raw buffer
+ * \param[in] n number of values
+ * \param[out] out converted values, at least n
+ */
+template<typename T, typename U>
+static void convertValues(const char * data, std::size_t n, U * out)
+{
+    for(std::size_t i=0; i<n; ++i){
+        T val;
+        std::memcpy(&val, data + i*sizeof(T), sizeof(T));
+        out[i] = static_cast<U>(val);
+    }
+}
+
+/*!
+ * Convert a raw buffer of integer values of a VTK data type in values of type U.
+ * \param[in] data raw buffer
+ * \param[in] n number of values
+ * \param[in] datatype VTK data type of the buffer
+ * \param[out] out converted values, at least n
+ * \param[in] error message thrown if datatype is not an integer one
+ */
+template<typename U>
+static void convertIntegers(const char * data, std::size_t n, bitpit::VTKDataType datatype, U * out, const std::string & error)
+{
+    switch(datatype){
+        case bitpit::VTKDataType::Int8 :    convertValues<int8_t>(data, n, out);   break;
+        case bitpit::VTKDataType::UInt8 :   convertValues<uint8_t>(data, n, out);  break;
+        case bitpit::VTKDataType::Int16 :   convertValues<int16_t>(data, n, out);  break;
+        case bitpit::VTKDataType::UInt16 :  convertValues<uint16_t>(data, n, out); break;
+        case bitpit::VTKDataType::Int32 :   convertValues<int32_t>(data, n, out);  break;
+        case bitpit::VTKDataType::UInt32 :  convertValues<uint32_t>(data, n, out); break;
+        case bitpit::VTKDataType::Int64 :   convertValues<int64_t>(data, n, out);  break;
+        case bitpit::VTKDataType::UInt64 :  convertValues<uint64_t>(data, n, out); break;
+        default:
+            throw std::runtime_error(error);
+        break;
+    }
+}
+
+/*!
+ * Convert a raw buffer of floating point values of a VTK data type in values of type U.
+ * \param[in] data raw buffer
+ * \param[in] n number of values
+ * \param[in] datatype VTK data type of the buffer
+ * \param[out] out converted values, at least n
+ * \param[in] error message thrown if datatype is not a floating point one
+ */
+template<typename U>
+static void convertReals(const char * data, std::size_t n, bitpit::VTKDataType datatype, U * out, const std::string & error)
+{
+    switch(datatype){
+        case bitpit::VTKDataType::Float32 : convertValues<float>(data, n, out);  break;
+        case bitpit::VTKDataType::Float64 : convertValues<double>(data, n, out); break;
+        default:
+            throw std::runtime_error(error);
+        break;
+    }
+}
+
+/*!
+ * \return bitpit::ElementType corresponding to a VTK cell type code, UNDEFINED if not supported.
+ * \param[in] code VTK cell type
+ */
+static bitpit::ElementType vtkCellType(long code)
+{
+    switch (code)  {
+        case 1:     return bitpit::ElementType::VERTEX;
+        case 3:     return bitpit::ElementType::LINE;
+        case 5:     return bitpit::ElementType::TRIANGLE;
+        case 7:     return bitpit::ElementType::POLYGON;
+        case 8:     return bitpit::ElementType::PIXEL;
+        case 9:     return bitpit::ElementType::QUAD;
+        case 10:    return bitpit::ElementType::TETRA;
+        case 11:    return bitpit::ElementType::VOXEL;
+        case 12:    return bitpit::ElementType::HEXAHEDRON;
+        case 13:    return bitpit::ElementType::WEDGE;
+        case 14:    return bitpit::ElementType::PYRAMID;
+        case 42:    return bitpit::ElementType::POLYHEDRON;
+        default:    return bitpit::ElementType::UNDEFINED;
+    }
+}
+
+/*!
+ * Read a whole data block from a stream positioned by bitpit::VTK.
+ * Binary blocks are read with a single call; ascii values are parsed as 64 bit integers
+ * or doubles, according to the type declared in file.
+ * \param[in] stream    stream to read from
+ * \param[in] format    ASCII or APPENDED
+ * \param[in] entries   number of values of the block
+ * \param[in] datatype  data type declared in file
+ * \param[out] buffer   raw values read
+ * \return data type of values in buffer
+ */
+static bitpit::VTKDataType readVTKBlock(std::fstream &stream, bitpit::VTKFormat format, uint64_t entries,
+                                        bitpit::VTKDataType datatype, std::vector<char> & buffer)
+{
+    if(format == bitpit::VTKFormat::ASCII){
+        buffer.resize(std::size_t(entries)*8);
+        if(datatype == bitpit::VTKDataType::Float32 || datatype == bitpit::VTKDataType::Float64){
+            double val;
+            for(std::size_t i=0; i<entries; ++i){
+                genericIO::absorbASCII(stream, val);
+                std::memcpy(buffer.data() + 8*i, &val, 8);
+            }
+            return bitpit::VTKDataType::Float64;
+        }
+        int64_t val;
+        for(std::size_t i=0; i<entries; ++i){
+            genericIO::absorbASCII(stream, val);
+            std::memcpy(buffer.data() + 8*i, &val, 8);
+        }
+        return bitpit::VTKDataType::Int64;
+    }
+
+    buffer.resize(std::size_t(entries)*vtkDataTypeSize(datatype));
+    stream.read(buffer.data(), buffer.size());
+    return datatype;
+}
+
 /*!
  * Base Constructor
  */
@@ -40,7 +199,8 @@ VTUAbsorbStreamer::VTUAbsorbStreamer() : VTKBaseStreamer(){}
 VTUAbsorbStreamer::~VTUAbsorbStreamer(){}
 
 /*!
- * Absorber of VTU mesh data. Reimplemented from bitpit::VTKBaseStreamer class
+ * Absorber of VTU mesh data. Reimplemented from bitpit::VTKBaseStreamer class.
+ * The whole data block is read in a raw buffer and passed to absorbBuffer.
  * \param[in] stream    stream to read from
  * \param[in] name      name of the geometry field
  * \param[in] format    ASCII or APPENDED
@@ -51,7 +211,9 @@ VTUAbsorbStreamer::~VTUAbsorbStreamer(){}
 void VTUAbsorbStreamer::absorbData(std::fstream &stream, const std::string &name, bitpit::VTKFormat format,
                                  uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
 {
-    bitpit::VTKBaseStreamer::absorbData(stream, name, format, entries, components, datatype);
+    std::vector<char> buffer;
+    bitpit::VTKDataType buffertype = readVTKBlock(stream, format, entries, datatype, buffer);
+    absorbBuffer(name, buffer.data(), entries, components, buffertype);
 }
 /*!
  * Absorber to get BITPIT_LEGACY from versions lesser then 1.6 release.
@@ -59,10 +221,28 @@ void VTUAbsorbStreamer::absorbData(std::fstream &stream, const std::string &name
 void VTUAbsorbStreamer::absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format,
                                  uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
 {
-    bitpit::VTKBaseStreamer::absorbData(stream, name, format, entries, components, datatype);
+    std::vector<char> buffer;
+    bitpit::VTKDataType buffertype = readVTKBlock(stream, format, entries, datatype, buffer);
+    absorbBuffer(name, buffer.data(), entries, components, buffertype);
 }
 
-
+/*!
+ * Absorber of a raw data buffer of a VTU mesh field. Base implementation skips the data.
+ * \param[in] name      name of the geometry field
+ * \param[in] data      raw values, not necessarily aligned
+ * \param[in] entries   number of values in data
+ * \param[in] components number of components of current data container
+ * \param[in] datatype   data type of the values
+ */
+void VTUAbsorbStreamer::absorbBuffer(const std::string &name, const char * data, uint64_t entries,
+                                     uint8_t components, bitpit::VTKDataType datatype)
+{
+    BITPIT_UNUSED(name);
+    BITPIT_UNUSED(data);
+    BITPIT_UNUSED(entries);
+    BITPIT_UNUSED(components);
+    BITPIT_UNUSED(datatype);
+}
 
 /*!
  * Base Constructor
@@ -75,1256 +255,58 @@ VTUGridStreamer::VTUGridStreamer():VTUAbsorbStreamer(){}
 VTUGridStreamer::~VTUGridStreamer(){}
 
 /*!
- * Absorber of VTU mesh data. Reimplemented from bitpit::VTKBaseStreamer class
- * \param[in] stream    stream to read from
+ * Absorber of a raw data buffer of VTU mesh data. The type of the buffer is resolved once,
+ * then values are converted in a single pass.
  * \param[in] name      name of the geometry field
- * \param[in] format    ASCII or APPENDED
- * \param[in] entries   number of entries for data container
+ * \param[in] data      raw values, not necessarily aligned
+ * \param[in] entries   number of values in data
  * \param[in] components number of components of current data container
- * \param[in] datatype   data format for binary casting
+ * \param[in] datatype   data type of the values
  */
-void VTUGridStreamer::absorbData(std::fstream &stream, const std::string &name, bitpit::VTKFormat format,
-                                 uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
+void VTUGridStreamer::absorbBuffer(const std::string &name, const char * data, uint64_t entries,
+                                   uint8_t components, bitpit::VTKDataType datatype)
 {
-    std::size_t sizeData = std::size_t(entries/components);
+    std::size_t sizeData = std::size_t(entries/std::max(components, uint8_t(1)));
     if (name == "Points") {
-        //get correct data type
         points.resize(sizeData);
-        for (auto & p :points) {
-            for(auto &pval : p){
-                switch (datatype){
-                    case bitpit::VTKDataType::Float32 :
-                    {
-                        float val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    case bitpit::VTKDataType::Float64:
-                    {
-                        double val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    default:
-                        throw std::runtime_error("VTUGridStreamer::absorbData : Points data format not available");
-                    break;
-                }
-
-            }
-        }
+        convertReals(data, 3*sizeData, datatype, reinterpret_cast<double *>(points.data()),
+                     "VTUGridStreamer::absorbData : Points data format not available");
     } else if (name == "offsets") {
         offsets.resize(sizeData);
-        for (auto & voffset : offsets) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Offsets data format not available");
-                break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, offsets.data(),
+                        "VTUGridStreamer::absorbData : Offsets data format not available");
     } else if (name == "types") {
+        livector1D codes(sizeData);
+        convertIntegers(data, sizeData, datatype, codes.data(),
+                        "VTUGridStreamer::absorbData : Types data format not available");
         types.resize(sizeData);
-        for (auto & vtype : types) {
-
-            int dumType;
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Types data format not available");
-                break;
-            }
-            //find ElementType
-            switch (dumType)  {
-                case 1:
-                    vtype = bitpit::ElementType::VERTEX;
-                    break;
-
-                case 3:
-                    vtype = bitpit::ElementType::LINE;
-                    break;
-
-                case 5:
-                    vtype = bitpit::ElementType::TRIANGLE;
-                    break;
-
-                case 7:
-                    vtype = bitpit::ElementType::POLYGON;
-                    break;
-
-                case 8:
-                    vtype = bitpit::ElementType::PIXEL;
-                    break;
-
-                case 9:
-                    vtype = bitpit::ElementType::QUAD;
-                    break;
-
-                case 10:
-                    vtype = bitpit::ElementType::TETRA;
-                    break;
-
-                case 11:
-                    vtype = bitpit::ElementType::VOXEL;
-                    break;
-
-                case 12:
-                    vtype = bitpit::ElementType::HEXAHEDRON;
-                    break;
-
-                case 13:
-                    vtype = bitpit::ElementType::WEDGE;
-                    break;
-
-                case 14:
-                    vtype = bitpit::ElementType::PYRAMID;
-                    break;
-
-                case 42:
-                    vtype = bitpit::ElementType::POLYHEDRON;
-                    break;
-
-                default:
-                    vtype = bitpit::ElementType::UNDEFINED;
-                    break;
-
-            }
+        for(std::size_t i=0; i<sizeData; ++i){
+            types[i] = vtkCellType(codes[i]);
         }
     } else if (name == "connectivity") {
         connectivitylist.resize(sizeData);
-        for (auto & vconn : connectivitylist) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Connectivity data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, connectivitylist.data(),
+                        "VTUGridStreamer::absorbData : Connectivity data format not available");
     } else if (name == "faces") {
         faces.resize(sizeData);
-        for (auto & vface : faces) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Faces data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, faces.data(),
+                        "VTUGridStreamer::absorbData : Faces data format not available");
     } else if (name == "faceoffsets") {
         faceoffsets.resize(sizeData);
-        for (auto & vfoffset : faceoffsets) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Faceoffsets data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, faceoffsets.data(),
+                        "VTUGridStreamer::absorbData : FaceOffsets data format not available");
     } else if (name == "cellIndex") {
         cellsID.resize(sizeData);
-        for (auto & vcid : cellsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : CellIndex data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, cellsID.data(),
+                        "VTUGridStreamer::absorbData : cellIndex data format not available");
     } else if (name == "PID") {
         pids.resize(sizeData);
-        for (auto & pid : pids) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : PID data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, pids.data(),
+                        "VTUGridStreamer::absorbData : PID data format not available");
     } else if (name == "vertexIndex") {
         pointsID.resize(sizeData);
-        for (auto & vpid : pointsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : VertexIndex data format not available");
-                    break;
-            }
-        }
-    }
-}
-
-/*!
- * Absorber to get BITPIT_LEGACY from versions lesser then 1.6 release.
- */
-void VTUGridStreamer::absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format,
-                                 uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
-{
-    std::size_t sizeData = std::size_t(entries/components);
-    if (name == "Points") {
-        //get correct data type
-        points.resize(sizeData);
-        for (auto & p :points) {
-            for(auto &pval : p){
-                switch (datatype){
-                    case bitpit::VTKDataType::Float32 :
-                    {
-                        float val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    case bitpit::VTKDataType::Float64:
-                    {
-                        double val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    default:
-                        throw std::runtime_error("VTUGridStreamer::absorbData : Points data format not available");
-                    break;
-                }
-
-            }
-        }
-    } else if (name == "offsets") {
-        offsets.resize(sizeData);
-        for (auto & voffset : offsets) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    voffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Offsets data format not available");
-                break;
-            }
-        }
-    } else if (name == "types") {
-        types.resize(sizeData);
-        for (auto & vtype : types) {
-
-            int dumType;
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    dumType = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Types data format not available");
-                break;
-            }
-            //find ElementType
-            switch (dumType)  {
-                case 1:
-                    vtype = bitpit::ElementType::VERTEX;
-                    break;
-
-                case 3:
-                    vtype = bitpit::ElementType::LINE;
-                    break;
-
-                case 5:
-                    vtype = bitpit::ElementType::TRIANGLE;
-                    break;
-
-                case 7:
-                    vtype = bitpit::ElementType::POLYGON;
-                    break;
-
-                case 8:
-                    vtype = bitpit::ElementType::PIXEL;
-                    break;
-
-                case 9:
-                    vtype = bitpit::ElementType::QUAD;
-                    break;
-
-                case 10:
-                    vtype = bitpit::ElementType::TETRA;
-                    break;
-
-                case 11:
-                    vtype = bitpit::ElementType::VOXEL;
-                    break;
-
-                case 12:
-                    vtype = bitpit::ElementType::HEXAHEDRON;
-                    break;
-
-                case 13:
-                    vtype = bitpit::ElementType::WEDGE;
-                    break;
-
-                case 14:
-                    vtype = bitpit::ElementType::PYRAMID;
-                    break;
-
-                case 42:
-                    vtype = bitpit::ElementType::POLYHEDRON;
-                    break;
-
-                default:
-                    vtype = bitpit::ElementType::UNDEFINED;
-                    break;
-
-            }
-        }
-    } else if (name == "connectivity") {
-        connectivitylist.resize(sizeData);
-        for (auto & vconn : connectivitylist) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vconn = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Connectivity data format not available");
-                    break;
-            }
-        }
-    } else if (name == "faces") {
-        faces.resize(sizeData);
-        for (auto & vface : faces) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vface = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Faces data format not available");
-                    break;
-            }
-        }
-    } else if (name == "faceoffsets") {
-        faceoffsets.resize(sizeData);
-        for (auto & vfoffset : faceoffsets) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vfoffset = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : Faceoffsets data format not available");
-                    break;
-            }
-        }
-    } else if (name == "cellIndex") {
-        cellsID.resize(sizeData);
-        for (auto & vcid : cellsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vcid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : CellIndex data format not available");
-                    break;
-            }
-        }
-    } else if (name == "PID") {
-        pids.resize(sizeData);
-        for (auto & pid : pids) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    pid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : PID data format not available");
-                    break;
-            }
-        }
-    } else if (name == "vertexIndex") {
-        pointsID.resize(sizeData);
-        for (auto & vpid : pointsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUGridStreamer::absorbData : VertexIndex data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, pointsID.data(),
+                        "VTUGridStreamer::absorbData : vertexIndex data format not available");
     }
 }
 
@@ -1343,7 +325,7 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
     if(nVertices == 0){
         throw std::runtime_error("Error VTUGridStreamer : no point coordinates detected while reading *.vtu file.");
     }
-    if(nCells == 0 || types.empty() || connectivitylist.size() < nCells ){
+    if(nCells == 0 || types.size() < nCells || connectivitylist.size() < nCells ){
         throw std::runtime_error("Error VTUGridStreamer : no valid connectivity/offsets/types info detected while reading *.vtu file.");
     }
 
@@ -1358,8 +340,9 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
         checkPointsID = ( checkSet.size() == nVertices);
     }
     //insert points and recover local/global map of vertices;
-    std::unordered_map<int, long> mapVert;
-    int counter = 0;
+    //local indices are contiguous, so the map is a plain vector.
+    std::vector<long> mapVert(nVertices);
+    std::size_t counter = 0;
     long idV=0;
     for(const auto & p : points){
         idV = bitpit::Vertex::NULL_ID;
@@ -1368,6 +351,13 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
         mapVert[counter] = (*it).getId();
         ++counter;
     }
+    //remap a local vertex index of the file into the id of the patch vertex.
+    auto globalVertex = [&mapVert](long local){
+        if(local < 0 || local >= long(mapVert.size())){
+            throw std::runtime_error("Error VTUGridStreamer : connectivity refers to a vertex index out of range while reading *.vtu file.");
+        }
+        return mapVert[local];
+    };
 
     //reading mesh connectivity by offsets and store it in cells.
     //check cell labels if any;
@@ -1381,7 +371,7 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
     //insert points;
     counter = 0;
     long idC=0;
-    int posCellBegin = 0, posFaceBegin=0;
+    long posCellBegin = 0, posFaceBegin=0;
     bitpit::ElementType eltype;
     long PID;
     livector1D conn;
@@ -1392,24 +382,28 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
         if(checkCellsID)  {idC= cellsID[counter];}
         if(checkPID)      {PID = pids[counter];}
         eltype = types[counter];
+        if(off < posCellBegin || off > long(connectivitylist.size())){
+            throw std::runtime_error("Error VTUGridStreamer : invalid cell offsets detected while reading *.vtu file.");
+        }
 
         if(eltype == bitpit::ElementType::POLYHEDRON){
             if(!checkFaceOffset){
                 throw std::runtime_error("Error VTUGridStreamer : trying to acquire POLYHEDRON info without faces and faceoffsets data");
             }
-            connSize = faceoffsets[counter] - posFaceBegin;
-            conn.resize(connSize);
-            int loc = 0;
-            for(int i=posFaceBegin; i<faceoffsets[counter]; ++i){
-                conn[loc] = faces[i];
-                ++loc;
+            if(faceoffsets[counter] < posFaceBegin || faceoffsets[counter] > long(faces.size())){
+                throw std::runtime_error("Error VTUGridStreamer : invalid face offsets detected while reading *.vtu file.");
             }
+            connSize = faceoffsets[counter] - posFaceBegin;
+            conn.assign(faces.begin() + posFaceBegin, faces.begin() + faceoffsets[counter]);
             //remap vertices: conn is now written face by face with local vertex indices
-            int posfbegin = 1, posfend; //begin from 1- value. 0 value of conn contains the total number fo faces
-            while(posfbegin < int(connSize)){
+            std::size_t posfbegin = 1, posfend; //begin from 1- value. 0 value of conn contains the total number fo faces
+            while(posfbegin < connSize){
                 posfend = posfbegin +conn[posfbegin] + 1;
-                for(int i=posfbegin+1; i<posfend; ++i){
-                    conn[i] = mapVert[conn[i]];
+                if(conn[posfbegin] < 0 || posfend > connSize){
+                    throw std::runtime_error("Error VTUGridStreamer : invalid polyhedron faces detected while reading *.vtu file.");
+                }
+                for(std::size_t i=posfbegin+1; i<posfend; ++i){
+                    conn[i] = globalVertex(conn[i]);
                 }
                 posfbegin = posfend;
             }
@@ -1417,17 +411,17 @@ void VTUGridStreamer::decodeRawData(bitpit::PatchKernel & patch)
             connSize = off - posCellBegin;
             conn.resize(connSize +1);
             conn[0] = connSize;
-            int loc =1;
-            for(int i=posCellBegin; i<off; ++i){
-                conn[loc] = mapVert[connectivitylist[i]];
+            std::size_t loc =1;
+            for(long i=posCellBegin; i<off; ++i){
+                conn[loc] = globalVertex(connectivitylist[i]);
                 ++loc;
             }
         }else{
             connSize = off - posCellBegin;
             conn.resize(connSize);
-            int loc =0;
-            for(int i=posCellBegin; i<off; ++i){
-                conn[loc] = mapVert[connectivitylist[i]];
+            std::size_t loc =0;
+            for(long i=posCellBegin; i<off; ++i){
+                conn[loc] = globalVertex(connectivitylist[i]);
                 ++loc;
             }
         }
@@ -1454,222 +448,28 @@ VTUPointCloudStreamer::VTUPointCloudStreamer():VTUAbsorbStreamer(){}
 VTUPointCloudStreamer::~VTUPointCloudStreamer(){}
 
 /*!
- * Absorber of VTU mesh data. Reimplemented from bitpit::VTKBaseStreamer class
- * \param[in] stream    stream to read from
+ * Absorber of a raw data buffer of VTU point cloud data.
  * \param[in] name      name of the geometry field
- * \param[in] format    ASCII or APPENDED
- * \param[in] entries   number of entries for the data container
+ * \param[in] data      raw values, not necessarily aligned
+ * \param[in] entries   number of values in data
  * \param[in] components number of components of current data container
- * \param[in] datatype   data format for binary casting
- */
-void VTUPointCloudStreamer::absorbData(std::fstream &stream, const std::string &name, bitpit::VTKFormat format,
-                                 uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
-{
-    std::size_t sizeData = std::size_t(entries/components);
-    if (name == "Points") {
-        //get correct data type
-        points.resize(sizeData);
-        for (auto & p :points) {
-            for(auto &pval : p){
-                switch (datatype){
-                    case bitpit::VTKDataType::Float32 :
-                    {
-                        float val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    case bitpit::VTKDataType::Float64:
-                    {
-                        double val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    default:
-                        throw std::runtime_error("VTUGridStreamer::absorbData : Points data format not available");
-                        break;
-                }
-
-            }
-        }
-    }else if (name == "vertexIndex") {
-        pointsID.resize(sizeData);
-        for (auto & vpid : pointsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUPointCloudStreamer::absorbData : VertexIndex data format not available");
-                    break;
-            }
-        }
-    }
-}
-/*!
- * method to ensure bitpit_legacy with versions lesser then 1.6 release
+ * \param[in] datatype   data type of the values
  */
-
-void VTUPointCloudStreamer::absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format,
-                                 uint64_t entries, uint8_t components, bitpit::VTKDataType datatype)
+void VTUPointCloudStreamer::absorbBuffer(const std::string &name, const char * data, uint64_t entries,
+                                         uint8_t components, bitpit::VTKDataType datatype)
 {
-    std::size_t sizeData = std::size_t(entries/components);
+    std::size_t sizeData = std::size_t(entries/std::max(components, uint8_t(1)));
     if (name == "Points") {
-        //get correct data type
         points.resize(sizeData);
-        for (auto & p :points) {
-            for(auto &pval : p){
-                switch (datatype){
-                    case bitpit::VTKDataType::Float32 :
-                    {
-                        float val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    case bitpit::VTKDataType::Float64:
-                    {
-                        double val;
-                        if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                        else                                    genericIO::absorbBINARY(stream, val);
-                        pval = val;
-                    }
-                    break;
-                    default:
-                        throw std::runtime_error("VTUGridStreamer::absorbData : Points data format not available");
-                        break;
-                }
-
-            }
-        }
-    }else if (name == "vertexIndex") {
+        convertReals(data, 3*sizeData, datatype, reinterpret_cast<double *>(points.data()),
+                     "VTUPointCloudStreamer::absorbData : Points data format not available");
+    } else if (name == "vertexIndex") {
         pointsID.resize(sizeData);
-        for (auto & vpid : pointsID) {
-            switch(datatype){
-                case bitpit::VTKDataType::Int8 :
-                {
-                    int8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt8 :
-                {
-                    uint8_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int16 :
-                {
-                    int16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt16 :
-                {
-                    uint16_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int32 :
-                {
-                    int32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt32 :
-                {
-                    uint32_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::Int64 :
-                {
-                    int64_t val;
-                    if(format == bitpit::VTKFormat::ASCII)  genericIO::absorbASCII(stream,val);
-                    else                                    genericIO::absorbBINARY(stream, val);
-                    vpid = val;
-                }
-                break;
-                case bitpit::VTKDataType::UInt64 :
-                default:
-                    throw std::runtime_error("VTUPointCloudStreamer::absorbData : VertexIndex data format not available");
-                    break;
-            }
-        }
+        convertIntegers(data, sizeData, datatype, pointsID.data(),
+                        "VTUPointCloudStreamer::absorbData : vertexIndex data format not available");
     }
 }
 
-
 /*!
  * Use streamer absorbed data, if any, to fill vertices of target bitpit::PatchKernel container,
  * passed externally. Please notice, container must be empty.
@@ -1692,20 +492,181 @@ void VTUPointCloudStreamer::decodeRawData(bitpit::PatchKernel & patch)
         std::unordered_set<long> checkSet(pointsID.begin(), pointsID.end());
         checkPointsID = ( checkSet.size() == nVertices);
     }
-    //insert points and recover local/global map of vertices;
-    std::unordered_map<int, long> mapVert;
-    int counter = 0;
+    //insert points
+    std::size_t counter = 0;
     long idV=0;
     for(const auto & p : points){
         idV = bitpit::Vertex::NULL_ID;
         if(checkPointsID) idV = pointsID[counter];
-        bitpit::PatchKernel::VertexIterator it = patch.addVertex(p, idV);
-        mapVert[counter] = (*it).getId();
+        patch.addVertex(p, idV);
         ++counter;
     }
 }
 
+/*!
+ * \return value of an attribute of a xml tag, empty string if not found.
+ * \param[in] tag  text of the tag, from '<' to '>'
+ * \param[in] attribute name of the attribute
+ */
+static std::string vtkTagAttribute(const std::string & tag, const std::string & attribute)
+{
+    std::size_t pos = 0;
+    std::string key = attribute + "=";
+    while((pos = tag.find(key, pos)) != std::string::npos){
+        //attribute name must be a whole word.
+        if(pos > 0 && !std::isspace(static_cast<unsigned char>(tag[pos-1]))){
+            pos += key.size();
+            continue;
+        }
+        pos += key.size();
+        if(pos >= tag.size())    return "";
+        char quote = tag[pos];
+        std::size_t end = tag.find(quote, pos+1);
+        if(end == std::string::npos)    return "";
+        return tag.substr(pos+1, end-pos-1);
+    }
+    return "";
+}
+
+/*!
+ * \return VTK data type corresponding to the type attribute of a DataArray, UNDEFINED if unknown.
+ * \param[in] type value of the type attribute
+ */
+static bitpit::VTKDataType vtkDataTypeFromString(const std::string & type)
+{
+    if(type == "Int8")      return bitpit::VTKDataType::Int8;
+    if(type == "UInt8")     return bitpit::VTKDataType::UInt8;
+    if(type == "Int16")     return bitpit::VTKDataType::Int16;
+    if(type == "UInt16")    return bitpit::VTKDataType::UInt16;
+    if(type == "Int32")     return bitpit::VTKDataType::Int32;
+    if(type == "UInt32")    return bitpit::VTKDataType::UInt32;
+    if(type == "Int64")     return bitpit::VTKDataType::Int64;
+    if(type == "UInt64")    return bitpit::VTKDataType::UInt64;
+    if(type == "Float32")   return bitpit::VTKDataType::Float32;
+    if(type == "Float64")   return bitpit::VTKDataType::Float64;
+    return bitpit::VTKDataType::UNDEFINED;
+}
 
+/*!
+ * Decode a base64 encoded text. Whitespaces are skipped, decoding stops at the first padding character.
+ * \param[in] text  begin of encoded text
+ * \param[in] size  number of characters of encoded text
+ * \param[out] out  decoded bytes
+ */
+static void vtkDecodeBase64(const char * text, std::size_t size, std::vector<char> & out)
+{
+    static const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    int table[256];
+    std::fill(table, table+256, -1);
+    for(std::size_t i=0; i<alphabet.size(); ++i)    table[static_cast<unsigned char>(alphabet[i])] = int(i);
+
+    out.clear();
+    out.reserve(3*(size/4)+3);
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for(std::size_t i=0; i<size; ++i){
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if(c == '=')    break;
+        int val = table[c];
+        if(val < 0)     continue;
+        accumulator = (accumulator << 6) | uint32_t(val);
+        bits += 6;
+        if(bits >= 8){
+            bits -= 8;
+            out.push_back(char((accumulator >> bits) & 0xFF));
+        }
+    }
+}
+
+/*!
+ * \return value of an unsigned integer of VTK header type, read from a raw buffer.
+ * \param[in] data raw buffer
+ * \param[in] headerSize size in bytes of the VTK header type, 4 or 8
+ */
+static uint64_t vtkHeaderValue(const char * data, std::size_t headerSize)
+{
+    if(headerSize == 8){
+        uint64_t val;
+        std::memcpy(&val, data, 8);
+        return val;
+    }
+    uint32_t val;
+    std::memcpy(&val, data, 4);
+    return val;
+}
+
+/*!
+ * Evaluate the size in bytes of the compression header of a VTK data array, checking it
+ * against overflow and against the bytes available.
+ * \param[in] nBlocks       number of compressed blocks, as read from the header
+ * \param[in] headerSize    size in bytes of the VTK header type, 4 or 8
+ * \param[in] available     number of bytes available from the begin of the header
+ * \param[out] bytes        size in bytes of the compression header
+ * \return false if the header does not fit in the available bytes
+ */
+static bool vtkBlocksHeaderBytes(std::size_t nBlocks, std::size_t headerSize, std::size_t available, std::size_t & bytes)
+{
+    std::size_t maxEntries = available / headerSize;
+    if(maxEntries < 3 || nBlocks > maxEntries - 3)  return false;
+    bytes = (3+nBlocks)*headerSize;
+    return true;
+}
+
+/*!
+ * Inflate the zlib compressed blocks of a VTK data array.
+ * Blocks are independent, so they are inflated in parallel, if OpenMP is enabled.
+ * \param[in] header        compression header: number of blocks, block size, last block size, compressed sizes
+ * \param[in] headerSize    size in bytes of the VTK header type, 4 or 8
+ * \param[in] compressed    begin of compressed blocks
+ * \param[in] available     number of bytes available from compressed
+ * \param[out] out          inflated data
+ */
+static void vtkInflateBlocks(const char * header, std::size_t headerSize, const char * compressed,
+                             std::size_t available, std::vector<char> & out)
+{
+    uint64_t nBlocks   = vtkHeaderValue(header, headerSize);
+    uint64_t blockSize = vtkHeaderValue(header + headerSize, headerSize);
+    uint64_t lastSize  = vtkHeaderValue(header + 2*headerSize, headerSize);
+
+    //inflated sizes bounded by the block size, as written by VTK, and addressable by zlib.
+    if(lastSize > blockSize || blockSize > uint64_t(std::numeric_limits<uLongf>::max())){
+        throw std::runtime_error("VTUGridReader : corrupted compression header");
+    }
+
+    std::vector<std::size_t> compressedOffsets(nBlocks+1, 0);
+    for(std::size_t i=0; i<nBlocks; ++i){
+        uint64_t blockBytes = vtkHeaderValue(header + (3+i)*headerSize, headerSize);
+        if(blockBytes > available - compressedOffsets[i]){
+            throw std::runtime_error("VTUGridReader : compressed data block exceeds file size");
+        }
+        compressedOffsets[i+1] = compressedOffsets[i] + blockBytes;
+    }
+
+    std::size_t total = 0;
+    if(nBlocks > 0){
+        if(blockSize > 0 && nBlocks-1 > (std::numeric_limits<std::size_t>::max() - blockSize) / blockSize){
+            throw std::runtime_error("VTUGridReader : corrupted compression header");
+        }
+        total = (nBlocks-1)*blockSize + (lastSize > 0 ? lastSize : blockSize);
+    }
+    out.resize(total);
+
+    long nFailed = 0;
+#if MIMMO_ENABLE_OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+:nFailed)
+#endif
+    for(long i=0; i<long(nBlocks); ++i){
+        uLongf expectedSize = (i == long(nBlocks)-1 && lastSize > 0) ? lastSize : blockSize;
+        uLongf inflatedSize = expectedSize;
+        int err = uncompress(reinterpret_cast<Bytef *>(out.data() + i*blockSize), &inflatedSize,
+                             reinterpret_cast<const Bytef *>(compressed + compressedOffsets[i]),
+                             compressedOffsets[i+1] - compressedOffsets[i]);
+        if(err != Z_OK || inflatedSize != expectedSize) ++nFailed;
+    }
+    if(nFailed > 0){
+        throw std::runtime_error("VTUGridReader : failed to inflate zlib compressed data block");
+    }
+}
 
 /*!
  * Base constructor. Linked reference bitpit::PatchKernel container must be empty. If not,
@@ -1717,7 +678,8 @@ void VTUPointCloudStreamer::decodeRawData(bitpit::PatchKernel & patch)
  * \param[in] eltype [optional] force the elementtype of the grid.
  */
 VTUGridReader::VTUGridReader( std::string dir, std::string name, VTUAbsorbStreamer & streamer, bitpit::PatchKernel & patch, bitpit::VTKElementType eltype) :
-                              VTKUnstructuredGrid(dir, name, eltype), m_patch(patch), m_streamer(streamer)
+                              VTKUnstructuredGrid(dir, name, eltype), m_patch(patch), m_streamer(streamer),
+                              m_dir(dir), m_filename(name)
 {
     for(auto & field : m_geometry){
         field.enable();
@@ -1736,13 +698,242 @@ VTUGridReader::~VTUGridReader(){}
 
 /*!
  * Read the file. Reimplemented from bitpit::VTKUnstructuredGrid::read().
+ * Files supported by the direct reader are decoded without passing through bitpit::VTK.
  */
 void VTUGridReader::read(){
 
-    VTKUnstructuredGrid::read();
+    if(!readDirect()){
+        VTKUnstructuredGrid::read();
+    }
      //clear target data
     m_patch.reset();
     m_streamer.decodeRawData(m_patch);
 }
 
+/*!
+ * Direct reader of *.vtu files. The file is memory-mapped and its xml header parsed;
+ * the data arrays of the mesh (Points, connectivity, offsets, types, faces, faceoffsets)
+ * and the fields vertexIndex, cellIndex and PID are decoded each one in a single buffer
+ * and passed to the streamer with VTUAbsorbStreamer::absorbBuffer.
+ * Raw appended data, inline binary and ascii data arrays are supported, optionally compressed
+ * with vtkZLibDataCompressor.
+ * \return false if the file layout is not supported by the direct reader (big endian byte order,
+ * base64 appended data), so that it has to be read through bitpit::VTK. Nothing is passed to the
+ * streamer in this case.
+ */
+bool VTUGridReader::readDirect(){
+
+    std::string filename = m_dir + "/" + m_filename + ".vtu";
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw std::runtime_error("VTUGridReader : cannot open file " + filename);
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0){
+        ::close(fd);
+        throw std::runtime_error("VTUGridReader : cannot read file " + filename);
+    }
+    std::size_t size = std::size_t(info.st_size);
+    void * mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        return false;
+    }
+    const char * data = static_cast<const char *>(mapped);
+
+    //location and format of a data array of the file.
+    struct DataArray{
+        std::string         name;
+        bitpit::VTKDataType datatype;
+        uint8_t             components;
+        std::string         format;         //ascii, binary or appended
+        std::size_t         offset;         //offset of appended data
+        std::size_t         begin;          //begin of inline data
+        std::size_t         end;            //end of inline data
+    };
+
+    //find a token in the mapped file, starting from a position.
+    auto find = [&](const std::string & token, std::size_t from) -> std::size_t{
+        if(from >= size)    return std::string::npos;
+        const char * found = static_cast<const char *>(memmem(data + from, size - from, token.data(), token.size()));
+        if(found == nullptr)    return std::string::npos;
+        return std::size_t(found - data);
+    };
+    //get the text of the tag starting at a position.
+    auto tagAt = [&](std::size_t pos) -> std::string{
+        std::size_t end = find(">", pos);
+        if(end == std::string::npos)    return "";
+        return std::string(data + pos, end - pos + 1);
+    };
+
+    bool supported = true;
+    std::vector<DataArray> arrays;
+    std::size_t headerSize = 4, appendedBegin = std::string::npos;
+    bool compressed = false;
+    try{
+        std::size_t posFile = find("<VTKFile", 0);
+        if(posFile == std::string::npos){
+            throw std::runtime_error("VTUGridReader : " + filename + " is not a valid *.vtu file");
+        }
+        std::string fileTag = tagAt(posFile);
+        if(vtkTagAttribute(fileTag, "byte_order") == "BigEndian")    supported = false;
+        if(vtkTagAttribute(fileTag, "header_type") == "UInt64")      headerSize = 8;
+        std::string compressor = vtkTagAttribute(fileTag, "compressor");
+        if(compressor == "vtkZLibDataCompressor"){
+            compressed = true;
+        }else if(!compressor.empty()){
+            throw std::runtime_error("VTUGridReader : unsupported compressor " + compressor + " in file " + filename);
+        }
+
+        std::size_t xmlEnd = find("<AppendedData", posFile);
+        if(xmlEnd != std::string::npos){
+            std::string appendedTag = tagAt(xmlEnd);
+            if(vtkTagAttribute(appendedTag, "encoding") != "raw")    supported = false;
+            appendedBegin = find("_", xmlEnd + appendedTag.size());
+            if(appendedBegin != std::string::npos)  ++appendedBegin;
+        }else{
+            xmlEnd = size;
+        }
+
+        std::size_t pointsBegin = find("<Points", posFile);
+        std::size_t pointsEnd   = find("</Points>", posFile);
+
+        std::size_t pos = find("<DataArray", posFile);
+        while(supported && pos < xmlEnd){
+            std::string tag = tagAt(pos);
+            DataArray array;
+            array.name = vtkTagAttribute(tag, "Name");
+            if(pointsBegin != std::string::npos && pos > pointsBegin && pos < pointsEnd)    array.name = "Points";
+            array.datatype = vtkDataTypeFromString(vtkTagAttribute(tag, "type"));
+            std::string components = vtkTagAttribute(tag, "NumberOfComponents");
+            array.components = uint8_t(components.empty() ? 1 : std::atoi(components.c_str()));
+            array.format = vtkTagAttribute(tag, "format");
+            std::string offset = vtkTagAttribute(tag, "offset");
+            array.offset = std::size_t(offset.empty() ? 0 : std::strtoull(offset.c_str(), nullptr, 10));
+            array.begin = pos + tag.size();
+            array.end = array.begin;
+            if(tag.size() > 1 && tag[tag.size()-2] != '/'){
+                array.end = find("</DataArray>", array.begin);
+                if(array.end == std::string::npos)  array.end = xmlEnd;
+            }
+            if(array.name == "Points" || array.name == "connectivity" || array.name == "offsets" ||
+               array.name == "types" || array.name == "faces" || array.name == "faceoffsets" ||
+               array.name == "vertexIndex" || array.name == "cellIndex" || array.name == "PID"){
+                if(vtkDataTypeSize(array.datatype) == 0){
+                    throw std::runtime_error("VTUGridReader : unsupported data type of array " + array.name + " in file " + filename);
+                }
+                if(array.format == "appended" && appendedBegin == std::string::npos){
+                    supported = false;
+                }
+                arrays.push_back(array);
+            }
+            pos = find("<DataArray", array.end);
+        }
+
+        if(supported){
+            std::vector<char> buffer, decoded;
+            for(const DataArray & array : arrays){
+                bitpit::VTKDataType buffertype = array.datatype;
+                std::size_t typeSize = vtkDataTypeSize(array.datatype);
+                if(array.format == "ascii"){
+                    //parse values as 64 bit integers or doubles, as in bitpit ascii reader.
+                    buffer.clear();
+                    const char * cursor = data + array.begin;
+                    const char * last = data + array.end;
+                    std::string text(cursor, last);
+                    const char * c = text.c_str();
+                    char * next = nullptr;
+                    bool real = (array.datatype == bitpit::VTKDataType::Float32 || array.datatype == bitpit::VTKDataType::Float64);
+                    buffertype = real ? bitpit::VTKDataType::Float64 : bitpit::VTKDataType::Int64;
+                    while(true){
+                        char value[8];
+                        if(real){
+                            double val = std::strtod(c, &next);
+                            std::memcpy(value, &val, 8);
+                        }else{
+                            long long val = std::strtoll(c, &next, 10);
+                            int64_t val64 = val;
+                            std::memcpy(value, &val64, 8);
+                        }
+                        if(next == c)   break;
+                        buffer.insert(buffer.end(), value, value+8);
+                        c = next;
+                    }
+                    typeSize = 8;
+                }else if(array.format == "binary"){
+                    //inline base64: header and data are encoded together if uncompressed, separately otherwise.
+                    const char * text = data + array.begin;
+                    std::size_t textSize = array.end - array.begin;
+                    while(textSize > 0 && std::isspace(static_cast<unsigned char>(*text))){
+                        ++text;
+                        --textSize;
+                    }
+                    if(!compressed){
+                        vtkDecodeBase64(text, textSize, decoded);
+                        if(decoded.size() < headerSize){
+                            throw std::runtime_error("VTUGridReader : corrupted binary array " + array.name + " in file " + filename);
+                        }
+                        std::size_t nbytes = std::min<std::size_t>(vtkHeaderValue(decoded.data(), headerSize), decoded.size() - headerSize);
+                        buffer.assign(decoded.begin() + headerSize, decoded.begin() + headerSize + nbytes);
+                    }else{
+                        vtkDecodeBase64(text, std::min<std::size_t>(textSize, 4*((headerSize+2)/3)), decoded);
+                        if(decoded.size() < headerSize){
+                            throw std::runtime_error("VTUGridReader : corrupted binary array " + array.name + " in file " + filename);
+                        }
+                        std::size_t nBlocks = vtkHeaderValue(decoded.data(), headerSize);
+                        //base64 text encodes at most 3 bytes every 4 characters
+                        std::size_t headerBytes;
+                        if(!vtkBlocksHeaderBytes(nBlocks, headerSize, 3*((textSize+3)/4), headerBytes)){
+                            throw std::runtime_error("VTUGridReader : corrupted binary array " + array.name + " in file " + filename);
+                        }
+                        std::size_t headerChars = 4*((headerBytes + 2)/3);
+                        if(headerChars > textSize){
+                            throw std::runtime_error("VTUGridReader : corrupted binary array " + array.name + " in file " + filename);
+                        }
+                        std::vector<char> header;
+                        vtkDecodeBase64(text, headerChars, header);
+                        if(header.size() < headerBytes){
+                            throw std::runtime_error("VTUGridReader : corrupted binary array " + array.name + " in file " + filename);
+                        }
+                        vtkDecodeBase64(text + headerChars, textSize - headerChars, decoded);
+                        vtkInflateBlocks(header.data(), headerSize, decoded.data(), decoded.size(), buffer);
+                    }
+                }else if(array.format == "appended"){
+                    if(array.offset > size || appendedBegin > size - array.offset){
+                        throw std::runtime_error("VTUGridReader : appended array " + array.name + " exceeds size of file " + filename);
+                    }
+                    std::size_t begin = appendedBegin + array.offset;
+                    if(headerSize > size - begin){
+                        throw std::runtime_error("VTUGridReader : appended array " + array.name + " exceeds size of file " + filename);
+                    }
+                    if(!compressed){
+                        std::size_t nbytes = vtkHeaderValue(data + begin, headerSize);
+                        if(nbytes > size - begin - headerSize){
+                            throw std::runtime_error("VTUGridReader : appended array " + array.name + " exceeds size of file " + filename);
+                        }
+                        m_streamer.absorbBuffer(array.name, data + begin + headerSize, nbytes/typeSize, array.components, buffertype);
+                        continue;
+                    }
+                    std::size_t nBlocks = vtkHeaderValue(data + begin, headerSize);
+                    std::size_t headerBytes;
+                    if(!vtkBlocksHeaderBytes(nBlocks, headerSize, size - begin, headerBytes)){
+                        throw std::runtime_error("VTUGridReader : appended array " + array.name + " exceeds size of file " + filename);
+                    }
+                    std::size_t blocksBegin = begin + headerBytes;
+                    vtkInflateBlocks(data + begin, headerSize, data + blocksBegin, size - blocksBegin, buffer);
+                }else{
+                    throw std::runtime_error("VTUGridReader : unsupported format " + array.format + " of array " + array.name + " in file " + filename);
+                }
+                m_streamer.absorbBuffer(array.name, buffer.data(), buffer.size()/typeSize, array.components, buffertype);
+            }
+        }
+    }catch(...){
+        munmap(mapped, size);
+        throw;
+    }
+
+    munmap(mapped, size);
+    return supported;
+}
+
 }
@@ -38,8 +38,9 @@ namespace mimmo{
  * \brief Abstract class for custom reader/absorber of *.vtu mesh external files
  *
  * Reader/absorber is focused to mesh data only.
+ * Data blocks are read in bulk from file and passed as raw buffers of their VTK data type to absorbBuffer.
  * Abstract class need to provide:
- *  - A custom implementation of absorbData method to read the data from file (actually void).
+ *  - A custom implementation of absorbBuffer method to convert the raw buffers (actually void).
  *  - A method to decode raw data acquired by the streamer, in order to fill a
  * custom mesh container of type bitpit::PatchKernel.
  */
@@ -52,6 +53,7 @@ public:
 
     virtual void absorbData(std::fstream &stream, const std::string & name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
     virtual void absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
+    virtual void absorbBuffer(const std::string & name, const char * data, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
     /*! Decode read raw data and fill a bitpit::PatchKernel structure with them */
     virtual void decodeRawData(bitpit::PatchKernel &) = 0;
 };
@@ -82,8 +84,7 @@ public:
     /*! Copy Constructor*/
     VTUGridStreamer(const VTUGridStreamer&) = default;
 
-    virtual void absorbData(std::fstream &stream, const std::string &name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
-    virtual void absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
+    void absorbBuffer(const std::string & name, const char * data, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
     void decodeRawData(bitpit::PatchKernel & patch);
 };
 
@@ -106,8 +107,7 @@ public:
     /*!Copy Constructor */
     VTUPointCloudStreamer(const VTUPointCloudStreamer&) = default;
 
-    virtual void absorbData(std::fstream &stream, const std::string & name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
-    virtual void absorbData(std::fstream &stream, std::string name, bitpit::VTKFormat format, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
+    void absorbBuffer(const std::string & name, const char * data, uint64_t entries, uint8_t components, bitpit::VTKDataType datatype);
     void decodeRawData(bitpit::PatchKernel & patch);
 
 };
@@ -120,6 +120,11 @@ public:
  * Reader of unstructured grids from external files *.vtu. if successfull reading,
  * store the mesh fields in target bitpit::Patchkernel data structure.
  * Need in construction to specify a streamer of type VTUAbsorbStreamer.
+ *
+ * Little endian files with raw appended data or inline binary data, optionally compressed
+ * with zlib, are read directly: the file is memory-mapped, each data array is decoded in
+ * a single buffer (compressed blocks are inflated in parallel, if OpenMP is enabled) and
+ * passed to the streamer. Other files are read through bitpit::VTKUnstructuredGrid.
  */
 class VTUGridReader: protected bitpit::VTKUnstructuredGrid
 {
@@ -134,6 +139,10 @@ public:
 private:
     bitpit::PatchKernel& m_patch;   /**< reference to patch kernel data structure to fill*/
     VTUAbsorbStreamer & m_streamer; /**< reference to streamer which knows how to read data from file */
+    std::string m_dir;              /**< directory of the file */
+    std::string m_filename;         /**< name of the file, without extension */
+
+    bool readDirect();
 };
 
 
@@ -51,6 +51,7 @@
 #include "MimmoPiercedVector.hpp"
 #include "MimmoCGUtils.hpp"
 #include "MimmoFvMesh.hpp"
+#include "Profiler.hpp"
 #include "VTUGridReader.hpp"
 
 #endif
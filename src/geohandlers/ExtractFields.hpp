@@ -185,6 +185,7 @@ public:
     dmpvector1D getOriginalField();
     
     void clear();
+    std::vector<MimmoObject*> getInvolvedGeometries();
 
     void     plotOptionalResults();
     bool     extract();
@@ -253,6 +254,7 @@ public:
 
     dmpvecarr3E     getOriginalField();
     void clear();
+    std::vector<MimmoObject*> getInvolvedGeometries();
 
     void     plotOptionalResults();
     bool     extract();
@@ -114,7 +114,19 @@ ExtractScalarField::getOriginalField(){
  */
 void
 ExtractScalarField::setField(dmpvector1D field){
-    m_field = field;
+    m_field = std::move(field);
+}
+
+/*!
+ * Return the geometries involved in the extraction: the linked geometry and the
+ * geometry of the input field.
+ * \return list of geometries involved in the execution
+ */
+std::vector<MimmoObject*>
+ExtractScalarField::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = BaseManipulation::getInvolvedGeometries();
+    if(m_field.getGeometry() != NULL)   result.push_back(m_field.getGeometry());
+    return result;
 }
 
 /*!
@@ -114,7 +114,19 @@ ExtractVectorField::getOriginalField(){
  */
 void
 ExtractVectorField::setField(dmpvecarr3E field){
-    m_field = field;
+    m_field = std::move(field);
+}
+
+/*!
+ * Return the geometries involved in the extraction: the linked geometry and the
+ * geometry of the input field.
+ * \return list of geometries involved in the execution
+ */
+std::vector<MimmoObject*>
+ExtractVectorField::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = BaseManipulation::getInvolvedGeometries();
+    if(m_field.getGeometry() != NULL)   result.push_back(m_field.getGeometry());
+    return result;
 }
 
 /*!
@@ -489,6 +489,7 @@ public:
     void    removeMappingGeometries();
 
     void clear();
+    std::vector<MimmoObject*> getInvolvedGeometries();
 
     virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name="" );
     virtual void flushSectionXML(bitpit::Config::Section & slotXML, std::string name="" );
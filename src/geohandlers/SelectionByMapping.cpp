@@ -46,12 +46,15 @@ SelectionByMapping::SelectionByMapping(int topo){
     m_allowedType[1].insert(FileType::SURFVTU);
     m_allowedType[1].insert(FileType::NAS);
     m_allowedType[1].insert(FileType::MIMMO);
+    m_allowedType[1].insert(FileType::MIMMOBIN);
 
     m_allowedType[2].insert(FileType::VOLVTU);
     m_allowedType[2].insert(FileType::MIMMO);
+    m_allowedType[2].insert(FileType::MIMMOBIN);
     
     m_allowedType[4].insert(FileType::CURVEVTU);
     m_allowedType[4].insert(FileType::MIMMO);
+    m_allowedType[4].insert(FileType::MIMMOBIN);
 };
 
 /*!
@@ -82,12 +85,15 @@ SelectionByMapping::SelectionByMapping(const bitpit::Config::Section & rootXML){
     m_allowedType[1].insert(FileType::SURFVTU);
     m_allowedType[1].insert(FileType::NAS);
     m_allowedType[1].insert(FileType::MIMMO);
+    m_allowedType[1].insert(FileType::MIMMOBIN);
     
     m_allowedType[2].insert(FileType::VOLVTU);
     m_allowedType[2].insert(FileType::MIMMO);
+    m_allowedType[2].insert(FileType::MIMMOBIN);
     
     m_allowedType[4].insert(FileType::CURVEVTU);
     m_allowedType[4].insert(FileType::MIMMO);
+    m_allowedType[4].insert(FileType::MIMMOBIN);
 
 
     if(input_name == "mimmo.SelectionByMapping"){
@@ -114,12 +120,15 @@ SelectionByMapping::SelectionByMapping(std::unordered_map<std::string, int> & ge
     m_allowedType[1].insert(FileType::SURFVTU);
     m_allowedType[1].insert(FileType::NAS);
     m_allowedType[1].insert(FileType::MIMMO);
+    m_allowedType[1].insert(FileType::MIMMOBIN);
     
     m_allowedType[2].insert(FileType::VOLVTU);
     m_allowedType[2].insert(FileType::MIMMO);
+    m_allowedType[2].insert(FileType::MIMMOBIN);
     
     m_allowedType[4].insert(FileType::CURVEVTU);
     m_allowedType[4].insert(FileType::MIMMO);
+    m_allowedType[4].insert(FileType::MIMMOBIN);
     
     if(target == NULL) return;
     if(target->isEmpty()) return;
@@ -306,6 +315,18 @@ SelectionByMapping::removeMappingGeometries(){
     m_mimmolist.clear();
 };
 
+/*!
+ * Return the geometries involved in the selection: the linked geometry and the
+ * geometries for mapping.
+ * \return list of geometries involved in the execution
+ */
+std::vector<MimmoObject*>
+SelectionByMapping::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = BaseManipulation::getInvolvedGeometries();
+    result.insert(result.end(), m_mimmolist.begin(), m_mimmolist.end());
+    return result;
+};
+
 /*!
  * Clear your class
  */
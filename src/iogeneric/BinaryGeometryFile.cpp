@@ -0,0 +1,628 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#include "BinaryGeometryFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mimmo{
+
+const uint32_t      BinaryGeometryFile::VERSION;
+const std::size_t   BinaryGeometryFile::ALIGNMENT;
+
+/*!
+ * Byte order check value.
+ */
+static const uint32_t BINARYGEOMETRY_ENDIANNESS = 0x01020304;
+
+/*!
+ * Format identifier.
+ */
+static const char BINARYGEOMETRY_MAGIC[8] = {'M','I','M','M','O','B','I','N'};
+
+/*!
+ * Size in bytes of a section, given the header of the file.
+ * \param[in] header file header
+ * \param[in] section target section
+ * \param[out] size size in bytes of the section
+ * \return false if the size overflows std::size_t.
+ */
+static bool sectionSize(const BinaryGeometryFile::Header & header, BinaryGeometryFile::Section section, std::size_t & size){
+    uint64_t count = 0;
+    std::size_t bytes = 0;
+    switch(section){
+    case BinaryGeometryFile::COORDS :
+        if(header.nVertices > std::numeric_limits<uint64_t>::max() / 3) return false;
+        count = 3*header.nVertices;     bytes = sizeof(double);     break;
+    case BinaryGeometryFile::VERTEXIDS :    count = header.nVertices;       bytes = sizeof(int64_t);    break;
+    case BinaryGeometryFile::CELLIDS :      count = header.nCells;          bytes = sizeof(int64_t);    break;
+    case BinaryGeometryFile::CELLTYPES :    count = header.nCells;          bytes = sizeof(int32_t);    break;
+    case BinaryGeometryFile::CELLPIDS :     count = header.nCells;          bytes = sizeof(int64_t);    break;
+    case BinaryGeometryFile::CONNOFFSETS :
+        if(header.nCells == std::numeric_limits<uint64_t>::max())   return false;
+        count = header.nCells+1;        bytes = sizeof(uint64_t);   break;
+    case BinaryGeometryFile::CONNECTIVITY : count = header.nConnectivity;   bytes = sizeof(int64_t);    break;
+    case BinaryGeometryFile::PIDS :         count = header.nPIDs;           bytes = sizeof(int64_t);    break;
+    case BinaryGeometryFile::PIDNAMES :     count = header.nPIDNames;       bytes = 1;                  break;
+    case BinaryGeometryFile::SKDNODES :     count = header.nSkdNodes;       bytes = sizeof(BinaryGeometryFile::SkdNode);    break;
+    default :                               break;
+    }
+    if(count > std::numeric_limits<std::size_t>::max() / std::max(bytes, std::size_t(1)))  return false;
+    size = std::size_t(count)*bytes;
+    return true;
+}
+
+/*!
+ * \return size in bytes of a section of a header written by this library, whose counts do not overflow.
+ * \param[in] header file header
+ * \param[in] section target section
+ */
+static std::size_t sectionSize(const BinaryGeometryFile::Header & header, BinaryGeometryFile::Section section){
+    std::size_t size = 0;
+    sectionSize(header, section, size);
+    return size;
+}
+
+/*!
+ * \return true if the stored cell type is a bitpit::ElementType supported by MimmoObject.
+ * \param[in] type stored cell type
+ */
+static bool isSupportedCellType(int32_t type){
+    switch(static_cast<bitpit::ElementType>(type)){
+    case bitpit::ElementType::VERTEX :
+    case bitpit::ElementType::LINE :
+    case bitpit::ElementType::TRIANGLE :
+    case bitpit::ElementType::PIXEL :
+    case bitpit::ElementType::QUAD :
+    case bitpit::ElementType::POLYGON :
+    case bitpit::ElementType::TETRA :
+    case bitpit::ElementType::VOXEL :
+    case bitpit::ElementType::HEXAHEDRON :
+    case bitpit::ElementType::WEDGE :
+    case bitpit::ElementType::PYRAMID :
+    case bitpit::ElementType::POLYHEDRON :
+        return true;
+    default :
+        return false;
+    }
+}
+
+/*!
+ * \return true if all the vertex ids of a cell connectivity exist in the vertex container.
+ * Counts of polygon and polyhedron connectivities (see MimmoObject::getConnectivity) are skipped.
+ * \param[in] type cell type
+ * \param[in] conn cell connectivity, already checked with MimmoObject::checkCellConnCoherence
+ * \param[in] vertices vertex container
+ */
+static bool hasKnownVertices(bitpit::ElementType type, const livector1D & conn, const bitpit::PiercedVector<bitpit::Vertex> & vertices){
+    std::size_t nConn = conn.size();
+    switch(type){
+    case bitpit::ElementType::POLYGON :
+        for(std::size_t k=1; k<nConn; ++k){
+            if(!vertices.exists(conn[k]))   return false;
+        }
+        return true;
+    case bitpit::ElementType::POLYHEDRON :
+    {
+        std::size_t pos = 1;
+        for(long face=0; face<conn[0]; ++face){
+            if(pos >= nConn || conn[pos] < 1 || std::size_t(conn[pos]) > nConn - pos - 1)  return false;
+            std::size_t end = pos + std::size_t(conn[pos]);
+            for(std::size_t k=pos+1; k<=end; ++k){
+                if(!vertices.exists(conn[k]))   return false;
+            }
+            pos = end + 1;
+        }
+        return true;
+    }
+    default :
+        for(long id : conn){
+            if(!vertices.exists(id))    return false;
+        }
+        return true;
+    }
+}
+
+/*!
+ * \return the smallest multiple of BinaryGeometryFile::ALIGNMENT not less than the argument.
+ * \param[in] size size in bytes
+ */
+static std::size_t alignedSize(std::size_t size){
+    return ((size + BinaryGeometryFile::ALIGNMENT - 1) / BinaryGeometryFile::ALIGNMENT) * BinaryGeometryFile::ALIGNMENT;
+}
+
+/*!
+ * Default constructor of BinaryGeometryFile.
+ */
+BinaryGeometryFile::BinaryGeometryFile(){
+    m_data = nullptr;
+    m_size = 0;
+}
+
+/*!
+ * Default destructor of BinaryGeometryFile. The file is unmapped, if any.
+ */
+BinaryGeometryFile::~BinaryGeometryFile(){
+    close();
+}
+
+/*!
+ * Map a file in memory. Any file previously mapped is released.
+ * \param[in] filename path of the file
+ * \return false if the file cannot be mapped or it is not a valid file of the current version.
+ */
+bool
+BinaryGeometryFile::open(const std::string & filename){
+
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)  return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(Header)){
+        ::close(fd);
+        return false;
+    }
+
+    void * data = mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED)  return false;
+
+    //sections are read once and in order during materialization.
+    madvise(data, std::size_t(info.st_size), MADV_SEQUENTIAL);
+
+    m_data = data;
+    m_size = std::size_t(info.st_size);
+    if(!validate()){
+        close();
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Release the mapped file, if any. Pointers to its sections are invalidated.
+ */
+void
+BinaryGeometryFile::close(){
+    if(m_data != nullptr){
+        munmap(m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+/*!
+ * \return true if a file is mapped.
+ */
+bool
+BinaryGeometryFile::isOpen() const{
+    return (m_data != nullptr);
+}
+
+/*!
+ * \return header of the mapped file.
+ */
+const BinaryGeometryFile::Header &
+BinaryGeometryFile::getHeader() const{
+    return *static_cast<const Header *>(m_data);
+}
+
+/*!
+ * \return MimmoObject type of the stored geometry.
+ */
+int
+BinaryGeometryFile::getType() const{
+    return int(getHeader().type);
+}
+
+/*!
+ * \return number of stored vertices.
+ */
+long
+BinaryGeometryFile::getNVertex() const{
+    return long(getHeader().nVertices);
+}
+
+/*!
+ * \return number of stored cells.
+ */
+long
+BinaryGeometryFile::getNCells() const{
+    return long(getHeader().nCells);
+}
+
+/*!
+ * \return true if the skdTree section is stored.
+ */
+bool
+BinaryGeometryFile::hasSkdTree() const{
+    return (getHeader().nSkdNodes > 0);
+}
+
+/*!
+ * \return vertex coordinates, 3 consecutive values for each vertex.
+ */
+const double *
+BinaryGeometryFile::getCoords() const{
+    return getSection<double>(COORDS);
+}
+
+/*!
+ * \return unique-id of each vertex.
+ */
+const int64_t *
+BinaryGeometryFile::getVertexIds() const{
+    return getSection<int64_t>(VERTEXIDS);
+}
+
+/*!
+ * \return unique-id of each cell.
+ */
+const int64_t *
+BinaryGeometryFile::getCellIds() const{
+    return getSection<int64_t>(CELLIDS);
+}
+
+/*!
+ * \return bitpit::ElementType of each cell.
+ */
+const int32_t *
+BinaryGeometryFile::getCellTypes() const{
+    return getSection<int32_t>(CELLTYPES);
+}
+
+/*!
+ * \return PID of each cell.
+ */
+const int64_t *
+BinaryGeometryFile::getCellPIDs() const{
+    return getSection<int64_t>(CELLPIDS);
+}
+
+/*!
+ * \return offsets of cell connectivity: the connectivity of the i-th cell spans
+ * from the i-th to the (i+1)-th offset of the connectivity section.
+ */
+const uint64_t *
+BinaryGeometryFile::getConnectivityOffsets() const{
+    return getSection<uint64_t>(CONNOFFSETS);
+}
+
+/*!
+ * \return cell connectivity, by vertex unique-ids.
+ */
+const int64_t *
+BinaryGeometryFile::getConnectivity() const{
+    return getSection<int64_t>(CONNECTIVITY);
+}
+
+/*!
+ * \return skdTree nodes, nullptr if the section is not stored. Node 0 is the root.
+ */
+const BinaryGeometryFile::SkdNode *
+BinaryGeometryFile::getSkdNodes() const{
+    if(!hasSkdTree())   return nullptr;
+    return getSection<SkdNode>(SKDNODES);
+}
+
+/*!
+ * \return PIDs stored, with their names.
+ */
+std::unordered_map<long, std::string>
+BinaryGeometryFile::getPIDNames() const{
+    std::unordered_map<long, std::string> result;
+    const int64_t * pids = getSection<int64_t>(PIDS);
+    const char * names = getSection<char>(PIDNAMES);
+    const char * namesEnd = names + getHeader().nPIDNames;
+    for(uint64_t i=0; i<getHeader().nPIDs && names < namesEnd; ++i){
+        std::size_t length = strnlen(names, std::size_t(namesEnd - names));
+        result[long(pids[i])] = std::string(names, length);
+        names += length + 1;
+    }
+    return result;
+}
+
+/*!
+ * Fill a geometry with the data of the mapped file. The geometry is reset to an empty
+ * geometry of the stored type, then vertices and cells are inserted in a single sequential
+ * pass on the mapped sections, directly in its patch: the geometry state (search trees,
+ * coordinates view, adjacencies, PIDs) is invalidated and updated once, instead of at each
+ * insertion. If the file stores the skdTree, cells are inserted in its leaf order.
+ * \param[in,out] geometry geometry to fill.
+ */
+void
+BinaryGeometryFile::materialize(MimmoObject & geometry) const{
+
+    if(!isOpen()){
+        throw std::runtime_error("BinaryGeometryFile : no file mapped");
+    }
+
+    geometry.reset(getType());
+    bitpit::PatchKernel * patch = geometry.getPatch();
+    bitpit::PiercedVector<bitpit::Vertex> & vertices = patch->getVertices();
+
+    long nVertices = getNVertex();
+    const double * coords = getCoords();
+    const int64_t * vertexIds = getVertexIds();
+    patch->reserveVertices(nVertices);
+    for(long i=0; i<nVertices; ++i){
+        if(vertices.exists(long(vertexIds[i]))){
+            throw std::runtime_error("BinaryGeometryFile : duplicated vertex id " + std::to_string(vertexIds[i]));
+        }
+        patch->addVertex({{coords[3*i], coords[3*i+1], coords[3*i+2]}}, long(vertexIds[i]));
+    }
+
+    long nCells = getNCells();
+    if(nCells > 0 && getType() == 3){
+        throw std::runtime_error("BinaryGeometryFile : cells stored for a point cloud geometry");
+    }
+    if(nCells > 0){
+        bitpit::PiercedVector<bitpit::Cell> & cells = patch->getCells();
+        const int64_t * cellIds = getCellIds();
+        const int32_t * cellTypes = getCellTypes();
+        const int64_t * cellPIDs = getCellPIDs();
+        const uint64_t * offsets = getConnectivityOffsets();
+        const int64_t * connectivity = getConnectivity();
+        patch->reserveCells(nCells);
+        livector1D conn;
+        for(long i=0; i<nCells; ++i){
+            conn.assign(connectivity + offsets[i], connectivity + offsets[i+1]);
+            bitpit::ElementType type = static_cast<bitpit::ElementType>(cellTypes[i]);
+            if(cells.exists(long(cellIds[i])) || !isSupportedCellType(cellTypes[i]) || !geometry.checkCellConnCoherence(type, conn)
+                    || !hasKnownVertices(type, conn, vertices)){
+                throw std::runtime_error("BinaryGeometryFile : invalid cell " + std::to_string(cellIds[i]));
+            }
+            bitpit::PatchKernel::CellIterator it = patch->addCell(type, true, conn, long(cellIds[i]));
+            it->setPID(long(cellPIDs[i]));
+        }
+    }
+
+    geometry.resyncPID();
+    for(const auto & touple : getPIDNames()){
+        geometry.setPIDName(touple.first, touple.second);
+    }
+}
+
+/*!
+ * Check the header of the mapped file, the extent of its sections, the order of
+ * connectivity offsets and the consistency of the skdTree nodes.
+ * \return true if the file is a valid file of the current version.
+ */
+bool
+BinaryGeometryFile::validate() const{
+
+    const Header & header = getHeader();
+    if(std::memcmp(header.magic, BINARYGEOMETRY_MAGIC, sizeof(BINARYGEOMETRY_MAGIC)) != 0)   return false;
+    if(header.version != VERSION)                       return false;
+    if(header.endianness != BINARYGEOMETRY_ENDIANNESS)  return false;
+
+    for(int i=0; i<NSECTIONS; ++i){
+        std::size_t size;
+        if(!sectionSize(header, Section(i), size))          return false;
+        uint64_t offset = header.offsets[i];
+        if(offset % ALIGNMENT != 0)                         return false;
+        if(offset > m_size || size > m_size - offset)       return false;
+    }
+    if(header.nVertices > uint64_t(std::numeric_limits<long>::max()) || header.nCells > uint64_t(std::numeric_limits<long>::max())){
+        return false;
+    }
+
+    //connectivity offsets must be non decreasing and bounded by the connectivity section.
+    const uint64_t * offsets = getConnectivityOffsets();
+    if(offsets[0] != 0 || offsets[header.nCells] != header.nConnectivity)  return false;
+    for(uint64_t i=0; i<header.nCells; ++i){
+        if(offsets[i] > offsets[i+1])   return false;
+    }
+
+    //skdTree nodes must refer to existing nodes and cells.
+    const SkdNode * nodes = getSkdNodes();
+    for(uint64_t i=0; i<header.nSkdNodes; ++i){
+        if(nodes[i].cellBegin > nodes[i].cellEnd || nodes[i].cellEnd > header.nCells)  return false;
+        for(int j=0; j<2; ++j){
+            if(nodes[i].children[j] < -1 || nodes[i].children[j] >= int64_t(header.nSkdNodes))  return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * Write a geometry in the native binary format.
+ * \param[in] geometry target geometry
+ * \param[in] filename path of the file
+ * \param[in] skdTree if true, store the skdTree section too. The skdTree of the geometry
+ * is built if not synchronized; the section is skipped if the geometry does not support it.
+ * \return false if the geometry is empty or the file cannot be written.
+ */
+bool
+BinaryGeometryFile::write(MimmoObject & geometry, const std::string & filename, bool skdTree){
+
+    if(geometry.isEmpty())  return false;
+
+    long nCells = geometry.getNCells();
+    skdTree = skdTree && (nCells > 0) && geometry.isSkdTreeSupported();
+
+    //cell order: leaf order of the skdTree, if stored, order of the cell container otherwise.
+    livector1D cellOrder;
+    std::vector<SkdNode> nodes;
+    if(skdTree){
+        bitpit::PatchSkdTree * tree = geometry.getSkdTree();
+        nodes.resize(tree->getNodeCount());
+        cellOrder.reserve(nCells);
+
+        //depth-first visit, the cells of each node are contiguous in leaf order.
+        std::vector<std::pair<std::size_t, bool> > stack;
+        if(!nodes.empty())  stack.push_back(std::make_pair(std::size_t(0), false));
+        while(!stack.empty()){
+            std::size_t nodeId = stack.back().first;
+            bool closing = stack.back().second;
+            stack.pop_back();
+            SkdNode & stored = nodes[nodeId];
+            if(closing){
+                stored.cellEnd = cellOrder.size();
+                continue;
+            }
+            const bitpit::SkdNode & node = tree->getNode(nodeId);
+            for(int j=0; j<3; ++j){
+                stored.boxMin[j] = node.getBoxMin()[j];
+                stored.boxMax[j] = node.getBoxMax()[j];
+            }
+            stored.cellBegin = cellOrder.size();
+            int nChildren = 0;
+            for (int i = bitpit::SkdNode::CHILD_BEGIN; i != bitpit::SkdNode::CHILD_END; ++i){
+                std::size_t childId = node.getChildId(static_cast<bitpit::SkdNode::ChildLocation>(i));
+                stored.children[nChildren++] = (childId == bitpit::SkdNode::NULL_ID) ? -1 : int64_t(childId);
+            }
+            if(node.isLeaf()){
+                for(long cellId : node.getCells())  cellOrder.push_back(cellId);
+                stored.cellEnd = cellOrder.size();
+                continue;
+            }
+            stack.push_back(std::make_pair(nodeId, true));
+            for(int i=nChildren-1; i>=0; --i){
+                if(stored.children[i] >= 0) stack.push_back(std::make_pair(std::size_t(stored.children[i]), false));
+            }
+        }
+
+        //a tree not covering all the cells is not stored.
+        if(long(cellOrder.size()) != nCells){
+            skdTree = false;
+            nodes.clear();
+            cellOrder.clear();
+        }
+    }
+    if(!skdTree && nCells > 0){
+        cellOrder = geometry.getCells().getIds(false);
+    }
+
+    //header
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, BINARYGEOMETRY_MAGIC, sizeof(BINARYGEOMETRY_MAGIC));
+    header.version = VERSION;
+    header.endianness = BINARYGEOMETRY_ENDIANNESS;
+    header.type = geometry.getType();
+    header.nVertices = geometry.getNVertex();
+    header.nCells = nCells;
+    header.nConnectivity = 0;
+    for(long cellId : cellOrder){
+        header.nConnectivity += geometry.getCells()[cellId].getConnectSize();
+    }
+
+    std::map<long, std::string> pidNames;
+    if(nCells > 0){
+        for(long pid : geometry.getPIDTypeList()) pidNames[pid] = "";
+        for(const auto & touple : geometry.getPIDTypeListWNames()){
+            if(pidNames.count(touple.first) > 0)    pidNames[touple.first] = touple.second;
+        }
+    }
+    header.nPIDs = pidNames.size();
+    header.nPIDNames = 0;
+    for(const auto & touple : pidNames) header.nPIDNames += touple.second.size() + 1;
+    header.nSkdNodes = nodes.size();
+
+    std::size_t offset = alignedSize(sizeof(Header));
+    for(int i=0; i<NSECTIONS; ++i){
+        header.offsets[i] = offset;
+        offset += alignedSize(sectionSize(header, Section(i)));
+    }
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!out.is_open())  return false;
+
+    //sections are written one at a time, padded to alignment.
+    const char padding[ALIGNMENT] = {};
+    auto writeBlock = [&out, &padding](const void * data, std::size_t size){
+        if(size > 0)    out.write(static_cast<const char *>(data), size);
+        std::size_t pad = alignedSize(size) - size;
+        if(pad > 0)     out.write(padding, pad);
+    };
+
+    writeBlock(&header, sizeof(Header));
+    {
+        std::vector<double> coords;
+        coords.reserve(3*header.nVertices);
+        std::vector<int64_t> ids;
+        ids.reserve(header.nVertices);
+        for(const bitpit::Vertex & vertex : geometry.getVertices()){
+            const darray3E & point = vertex.getCoords();
+            coords.insert(coords.end(), point.begin(), point.end());
+            ids.push_back(vertex.getId());
+        }
+        writeBlock(coords.data(), sectionSize(header, COORDS));
+        writeBlock(ids.data(), sectionSize(header, VERTEXIDS));
+    }
+    {
+        bitpit::PiercedVector<bitpit::Cell> & cells = geometry.getCells();
+        std::vector<int64_t> ids(cellOrder.begin(), cellOrder.end());
+        writeBlock(ids.data(), sectionSize(header, CELLIDS));
+
+        std::vector<int32_t> types(nCells);
+        std::vector<int64_t> pids(nCells);
+        std::vector<uint64_t> offsets(nCells+1, 0);
+        for(long i=0; i<nCells; ++i){
+            const bitpit::Cell & cell = cells[cellOrder[i]];
+            types[i] = int32_t(cell.getType());
+            pids[i] = cell.getPID();
+            offsets[i+1] = offsets[i] + cell.getConnectSize();
+        }
+        writeBlock(types.data(), sectionSize(header, CELLTYPES));
+        writeBlock(pids.data(), sectionSize(header, CELLPIDS));
+        writeBlock(offsets.data(), sectionSize(header, CONNOFFSETS));
+    }
+    {
+        bitpit::PiercedVector<bitpit::Cell> & cells = geometry.getCells();
+        std::vector<int64_t> connectivity;
+        connectivity.reserve(header.nConnectivity);
+        for(long cellId : cellOrder){
+            const bitpit::Cell & cell = cells[cellId];
+            const long * conn = cell.getConnect();
+            connectivity.insert(connectivity.end(), conn, conn + cell.getConnectSize());
+        }
+        writeBlock(connectivity.data(), sectionSize(header, CONNECTIVITY));
+    }
+    {
+        std::vector<int64_t> pids;
+        std::string names;
+        for(const auto & touple : pidNames){
+            pids.push_back(touple.first);
+            names += touple.second;
+            names.push_back('\0');
+        }
+        writeBlock(pids.data(), sectionSize(header, PIDS));
+        writeBlock(names.data(), sectionSize(header, PIDNAMES));
+    }
+    writeBlock(nodes.data(), sectionSize(header, SKDNODES));
+
+    out.close();
+    return !out.fail();
+}
+
+}
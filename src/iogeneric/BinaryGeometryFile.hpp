@@ -0,0 +1,161 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __BINARYGEOMETRYFILE_HPP__
+#define __BINARYGEOMETRYFILE_HPP__
+
+#include "MimmoObject.hpp"
+#include <cstdint>
+
+namespace mimmo{
+
+/*!
+ * \class BinaryGeometryFile
+ * \ingroup iogeneric
+ * \brief BinaryGeometryFile handles the native binary geometry format of mimmo *.binmimmo.
+ *
+ * The format is designed to be memory-mapped: a fixed size header is followed by
+ * contiguous sections, each one aligned to BinaryGeometryFile::ALIGNMENT bytes and
+ * stored with the native byte order of the writing machine:
+ * - vertex coordinates, 3 doubles per vertex;
+ * - vertex ids, i.e. the map from compact vertex index to vertex unique-id;
+ * - cell ids, types and PIDs;
+ * - cell connectivity, in the CSR layout of offsets and vertex unique-ids
+ *   (polygons and polyhedra keep the special connectivity of MimmoObject::getConnectivity);
+ * - PIDs with their names;
+ * - an optional skdTree section, i.e. the nodes of the cell skdTree of the geometry,
+ *   with bounding boxes, children and range of their cells. When present, cells are
+ *   stored in the leaf order of the tree, so that the cells of each node are contiguous.
+ *
+ * Sections are accessed in place by pointers into the mapped file, with no parsing and
+ * no intermediate buffer. Opening a file validates its header, the extent of the sections,
+ * the connectivity offsets and the skdTree nodes, with all counts checked against overflow.
+ * A MimmoObject is then filled in a single sequential pass on the sections (see materialize).
+ * Cells are stored for every geometry type.
+ */
+class BinaryGeometryFile{
+
+public:
+    static const uint32_t       VERSION   = 1;   /**< current version of the format */
+    static const std::size_t    ALIGNMENT = 64;  /**< alignment in bytes of the sections */
+
+    /*!
+     * \enum Section
+     * Sections of the file, in order of storage.
+     */
+    enum Section{
+        COORDS = 0,         /**< vertex coordinates */
+        VERTEXIDS = 1,      /**< vertex unique-ids */
+        CELLIDS = 2,        /**< cell unique-ids */
+        CELLTYPES = 3,      /**< cell bitpit::ElementType */
+        CELLPIDS = 4,       /**< cell PIDs */
+        CONNOFFSETS = 5,    /**< offsets of cell connectivity */
+        CONNECTIVITY = 6,   /**< cell connectivity */
+        PIDS = 7,           /**< PIDs of the geometry */
+        PIDNAMES = 8,       /**< names of PIDs, null-terminated and concatenated */
+        SKDNODES = 9,       /**< skdTree nodes */
+        NSECTIONS = 10      /**< number of sections */
+    };
+
+    /*!
+     * \struct Header
+     * Header of the file.
+     */
+    struct Header{
+        char        magic[8];               /**< format identifier "MIMMOBIN" */
+        uint32_t    version;                /**< version of the format */
+        uint32_t    endianness;             /**< byte order check, 0x01020304 written in native order */
+        int32_t     type;                   /**< MimmoObject type of the geometry */
+        int32_t     reserved;               /**< unused, padding */
+        uint64_t    nVertices;              /**< number of vertices */
+        uint64_t    nCells;                 /**< number of cells */
+        uint64_t    nConnectivity;          /**< size of connectivity section */
+        uint64_t    nPIDs;                  /**< number of PIDs */
+        uint64_t    nPIDNames;              /**< size in bytes of PID names section */
+        uint64_t    nSkdNodes;              /**< number of skdTree nodes, 0 if section is absent */
+        uint64_t    offsets[NSECTIONS];     /**< offset in bytes of each section from the begin of file */
+    };
+
+    /*!
+     * \struct SkdNode
+     * Node of the stored skdTree.
+     */
+    struct SkdNode{
+        double      boxMin[3];      /**< minimum point of node bounding box */
+        double      boxMax[3];      /**< maximum point of node bounding box */
+        int64_t     children[2];    /**< index of children nodes, -1 if absent */
+        uint64_t    cellBegin;      /**< first cell of the node in the cell sections */
+        uint64_t    cellEnd;        /**< past-the-last cell of the node in the cell sections */
+    };
+
+private:
+    void *          m_data;     /**< begin of the mapped file */
+    std::size_t     m_size;     /**< size of the mapped file */
+
+public:
+    BinaryGeometryFile();
+    ~BinaryGeometryFile();
+
+    BinaryGeometryFile(const BinaryGeometryFile & other) = delete;
+    BinaryGeometryFile & operator=(const BinaryGeometryFile & other) = delete;
+
+    bool            open(const std::string & filename);
+    void            close();
+    bool            isOpen() const;
+
+    const Header &  getHeader() const;
+    int             getType() const;
+    long            getNVertex() const;
+    long            getNCells() const;
+    bool            hasSkdTree() const;
+
+    const double *  getCoords() const;
+    const int64_t * getVertexIds() const;
+    const int64_t * getCellIds() const;
+    const int32_t * getCellTypes() const;
+    const int64_t * getCellPIDs() const;
+    const uint64_t* getConnectivityOffsets() const;
+    const int64_t * getConnectivity() const;
+    const SkdNode * getSkdNodes() const;
+    std::unordered_map<long, std::string>   getPIDNames() const;
+
+    void            materialize(MimmoObject & geometry) const;
+
+    static bool     write(MimmoObject & geometry, const std::string & filename, bool skdTree = false);
+
+private:
+    /*!
+     * \return pointer to the begin of a section of the mapped file.
+     * \param[in] section target section
+     */
+    template<typename T>
+    const T *       getSection(Section section) const{
+        return reinterpret_cast<const T *>(static_cast<const char *>(m_data) + getHeader().offsets[section]);
+    }
+
+    bool            validate() const;
+};
+
+}
+
+#endif /* __BINARYGEOMETRYFILE_HPP__ */
@@ -235,7 +235,7 @@ void
 GenericDispls::setDispl(dvecarr3E displs){
     if(m_read) return;
     m_displ.clear();
-    m_displ = displs;
+    m_displ = std::move(displs);
     m_nDispl = m_displ.size();
 };
 
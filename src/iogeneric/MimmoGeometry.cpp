@@ -22,6 +22,8 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "MimmoGeometry.hpp"
+#include "BinaryGeometryFile.hpp"
+#include "StlInterface.hpp"
 #include "customOperators.hpp"
 #include "VTUGridReader.hpp"
 #include <iostream>
@@ -632,14 +634,9 @@ MimmoGeometry::write(){
     case FileType::STL :
         //Export STL
     {
-        auto pidsMap = getGeometry()->getPIDTypeListWNames();
-        std::unordered_map<int, std::string> mpp;
-        for(const auto & touple : pidsMap){
-            mpp[touple.first] = touple.second;
-        }
         string name = (m_winfo.fdir+"/"+m_winfo.fname+".stl");
-        dynamic_cast<SurfUnstructured*>(getGeometry()->getPatch())->exportSTL(name, m_codex, m_multiSolidSTL, false, &mpp);
-        return true;
+        StlInterface stl;
+        return stl.write(name, *(getGeometry()), m_codex, m_multiSolidSTL);
     }
     break;
 
@@ -723,6 +720,15 @@ MimmoGeometry::write(){
     }
     break;
 
+    case FileType::MIMMOBIN :
+        //Export in mimmo native binary format
+    {
+        string name = (m_winfo.fdir+"/"+m_winfo.fname+".binmimmo");
+        bool skdTree = m_buildSkdTree && getGeometry()->isSkdTreeSupported();
+        return BinaryGeometryFile::write(*getGeometry(), name, skdTree);
+    }
+    break;
+
     default: //never been reached
         break;
     }
@@ -744,46 +750,19 @@ MimmoGeometry::read(){
     //Import STL
     case FileType::STL :
     {
-        setGeometry(1);
-        string name;
-
+        string name = m_rinfo.fdir+"/"+m_rinfo.fname+".stl";
         {
-            std::ifstream infile(m_rinfo.fdir+"/"+m_rinfo.fname+".stl");
-            bool check = infile.good();
-            name = m_rinfo.fdir+"/"+m_rinfo.fname+".stl";
-            if (!check){
-                infile.open(m_rinfo.fdir+m_rinfo.fname+".STL");
-                check = infile.good();
+            std::ifstream infile(name);
+            if (!infile.good()){
                 name = m_rinfo.fdir+"/"+m_rinfo.fname+".STL";
-                if (!check) return false;
+                infile.open(name);
+                if (!infile.good()) return false;
             }
         }
 
-        ifstream in(name);
-        string    ss, sstype;
-        getline(in,ss);
-        stringstream ins;
-        ins << ss;
-        ins >> sstype;
-        bool binary = true;
-        if (sstype == "solid" || sstype == "SOLID") binary = false;
-        in.close();
-
-        std::unordered_map<int,std::string> mapPIDSolid;
-        dynamic_cast<SurfUnstructured*>(getGeometry()->getPatch())->importSTL(name, binary, 0, false, &mapPIDSolid);
-
-        getGeometry()->cleanGeometry();
-
-        //count PID if multi-solid
-        auto & mapset = getGeometry()->getPIDTypeList();
-        for(const auto & cell : getGeometry()->getCells() ){
-            mapset.insert(cell.getPID());
-        }
-        std::unordered_map<long, std::string> & mapWNames = getGeometry()->getPIDTypeListWNames();
-        for(const auto & val :mapset ){
-            mapWNames[val] = mapPIDSolid[val];
-        }
-
+        setGeometry(1);
+        StlInterface stl;
+        if (!stl.read(name, *(getGeometry()))) return false;
     }
     break;
 
@@ -939,6 +918,16 @@ MimmoGeometry::read(){
     }
     break;
 
+    case FileType::MIMMOBIN :
+        //Import in mimmo native binary format
+    {
+        BinaryGeometryFile file;
+        if(!file.open(m_rinfo.fdir+"/"+m_rinfo.fname+".binmimmo"))  return false;
+        setGeometry(file.getType());
+        file.materialize(*(getGeometry()));
+    }
+    break;
+
     default: //never been reached
         break;
 
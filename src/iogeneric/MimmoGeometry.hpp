@@ -28,7 +28,7 @@
 #include "MimmoNamespace.hpp"
 #include "enum.hpp"
 
-BETTER_ENUM(FileType, int, STL = 0, SURFVTU = 1, VOLVTU = 2, NAS = 3, OFP = 4, PCVTU = 5, CURVEVTU = 6, MIMMO = 99);
+BETTER_ENUM(FileType, int, STL = 0, SURFVTU = 1, VOLVTU = 2, NAS = 3, OFP = 4, PCVTU = 5, CURVEVTU = 6, MIMMO = 99, MIMMOBIN = 100);
 BETTER_ENUM(IOMode, int, READ = 0, WRITE = 1, CONVERT = 2);
 
 namespace mimmo{
@@ -75,6 +75,8 @@ enum WFORMAT{    /*!Single precision data.*/        Short,
  * - <B>PCVTU   = 5</B> Point Cloud VTU, of only VERTEX elements
  * - <B>CURVEVTU= 6</B> 3D Curve in VTU, of only LINE elements
  * - <B>MIMMO   = 99</B> mimmo dump/restore format *.geomimmo
+ * - <B>MIMMOBIN= 100</B> mimmo native binary format *.binmimmo, memory-mapped on reading (see BinaryGeometryFile).
+ *                     If SkdTree building is active, the skdTree is stored too on writing.
  *
  * Outside this list of options, the class cannot hold any other type of formats for now.
  * The smart enum can be recalled in every moment in your code, just using <tt>mimmo::FileType</tt>
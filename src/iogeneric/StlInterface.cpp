@@ -0,0 +1,532 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#include "StlInterface.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <strings.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mimmo{
+
+/*!
+ * \return true if the character is a blank one.
+ * \param[in] c character
+ */
+static inline bool isBlank(char c){
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+/*!
+ * Check if a keyword (case insensitive) starts at a given position of an ascii STL as first token of its line,
+ * and it is followed by a blank or by the end of file.
+ * \param[in] data begin of file
+ * \param[in] size size of file
+ * \param[in] pos position of the candidate keyword
+ * \param[in] keyword keyword
+ * \param[in] length length of the keyword
+ * \return true if the keyword is found
+ */
+static bool isKeyword(const char * data, std::size_t size, std::size_t pos, const char * keyword, std::size_t length){
+    if(pos + length > size || strncasecmp(data + pos, keyword, length) != 0)  return false;
+    if(pos + length < size && !isBlank(data[pos+length]))   return false;
+    std::size_t i = pos;
+    while(i > 0 && (data[i-1] == ' ' || data[i-1] == '\t' || data[i-1] == '\r'))   --i;
+    return (i == 0 || data[i-1] == '\n');
+}
+
+/*!
+ * Find the next token of an ascii STL, case insensitive.
+ * \param[in] data begin of file
+ * \param[in] size size of file
+ * \param[in] from starting position of the search
+ * \param[in] token token
+ * \param[in] length length of the token
+ * \return position of the token, size if not found
+ */
+static std::size_t findToken(const char * data, std::size_t size, std::size_t from, const char * token, std::size_t length){
+    for(; from + length <= size; ++from){
+        if(std::tolower(static_cast<unsigned char>(data[from])) == token[0] && strncasecmp(data + from, token, length) == 0)   return from;
+    }
+    return size;
+}
+
+/*!
+ * Parse a floating point number of an ascii STL.
+ * \param[in] data begin of file
+ * \param[in] size size of file
+ * \param[in,out] pos position where the parsing starts, moved past the number
+ * \param[out] value parsed value
+ * \return false if no number is found
+ */
+static bool parseNumber(const char * data, std::size_t size, std::size_t & pos, double & value){
+    while(pos < size && isBlank(data[pos]))  ++pos;
+    char buffer[64];
+    std::size_t length = 0;
+    while(pos < size && length < sizeof(buffer)-1 && !isBlank(data[pos])){
+        buffer[length++] = data[pos++];
+    }
+    if(length == 0) return false;
+    buffer[length] = '\0';
+    char * end;
+    value = std::strtod(buffer, &end);
+    return (end != buffer);
+}
+
+/*!
+ * \return hash of point coordinates, coherent with their equality.
+ * \param[in] point coordinates
+ */
+static uint64_t hashPoint(const darray3E & point){
+    uint64_t hash = 0;
+    for(int j=0; j<3; ++j){
+        //adding zero maps -0.0 to 0.0
+        double value = point[j] + 0.0;
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash ^= bits + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+/*!
+ * Evaluate the unit normal of a triangle.
+ * \param[in] a first vertex
+ * \param[in] b second vertex
+ * \param[in] c third vertex
+ * \return unit normal, null for degenerate triangles
+ */
+static darray3E triangleNormal(const darray3E & a, const darray3E & b, const darray3E & c){
+    darray3E u, v, n;
+    for(int j=0; j<3; ++j){
+        u[j] = b[j] - a[j];
+        v[j] = c[j] - a[j];
+    }
+    n[0] = u[1]*v[2] - u[2]*v[1];
+    n[1] = u[2]*v[0] - u[0]*v[2];
+    n[2] = u[0]*v[1] - u[1]*v[0];
+    double length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+    if(length > 0.0){
+        for(int j=0; j<3; ++j)  n[j] /= length;
+    }
+    return n;
+}
+
+/*!
+ * Read an ascii/binary STL file and fill a surface geometry with its triangles.
+ * Vertices and cells are numbered from 0; cells follow the order of facets in the file.
+ * \param[in] filename path of the file
+ * \param[in,out] geometry empty surface geometry to fill
+ * \return false if the file cannot be mapped or it contains no facet.
+ */
+bool
+StlInterface::read(const std::string & filename, MimmoObject & geometry){
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)  return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0){
+        ::close(fd);
+        return false;
+    }
+    std::size_t size = std::size_t(info.st_size);
+    void * mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED)    return false;
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    const char * data = static_cast<const char *>(mapped);
+
+    //binary file size is fixed by its number of facets. A binary header may start with "solid"
+    //as an ascii file: in that case the file is ascii if it is closed by an endsolid keyword.
+    bool binary = false;
+    if(size >= 84){
+        uint32_t nFacets;
+        std::memcpy(&nFacets, data + 80, sizeof(nFacets));
+        binary = (84 + 50*uint64_t(nFacets) == uint64_t(size));
+    }
+    if(binary){
+        std::size_t first = 0;
+        while(first < size && isBlank(data[first]))  ++first;
+        if(isKeyword(data, size, first, "solid", 5)){
+            std::size_t tail = (size > 1024) ? size - 1024 : 0;
+            binary = (findToken(data, size, tail, "endsolid", 8) == size);
+        }
+    }
+
+    std::vector<Facet> facets;
+    std::vector<std::string> solids;
+    try{
+        if(binary)  readBinary(data, size, facets);
+        else        readAscii(data, size, facets, solids);
+    }catch(...){
+        munmap(mapped, size);
+        throw;
+    }
+    munmap(mapped, size);
+    if(facets.empty())  return false;
+    if(solids.empty())  solids.push_back("");
+
+    livector1D pointVertex;
+    std::vector<long> vertexPoint;
+    weld(facets, pointVertex, vertexPoint);
+
+    bitpit::PatchKernel * patch = geometry.getPatch();
+    long nVertices = vertexPoint.size();
+    patch->reserveVertices(nVertices);
+    for(long i=0; i<nVertices; ++i){
+        long point = vertexPoint[i];
+        geometry.addVertex(facets[point/3].vertex[point%3], i);
+    }
+
+    long nFacets = facets.size();
+    patch->reserveCells(nFacets);
+    livector1D conn(3);
+    for(long i=0; i<nFacets; ++i){
+        for(int k=0; k<3; ++k)  conn[k] = pointVertex[3*i+k];
+        geometry.addConnectedCell(conn, bitpit::ElementType::TRIANGLE, facets[i].solid, i);
+    }
+
+    for(std::size_t i=0; i<solids.size(); ++i){
+        geometry.setPIDName(long(i), solids[i]);
+    }
+    return true;
+}
+
+/*!
+ * Parse the facets of a binary STL file, in parallel.
+ * \param[in] data begin of file
+ * \param[in] size size of file
+ * \param[out] facets parsed facets
+ */
+void
+StlInterface::readBinary(const char * data, std::size_t size, std::vector<Facet> & facets){
+
+    BITPIT_UNUSED(size);
+    uint32_t nFacets;
+    std::memcpy(&nFacets, data + 80, sizeof(nFacets));
+    facets.resize(nFacets);
+
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<long(nFacets); ++i){
+        //skip the normal, vertices follow as 9 floats.
+        float values[9];
+        std::memcpy(values, data + 84 + 50*std::size_t(i) + 12, sizeof(values));
+        for(int k=0; k<3; ++k){
+            facets[i].vertex[k] = {{double(values[3*k]), double(values[3*k+1]), double(values[3*k+2])}};
+        }
+        facets[i].solid = 0;
+    }
+}
+
+/*!
+ * Parse the facets of an ascii STL file. The file is split in chunks of fixed size,
+ * parsed in parallel: each chunk owns the facets and solids whose keyword starts in it.
+ * Facets are then assigned to the last solid opened before them.
+ * \param[in] data begin of file
+ * \param[in] size size of file
+ * \param[out] facets parsed facets
+ * \param[out] solids names of solids, in order of appearance
+ */
+void
+StlInterface::readAscii(const char * data, std::size_t size, std::vector<Facet> & facets, std::vector<std::string> & solids){
+
+    const std::size_t chunkSize = std::size_t(1) << 22;
+    long nChunks = long((size + chunkSize - 1) / chunkSize);
+
+    std::vector<std::vector<Facet> > chunkFacets(nChunks);
+    std::vector<std::vector<std::size_t> > chunkFacetsPos(nChunks);
+    std::vector<std::vector<std::pair<std::size_t, std::string> > > chunkSolids(nChunks);
+    bool failed = false;
+
+#pragma omp parallel for schedule(dynamic)
+    for(long c=0; c<nChunks; ++c){
+        std::size_t pos = std::size_t(c)*chunkSize;
+        std::size_t end = std::min(size, pos + chunkSize);
+        while(pos < end){
+            //next facet or solid keyword starting in the chunk
+            std::size_t next = end;
+            for(std::size_t i=pos; i<end; ++i){
+                char ch = char(std::tolower(static_cast<unsigned char>(data[i])));
+                if((ch == 'f' && isKeyword(data, size, i, "facet", 5)) ||
+                   (ch == 's' && isKeyword(data, size, i, "solid", 5))){
+                    next = i;
+                    break;
+                }
+            }
+            if(next >= end) break;
+
+            if(std::tolower(static_cast<unsigned char>(data[next])) == 's'){
+                std::size_t first = next + 5;
+                std::size_t last = first;
+                while(last < size && data[last] != '\n')    ++last;
+                pos = last;
+                while(first < last && isBlank(data[first]))     ++first;
+                while(last > first && isBlank(data[last-1]))    --last;
+                chunkSolids[c].push_back(std::make_pair(next, std::string(data + first, last - first)));
+                continue;
+            }
+
+            Facet facet;
+            facet.solid = 0;
+            std::size_t p = next + 5;
+            bool ok = true;
+            for(int k=0; k<3 && ok; ++k){
+                p = findToken(data, size, p, "vertex", 6);
+                ok = (p < size);
+                p += 6;
+                for(int j=0; j<3 && ok; ++j){
+                    ok = parseNumber(data, size, p, facet.vertex[k][j]);
+                }
+            }
+            if(!ok){
+#pragma omp critical
+                failed = true;
+                break;
+            }
+            chunkFacets[c].push_back(facet);
+            chunkFacetsPos[c].push_back(next);
+            pos = p;
+        }
+    }
+
+    if(failed){
+        throw std::runtime_error("StlInterface : malformed facet in ascii STL file");
+    }
+
+    std::size_t nFacets = 0;
+    for(const auto & chunk : chunkFacets)   nFacets += chunk.size();
+    facets.clear();
+    facets.reserve(nFacets);
+
+    std::vector<std::size_t> solidsPos;
+    solids.clear();
+    for(const auto & chunk : chunkSolids){
+        for(const auto & solid : chunk){
+            solidsPos.push_back(solid.first);
+            solids.push_back(solid.second);
+        }
+    }
+
+    //chunks are in file order: facets take the index of the last solid opened before them.
+    long solid = -1;
+    for(long c=0; c<nChunks; ++c){
+        for(std::size_t i=0; i<chunkFacets[c].size(); ++i){
+            while(solid+1 < long(solidsPos.size()) && solidsPos[solid+1] < chunkFacetsPos[c][i])  ++solid;
+            facets.push_back(chunkFacets[c][i]);
+            facets.back().solid = std::max(solid, long(0));
+        }
+        std::vector<Facet>().swap(chunkFacets[c]);
+    }
+}
+
+/*!
+ * Weld coincident facet vertices. Points (the 3 vertices of each facet, in facet order) are
+ * partitioned in buckets by the hash of their coordinates; buckets are processed in parallel,
+ * each point being matched with the first point of its bucket with the same coordinates.
+ * Vertices are then numbered in order of first appearance of their points.
+ *
+ * The weld is exact: points are merged only if their coordinates are bitwise equal (-0.0 and 0.0
+ * apart), with no tolerance. STL files repeat a shared vertex with the same value in each facet,
+ * so this merges the same vertices of a tolerance based weld; nearly coincident vertices of
+ * different value are kept apart, and can be merged afterwards with MimmoObject::cleanGeometry.
+ * \param[in] facets parsed facets
+ * \param[out] pointVertex vertex of each point
+ * \param[out] vertexPoint first point of each vertex
+ */
+void
+StlInterface::weld(const std::vector<Facet> & facets, livector1D & pointVertex, std::vector<long> & vertexPoint){
+
+    long nPoints = 3*long(facets.size());
+    auto point = [&facets](long i) -> const darray3E & {
+        return facets[i/3].vertex[i%3];
+    };
+
+    std::vector<uint64_t> hashes(nPoints);
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<nPoints; ++i){
+        hashes[i] = hashPoint(point(i));
+    }
+
+    //bucket lists, sorted by point index
+    const long nBuckets = 1024;
+    std::vector<long> bucketOffsets(nBuckets+1, 0);
+    for(long i=0; i<nPoints; ++i){
+        ++bucketOffsets[hashes[i] % nBuckets + 1];
+    }
+    for(long b=0; b<nBuckets; ++b){
+        bucketOffsets[b+1] += bucketOffsets[b];
+    }
+    std::vector<long> bucketPoints(nPoints);
+    {
+        std::vector<long> fill(bucketOffsets.begin(), bucketOffsets.end()-1);
+        for(long i=0; i<nPoints; ++i){
+            bucketPoints[fill[hashes[i] % nBuckets]++] = i;
+        }
+    }
+
+    std::vector<long> representative(nPoints);
+#pragma omp parallel for schedule(dynamic)
+    for(long b=0; b<nBuckets; ++b){
+        std::unordered_multimap<uint64_t, long> found;
+        found.reserve(bucketOffsets[b+1] - bucketOffsets[b]);
+        for(long k=bucketOffsets[b]; k<bucketOffsets[b+1]; ++k){
+            long i = bucketPoints[k];
+            representative[i] = i;
+            auto range = found.equal_range(hashes[i]);
+            for(auto it = range.first; it != range.second; ++it){
+                if(point(it->second) == point(i)){
+                    representative[i] = it->second;
+                    break;
+                }
+            }
+            if(representative[i] == i)  found.insert(std::make_pair(hashes[i], i));
+        }
+    }
+
+    //representatives precede their points
+    pointVertex.resize(nPoints);
+    vertexPoint.clear();
+    for(long i=0; i<nPoints; ++i){
+        if(representative[i] == i){
+            pointVertex[i] = vertexPoint.size();
+            vertexPoint.push_back(i);
+        }else{
+            pointVertex[i] = pointVertex[representative[i]];
+        }
+    }
+}
+
+/*!
+ * Write a surface geometry as STL file, streaming its cells. Cells of more than three vertices
+ * are split in triangle fans.
+ * \param[in] filename path of the file
+ * \param[in] geometry surface geometry
+ * \param[in] binary true for binary format, false for ascii
+ * \param[in] multiSolid if true and format is ascii, write one solid for each PID, named as the PID
+ * \return false if the geometry is empty or the file cannot be written.
+ */
+bool
+StlInterface::write(const std::string & filename, MimmoObject & geometry, bool binary, bool multiSolid){
+
+    if(geometry.isEmpty())  return false;
+
+    std::ofstream out(filename, binary ? (std::ios::out | std::ios::binary) : std::ios::out);
+    if(!out.is_open())  return false;
+
+    bitpit::PatchKernel * patch = geometry.getPatch();
+    const std::size_t bufferSize = std::size_t(1) << 20;
+    std::string buffer;
+    buffer.reserve(bufferSize + 1024);
+
+    //visit the triangles of the cells, optionally of a PID only.
+    auto visitTriangles = [patch](bool filter, long pid, const std::function<void(const darray3E &, const darray3E &, const darray3E &)> & visitor){
+        for(const bitpit::Cell & cell : patch->getCells()){
+            if(filter && cell.getPID() != pid)  continue;
+            auto vertexIds = cell.getVertexIds();
+            std::size_t nv = vertexIds.size();
+            if(nv < 3)  continue;
+            const darray3E & a = patch->getVertexCoords(vertexIds[0]);
+            for(std::size_t k=1; k+1<nv; ++k){
+                visitor(a, patch->getVertexCoords(vertexIds[k]), patch->getVertexCoords(vertexIds[k+1]));
+            }
+        }
+    };
+
+    if(binary){
+        uint32_t nTriangles = 0;
+        for(const bitpit::Cell & cell : patch->getCells()){
+            std::size_t nv = cell.getVertexIds().size();
+            if(nv >= 3) nTriangles += uint32_t(nv - 2);
+        }
+        char header[80] = {};
+        std::strncpy(header, "mimmo binary STL", sizeof(header)-1);
+        out.write(header, sizeof(header));
+        out.write(reinterpret_cast<const char *>(&nTriangles), sizeof(nTriangles));
+
+        visitTriangles(false, 0, [&](const darray3E & a, const darray3E & b, const darray3E & c){
+            darray3E n = triangleNormal(a, b, c);
+            float record[12];
+            for(int j=0; j<3; ++j){
+                record[j]   = float(n[j]);
+                record[3+j] = float(a[j]);
+                record[6+j] = float(b[j]);
+                record[9+j] = float(c[j]);
+            }
+            uint16_t attribute = 0;
+            buffer.append(reinterpret_cast<const char *>(record), sizeof(record));
+            buffer.append(reinterpret_cast<const char *>(&attribute), sizeof(attribute));
+            if(buffer.size() >= bufferSize){
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        });
+    }else{
+        char line[256];
+        auto writeFacet = [&](const darray3E & a, const darray3E & b, const darray3E & c){
+            darray3E n = triangleNormal(a, b, c);
+            std::snprintf(line, sizeof(line), "  facet normal %.16e %.16e %.16e\n    outer loop\n", n[0], n[1], n[2]);
+            buffer += line;
+            for(const darray3E * v : {&a, &b, &c}){
+                std::snprintf(line, sizeof(line), "      vertex %.16e %.16e %.16e\n", (*v)[0], (*v)[1], (*v)[2]);
+                buffer += line;
+            }
+            buffer += "    endloop\n  endfacet\n";
+            if(buffer.size() >= bufferSize){
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        };
+
+        if(multiSolid){
+            std::set<long> pids(geometry.getPIDTypeList().begin(), geometry.getPIDTypeList().end());
+            std::unordered_map<long, std::string> & names = geometry.getPIDTypeListWNames();
+            for(long pid : pids){
+                std::string name = names.count(pid) > 0 ? names[pid] : "";
+                buffer += "solid " + name + "\n";
+                visitTriangles(true, pid, writeFacet);
+                buffer += "endsolid " + name + "\n";
+            }
+        }else{
+            buffer += "solid\n";
+            visitTriangles(false, 0, writeFacet);
+            buffer += "endsolid\n";
+        }
+    }
+
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    return !out.fail();
+}
+
+}
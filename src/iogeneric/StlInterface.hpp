@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __STLINTERFACE_HPP__
+#define __STLINTERFACE_HPP__
+
+#include "MimmoObject.hpp"
+
+namespace mimmo{
+
+/*!
+ * \class StlInterface
+ * \ingroup iogeneric
+ * \brief StlInterface is an interface class for I/O handling of ascii/binary STL triangulations *.stl.
+ *
+ * Reading memory-maps the file and parses it in chunks, distributed among the available threads
+ * (if mimmo is compiled with OpenMP support). Binary files are recognized by their size; a file
+ * of matching size starting with "solid" is read as ascii if it ends with an endsolid keyword.
+ * Files with no facets are rejected.
+ * In ascii files each solid becomes a PID, numbered from 0 in order of appearance, named as the solid.
+ * Facet vertices with bitwise identical coordinates are welded by a parallel hash partition of the points,
+ * with no tolerance; vertices are numbered in order of first appearance, as in a serial weld.
+ *
+ * Writing streams facets straight from the geometry cells, computing their normals on the fly;
+ * quadrilaterals and polygons are written as triangle fans.
+ */
+class StlInterface{
+
+public:
+    bool    read(const std::string & filename, MimmoObject & geometry);
+    bool    write(const std::string & filename, MimmoObject & geometry, bool binary = true, bool multiSolid = false);
+
+private:
+    /*!
+     * \struct Facet
+     * Parsed facet.
+     */
+    struct Facet{
+        darray3E    vertex[3];  /**< facet vertices */
+        long        solid;      /**< solid index of the facet */
+    };
+
+    void    readBinary(const char * data, std::size_t size, std::vector<Facet> & facets);
+    void    readAscii(const char * data, std::size_t size, std::vector<Facet> & facets, std::vector<std::string> & solids);
+    void    weld(const std::vector<Facet> & facets, livector1D & pointVertex, std::vector<long> & vertexPoint);
+};
+
+}
+
+#endif /* __STLINTERFACE_HPP__ */
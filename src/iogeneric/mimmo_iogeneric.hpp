@@ -34,10 +34,12 @@
 
 #include "mimmo_core.hpp"
 
+#include "BinaryGeometryFile.hpp"
 #include "GenericDispls.hpp"
 #include "GenericInput.hpp"
 #include "GenericOutput.hpp"
 #include "IOCloudPoints.hpp"
 #include "MimmoGeometry.hpp"
+#include "StlInterface.hpp"
 
 #endif
@@ -97,7 +97,7 @@ Apply::buildPorts(){
  */
 void
 Apply::setInput(dmpvecarr3E input){
-	m_input = input;
+	m_input = std::move(input);
 };
 
 /*!It sets the displacements given as scalar input. It makes sense only for surface gemetries.
@@ -106,7 +106,7 @@ Apply::setInput(dmpvecarr3E input){
  */
 void
 Apply::setScalarInput(dmpvector1D input){
-	m_scalarinput = input;
+	m_scalarinput = std::move(input);
 };
 
 /*!It sets the displacements scalar factor.
@@ -135,14 +135,7 @@ Apply::execute(){
 
 	checkInput();
 
-	darray3E vertexcoords;
-	long int ID;
-	for (const auto & vertex : m_geometry->getVertices()){
-		vertexcoords = vertex.getCoords();
-		ID = vertex.getId();
-		vertexcoords += m_factor*m_input[ID];
-		getGeometry()->modifyVertex(vertexcoords, ID);
-	}
+	getGeometry()->applyDisplacements(m_input, m_factor);
 };
 
 
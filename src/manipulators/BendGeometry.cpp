@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "BendGeometry.hpp"
+#include "ManipulatorKernels.hpp"
 #include "customOperators.hpp"
 
 using namespace bitpit;
@@ -158,6 +159,15 @@ BendGeometry::getDisplacements(){
     return(m_displ);
 };
 
+/*!
+ * Return the filter field set to modulate the displacements of the vertices.
+ * \return filter field
+ */
+dmpvector1D
+BendGeometry::getFilter(){
+    return m_filter;
+};
+
 /*!It sets the degrees of polynomial law for each component of displacements of degrees of freedom.
  * \param[in] degree Degrees of polynomial laws (degree[i][j] = degree of displacement function si = f(xj)).
  */
@@ -225,7 +235,7 @@ BendGeometry::setRefSystem(dmatrix33E axes){
  */
 void
 BendGeometry::setFilter(dmpvector1D filter){
-    m_filter = filter;
+    m_filter = std::move(filter);
 }
 
 /*!Execution command. It computes the nodes displacements with the polynomial law by
@@ -256,33 +266,115 @@ BendGeometry::execute(){
     m_displ.reserve(getGeometry()->getNVertex());
     m_displ.setGeometry(getGeometry());
 
-    long ID;
-    darray3E value;
-    darray3E point, point0;
-    for (const auto & vertex : m_geometry->getVertices()){
-        point = vertex.getCoords();
-        if (m_local){
-            point0 = point;
-            point = toLocalCoord(point);
+    const CoordinatesView & coords = m_geometry->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices), displ(nVertices);
+    dvector1D filter(nVertices);
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+        filter[i] = m_filter[coords.ids[i]];
+    }
+    deformPoints(nVertices, points.data(), filter.data(), displ.data());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], displ[i]);
+    }
+};
+
+/*!
+ * Compute the bending displacements of a list of points.
+ * Used by execute and by FusedDeformation to evaluate the same deformation on given coordinates.
+ * Points are processed in blocks (see manipulatorKernels): polynomial laws are evaluated by Horner scheme
+ * and the local reference system, if any, is applied as a batch affine transformation.
+ * Coefficients missing for a degree are taken as zero.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ */
+void
+BendGeometry::deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ){
+
+    //coefficients padded to the degree of each law
+    dmat33Evec coeffs;
+    for (int j=0; j<3; j++){
+        for (int z=0; z<3; z++){
+            if (m_degree[j][z] == 0) continue;
+            coeffs[j][z].resize(m_degree[j][z]+1, 0.0);
+            for (std::size_t k=0; k<std::min(coeffs[j][z].size(), m_coeffs[j][z].size()); k++){
+                coeffs[j][z][k] = m_coeffs[j][z][k];
+            }
+        }
+    }
+
+    //matrices of local and global transformations
+    bool local = m_local;
+    dmatrix33E toLocal, toGlobal;
+    if (local){
+        dmatrix33E transp = linearalgebra::transpose(m_system);
+        for (int k=0; k<3; k++){
+            darray3E unit = {{0.0, 0.0, 0.0}};
+            unit[k] = 1.0;
+            darray3E colLocal, colGlobal;
+            linearalgebra::matmul(unit, transp, colLocal);
+            linearalgebra::matmul(unit, m_system, colGlobal);
+            for (int i=0; i<3; i++){
+                toLocal[i][k] = colLocal[i];
+                toGlobal[i][k] = colGlobal[i];
+            }
         }
-        ID = vertex.getId();
-        value.fill(0.0);
+    }
+
+    auto kernel = [&](manipulatorKernels::Block & block){
+        long size = block.size;
+        const double * f = block.filter;
+        double * coord[3] = {block.x, block.y, block.z};
+        double * value[3] = {block.dx, block.dy, block.dz};
+        double point0[3][manipulatorKernels::BLOCK_SIZE];
+
+        if (local){
+            for (int j=0; j<3; j++){
+                std::copy(coord[j], coord[j] + size, point0[j]);
+            }
+            manipulatorKernels::toFrame(block, toLocal, m_origin);
+        }
+
         for (int j=0; j<3; j++){
+            std::fill(value[j], value[j] + size, 0.0);
             for (int z=0; z<3; z++){
                 if (m_degree[j][z] > 0){
-                    for (int k=0; k<(int)m_degree[j][z]+1; k++){
-                        value[j] += pow(point[z],(double)k)*m_coeffs[j][z][k]*m_filter[ID];
-                    }
+                    manipulatorKernels::horner(size, coord[z], coeffs[j][z].data(), int(m_degree[j][z]), value[j]);
                 }
             }
+            double * val = value[j];
+#pragma omp simd
+            for (long i=0; i<size; ++i){
+                val[i] *= f[i];
+            }
         }
-        if (m_local){
-            point += value;
-            point = toGlobalCoord(point);
-            value = point - point0;
+
+        if (local){
+            for (int j=0; j<3; j++){
+                double * crd = coord[j];
+                const double * val = value[j];
+#pragma omp simd
+                for (long i=0; i<size; ++i){
+                    crd[i] += val[i];
+                }
+            }
+            manipulatorKernels::fromFrame(block, toGlobal, m_origin);
+            for (int j=0; j<3; j++){
+                const double * crd = coord[j];
+                const double * p0 = point0[j];
+                double * val = value[j];
+#pragma omp simd
+                for (long i=0; i<size; ++i){
+                    val[i] = crd[i] - p0[i];
+                }
+            }
         }
-        m_displ.insert(ID, value);
-    }
+    };
+    manipulatorKernels::forEachBlock(n, points, filter, displ, kernel);
 };
 
 /*!
@@ -293,14 +385,7 @@ BendGeometry::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_displ[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_displ);
 
 }
 
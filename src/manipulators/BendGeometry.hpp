@@ -131,6 +131,7 @@ public:
     umatrix33E    getDegree();
     dmat33Evec    getCoeffs();
     dmpvecarr3E    getDisplacements();
+    dmpvector1D    getFilter();
 
     void    setFilter(dmpvector1D filter);
     void    setOrigin(darray3E origin);
@@ -142,6 +143,7 @@ public:
 
     void     execute();
     void     apply();
+    void     deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ);
 
     //XML utilities from reading writing settings to file
     virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name="");
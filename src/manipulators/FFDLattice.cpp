@@ -25,19 +25,46 @@
 #include "FFDLattice.hpp"
 #include "Operators.hpp"
 #include "customOperators.hpp"
+#include <cstring>
+#include <fstream>
 
 
 using namespace std;
 namespace mimmo{
 
+/*! Magic string identifying weight matrix files */
+static const char FFDWEIGHTS_MAGIC[8] = {'M','I','M','M','O','F','F','D'};
+/*! Version of the weight matrix file layout */
+static const uint32_t FFDWEIGHTS_VERSION = 1;
+
+/*!
+ * Update a FNV-1a hash with a block of raw data.
+ * \param[in,out] hash  current hash value
+ * \param[in] data      pointer to data
+ * \param[in] bytes     size of data in bytes
+ */
+static void hashBytes(uint64_t & hash, const void * data, std::size_t bytes){
+    const unsigned char * ptr = static_cast<const unsigned char *>(data);
+    for(std::size_t i=0; i<bytes; ++i){
+        hash ^= uint64_t(ptr[i]);
+        hash *= 1099511628211ULL;
+    }
+}
+
 /*! Basic Constructor.*/
 FFDLattice::FFDLattice(){
     m_knots.resize(3);
     m_mapEff.resize(3);
     m_deg.fill(1);
     m_mapNodes.resize(3);
+    m_mapTheo.resize(3);
+    m_knotsRegular.fill(false);
+    m_knotsInvSpacing.fill(0.0);
     m_globalDispl = false;
     m_bfilter = false;
+    m_useWeightMatrix = false;
+    m_wmatrix.revision = 0;
+    m_wmatrix.lattice = 0;
     m_name = "mimmo.FFDlattice";
 };
 
@@ -51,8 +78,14 @@ FFDLattice::FFDLattice(const bitpit::Config::Section & rootXML){
     m_mapEff.resize(3);
     m_deg.fill(1);
     m_mapNodes.resize(3);
+    m_mapTheo.resize(3);
+    m_knotsRegular.fill(false);
+    m_knotsInvSpacing.fill(0.0);
     m_globalDispl = false;
     m_bfilter = false;
+    m_useWeightMatrix = false;
+    m_wmatrix.revision = 0;
+    m_wmatrix.lattice = 0;
     m_name = "mimmo.FFDlattice";
 
     std::string fallback_name = "ClassNONE";
@@ -68,7 +101,7 @@ FFDLattice::FFDLattice(const bitpit::Config::Section & rootXML){
 /*! Destructor */
 FFDLattice::~FFDLattice(){};
 
-/*! Copy Constructor. Result displacements are never copied.
+/*! Copy Constructor. Result displacements and weight matrix are never copied.
  *\param[in] other FFDLattice where copy from
  */ 
 FFDLattice::FFDLattice(const FFDLattice & other):Lattice(other){
@@ -79,10 +112,17 @@ FFDLattice::FFDLattice(const FFDLattice & other):Lattice(other){
     m_displ = other.m_displ;
     m_mapNodes = other.m_mapNodes;
     m_mapdeg = other.m_mapdeg;
+    m_mapTheo = other.m_mapTheo;
+    m_knotsRegular = other.m_knotsRegular;
+    m_knotsInvSpacing = other.m_knotsInvSpacing;
     m_globalDispl = other.m_globalDispl;
     m_bfilter = other.m_bfilter;
     m_filter = other.m_filter;
     m_collect_wg = other.m_collect_wg;
+    m_useWeightMatrix = other.m_useWeightMatrix;
+    m_weightMatrixFile = other.m_weightMatrixFile;
+    m_wmatrix.revision = 0;
+    m_wmatrix.lattice = 0;
 };
 
 
@@ -107,6 +147,9 @@ void FFDLattice::swap(FFDLattice & x) noexcept
    std::swap(m_displ, x.m_displ);
    std::swap(m_mapNodes, x.m_mapNodes);
    std::swap(m_mapdeg, x.m_mapdeg);
+   std::swap(m_mapTheo, x.m_mapTheo);
+   std::swap(m_knotsRegular, x.m_knotsRegular);
+   std::swap(m_knotsInvSpacing, x.m_knotsInvSpacing);
    std::swap(m_globalDispl, x.m_globalDispl);
    std::swap(m_bfilter, x.m_bfilter);
    //std::swap(m_filter, x.m_filter);
@@ -114,6 +157,9 @@ void FFDLattice::swap(FFDLattice & x) noexcept
    std::swap(m_collect_wg, x.m_collect_wg);
    //std::swap(m_gdispl, x.m_gdispl);
    m_gdispl.swap(x.m_gdispl);
+   std::swap(m_useWeightMatrix, x.m_useWeightMatrix);
+   std::swap(m_weightMatrixFile, x.m_weightMatrixFile);
+   std::swap(m_wmatrix, x.m_wmatrix);
    Lattice::swap(x);
 }
 
@@ -148,6 +194,7 @@ FFDLattice::clearLattice(){
     Lattice::clearLattice();
     clearKnots(); //clear all knots stuff;
     clearFilter();
+    clearWeightMatrix();
     m_displ.clear();
 
 };
@@ -159,6 +206,14 @@ FFDLattice::clearFilter(){
     m_bfilter = false;
 };
 
+/*!Clean the precomputed weight matrix. It will be evaluated again at next execution, if the weight matrix mode is active */
+void
+FFDLattice::clearWeightMatrix(){
+    m_wmatrix = WeightMatrix();
+    m_wmatrix.revision = 0;
+    m_wmatrix.lattice = 0;
+};
+
 
 /*! Return a vector of six elements reporting the real number of knots effectively stored in the current class (first 3 elements)
  * and the theoretical number of knots (last 3 elements) for Nurbs representation (see Nurbs Books of Peigl)
@@ -263,6 +318,18 @@ FFDLattice::getDeformation(){
 bool
 FFDLattice::isDisplGlobal(){return(m_globalDispl);}
 
+/*! Check if the geometry is deformed through the precomputed weight matrix.
+ * \return true if the weight matrix mode is active
+ */
+bool
+FFDLattice::isWeightMatrixActive(){return(m_useWeightMatrix);}
+
+/*! Get the file where the weight matrix is persisted.
+ * \return file name, empty if the matrix is kept in memory only
+ */
+std::string
+FFDLattice::getWeightMatrixFile(){return(m_weightMatrixFile);}
+
 
 /*! Set the degree of nurbs curve in each direction. If the number of control nodes are
  * not initialized, they are set to the minimum number admissible.
@@ -282,7 +349,7 @@ FFDLattice::setDegrees(iarray3E degrees){
  */
 void
 FFDLattice::setDisplacements(dvecarr3E displacements){
-    m_displ = displacements;
+    m_displ = std::move(displacements);
 };
 
 /*! Set if displacements are meant as global-true or local-false.
@@ -479,7 +546,29 @@ void
 FFDLattice::setFilter(dmpvector1D filter){
     m_filter.clear();
     m_bfilter = !(filter.empty());
-    m_filter = filter;
+    m_filter = std::move(filter);
+};
+
+/*! Activate/deactivate the weight matrix mode. If active, the rational basis of the control nodes is
+ * evaluated once on the geometry vertices included in the lattice and stored as a sparse matrix;
+ * following executions with new displacements only need a sparse matrix-vector product. The matrix is
+ * evaluated again whenever the geometry or the lattice setup (shape, dimensions, degrees, coordinate types, weights) change.
+ * Memory needed is (deg0+1)*(deg1+1)*(deg2+1) entries for each included vertex.
+ * \param[in] active true to activate the weight matrix mode (default false)
+ */
+void
+FFDLattice::setWeightMatrix(bool active){
+    m_useWeightMatrix = active;
+    if(!active) clearWeightMatrix();
+};
+
+/*! Set a file where the weight matrix is written after its evaluation, and read from instead of being
+ * evaluated, if it refers to the same geometry and lattice setup. Meaningful only if the weight matrix mode is active.
+ * \param[in] filename file of the persisted weight matrix, empty to keep it in memory only.
+ */
+void
+FFDLattice::setWeightMatrixFile(std::string filename){
+    m_weightMatrixFile = filename;
 };
 
 /*! Plot your current lattice as a structured grid to *vtu file. Wrapped method of plotGrid of father class UCubicMesh.
@@ -568,9 +657,11 @@ FFDLattice::execute(){
         build();
     }
     
-    //build trees
-    if(container->isSkdTreeSupported() && !container->isSkdTreeSync())    container->buildSkdTree();
-    else if(!container->isKdTreeSync())                                container->buildKdTree();
+    //build trees, not needed if the weight matrix is already available
+    if(!m_useWeightMatrix || !isWeightMatrixSync()){
+        if(container->isSkdTreeSupported() && !container->isSkdTreeSync())    container->buildSkdTree();
+        else if(!container->isKdTreeSync())                                container->buildKdTree();
+    }
 
     livector1D map;
     dvecarr3E localdef = apply(map);
@@ -626,11 +717,19 @@ FFDLattice::apply(livector1D & list){
 
     list.clear();
 
-    //check simplex included and extract their vertex in global IDs;
-    if(container->isSkdTreeSupported()) list= container->getVertexFromCellList(getShape()->includeGeometry(container));
-    else                               list= getShape()->includeCloudPoints(container);
-    //return deformation
-    dvecarr3E result = nurbsEvaluator(list);
+    dvecarr3E result;
+    if(m_useWeightMatrix){
+        //deformation through the precomputed weight matrix
+        if(!isWeightMatrixSync())   buildWeightMatrix();
+        list = m_wmatrix.rows;
+        result = evalWeightMatrix();
+    }else{
+        //check simplex included and extract their vertex in global IDs;
+        if(container->isSkdTreeSupported()) list= container->getVertexFromCellList(getShape()->includeGeometry(container));
+        else                               list= getShape()->includeCloudPoints(container);
+        //return deformation
+        result = nurbsEvaluator(list);
+    }
     if(m_bfilter){
 
         checkFilter();
@@ -658,15 +757,37 @@ FFDLattice::apply(dvecarr3E * point){
 
     result.resize(point->size(), darray3E{{0,0,0}});
     livector1D list = getShape()->includeCloudPoints(*point);
+    long lsize = list.size();
 
-    for(const auto & index : list){
-        darray3E target = (*point)[index];
-        result[index] = nurbsEvaluator(target);
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<lsize; ++i){
+        darray3E target = (*point)[list[i]];
+        result[list[i]] = nurbsEvaluator(target);
     }
 
     return(result);
 };
 
+/*! Evaluate the current deformation on a list of 3D points, modulated by a filter value per point.
+ *  Points are assumed to be included in the lattice: inclusion has to be checked by the caller.
+ *  Used by FusedDeformation to evaluate the lattice on the coordinates of a geometry deformed by previous stages.
+ *  The lattice has to be built (see build).
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ */
+void
+FFDLattice::deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ){
+
+    if(n == 0 || !isBuilt()) return;
+    dvecarr3E targets(points, points+n);
+    dvecarr3E result = nurbsEvaluator(targets);
+    for(long i=0; i<n; ++i){
+        displ[i] = result[i]*filter[i];
+    }
+};
+
 /*!
  * Directly apply deformation field to target geometry.
  */
@@ -675,14 +796,7 @@ FFDLattice::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_gdispl.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_gdispl[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_gdispl);
 
 }
 
@@ -826,138 +940,307 @@ FFDLattice::nurbsEvaluator(darray3E & pointOr){
 
 }; 
 
-/*! Return displacement of a list of points,
- * under the deformation effect of the whole Lattice.
- *  
- * \param[in] list 3D points
- * \return points displacements
+/*!Evaluate the local basis function of a Nurbs Curve of degree D, known at compile time, into a
+ * caller-owned buffer. Same Inverted Triangular Scheme Algorithm of FFDLattice::basisITS0(int, int, double),
+ * with knot values gathered once and loops fully unrolled by the compiler.
+ *\param[in] k  local knot interval in which coord resides -> theoretical knot indexing,
+ *\param[in] pos identifies which nurbs curve of lattice (3 curve for 3 box direction) you are pointing
+ *\param[in] coord the evaluation point on the curve
+ *\param[out] basis buffer of D+1 elements, filled with the local basis
  */
-dvecarr3E
-FFDLattice::nurbsEvaluator(livector1D & list){
+template<int D>
+void
+FFDLattice::basisITS0Fixed(int k, int pos, double coord, double * basis){
 
-    bitpit::PatchKernel * tri = getGeometry()->getPatch();
-    long int id;
-    int lsize = list.size();
-    livector1D::iterator it, itend = list.end();
-    darray3E target, point;
-    ivector1D knotInterval(3,0);
-    dvector1D BSbasisi0, BSbasisi1, BSbasisi2;
-    dvector1D valH(4,0), temp1(4,0),temp2(4,0);
+    double left[D+1], right[D+1];
+    left[0] = 0.0;
+    right[0] = 0.0;
+    for(int j = 1; j <= D; ++j){
+        left[j] = coord - getKnotValue(k+1-j, pos);
+        right[j]= getKnotValue(k+j, pos) - coord;
+    }
+
+    basis[0] = 1.0;
+    for(int j = 1; j <= D; ++j){
+        double saved = 0.0;
+        for(int r = 0; r < j; ++r){
+            double tmp = basis[r]/(right[r+1] + left[j-r]);
+            basis[r] = saved + right[r+1] * tmp;
+            saved = left[j-r] * tmp;
+        }//next r
+        basis[j] = saved;
+    }//next j
+};
+
+/*! Return displacement of a list of points, under the deformation effect of the whole Lattice,
+ * for curve degrees known at compile time. D0, D1, D2 are the degrees of the directions in the
+ * order of evaluation of the tensor product (m_mapdeg), i.e. D0 = m_deg[m_mapdeg[0]] and so on.
+ * Basis functions live on the stack and the tensor product loops have fixed bounds; the sequence of
+ * operations is the same of the blocked evaluation of FFDLattice::nurbsEvaluator(const dvecarr3E &),
+ * so results match it bit for bit.
+ * Points are distributed among the available threads (if mimmo is compiled with OpenMP support).
+ * \param[in] targets 3D points
+ * \param[out] result points displacements, sized as targets
+ */
+template<int D0, int D1, int D2>
+void
+FFDLattice::nurbsEvaluatorFixed(const dvecarr3E & targets, dvecarr3E & result){
+
+    long lsize = targets.size();
 
     dvecarr3E displ = recoverFullGridDispl();
     dvector1D weig = recoverFullNodeWeights();
 
-    int uind, vind, wind, index;
-
-    int intv, i, j, k;
+    //homogeneous control values, 4th component multiplies the sole weight.
+    std::vector<darray4E> hdispl(displ.size());
+    for(std::size_t i=0; i<displ.size(); ++i){
+        hdispl[i] = {{displ[i][0], displ[i][1], displ[i][2], 1.0}};
+    }
 
     int i0 = m_mapdeg[0];
     int i1 = m_mapdeg[1];
     int i2 = m_mapdeg[2];
-    iarray3E mappedIndex;
-
-    int md0 = m_deg[i0];
-    int md1 = m_deg[i1];
-    int md2 = m_deg[i2];
 
-    dvecarr3E outres(lsize);
-    dvecarr3E::iterator itout = outres.begin();
+    bool displGlobal = isDisplGlobal();
     darray3E scaling = getShape()->getScaling();
 
-    double bbasisw2;
-    double bbasis1, bbasis0;
-
-    for(it = list.begin(); it != itend; ++it){
-
-        for(intv=0; intv<4; ++intv){
-            valH[intv] = 0.0;
+#pragma omp parallel for schedule(static)
+    for(long ip=0; ip<lsize; ++ip){
+
+        darray3E target = targets[ip];
+        darray3E point = transfToLocal(target);
+
+        double basis0[D0+1], basis1[D1+1], basis2[D2+1];
+        int span0 = getKnotInterval(point[i0], i0);
+        int span1 = getKnotInterval(point[i1], i1);
+        int span2 = getKnotInterval(point[i2], i2);
+        basisITS0Fixed<D0>(span0, i0, point[i0], basis0);
+        basisITS0Fixed<D1>(span1, i1, point[i1], basis1);
+        basisITS0Fixed<D2>(span2, i2, point[i2], basis2);
+        span0 -= D0;
+        span1 -= D1;
+        span2 -= D2;
+
+        iarray3E mappedIndex;
+        double valH[4] = {0.0, 0.0, 0.0, 0.0};
+        for(int i=0; i<=D0; ++i){
+            mappedIndex[i0] = span0 + i;
+            double temp1[4] = {0.0, 0.0, 0.0, 0.0};
+            for(int j=0; j<=D1; ++j){
+                mappedIndex[i1] = span1 + j;
+                double temp2[4] = {0.0, 0.0, 0.0, 0.0};
+                for(int k=0; k<=D2; ++k){
+                    mappedIndex[i2] = span2 + k;
+                    int index = accessMapNodes(mappedIndex[0], mappedIndex[1], mappedIndex[2]);
+                    double bbasisw2 = basis2[k]*weig[index];
+                    const darray4E & hnode = hdispl[index];
+                    for(int intv=0; intv<4; ++intv){
+                        temp2[intv] += bbasisw2*hnode[intv];
+                    }
+                }
+                for(int intv=0; intv<4; ++intv){
+                    temp1[intv] += basis1[j]*temp2[intv];
+                }
+            }
+            for(int intv=0; intv<4; ++intv){
+                valH[intv] += basis0[i]*temp1[intv];
+            }
         }
-        id  = *it;
-        target = tri->getVertex(id).getCoords();
-        point = transfToLocal(target);
 
-        // get reference Interval int the knot matrix
-        for(i=0; i<3; i++){
-            knotInterval[i] = getKnotInterval(point[i],i);
+        darray3E & res = result[ip];
+        if(displGlobal){
+            for(int intv=0; intv<3; ++intv){
+                res[intv] = valH[intv]/valH[3];
+            }
+        }else{
+            //adding to local point displ rescaled, get absolute displ as difference of global points
+            for(int intv=0; intv<3; ++intv){
+                point[intv]+= valH[intv]/(valH[3]*scaling[intv]);
+            }
+            res = transfToGlobal(point) - target;
         }
-        BSbasisi0 = basisITS0(knotInterval[i0], i0, point[i0]);
-        BSbasisi1 = basisITS0(knotInterval[i1], i1, point[i1]);
-        BSbasisi2 = basisITS0(knotInterval[i2], i2, point[i2]);
-
-        uind = knotInterval[i0] - md0;
-        vind = knotInterval[i1] - md1;
-        wind = knotInterval[i2] - md2;
-
+    }
+};
 
-        for(i=0; i<=md0; ++i){
+/*! Return displacement of a list of vertices of the linked geometry,
+ * under the deformation effect of the whole Lattice. Vertex coordinates are read from the
+ * coordinates view of the geometry (see MimmoObject::getCoordinatesView).
+ * \param[in] list ids of the vertices
+ * \return vertices displacements
+ */
+dvecarr3E
+FFDLattice::nurbsEvaluator(livector1D & list){
 
-            mappedIndex[i0] = uind + i;
+    const CoordinatesView & coords = getGeometry()->getCoordinatesView();
+    long lsize = list.size();
+    dvecarr3E targets(lsize);
+    for(long i=0; i<lsize; ++i){
+        targets[i] = coords.getCoords(coords.index.at(list[i]));
+    }
+    return(nurbsEvaluator(targets));
+};
 
-            for(int intv=0; intv<4; ++intv){
-                temp1[intv] = 0.0;
-            }
+/*! Return displacement of a list of points,
+ * under the deformation effect of the whole Lattice.
+ *
+ * The list is partitioned in blocks of points, distributed among the available threads
+ * (if mimmo is compiled with OpenMP support). For each block, local coordinates, knot
+ * intervals and basis functions are evaluated first into per-thread buffers, sized once on the
+ * curve degrees fixed by build(); the rational tensor product is then accumulated on a contiguous
+ * homogeneous copy of the control nodes displacements. The arithmetic sequence of each point is
+ * the same of the serial evaluation, so results do not depend on the number of threads.
+ *
+ * Curve degrees from 1 to 4 in each direction are dispatched to the degree specialized FFDLattice::nurbsEvaluatorFixed,
+ * which keeps the same sequence of operations; the blocked evaluation above is the generic fallback for higher degrees.
+ *
+ * \param[in] targets 3D points
+ * \return points displacements
+ */
+dvecarr3E
+FFDLattice::nurbsEvaluator(const dvecarr3E & targets){
 
-            for(j=0; j<=md1; ++j){
+    long lsize = targets.size();
+    dvecarr3E outres(lsize);
+    if(lsize == 0) return outres;
+
+    if(m_deg[0] >= 1 && m_deg[0] <= 4 && m_deg[1] >= 1 && m_deg[1] <= 4 && m_deg[2] >= 1 && m_deg[2] <= 4){
+        typedef void (FFDLattice::*FixedEvaluator)(const dvecarr3E &, dvecarr3E &);
+#define FFD_FIXED_ROW(D0, D1) {&FFDLattice::nurbsEvaluatorFixed<D0,D1,1>, &FFDLattice::nurbsEvaluatorFixed<D0,D1,2>, &FFDLattice::nurbsEvaluatorFixed<D0,D1,3>, &FFDLattice::nurbsEvaluatorFixed<D0,D1,4>}
+#define FFD_FIXED_PLANE(D0) {FFD_FIXED_ROW(D0,1), FFD_FIXED_ROW(D0,2), FFD_FIXED_ROW(D0,3), FFD_FIXED_ROW(D0,4)}
+        static const FixedEvaluator evaluators[4][4][4] = {FFD_FIXED_PLANE(1), FFD_FIXED_PLANE(2), FFD_FIXED_PLANE(3), FFD_FIXED_PLANE(4)};
+#undef FFD_FIXED_PLANE
+#undef FFD_FIXED_ROW
+        (this->*evaluators[m_deg[m_mapdeg[0]]-1][m_deg[m_mapdeg[1]]-1][m_deg[m_mapdeg[2]]-1])(targets, outres);
+        return outres;
+    }
 
-                mappedIndex[i1] = vind + j;
+    dvecarr3E displ = recoverFullGridDispl();
+    dvector1D weig = recoverFullNodeWeights();
 
-                for(intv=0; intv<4; ++intv){
-                    temp2[intv] = 0.0;
-                }
+    //homogeneous control values, 4th component multiplies the sole weight.
+    std::vector<darray4E> hdispl(displ.size());
+    for(std::size_t i=0; i<displ.size(); ++i){
+        hdispl[i] = {{displ[i][0], displ[i][1], displ[i][2], 1.0}};
+    }
 
-                for(k=0; k<=md2; ++k){
+    int i0 = m_mapdeg[0];
+    int i1 = m_mapdeg[1];
+    int i2 = m_mapdeg[2];
 
-                    mappedIndex[i2] = wind + k;
+    int md0 = m_deg[i0];
+    int md1 = m_deg[i1];
+    int md2 = m_deg[i2];
 
-                    index = accessMapNodes(mappedIndex[0], mappedIndex[1], mappedIndex[2]);
+    iarray3E dd = {{m_deg[0]+1, m_deg[1]+1, m_deg[2]+1}};
+    int maxdd = std::max(dd[0], std::max(dd[1], dd[2]));
 
-                    bbasisw2 = BSbasisi2[k]* weig[index];
+    bool displGlobal = isDisplGlobal();
+    darray3E scaling = getShape()->getScaling();
 
-                    for(intv=0; intv<3; ++intv){
-                        temp2[intv] += bbasisw2 * displ[index][intv];
-                    }
-                    temp2[3] += bbasisw2;
+    const long blockSize = 64;
+    long nblocks = (lsize + blockSize - 1) / blockSize;
 
+#pragma omp parallel
+    {
+        //thread buffers of the current block of points.
+        dvecarr3E   blockTarget(blockSize), blockPoint(blockSize);
+        ivector1D   blockSpan(3*blockSize);
+        dvector1D   blockBasis((dd[0]+dd[1]+dd[2])*blockSize);
+        dvector1D   left(maxdd, 0.0), right(maxdd, 0.0);
+        std::array<double*,3> basisDir = {{&blockBasis[0], &blockBasis[dd[0]*blockSize], &blockBasis[(dd[0]+dd[1])*blockSize]}};
+
+        iarray3E mappedIndex;
+        double valH[4], temp1[4], temp2[4];
+        double bbasisw2, bbasis1, bbasis0;
+        int uind, vind, wind, index;
+
+#pragma omp for schedule(static)
+        for(long ib=0; ib<nblocks; ++ib){
+
+            long start = ib*blockSize;
+            int nb = int(std::min(blockSize, lsize - start));
+
+            //local coordinates, knot intervals and basis functions of the whole block
+            for(int ip=0; ip<nb; ++ip){
+                blockTarget[ip] = targets[start+ip];
+                blockPoint[ip] = transfToLocal(blockTarget[ip]);
+                for(int d=0; d<3; ++d){
+                    int & span = blockSpan[d*blockSize + ip];
+                    span = getKnotInterval(blockPoint[ip][d], d);
+                    basisITS0(span, d, blockPoint[ip][d], basisDir[d] + ip*dd[d], left.data(), right.data());
                 }
-                bbasis1 = BSbasisi1[j];
-                for(intv=0; intv<4; ++intv){
-                    temp1[intv] += bbasis1*temp2[intv];
-                }
-
-            }
-            bbasis0 = BSbasisi0[i];
-            for(intv=0; intv<4; ++intv){
-                valH[intv] += bbasis0*temp1[intv];
             }
-        }
-
 
-        if(isDisplGlobal()){
+            //rational tensor product accumulation
+            for(int ip=0; ip<nb; ++ip){
 
-            //adding to local point displ rescaled
-            for(i=0; i<3; ++i){
-                (*itout)[i] = valH[i]/valH[3];
-            }
+                const double * BSbasisi0 = basisDir[i0] + ip*dd[i0];
+                const double * BSbasisi1 = basisDir[i1] + ip*dd[i1];
+                const double * BSbasisi2 = basisDir[i2] + ip*dd[i2];
 
-        }else{
-
-            //adding to local point displ rescaled
-            for(i=0; i<3; ++i){
-                point[i]+= valH[i]/(valH[3]*scaling[i]);
-            }
+                uind = blockSpan[i0*blockSize + ip] - md0;
+                vind = blockSpan[i1*blockSize + ip] - md1;
+                wind = blockSpan[i2*blockSize + ip] - md2;
 
-            //get absolute displ as difference of
-            for(i=0; i<3; ++i){
-                (*itout)[i] = transfToGlobal(point)[i] - target[i];
-            }
+                for(int intv=0; intv<4; ++intv){
+                    valH[intv] = 0.0;
+                }
 
-        }
+                for(int i=0; i<=md0; ++i){
 
-        itout++;
+                    mappedIndex[i0] = uind + i;
+                    for(int intv=0; intv<4; ++intv){
+                        temp1[intv] = 0.0;
+                    }
 
-    }//next list id
+                    for(int j=0; j<=md1; ++j){
+
+                        mappedIndex[i1] = vind + j;
+                        for(int intv=0; intv<4; ++intv){
+                            temp2[intv] = 0.0;
+                        }
+
+                        for(int k=0; k<=md2; ++k){
+
+                            mappedIndex[i2] = wind + k;
+                            index = accessMapNodes(mappedIndex[0], mappedIndex[1], mappedIndex[2]);
+                            bbasisw2 = BSbasisi2[k]* weig[index];
+                            const darray4E & hnode = hdispl[index];
+#pragma omp simd
+                            for(int intv=0; intv<4; ++intv){
+                                temp2[intv] += bbasisw2 * hnode[intv];
+                            }
+                        }
+                        bbasis1 = BSbasisi1[j];
+#pragma omp simd
+                        for(int intv=0; intv<4; ++intv){
+                            temp1[intv] += bbasis1*temp2[intv];
+                        }
+                    }
+                    bbasis0 = BSbasisi0[i];
+#pragma omp simd
+                    for(int intv=0; intv<4; ++intv){
+                        valH[intv] += bbasis0*temp1[intv];
+                    }
+                }
 
-    itout = outres.end();
+                darray3E & res = outres[start+ip];
+                if(displGlobal){
+                    for(int intv=0; intv<3; ++intv){
+                        res[intv] = valH[intv]/valH[3];
+                    }
+                }else{
+                    //adding to local point displ rescaled
+                    darray3E & point = blockPoint[ip];
+                    for(int intv=0; intv<3; ++intv){
+                        point[intv]+= valH[intv]/(valH[3]*scaling[intv]);
+                    }
+                    //get absolute displ as difference of global points
+                    res = transfToGlobal(point) - blockTarget[ip];
+                }
+            }
+        }//next block
+    }
 
     return(outres);
 
@@ -1049,13 +1332,36 @@ FFDLattice::nurbsEvaluatorScalar(darray3E & coordOr, int targ){
 dvector1D
 FFDLattice::basisITS0(int k, int pos, double coord){
 
+    int dd1 = m_deg[pos]+1;
+    dvector1D basis(dd1);
+    dvector1D left(dd1,0), right(dd1,0);
+    basisITS0(k, pos, coord, basis.data(), left.data(), right.data());
+    return(basis);
+};
+
+/*!Evaluate the local basis function of a Nurbs Curve into a caller-owned buffer, with no
+ * memory allocation. Same Inverted Triangular Scheme Algorithm of FFDLattice::basisITS0(int, int, double).
+ *\param[in] k  local knot interval in which coord resides -> theoretical knot indexing,
+ *\param[in] pos identifies which nurbs curve of lattice (3 curve for 3 box direction) you are pointing
+ *\param[in] coord the evaluation point on the curve
+ *\param[out] basis buffer of at least m_deg[pos]+1 elements, filled with the local basis
+ *\param[in,out] left work buffer of at least m_deg[pos]+1 elements
+ *\param[in,out] right work buffer of at least m_deg[pos]+1 elements
+ */
+void
+FFDLattice::basisITS0(int k, int pos, double coord, double * basis, double * left, double * right){
+
     //return local basis function given the local interval in theoretical knot index,
     //local degree of the curve -> Please refer to NURBS book of PEIGL for this Inverted Triangular Scheme Algorithm (pag 74);
     int dd1 = m_deg[pos]+1;
-    dvector1D basis(dd1,1);
-    dvector1D left(dd1,0), right(dd1,0);
     double saved, tmp;
 
+    for(int j = 0; j < dd1; ++j){
+        basis[j] = 1.0;
+        left[j] = 0.0;
+        right[j] = 0.0;
+    }
+
     for(int j = 1; j < dd1; ++j){
         saved = 0.0;
         left[j] = coord - getKnotValue(k+1-j, pos);
@@ -1069,8 +1375,6 @@ FFDLattice::basisITS0(int k, int pos, double coord){
 
         basis[j] = saved;
     }//next j
-
-    return(basis);
 };
 
 /*!Return list of equally spaced knots for the Nurbs curve in a specific lattice direction
@@ -1156,6 +1460,10 @@ FFDLattice::clearKnots(){
     m_deg.fill(1.0);
     m_mapNodes.resize(3);
     m_mapdeg[0]=0; m_mapdeg[1]=1; m_mapdeg[2]=2;
+    m_mapTheo.clear();
+    m_mapTheo.resize(3);
+    m_knotsRegular.fill(false);
+    m_knotsInvSpacing.fill(0.0);
 
 };
 
@@ -1325,32 +1633,82 @@ FFDLattice::setKnotsStructure(int dir,CoordType type){
         break;
     }
 
+    setKnotsLookup(dir);
     setMapNodes(dir);
 
 };
 
+/*! Prepare the lookup structures of the knots of a curve: the inverse map of theoretical knot indices and
+ * the inverse of the mean knot spacing. Knots built on the equally spaced lattice nodes are equally spaced, but for a few
+ * wider intervals at the curve ends; if every knot deviates from its equally spaced position by a few minimum
+ * knot intervals at most, the curve is marked as regular and FFDLattice::getKnotInterval locates the knot interval of
+ * a coordinate in constant time.
+ * \param[in] dir direction of the curve
+ */
+void
+FFDLattice::setKnotsLookup(int dir){
+
+    const dvector1D & knots = m_knots[dir];
+    int size = knots.size();
+
+    //last theoretical index pointing to each knot
+    m_mapTheo[dir].assign(size, -1);
+    for(int i=0; i<(int)m_mapEff[dir].size(); ++i){
+        int target = m_mapEff[dir][i];
+        if(target >= 0 && target < size)   m_mapTheo[dir][target] = i;
+    }
+
+    m_knotsRegular[dir] = false;
+    m_knotsInvSpacing[dir] = 0.0;
+    if(size < 2)    return;
+
+    double spacing = (knots[size-1] - knots[0])/double(size-1);
+    double minSpacing = spacing;
+    double deviation = 0.0;
+    for(int i=0; i<size-1; ++i){
+        minSpacing = std::min(minSpacing, knots[i+1] - knots[i]);
+        deviation = std::max(deviation, std::abs(knots[i] - knots[0] - i*spacing));
+    }
+    if(minSpacing <= 0.0)   return;
+
+    m_knotsRegular[dir] = (deviation <= 4.0*minSpacing);
+    m_knotsInvSpacing[dir] = 1.0/spacing;
+};
+
 /*! Given a knots distribution for one curve in direction "dir", return the index of
  * interval which a coord belongs to
  * \param[in] coord target position
  * \param[in] dir   0,1,2 identifies the three direction x,y,z in space, and the relative knots distribution
  * \return interval index.
+ *
+ * Regular knots (see FFDLattice::setKnotsLookup) are located in constant time from their mean spacing, others by binary search.
  */
 int
 FFDLattice::getKnotInterval(double coord, int dir){
 
-    int size = m_knots[dir].size();
-    if(coord< m_knots[dir][0] ){ return(getTheoreticalKnotIndex(0, dir));}
-    if(coord >= m_knots[dir][size-1]){ return(getTheoreticalKnotIndex(size-2, dir));}
-
-    int low = 0;
-    int high = size-1;
-    int mid = (low + high)/2;
-    while( coord < m_knots[dir][mid] || coord>= m_knots[dir][mid+1]){
-        if(coord < m_knots[dir][mid])    {high=mid;}
-        else                {low=mid;}
-        mid = (low+high)/2;
+    const dvector1D & knots = m_knots[dir];
+    int size = knots.size();
+    if(coord< knots[0] ){ return(m_mapTheo[dir][0]);}
+    if(coord >= knots[size-1]){ return(m_mapTheo[dir][size-2]);}
+
+    int mid;
+    if(m_knotsRegular[dir]){
+        //guess from the mean spacing, corrected against the knot values
+        mid = int(std::floor((coord - knots[0]) * m_knotsInvSpacing[dir]));
+        mid = std::min(std::max(mid, 0), size-2);
+        while(coord < knots[mid])       --mid;
+        while(coord >= knots[mid+1])    ++mid;
+    }else{
+        int low = 0;
+        int high = size-1;
+        mid = (low + high)/2;
+        while( coord < knots[mid] || coord>= knots[mid+1]){
+            if(coord < knots[mid])    {high=mid;}
+            else                {low=mid;}
+            mid = (low+high)/2;
+        }
     }
-    return(getTheoreticalKnotIndex(mid, dir));
+    return(m_mapTheo[dir][mid]);
 };
 
 /*! Return value of a knot for a given its theoretical index and a direction in space
@@ -1385,10 +1743,8 @@ int
 FFDLattice::getTheoreticalKnotIndex(int locIndex,int dir){
     if(locIndex <0 || locIndex >= (int)m_knots[dir].size()){return(-1);}
 
-    // search from the end your m_mapEff vector
-    ivector1D::reverse_iterator it = find(m_mapEff[dir].rbegin(), m_mapEff[dir].rend(), locIndex);
-    int result = std::distance(m_mapEff[dir].begin(), (it.base()-1));
-    return(result);
+    // last theoretical index pointing to the knot, see setKnotsLookup
+    return(m_mapTheo[dir][locIndex]);
 };
 
 /*! Resize map of effective nodes of the lattice grid to fit a total number od degree of freedom nx*ny*nz.
@@ -1532,6 +1888,343 @@ FFDLattice::orderDimension(){
 
 };
 
+/*!
+ * Evaluate a signature of the current lattice setup, that is shape, dimensions, curve degrees,
+ * coordinate types, knots structures and nodal weights.
+ * \return signature of the lattice setup
+ */
+uint64_t
+FFDLattice::latticeSignature(){
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    darray3E origin = getOrigin();
+    darray3E span = getSpan();
+    darray3E inf = getInfLimits();
+    dmatrix33E sdr = getRefSystem();
+    int shape = static_cast<int>(getShape()->getShapeType());
+    iarray3E dim = getDimension();
+    std::array<CoordType,3> ctype = getCoordType();
+
+    hashBytes(hash, &shape, sizeof(int));
+    hashBytes(hash, origin.data(), 3*sizeof(double));
+    hashBytes(hash, span.data(), 3*sizeof(double));
+    hashBytes(hash, inf.data(), 3*sizeof(double));
+    for(int i=0; i<3; ++i){
+        hashBytes(hash, sdr[i].data(), 3*sizeof(double));
+        int type = static_cast<int>(ctype[i]);
+        hashBytes(hash, &type, sizeof(int));
+    }
+    hashBytes(hash, dim.data(), 3*sizeof(int));
+    hashBytes(hash, m_deg.data(), 3*sizeof(int));
+    for(int i=0; i<3; ++i){
+        hashBytes(hash, m_knots[i].data(), m_knots[i].size()*sizeof(double));
+        hashBytes(hash, m_mapEff[i].data(), m_mapEff[i].size()*sizeof(int));
+        hashBytes(hash, m_mapNodes[i].data(), m_mapNodes[i].size()*sizeof(int));
+    }
+    dvector1D weig = recoverFullNodeWeights();
+    hashBytes(hash, weig.data(), weig.size()*sizeof(double));
+
+    return hash;
+};
+
+/*!
+ * Evaluate a signature of the linked geometry, on vertex ids and coordinates and on cell connectivities.
+ * Differently from MimmoObject::getRevision, the signature identifies the geometry across different runs.
+ * \return signature of the geometry
+ */
+uint64_t
+FFDLattice::geometrySignature(){
+
+    uint64_t hash = 14695981039346656037ULL;
+    MimmoObject * container = getGeometry();
+
+    const CoordinatesView & coords = container->getCoordinatesView();
+    long nV = coords.size();
+    hashBytes(hash, &nV, sizeof(long));
+    hashBytes(hash, coords.ids.data(), nV*sizeof(long));
+    hashBytes(hash, coords.x.data(), nV*sizeof(double));
+    hashBytes(hash, coords.y.data(), nV*sizeof(double));
+    hashBytes(hash, coords.z.data(), nV*sizeof(double));
+
+    for(const auto & cell : container->getCells()){
+        long id = cell.getId();
+        hashBytes(hash, &id, sizeof(long));
+        bitpit::ConstProxyVector<long> vIds = cell.getVertexIds();
+        for(const auto & idV : vIds){
+            hashBytes(hash, &idV, sizeof(long));
+        }
+    }
+    return hash;
+};
+
+/*!
+ * \return true if the weight matrix is evaluated on the current geometry with the current lattice setup.
+ */
+bool
+FFDLattice::isWeightMatrixSync(){
+    MimmoObject * container = getGeometry();
+    if(container == NULL || m_wmatrix.revision == 0)    return false;
+    return (m_wmatrix.revision == container->getRevision()) && (m_wmatrix.lattice == latticeSignature());
+};
+
+/*!
+ * Evaluate the weight matrix on the linked geometry, or read it from the weight matrix file, if any,
+ * when it refers to the same geometry and lattice setup and passes validation (see readWeightMatrix).
+ * Otherwise the matrix is evaluated, and the newly evaluated matrix is written to the file.
+ *
+ * Vertices included in the lattice are found as in FFDLattice::apply(livector1D &); for each of them,
+ * distributed among the available threads (if mimmo is compiled with OpenMP support), knot intervals and
+ * basis functions are evaluated and the (deg0+1)*(deg1+1)*(deg2+1) products of basis functions and nodal weights
+ * are stored, normalized by their sum, with the full grid index of their control node.
+ */
+void
+FFDLattice::buildWeightMatrix(){
+
+    MimmoObject * container = getGeometry();
+    uint64_t lattice = latticeSignature();
+    uint64_t geometry = 0;
+
+    if(!m_weightMatrixFile.empty()){
+        geometry = geometrySignature();
+        if(readWeightMatrix(m_weightMatrixFile, lattice, geometry)){
+            m_wmatrix.revision = container->getRevision();
+            m_wmatrix.lattice = lattice;
+            return;
+        }
+        (*m_log)<<m_name<<" : weight matrix file "<<m_weightMatrixFile<<" missing, stale or invalid, evaluating the matrix"<<std::endl;
+    }
+
+    livector1D list;
+    if(container->isSkdTreeSupported()) list= container->getVertexFromCellList(getShape()->includeGeometry(container));
+    else                               list= getShape()->includeCloudPoints(container);
+
+    const CoordinatesView & coords = container->getCoordinatesView();
+    long lsize = list.size();
+    dvector1D weig = recoverFullNodeWeights();
+
+    iarray3E dd = {{m_deg[0]+1, m_deg[1]+1, m_deg[2]+1}};
+    int maxdd = std::max(dd[0], std::max(dd[1], dd[2]));
+    long rowSize = long(dd[0])*long(dd[1])*long(dd[2]);
+
+    WeightMatrix matrix;
+    matrix.rows = list;
+    matrix.offsets.resize(lsize+1);
+    for(long ip=0; ip<=lsize; ++ip){
+        matrix.offsets[ip] = ip*rowSize;
+    }
+    matrix.cols.resize(lsize*rowSize);
+    matrix.vals.resize(lsize*rowSize);
+    matrix.local.resize(lsize);
+    matrix.target.resize(lsize);
+
+#pragma omp parallel
+    {
+        dvector1D   basis(dd[0]+dd[1]+dd[2]);
+        dvector1D   left(maxdd, 0.0), right(maxdd, 0.0);
+        std::array<double*,3> basisDir = {{&basis[0], &basis[dd[0]], &basis[dd[0]+dd[1]]}};
+        iarray3E    start, mappedIndex;
+
+#pragma omp for schedule(static)
+        for(long ip=0; ip<lsize; ++ip){
+
+            darray3E target = coords.getCoords(coords.index.at(list[ip]));
+            darray3E point = transfToLocal(target);
+            for(int d=0; d<3; ++d){
+                int span = getKnotInterval(point[d], d);
+                basisITS0(span, d, point[d], basisDir[d], left.data(), right.data());
+                start[d] = span - m_deg[d];
+            }
+
+            long pos = matrix.offsets[ip];
+            double sum = 0.0;
+            for(int i=0; i<dd[0]; ++i){
+                mappedIndex[0] = start[0] + i;
+                for(int j=0; j<dd[1]; ++j){
+                    mappedIndex[1] = start[1] + j;
+                    double basis01 = basisDir[0][i]*basisDir[1][j];
+                    for(int k=0; k<dd[2]; ++k){
+                        mappedIndex[2] = start[2] + k;
+                        int index = accessMapNodes(mappedIndex[0], mappedIndex[1], mappedIndex[2]);
+                        double val = basis01*basisDir[2][k]*weig[index];
+                        matrix.cols[pos] = index;
+                        matrix.vals[pos] = val;
+                        sum += val;
+                        ++pos;
+                    }
+                }
+            }
+            for(long e=matrix.offsets[ip]; e<pos; ++e){
+                matrix.vals[e] /= sum;
+            }
+            matrix.local[ip] = point;
+            matrix.target[ip] = target;
+        }
+    }
+
+    matrix.revision = container->getRevision();
+    matrix.lattice = lattice;
+    m_wmatrix = std::move(matrix);
+
+    (*m_log)<<m_name<<" : weight matrix evaluated on "<<lsize<<" vertices, "<<m_wmatrix.vals.size()<<" entries"<<std::endl;
+
+    if(!m_weightMatrixFile.empty() && !writeWeightMatrix(m_weightMatrixFile, geometry)){
+        (*m_log)<<"warning: "<<m_name<<" failed to write weight matrix file "<<m_weightMatrixFile<<std::endl;
+    }
+};
+
+/*!
+ * Evaluate the displacements of the geometry vertices stored in the weight matrix, as product of the
+ * weight matrix and the current displacements of the control nodes. Rows are distributed among the available
+ * threads (if mimmo is compiled with OpenMP support).
+ * \return displacements of the weight matrix vertices, in the same order of the matrix rows.
+ */
+dvecarr3E
+FFDLattice::evalWeightMatrix(){
+
+    long lsize = m_wmatrix.rows.size();
+    dvecarr3E result(lsize);
+    if(lsize == 0)  return result;
+
+    dvecarr3E displ = recoverFullGridDispl();
+    bool displGlobal = isDisplGlobal();
+    darray3E scaling = getShape()->getScaling();
+
+    const long * offsets = m_wmatrix.offsets.data();
+    const int * cols = m_wmatrix.cols.data();
+    const double * vals = m_wmatrix.vals.data();
+
+#pragma omp parallel for schedule(static)
+    for(long ip=0; ip<lsize; ++ip){
+        double val0 = 0.0, val1 = 0.0, val2 = 0.0;
+        for(long e=offsets[ip]; e<offsets[ip+1]; ++e){
+            const darray3E & node = displ[cols[e]];
+            val0 += vals[e]*node[0];
+            val1 += vals[e]*node[1];
+            val2 += vals[e]*node[2];
+        }
+        if(displGlobal){
+            result[ip] = {{val0, val1, val2}};
+        }else{
+            //adding to local point displ rescaled, get absolute displ as difference of global points
+            darray3E point = m_wmatrix.local[ip];
+            point[0] += val0/scaling[0];
+            point[1] += val1/scaling[1];
+            point[2] += val2/scaling[2];
+            result[ip] = transfToGlobal(point) - m_wmatrix.target[ip];
+        }
+    }
+    return result;
+};
+
+/*!
+ * Read the weight matrix from a binary file. The matrix is replaced only if the file refers to the
+ * given lattice setup and geometry and is read successfully. Sizes declared in the file are checked
+ * against the file size before allocating the matrix, and its content is validated: row offsets have
+ * to be non decreasing, entries have to refer to existing lattice nodes and rows to existing
+ * vertices of the linked geometry.
+ * \param[in] filename  name of the file
+ * \param[in] lattice   signature of the current lattice setup
+ * \param[in] geometry  signature of the current geometry
+ * \return true if the matrix is read, false if the file is missing, stale or corrupted
+ */
+bool
+FFDLattice::readWeightMatrix(const std::string & filename, uint64_t lattice, uint64_t geometry){
+
+    std::ifstream in(filename, std::ios::binary);
+    if(!in.is_open())   return false;
+
+    in.seekg(0, std::ios::end);
+    std::streamoff fileSize = in.tellg();
+    in.seekg(0, std::ios::beg);
+    if(fileSize < 0)    return false;
+
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t fileLattice = 0, fileGeometry = 0, nRows = 0, nEntries = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&fileLattice), sizeof(fileLattice));
+    in.read(reinterpret_cast<char *>(&fileGeometry), sizeof(fileGeometry));
+    in.read(reinterpret_cast<char *>(&nRows), sizeof(nRows));
+    in.read(reinterpret_cast<char *>(&nEntries), sizeof(nEntries));
+    if(!in.good() || std::memcmp(magic, FFDWEIGHTS_MAGIC, sizeof(magic)) != 0 || version != FFDWEIGHTS_VERSION){
+        return false;
+    }
+    if(fileLattice != lattice || fileGeometry != geometry)  return false;
+
+    //declared sizes must match the file size exactly; overflow safe, as each count is bounded first.
+    uint64_t header = sizeof(magic) + sizeof(version) + 4*sizeof(uint64_t);
+    uint64_t rowBytes = sizeof(long) + sizeof(long) + 2*sizeof(darray3E);
+    uint64_t entryBytes = sizeof(int) + sizeof(double);
+    uint64_t available = uint64_t(fileSize);
+    if(available < header + sizeof(long))   return false;
+    available -= header + sizeof(long);
+    if(nRows > available/rowBytes)  return false;
+    available -= nRows*rowBytes;
+    if(nEntries > available/entryBytes || nEntries*entryBytes != available)  return false;
+
+    WeightMatrix matrix;
+    matrix.rows.resize(nRows);
+    matrix.offsets.resize(nRows+1);
+    matrix.cols.resize(nEntries);
+    matrix.vals.resize(nEntries);
+    matrix.local.resize(nRows);
+    matrix.target.resize(nRows);
+    in.read(reinterpret_cast<char *>(matrix.rows.data()), nRows*sizeof(long));
+    in.read(reinterpret_cast<char *>(matrix.offsets.data()), (nRows+1)*sizeof(long));
+    in.read(reinterpret_cast<char *>(matrix.cols.data()), nEntries*sizeof(int));
+    in.read(reinterpret_cast<char *>(matrix.vals.data()), nEntries*sizeof(double));
+    in.read(reinterpret_cast<char *>(matrix.local.data()), nRows*sizeof(darray3E));
+    in.read(reinterpret_cast<char *>(matrix.target.data()), nRows*sizeof(darray3E));
+    if(!in.good())  return false;
+
+    if(matrix.offsets[0] != 0 || matrix.offsets[nRows] != long(nEntries))   return false;
+    for(uint64_t ip=0; ip<nRows; ++ip){
+        if(matrix.offsets[ip+1] < matrix.offsets[ip])   return false;
+    }
+    iarray3E dim = getDimension();
+    int nNodes = dim[0]*dim[1]*dim[2];
+    for(int col : matrix.cols){
+        if(col < 0 || col >= nNodes)    return false;
+    }
+    MimmoObject * container = getGeometry();
+    for(long id : matrix.rows){
+        if(!container->getVertices().exists(id))    return false;
+    }
+
+    m_wmatrix = std::move(matrix);
+    return true;
+};
+
+/*!
+ * Write the weight matrix to a binary file, tagged with the signatures of lattice setup and geometry.
+ * \param[in] filename  name of the file
+ * \param[in] geometry  signature of the current geometry
+ * \return true if the matrix is written
+ */
+bool
+FFDLattice::writeWeightMatrix(const std::string & filename, uint64_t geometry){
+
+    std::ofstream out(filename, std::ios::binary);
+    if(!out.is_open())  return false;
+
+    uint64_t nRows = m_wmatrix.rows.size(), nEntries = m_wmatrix.vals.size();
+    out.write(FFDWEIGHTS_MAGIC, sizeof(FFDWEIGHTS_MAGIC));
+    out.write(reinterpret_cast<const char *>(&FFDWEIGHTS_VERSION), sizeof(FFDWEIGHTS_VERSION));
+    out.write(reinterpret_cast<const char *>(&m_wmatrix.lattice), sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(&geometry), sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(&nRows), sizeof(nRows));
+    out.write(reinterpret_cast<const char *>(&nEntries), sizeof(nEntries));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.rows.data()), nRows*sizeof(long));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.offsets.data()), (nRows+1)*sizeof(long));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.cols.data()), nEntries*sizeof(int));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.vals.data()), nEntries*sizeof(double));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.local.data()), nRows*sizeof(darray3E));
+    out.write(reinterpret_cast<const char *>(m_wmatrix.target.data()), nRows*sizeof(darray3E));
+    return out.good();
+};
+
 /*! Build your lattice and all your knot structures. Execute this method every 
  *  time a parameter modification is applied, in order to enable it 
  *  \return id lattice is successfully built.
@@ -1615,6 +2308,23 @@ FFDLattice::absorbSectionXML(const bitpit::Config::Section & slotXML, std::strin
         setDisplGlobal(temp);
     };
 
+    if(slotXML.hasOption("WeightMatrix")){
+        std::string input = slotXML.get("WeightMatrix");
+        input = bitpit::utils::string::trim(input);
+        bool temp = false;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss>>temp;
+        }
+        setWeightMatrix(temp);
+    };
+
+    if(slotXML.hasOption("WeightMatrixFile")){
+        std::string input = slotXML.get("WeightMatrixFile");
+        input = bitpit::utils::string::trim(input);
+        setWeightMatrixFile(input);
+    };
+
 };
 
 /*!
@@ -1653,6 +2363,13 @@ FFDLattice::flushSectionXML(bitpit::Config::Section & slotXML, std::string name)
         slotXML.set("DisplGlobal", std::to_string(int(isDisplGlobal())));
     }
 
+    {
+        slotXML.set("WeightMatrix", std::to_string(int(isWeightMatrixActive())));
+        if(!m_weightMatrixFile.empty()){
+            slotXML.set("WeightMatrixFile", m_weightMatrixFile);
+        }
+    }
+
 };
 
 }
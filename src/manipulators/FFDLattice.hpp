@@ -122,10 +122,18 @@ namespace mimmo{
  * - <B>CoordType</B>: Set Boundary conditions for each NURBS interpolant on their extrema. Available choice are <B>CLAMPED,SYMMETRIC,UNCLAMPED, PERIODIC</B>;
  * - <B>Degrees</B>: degrees for NURBS interpolant in each spatial direction;
  * - <B>DisplGlobal</B>:0/1 use local-shape/global x,y,z reference system to define displacements of lattice node;
+ * - <B>WeightMatrix</B>:0/1 precompute and reuse the sparse weight matrix of the geometry vertices (see setWeightMatrix);
+ * - <B>WeightMatrixFile</B>: file where the weight matrix is persisted and reloaded from, empty to keep it in memory only;
  *
 
  *
  * Geometry, displacements field and filter field have to be mandatorily passed through port.
+ *
+ * When the same geometry is deformed repeatedly with the same lattice setup and different displacements
+ * (e.g. in a shape optimization loop), the weight matrix mode splits the work in an offline and an online phase.
+ * Offline, the rational basis of each control node is evaluated once on the vertices included in the shape and stored
+ * as a sparse vertex by control node matrix; online, each new set of displacements costs a parallel sparse matrix-vector product.
+ * The matrix is rebuilt automatically when the geometry (see MimmoObject::getRevision) or the lattice setup change.
  */
 class FFDLattice: public Lattice {
 
@@ -139,11 +147,33 @@ protected:
     dmpvecarr3E    m_gdispl;        /**< Displacements of geometry vertex.*/
 private:
     iarray3E    m_mapdeg;        /**< Map of curves degrees. Increasing order of curves degrees. */
+    ivector2D   m_mapTheo;       /**< Theoretical index of each knot, inverse map of m_mapEff */
+    std::array<bool,3> m_knotsRegular;  /**< True if the knots of the curve deviate from equal spacing by a few minimum intervals at most */
+    darray3E    m_knotsInvSpacing;      /**< Inverse of the mean knot spacing of the curve */
     bool        m_globalDispl;     /**< Choose type of displacements passed to lattice TRUE/Global XYZ displacement, False/local shape ref sys*/
     std::unordered_map<int, double> m_collect_wg; /**< temporary collector of nodal weights passed as parameter. Nodal weight can be applied by build() method */
     dmpvector1D   m_filter;        /**< Filter scalar field defined on geometry nodes for displacements modulation*/
     bool         m_bfilter;        /**< Boolean to recognize if a filter field for for displacements modulation is set or not */
 
+    /*!
+     * \struct WeightMatrix
+     * Sparse rational basis of the control nodes, evaluated on the geometry vertices included in the lattice.
+     */
+    struct WeightMatrix{
+        unsigned long   revision;   /**< revision of the geometry the matrix is evaluated on, 0 if not evaluated */
+        uint64_t        lattice;    /**< signature of the lattice setup the matrix is evaluated with */
+        livector1D      rows;       /**< ids of the geometry vertices, one per row */
+        livector1D      offsets;    /**< offsets of the rows in cols/vals, size rows+1 */
+        ivector1D       cols;       /**< full grid index of the control node of each entry */
+        dvector1D       vals;       /**< rational basis value of each entry */
+        dvecarr3E       local;      /**< local coordinates of the vertices */
+        dvecarr3E       target;     /**< global coordinates of the vertices */
+    };
+
+    bool            m_useWeightMatrix;  /**< true to deform the geometry through the precomputed weight matrix */
+    std::string     m_weightMatrixFile; /**< file of the persisted weight matrix */
+    WeightMatrix    m_wmatrix;          /**< weight matrix of the linked geometry */
+
 public:
     FFDLattice();
     FFDLattice(const bitpit::Config::Section & rootXML);
@@ -158,17 +188,21 @@ public:
     //clean structure
     void         clearLattice();
     void         clearFilter();
+    void         clearWeightMatrix();
 
     //internal methods
     ivector1D     getKnotsDimension();
     dvector1D   getWeights();
     void         returnKnotsStructure(dvector2D &, ivector2D &);
     void         returnKnotsStructure( int, dvector1D &, ivector1D &);
+    int          getKnotInterval(double, int);
     dvecarr3E*     getDisplacements();
     dmpvector1D   getFilter();
     dmpvecarr3E     getDeformation();
     bool         isDisplGlobal();
     iarray3E    getDegrees();
+    bool        isWeightMatrixActive();
+    std::string getWeightMatrixFile();
 
     void        setDegrees(iarray3E curveDegrees);
     void         setDisplacements(dvecarr3E displacements);
@@ -183,6 +217,8 @@ public:
     void         setNodalWeight(dvector1D );
 
     void        setFilter(dmpvector1D );
+    void        setWeightMatrix(bool active);
+    void        setWeightMatrixFile(std::string filename);
 
     //plotting wrappers
     void        plotGrid(std::string directory, std::string filename, int counter, bool binary, bool deformed);
@@ -194,6 +230,7 @@ public:
     darray3E     apply(darray3E & point);
     dvecarr3E     apply(dvecarr3E * point);
     dvecarr3E     apply(livector1D & map);
+    void          deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ);
 
     virtual bool         build();
 
@@ -214,17 +251,23 @@ private:
     //Nurbs Evaluators
     darray3E    nurbsEvaluator(darray3E &);
     dvecarr3E    nurbsEvaluator(livector1D &);
+    dvecarr3E    nurbsEvaluator(const dvecarr3E & targets);
     double        nurbsEvaluatorScalar(darray3E &, int);
 
     //Nurbs utilities
     dvector1D    basisITS0(int k, int pos, double coord);
+    void        basisITS0(int k, int pos, double coord, double * basis, double * left, double * right);
+    template<int D>
+    void        basisITS0Fixed(int k, int pos, double coord, double * basis);
+    template<int D0, int D1, int D2>
+    void        nurbsEvaluatorFixed(const dvecarr3E & targets, dvecarr3E & result);
     dvector1D    getNodeSpacing(int dir);
 
     //knots mantenaince utilities
     void         clearKnots();
     void         setKnotsStructure();
     void         setKnotsStructure(int dir, CoordType type);
-    int          getKnotInterval(double, int);
+    void         setKnotsLookup(int dir);
     double         getKnotValue(int, int);
     int         getKnotIndex(int,int);
     int         getTheoreticalKnotIndex(int,int);
@@ -238,6 +281,15 @@ private:
 
     //dimension utilities
     void        orderDimension();
+
+    //weight matrix utilities
+    uint64_t    latticeSignature();
+    uint64_t    geometrySignature();
+    bool        isWeightMatrixSync();
+    void        buildWeightMatrix();
+    dvecarr3E   evalWeightMatrix();
+    bool        readWeightMatrix(const std::string & filename, uint64_t lattice, uint64_t geometry);
+    bool        writeWeightMatrix(const std::string & filename, uint64_t geometry);
 };
 
 /*! Return real global index of a nodal displacement, given its position i,j,k in knots indexing logic*/
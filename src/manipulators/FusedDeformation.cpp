@@ -0,0 +1,523 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#include "FusedDeformation.hpp"
+#include "TranslationGeometry.hpp"
+#include "RotationGeometry.hpp"
+#include "ScaleGeometry.hpp"
+#include "TwistGeometry.hpp"
+#include "BendGeometry.hpp"
+#include "FFDLattice.hpp"
+#include "ManipulatorKernels.hpp"
+
+namespace mimmo{
+
+/*!
+ * Kind of a stage of the chain.
+ */
+enum class FusedStageKind{
+    TRANSLATION, ROTATION, TWIST, BEND, SCALE, LATTICE
+};
+
+/*!
+ * Pointwise stage of a fused pass, with its dense filter and its center of scaling, if any.
+ */
+struct FusedStage{
+    FusedStageKind      kind;           /**< kind of the stage */
+    BaseManipulation *  manipulator;    /**< manipulator of the stage */
+    dvector1D           filter;         /**< filter value of each vertex, in coordinates view order */
+    darray3E            center;         /**< center of scaling of a ScaleGeometry stage */
+};
+
+/*!
+ * Find the kind of a manipulator.
+ * \param[in] manipulator target manipulator
+ * \param[out] kind kind of the manipulator
+ * \return false if the manipulator is not supported by FusedDeformation
+ */
+static bool
+stageKind(BaseManipulation * manipulator, FusedStageKind & kind){
+    if(dynamic_cast<TranslationGeometry*>(manipulator))     kind = FusedStageKind::TRANSLATION;
+    else if(dynamic_cast<RotationGeometry*>(manipulator))   kind = FusedStageKind::ROTATION;
+    else if(dynamic_cast<TwistGeometry*>(manipulator))      kind = FusedStageKind::TWIST;
+    else if(dynamic_cast<BendGeometry*>(manipulator))       kind = FusedStageKind::BEND;
+    else if(dynamic_cast<ScaleGeometry*>(manipulator))      kind = FusedStageKind::SCALE;
+    else if(dynamic_cast<FFDLattice*>(manipulator))         kind = FusedStageKind::LATTICE;
+    else return false;
+    return true;
+}
+
+/*!
+ * Get the filter field of a supported manipulator.
+ * \param[in] manipulator target manipulator
+ * \param[in] kind kind of the manipulator
+ * \return filter field
+ */
+static dmpvector1D
+stageFilter(BaseManipulation * manipulator, FusedStageKind kind){
+    switch(kind){
+    case FusedStageKind::TRANSLATION:   return static_cast<TranslationGeometry*>(manipulator)->getFilter();
+    case FusedStageKind::ROTATION:      return static_cast<RotationGeometry*>(manipulator)->getFilter();
+    case FusedStageKind::TWIST:         return static_cast<TwistGeometry*>(manipulator)->getFilter();
+    case FusedStageKind::BEND:          return static_cast<BendGeometry*>(manipulator)->getFilter();
+    case FusedStageKind::SCALE:         return static_cast<ScaleGeometry*>(manipulator)->getFilter();
+    default:                            return static_cast<FFDLattice*>(manipulator)->getFilter();
+    }
+}
+
+/*!
+ * Apply a sequence of pointwise stages to a list of points, in a single pass.
+ * Points are partitioned in blocks, distributed among the available threads (if mimmo is compiled
+ * with OpenMP support); each block is deformed by all the stages in sequence. Points are moved
+ * as in MimmoObject::applyDisplacements after each stage, so results match the sequential chain.
+ * \param[in] stages pointwise stages, in order of application
+ * \param[in,out] points coordinates of the points
+ */
+static void
+deformPointwise(std::vector<FusedStage> & stages, dvecarr3E & points){
+
+    if(stages.empty())  return;
+
+    const long blockSize = manipulatorKernels::BLOCK_SIZE;
+    long n = points.size();
+    long nblocks = (n + blockSize - 1) / blockSize;
+
+#pragma omp parallel
+    {
+        dvecarr3E displ(blockSize);
+
+#pragma omp for schedule(static)
+        for(long ib=0; ib<nblocks; ++ib){
+
+            long start = ib*blockSize;
+            long nb = std::min(blockSize, n - start);
+            darray3E * pts = points.data() + start;
+
+            for(FusedStage & stage : stages){
+                const double * filter = stage.filter.data() + start;
+                switch(stage.kind){
+                case FusedStageKind::TRANSLATION:
+                    static_cast<TranslationGeometry*>(stage.manipulator)->deformPoints(nb, pts, filter, displ.data());
+                    break;
+                case FusedStageKind::ROTATION:
+                    static_cast<RotationGeometry*>(stage.manipulator)->deformPoints(nb, pts, filter, displ.data());
+                    break;
+                case FusedStageKind::TWIST:
+                    static_cast<TwistGeometry*>(stage.manipulator)->deformPoints(nb, pts, filter, displ.data());
+                    break;
+                case FusedStageKind::BEND:
+                    static_cast<BendGeometry*>(stage.manipulator)->deformPoints(nb, pts, filter, displ.data());
+                    break;
+                case FusedStageKind::SCALE:
+                    static_cast<ScaleGeometry*>(stage.manipulator)->deformPoints(nb, pts, filter, stage.center, displ.data());
+                    break;
+                default:
+                    break;
+                }
+                for(long i=0; i<nb; ++i){
+                    for(int j=0; j<3; ++j){
+                        pts[i][j] += displ[i][j];
+                    }
+                }
+            }
+        }
+    }
+
+    stages.clear();
+}
+
+/*!
+ * Default constructor of FusedDeformation
+ */
+FusedDeformation::FusedDeformation(){
+    m_name = "mimmo.FusedDeformation";
+    m_revision = 0;
+};
+
+/*!
+ * Custom constructor reading xml data
+ * \param[in] rootXML reference to your xml tree section
+ */
+FusedDeformation::FusedDeformation(const bitpit::Config::Section & rootXML){
+
+    m_name = "mimmo.FusedDeformation";
+    m_revision = 0;
+
+    std::string fallback_name = "ClassNONE";
+    std::string input = rootXML.get("ClassName", fallback_name);
+    input = bitpit::utils::string::trim(input);
+    if(input == "mimmo.FusedDeformation"){
+        absorbSectionXML(rootXML);
+    }else{
+        warningXML(m_log, m_name);
+    };
+}
+
+/*!Default destructor of FusedDeformation
+ */
+FusedDeformation::~FusedDeformation(){};
+
+/*!Copy constructor of FusedDeformation. Manipulators are shared, no result geometry displacements are copied.
+ */
+FusedDeformation::FusedDeformation(const FusedDeformation & other):BaseManipulation(other){
+    m_stages = other.m_stages;
+    m_stageNames = other.m_stageNames;
+    m_revision = 0;
+};
+
+/*!Assignment operator of FusedDeformation. Manipulators are shared, no result geometry displacements are copied.
+ */
+FusedDeformation & FusedDeformation::operator=(FusedDeformation other){
+    swap(other);
+    return *this;
+};
+
+/*!
+ * Swap function
+ * \param[in] x object to be swapped
+ */
+void FusedDeformation::swap(FusedDeformation & x) noexcept
+{
+    std::swap(m_stages, x.m_stages);
+    m_displ.swap(x.m_displ);
+    std::swap(m_deformed, x.m_deformed);
+    std::swap(m_revision, x.m_revision);
+    std::swap(m_stageNames, x.m_stageNames);
+    BaseManipulation::swap(x);
+}
+
+/*! It builds the input/output ports of the object
+ */
+void
+FusedDeformation::buildPorts(){
+    bool built = true;
+    built = (built && createPortIn<MimmoObject*, FusedDeformation>(&m_geometry, M_GEOM, true));
+    built = (built && createPortOut<dmpvecarr3E, FusedDeformation>(this, &mimmo::FusedDeformation::getDisplacements, M_GDISPLS));
+    built = (built && createPortOut<MimmoObject*, FusedDeformation>(this, &BaseManipulation::getGeometry, M_GEOM));
+    m_arePortsBuilt = built;
+};
+
+/*!It appends a manipulator to the chain. Supported manipulators are TranslationGeometry, RotationGeometry,
+ * TwistGeometry, BendGeometry, ScaleGeometry and FFDLattice; others are ignored with a warning.
+ * The manipulator is not owned by FusedDeformation.
+ * \param[in] manipulator pointer to the manipulator
+ */
+void
+FusedDeformation::addManipulator(BaseManipulation * manipulator){
+    FusedStageKind kind;
+    if(manipulator == NULL || !stageKind(manipulator, kind)){
+        (*m_log)<<"warning: "<<m_name<<" cannot fuse manipulator "<<(manipulator ? manipulator->getName() : "NULL")<<". Skipped"<<std::endl;
+        return;
+    }
+    m_stages.push_back(manipulator);
+}
+
+/*!It removes all the manipulators of the chain.
+ */
+void
+FusedDeformation::clearManipulators(){
+    m_stages.clear();
+}
+
+/*!
+ * \return manipulators of the chain, in order of application
+ */
+std::vector<BaseManipulation*>
+FusedDeformation::getManipulators(){
+    return m_stages;
+}
+
+/*!It sets the names of the blocks of an XML dictionary to be used as stages, in order of application.
+ * Names are resolved into manipulators by resolveStages.
+ * \param[in] names names of the blocks
+ */
+void
+FusedDeformation::setStageNames(svector1D names){
+    m_stageNames = names;
+}
+
+/*!
+ * \return names of the blocks of an XML dictionary to be used as stages
+ */
+svector1D
+FusedDeformation::getStageNames(){
+    return m_stageNames;
+}
+
+/*!It replaces the manipulators of the chain with the blocks named in the stage names, in the same order.
+ * Stage blocks are not executed in the workflow, so they cannot be connected to other blocks:
+ * their parents would not be scheduled before FusedDeformation and their children would never be fed.
+ * \param[in] blocks map of the available blocks, by name
+ */
+void
+FusedDeformation::resolveStages(const std::unordered_map<std::string, BaseManipulation*> & blocks){
+    clearManipulators();
+    for(const std::string & name : m_stageNames){
+        auto it = blocks.find(name);
+        if(it == blocks.end() || it->second == NULL){
+            throw std::runtime_error (m_name + " : stage block " + name + " not found");
+        }
+        if(it->second->getNParent() > 0 || it->second->getNChild() > 0){
+            throw std::runtime_error (m_name + " : stage block " + name + " cannot be connected, set its parameters in its own section");
+        }
+        addManipulator(it->second);
+    }
+}
+
+/*!
+ * \return geometries involved by the block: the linked geometry and the geometries of the stages.
+ */
+std::vector<MimmoObject*>
+FusedDeformation::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = BaseManipulation::getInvolvedGeometries();
+    for(BaseManipulation * manipulator : m_stages){
+        std::vector<MimmoObject*> stageGeometries = manipulator->getInvolvedGeometries();
+        result.insert(result.end(), stageGeometries.begin(), stageGeometries.end());
+    }
+    return result;
+}
+
+/*!
+ * Return actual computed displacements field (if any) for the geometry linked.
+ * \return  deformation field
+ */
+dmpvecarr3E
+FusedDeformation::getDisplacements(){
+    return m_displ;
+};
+
+/*!Execution command. It evaluates the chain of manipulators on the vertices of the geometry,
+ * fusing consecutive pointwise stages in a single pass, and stores the total displacements.
+ */
+void
+FusedDeformation::execute(){
+
+    if (getGeometry() == NULL){
+        throw std::runtime_error (m_name + " : NULL pointer to linked geometry");
+    }
+    if (getGeometry()->isEmpty()){
+        throw std::runtime_error (m_name + " : empty linked geometry");
+    }
+
+    bool anyActive = false;
+    for (BaseManipulation * manipulator : m_stages){
+        anyActive = anyActive || manipulator->isActive();
+    }
+    if(!anyActive){
+        (*m_log)<<"warning: "<<m_name<<" : no active manipulator in the chain, null displacements"<<std::endl;
+    }
+
+    const CoordinatesView & coords = getGeometry()->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices);
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+    }
+
+    std::vector<FusedStage> pointwise;
+    for (BaseManipulation * manipulator : m_stages){
+
+        if(!manipulator->isActive())    continue;
+
+        FusedStage stage;
+        stageKind(manipulator, stage.kind);
+        stage.manipulator = manipulator;
+        evalStageFilter(stageFilter(manipulator, stage.kind), coords.ids, stage.filter);
+
+        if(stage.kind == FusedStageKind::LATTICE){
+            //barrier: the lattice classifies the whole deformed geometry
+            deformPointwise(pointwise, points);
+            deformLattice(static_cast<FFDLattice*>(manipulator), stage.filter, points);
+            continue;
+        }
+
+        if(stage.kind == FusedStageKind::SCALE){
+            ScaleGeometry * scale = static_cast<ScaleGeometry*>(manipulator);
+            //barrier: the mean point is evaluated on the whole deformed geometry
+            if(scale->isMeanPoint())    deformPointwise(pointwise, points);
+            stage.center = scale->evalCenter(nVertices, points.data());
+        }
+        pointwise.push_back(std::move(stage));
+    }
+    deformPointwise(pointwise, points);
+
+    m_displ.clear();
+    m_displ.setDataLocation(mimmo::MPVLocation::POINT);
+    m_displ.reserve(nVertices);
+    m_displ.setGeometry(getGeometry());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], points[i] - coords.getCoords(i));
+    }
+
+    m_deformed.swap(points);
+    m_revision = getGeometry()->getRevision();
+};
+
+/*!
+ * Directly apply deformation field to target geometry.
+ * If the geometry is unchanged since the execution, the final coordinates of the chain
+ * are written to the vertices, otherwise the displacements are applied.
+ */
+void
+FusedDeformation::apply(){
+
+    if (getGeometry() == NULL) return;
+    if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
+
+    if (m_revision != 0 && m_revision == getGeometry()->getRevision() && long(m_deformed.size()) == getGeometry()->getNVertex()){
+        CoordinatesView & coords = getGeometry()->editCoordinatesView();
+        long nVertices = coords.size();
+        for (long i=0; i<nVertices; ++i){
+            coords.setCoords(i, m_deformed[i]);
+        }
+        if (getGeometry()->commitCoordinatesView()) return;
+    }
+    getGeometry()->applyDisplacements(m_displ);
+}
+
+/*!
+ * Evaluate the dense filter of a stage, as the manipulator would do on the geometry:
+ * if the filter field is not related to the target geometry, a unitary filter is used.
+ * \param[in] source filter field of the manipulator
+ * \param[in] ids unique-id of the vertices, in coordinates view order
+ * \param[out] filter filter value of each vertex
+ */
+void
+FusedDeformation::evalStageFilter(dmpvector1D source, const livector1D & ids, dvector1D & filter){
+
+    bool check = source.getDataLocation() == mimmo::MPVLocation::POINT;
+    check = check && source.completeMissingData(0.0);
+    check = check && source.getGeometry() == getGeometry();
+
+    filter.resize(ids.size());
+    if (!check){
+        std::fill(filter.begin(), filter.end(), 1.0);
+        return;
+    }
+    for (std::size_t i=0; i<ids.size(); ++i){
+        filter[i] = source[ids[i]];
+    }
+}
+
+/*!
+ * Apply a FFDLattice stage to the current coordinates of the vertices.
+ * Included vertices are found as in FFDLattice::apply(livector1D &): for geometries with
+ * cells, vertices of the cells entirely included in the lattice shape, otherwise
+ * the vertices included in the shape.
+ * \param[in] lattice FFDLattice of the stage
+ * \param[in] filter filter value of each vertex
+ * \param[in,out] points coordinates of the vertices, in coordinates view order
+ */
+void
+FusedDeformation::deformLattice(FFDLattice * lattice, const dvector1D & filter, dvecarr3E & points){
+
+    if(!lattice->isBuilt()){
+        lattice->build();
+    }
+
+    std::vector<uint8_t> mask = lattice->getShape()->classifyPoints(points);
+
+    MimmoObject * container = getGeometry();
+    if(container->isSkdTreeSupported()){
+        const CoordinatesView & coords = container->getCoordinatesView();
+        std::vector<uint8_t> cellMask(points.size(), 0);
+        for(const auto & cell : container->getCells()){
+            bitpit::ConstProxyVector<long> vIds = cell.getVertexIds();
+            bool included = true;
+            for(const auto & idV : vIds){
+                included = included && mask[coords.index.at(idV)];
+            }
+            if(!included)   continue;
+            for(const auto & idV : vIds){
+                cellMask[coords.index.at(idV)] = 1;
+            }
+        }
+        mask.swap(cellMask);
+    }
+
+    livector1D list;
+    dvecarr3E targets;
+    dvector1D targetFilter;
+    for(std::size_t i=0; i<points.size(); ++i){
+        if(!mask[i])    continue;
+        list.push_back(i);
+        targets.push_back(points[i]);
+        targetFilter.push_back(filter[i]);
+    }
+
+    long n = list.size();
+    dvecarr3E displ(n);
+    lattice->deformPoints(n, targets.data(), targetFilter.data(), displ.data());
+    for(long i=0; i<n; ++i){
+        for(int j=0; j<3; ++j){
+            points[list[i]][j] += displ[i][j];
+        }
+    }
+}
+
+/*!
+ * It sets infos reading from a XML bitpit::Config::section.
+ * Manipulators of the chain are read as block names, see resolveStages.
+ * \param[in] slotXML bitpit::Config::Section of XML file
+ * \param[in] name   name associated to the slot
+ */
+void
+FusedDeformation::absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name){
+
+    BITPIT_UNUSED(name);
+    BaseManipulation::absorbSectionXML(slotXML, name);
+
+    if(slotXML.hasOption("Stages")){
+        std::string input = slotXML.get("Stages");
+        std::stringstream ss(bitpit::utils::string::trim(input));
+        svector1D names;
+        std::string stage;
+        while(ss >> stage){
+            names.push_back(stage);
+        }
+        setStageNames(names);
+    }
+};
+
+/*!
+ * It sets infos from class members in a XML bitpit::Config::section.
+ * \param[in] slotXML bitpit::Config::Section of XML file
+ * \param[in] name   name associated to the slot
+ */
+void
+FusedDeformation::flushSectionXML(bitpit::Config::Section & slotXML, std::string name){
+
+    BITPIT_UNUSED(name);
+    BaseManipulation::flushSectionXML(slotXML, name);
+
+    if(!m_stageNames.empty()){
+        std::stringstream ss;
+        for(std::size_t i=0; i<m_stageNames.size(); ++i){
+            if(i > 0)   ss<<" ";
+            ss<<m_stageNames[i];
+        }
+        slotXML.set("Stages", ss.str());
+    }
+};
+
+}
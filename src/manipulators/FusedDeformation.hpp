@@ -0,0 +1,145 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __FUSEDDEFORMATION_HPP__
+#define __FUSEDDEFORMATION_HPP__
+
+#include "BaseManipulation.hpp"
+
+namespace mimmo{
+
+class FFDLattice;
+
+/*!
+ *    \class FusedDeformation
+ *    \ingroup manipulators
+ *    \brief FusedDeformation applies a chain of manipulators to a geometry in a single pass over its vertices.
+ *
+ *    A chain of manipulators, each one followed by an Apply block, sweeps the whole geometry and
+ *    rebuilds its search trees once per stage. FusedDeformation evaluates the same chain, in the order
+ *    the manipulators are added, on a dense copy of the vertex coordinates: consecutive pointwise stages
+ *    (TranslationGeometry, RotationGeometry, TwistGeometry, BendGeometry, ScaleGeometry with a fixed center)
+ *    are applied to each block of vertices one after the other while the block is in cache.
+ *    Stages needing the whole deformed geometry are barriers closing the fused pass:
+ *    - FFDLattice, whose vertices to be deformed are classified on the current coordinates
+ *      with the same rule of FFDLattice::apply (vertices of cells entirely included in the lattice shape);
+ *    - ScaleGeometry with the mean point as center, evaluated on the current coordinates.
+ *
+ *    Each stage uses its own parameters and filter field; a filter field has to refer to
+ *    the geometry linked to FusedDeformation, otherwise a unitary field is used. Manipulators
+ *    need no linked geometry and are not executed: their own displacements are not updated.
+ *    Inactive manipulators are skipped. The FFDLattice weight matrix mode is not used,
+ *    the lattice is evaluated directly on the deformed coordinates.
+ *    Unsupported manipulators are skipped with a warning.
+ *
+ *    The result is the total displacement field of the chain. If apply is active, the final coordinates
+ *    are written to the geometry, matching the sequential chain followed by its Apply blocks.
+ *
+ * \n
+ * Ports available in FusedDeformation Class :
+ *
+ *    =========================================================
+
+     |Port Input | | |
+     |-|-|-|
+     | <B>PortType</B>   | <B>variable/function</B>  |<B>DataType</B> |
+     | M_GEOM   | setGeometry       | (MC_SCALAR, MD_MIMMO_)      |
+
+     |Port Output | | |
+     |-|-|-|
+     | <B>PortType</B> | <B>variable/function</B> |<B>DataType</B>|
+     | M_GDISPLS | getDisplacements  | (MC_MPVECARR3, MD_FLOAT)      |
+     | M_GEOM   | getGeometry       | (MC_SCALAR,MD_MIMMO_) |
+
+ *    =========================================================
+ * \n
+ *
+ * The xml available parameters, sections and subsections are the following :
+ *
+ * Inherited from BaseManipulation:
+ * - <B>ClassName</B>: name of the class as <tt>mimmo.FusedDeformation</tt>;
+ * - <B>Priority</B>: uint marking priority in multi-chain execution;
+ * - <B>Apply</B>: boolean 0/1 activate apply deformation result on target geometry directly in execution;
+ *
+ * Proper of the class:
+ * - <B>Stages</B>: names of the blocks of the XML dictionary to be used as stages, separated by blanks, in order of application.
+ *
+ * Geometry has to be mandatorily passed through port. Manipulators have to be added with addManipulator or,
+ * in XML workflows, listed by block name in Stages: the mimmo++ executable resolves them with resolveStages
+ * and removes them from the execution chains, so that they are evaluated only by FusedDeformation.
+ * Their parameters have to be set in their own XML sections: stage blocks with connections are rejected.
+ *
+ */
+class FusedDeformation: public BaseManipulation{
+private:
+    //members
+    std::vector<BaseManipulation*>  m_stages;       /**<Manipulators of the chain, in order of application. */
+    dmpvecarr3E                     m_displ;        /**<Resulting displacements of geometry vertex.*/
+    dvecarr3E                       m_deformed;     /**<Final coordinates of the vertices, in coordinates view order. */
+    unsigned long                   m_revision;     /**<Revision of the geometry m_deformed refers to. */
+    svector1D                       m_stageNames;   /**<Names of the XML blocks to be used as stages. */
+
+public:
+    FusedDeformation();
+    FusedDeformation(const bitpit::Config::Section & rootXML);
+    ~FusedDeformation();
+
+    FusedDeformation(const FusedDeformation & other);
+    FusedDeformation & operator=(FusedDeformation other);
+
+    void        buildPorts();
+
+    void        addManipulator(BaseManipulation * manipulator);
+    void        clearManipulators();
+    std::vector<BaseManipulation*> getManipulators();
+    void        setStageNames(svector1D names);
+    svector1D   getStageNames();
+    void        resolveStages(const std::unordered_map<std::string, BaseManipulation*> & blocks);
+
+    dmpvecarr3E   getDisplacements();
+
+    void         execute();
+    void         apply();
+
+    virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name = "");
+    virtual void flushSectionXML(bitpit::Config::Section & slotXML, std::string name= "");
+
+    std::vector<MimmoObject*> getInvolvedGeometries();
+
+protected:
+    void swap(FusedDeformation & x) noexcept;
+
+private:
+    void        evalStageFilter(dmpvector1D source, const livector1D & ids, dvector1D & filter);
+    void        deformLattice(FFDLattice * lattice, const dvector1D & filter, dvecarr3E & points);
+};
+
+REGISTER_PORT(M_GEOM, MC_SCALAR, MD_MIMMO_,__FUSEDDEFORMATION_HPP__)
+REGISTER_PORT(M_GDISPLS, MC_MPVECARR3, MD_FLOAT,__FUSEDDEFORMATION_HPP__)
+
+
+REGISTER(BaseManipulation, FusedDeformation, "mimmo.FusedDeformation")
+
+};
+
+#endif /* __FUSEDDEFORMATION_HPP__ */
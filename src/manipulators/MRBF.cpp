@@ -23,11 +23,129 @@
  \ *---------------------------------------------------------------------------*/
 
 #include "MRBF.hpp"
+#include "mimmo_private_lapacke.hpp"
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 using namespace bitpit;
 namespace mimmo{
 
+/*!
+ * \brief Cluster of RBF nodes used by MRBF evaluation engine.
+ *
+ * Clusters are arranged in a binary tree built by recursive median bisection
+ * of the active RBF nodes along their longest extent. Each cluster stores its bounding
+ * sphere and the moments up to second order of the node weights with respect to
+ * its center, used by the far-field expansion of the kernel.
+ */
+struct RBFNodeCluster{
+	int         begin;      /**< first position of cluster nodes in the sorted node list */
+	int         end;        /**< past-the-end position of cluster nodes in the sorted node list */
+	int         left;       /**< index of first child cluster, -1 for leaves */
+	int         right;      /**< index of second child cluster, -1 for leaves */
+	darray3E    center;     /**< centroid of cluster nodes */
+	double      radius;     /**< radius of the cluster bounding sphere */
+	dvector1D   weight;     /**< sum of node weights for each field */
+	dvecarr3E   moment;     /**< first order moments of node weights for each field */
+	std::vector<std::array<double,6> > quadrupole; /**< second order moments xx,yy,zz,xy,xz,yz of node weights for each field */
+};
+
+/*!
+ * Build the binary tree of clusters of RBF nodes.
+ * \param[in,out] list indices of the active nodes, reordered so that each cluster owns a contiguous range
+ * \param[in] nodes RBF node coordinates
+ * \param[in] weights RBF weights, arranged as [field][node]
+ * \param[in] leafSize maximum number of nodes in a leaf cluster
+ * \return list of clusters, the root being the first one
+ */
+static std::vector<RBFNodeCluster>
+buildRBFNodeTree(ivector1D & list, const dvecarr3E & nodes, const dvector2D & weights, int leafSize){
+
+	std::vector<RBFNodeCluster> tree;
+	if(list.empty())   return tree;
+	int nfields = int(weights.size());
+
+	tree.reserve(2*(list.size()/leafSize + 1));
+	RBFNodeCluster root;
+	root.begin = 0;
+	root.end = int(list.size());
+	tree.push_back(root);
+
+	std::vector<int> stack(1, 0);
+	while(!stack.empty()){
+		int k = stack.back();
+		stack.pop_back();
+		int begin = tree[k].begin;
+		int end = tree[k].end;
+
+		darray3E center = {{0.0, 0.0, 0.0}};
+		darray3E pmin, pmax;
+		pmin.fill(std::numeric_limits<double>::max());
+		pmax.fill(-std::numeric_limits<double>::max());
+		for(int i=begin; i<end; ++i){
+			const darray3E & node = nodes[list[i]];
+			center += node;
+			for(int j=0; j<3; ++j){
+				pmin[j] = std::min(pmin[j], node[j]);
+				pmax[j] = std::max(pmax[j], node[j]);
+			}
+		}
+		center /= double(end - begin);
+
+		double radius = 0.0;
+		dvector1D weight(nfields, 0.0);
+		dvecarr3E moment(nfields, darray3E({{0.0, 0.0, 0.0}}));
+		std::vector<std::array<double,6> > quadrupole(nfields, std::array<double,6>({{0.0, 0.0, 0.0, 0.0, 0.0, 0.0}}));
+		for(int i=begin; i<end; ++i){
+			darray3E delta = nodes[list[i]] - center;
+			radius = std::max(radius, norm2(delta));
+			for(int f=0; f<nfields; ++f){
+				double w = weights[f][list[i]];
+				weight[f] += w;
+				moment[f] += w * delta;
+				quadrupole[f][0] += w * delta[0] * delta[0];
+				quadrupole[f][1] += w * delta[1] * delta[1];
+				quadrupole[f][2] += w * delta[2] * delta[2];
+				quadrupole[f][3] += w * delta[0] * delta[1];
+				quadrupole[f][4] += w * delta[0] * delta[2];
+				quadrupole[f][5] += w * delta[1] * delta[2];
+			}
+		}
+		tree[k].center = center;
+		tree[k].radius = radius;
+		tree[k].weight.swap(weight);
+		tree[k].moment.swap(moment);
+		tree[k].quadrupole.swap(quadrupole);
+		tree[k].left = -1;
+		tree[k].right = -1;
+
+		if(end - begin <= leafSize || radius <= 0.0)   continue;
+
+		int dir = 0;
+		for(int j=1; j<3; ++j){
+			if(pmax[j] - pmin[j] > pmax[dir] - pmin[dir])  dir = j;
+		}
+		int mid = begin + (end - begin)/2;
+		std::nth_element(list.begin()+begin, list.begin()+mid, list.begin()+end,
+				[&nodes, dir](int a, int b){return nodes[a][dir] < nodes[b][dir];});
+
+		RBFNodeCluster child;
+		child.begin = begin;
+		child.end = mid;
+		tree[k].left = int(tree.size());
+		tree.push_back(child);
+		child.begin = mid;
+		child.end = end;
+		tree[k].right = int(tree.size());
+		tree.push_back(child);
+
+		stack.push_back(tree[k].left);
+		stack.push_back(tree[k].right);
+	}
+	return tree;
+}
+
 
 /*! Default Constructor.*/
 MRBF::MRBF(){
@@ -37,6 +155,11 @@ MRBF::MRBF(){
 	setMode(MRBFSol::NONE);
 	m_bfilter = false;
 	m_SRRatio = -1.0;
+	m_farFieldAccuracy = 0.0;
+	m_krylov = false;
+	m_useOperator = true;
+	m_operatorMemory = 512.0;
+	clearOperatorCache();
 };
 
 /*!
@@ -51,6 +174,11 @@ MRBF::MRBF(const bitpit::Config::Section & rootXML){
 	setMode(MRBFSol::NONE);
 	m_bfilter = false;
 	m_SRRatio = -1.0;
+	m_farFieldAccuracy = 0.0;
+	m_krylov = false;
+	m_useOperator = true;
+	m_operatorMemory = 512.0;
+	clearOperatorCache();
 
 	std::string fallback_name = "ClassNONE";
 	std::string input = rootXML.get("ClassName", fallback_name);
@@ -65,7 +193,7 @@ MRBF::MRBF(const bitpit::Config::Section & rootXML){
 /*! Default Destructor */
 MRBF::~MRBF(){};
 
-/*! Copy Constructor. Result geometry displacement are not copied.
+/*! Copy Constructor. Result geometry displacement and cached kernel matrix are not copied.
  *\param[in] other MRBF where copy from
  */
 MRBF::MRBF(const MRBF & other):BaseManipulation(other), bitpit::RBF(other){
@@ -74,6 +202,11 @@ MRBF::MRBF(const MRBF & other):BaseManipulation(other), bitpit::RBF(other){
 	m_SRRatio  = other.m_SRRatio;
 	m_supRIsValue = other.m_supRIsValue;
 	m_bfilter = other.m_bfilter;
+	m_farFieldAccuracy = other.m_farFieldAccuracy;
+	m_krylov = other.m_krylov;
+	m_useOperator = other.m_useOperator;
+	m_operatorMemory = other.m_operatorMemory;
+	clearOperatorCache();
 	if(m_bfilter)    m_filter = other.m_filter;
 };
 
@@ -96,6 +229,11 @@ void MRBF::swap(MRBF & x) noexcept
 	std::swap(m_SRRatio , x.m_SRRatio);
 	std::swap(m_supRIsValue, x.m_supRIsValue);
 	std::swap(m_bfilter, x.m_bfilter);
+	std::swap(m_farFieldAccuracy, x.m_farFieldAccuracy);
+	std::swap(m_krylov, x.m_krylov);
+	std::swap(m_useOperator, x.m_useOperator);
+	std::swap(m_operatorMemory, x.m_operatorMemory);
+	std::swap(m_operator, x.m_operator);
 	//    std::swap(m_filter, x.m_filter);
 	//    std::swap(m_displ, x.m_displ);
 	m_filter.swap(x.m_filter);
@@ -211,6 +349,42 @@ MRBF::getIsSupportRadiusValue(){
 	return(m_supRIsValue);
 }
 
+/*!
+ * It gets the opening ratio used by the far-field approximation of non compact RBF kernels.
+ * \return far-field accuracy, 0 if evaluation is exact
+ */
+double
+MRBF::getFarFieldAccuracy(){
+	return(m_farFieldAccuracy);
+}
+
+/*!
+ * It gets if non compact RBF kernels are solved with the iterative solver in MRBFSol::WHOLE mode.
+ * \return true if the iterative solver is used for non compact kernels
+ */
+bool
+MRBF::isKrylovSolver(){
+	return(m_krylov);
+}
+
+/*!
+ * It gets if the kernel matrix between vertices and nodes is cached in MRBFSol::NONE mode.
+ * \return true if the kernel matrix is cached
+ */
+bool
+MRBF::isOperatorCacheActive(){
+	return(m_useOperator);
+}
+
+/*!
+ * It gets the memory budget of the cached kernel matrix.
+ * \return memory budget in MB
+ */
+double
+MRBF::getOperatorCacheMemory(){
+	return(m_operatorMemory);
+}
+
 /*!
  * Return actual computed displacements field (if any) for the geometry linked.
  * \return     The computed deformation field on the vertices of the linked geometry
@@ -296,7 +470,7 @@ void
 MRBF::setFilter(dmpvector1D filter){
 	m_filter.clear();
 	m_bfilter = !(filter.empty());
-	m_filter = filter;
+	m_filter = std::move(filter);
 };
 
 
@@ -382,6 +556,55 @@ MRBF::setTol(double tol){
 	m_tol = tol;
 }
 
+/*!
+ * It sets the accuracy of the far-field approximation used to evaluate non compact RBF kernels.
+ * A cluster of RBF nodes of radius r seen from a distance d is evaluated with a second order
+ * expansion of the kernel around its center if r < theta*d. Lower values give more accurate
+ * and slower evaluations; 0 (default) disables the approximation. Kernels with compact support
+ * are always evaluated exactly.
+ * \param[in] theta opening ratio in [0,1)
+ */
+void
+MRBF::setFarFieldAccuracy(double theta){
+	m_farFieldAccuracy = std::min(std::max(0.0, theta), 0.99);
+}
+
+/*!
+ * It enables the matrix-free preconditioned GMRES solver for non compact RBF kernels
+ * in MRBFSol::WHOLE mode, in place of the dense direct solver of bitpit::RBF.
+ * Memory requirements drop from quadratic to linear in the number of nodes.
+ * Kernels with compact support always use the sparse iterative solver.
+ * \param[in] flag true to enable the iterative solver
+ */
+void
+MRBF::setKrylovSolver(bool flag){
+	m_krylov = flag;
+}
+
+/*!
+ * It enables the cache of the kernel matrix between geometry vertices and active RBF nodes
+ * in MRBFSol::NONE mode (default true). The matrix is evaluated when two consecutive executions
+ * share the same setup; following executions with different weights only need the product of
+ * the cached matrix with the weights.
+ * \param[in] flag true to enable the cache
+ */
+void
+MRBF::setOperatorCache(bool flag){
+	m_useOperator = flag;
+	if(!flag)   clearOperatorCache();
+}
+
+/*!
+ * It sets the memory budget of the cached kernel matrix (default 512 MB). If the matrix
+ * exceeds the budget it is not stored and RBF displacements are evaluated on the fly.
+ * \param[in] memory memory budget in MB
+ */
+void
+MRBF::setOperatorCacheMemory(double memory){
+	m_operatorMemory = std::max(0.0, memory);
+	clearOperatorCache();
+}
+
 /*!
  * Set a field  of 3D displacements on your RBF Nodes. According to MRBFSol mode
  * active in the class set: displacements as direct RBF weights coefficients in MRBFSol::NONE mode,
@@ -467,6 +690,17 @@ MRBF::clearFilter(){
 	m_bfilter = false;
 };
 
+/*!Clean the cached kernel matrix. It will be evaluated again at next execution in MRBFSol::NONE mode */
+void
+MRBF::clearOperatorCache(){
+	m_operator = RBFOperator();
+	m_operator.revision = 0;
+	m_operator.radius = 0.0;
+	m_operator.pending = false;
+	m_operator.onTheFly = false;
+	m_operator.sparse = false;
+};
+
 /*!
  * Set a field  of n-Dim weights on your RBF Nodes. Supported only in MRBFSol::NONE mode.
  * Weights total number may not match the actual number of RBF nodes stored in the class.
@@ -568,7 +802,10 @@ MRBF::execute(){
 	const double radius = distance;
 	RBF::setSupportRadius(radius);
 
-	if (m_solver == MRBFSol::WHOLE)    solve();
+	if (m_solver == MRBFSol::WHOLE){
+		if(m_krylov || hasCompactSupport())    solveKrylov();
+		else                                    solve();
+	}
 	if (m_solver == MRBFSol::GREEDY)    greedy(m_tol);
 
 	m_displ.clear();
@@ -576,13 +813,25 @@ MRBF::execute(){
 	m_displ.reserve(getGeometry()->getNVertex());
 	m_displ.setGeometry(getGeometry());
 
-	dvector1D displ;
-	darray3E adispl;
-	for(const auto & vertex : container->getVertices()){
-		displ = RBF::evalRBF(vertex.getCoords());
-		for (int j=0; j<3; ++j)
-			adispl[j] = displ[j];
-		m_displ.insert(vertex.getId(), adispl);
+	const CoordinatesView & coords = container->getCoordinatesView();
+	long nVertices = coords.size();
+	dvecarr3E points(nVertices);
+	for(long i=0; i<nVertices; ++i){
+		points[i] = coords.getCoords(i);
+	}
+
+	dvecarr3E displ;
+	if(m_solver == MRBFSol::NONE && m_useOperator){
+		//the kernel matrix is evaluated at the second consecutive request of the same setup.
+		if(!isOperatorSync())          resetOperator();
+		else if(m_operator.pending)    buildOperator(points);
+		if(m_operator.pending || m_operator.onTheFly)  displ = evaluateDisplacements(points);
+		else                                            displ = evaluateOperator();
+	}else{
+		displ = evaluateDisplacements(points);
+	}
+	for(long i=0; i<nVertices; ++i){
+		m_displ.insert(coords.ids[i], displ[i]);
 	}
 
 	//if m_filter is active;
@@ -607,14 +856,7 @@ MRBF::apply(){
 
 	if (getGeometry() == NULL) return;
 	if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-	darray3E vertexcoords;
-	long int ID;
-	for (const auto & vertex : m_geometry->getVertices()){
-		vertexcoords = vertex.getCoords();
-		ID = vertex.getId();
-		vertexcoords += m_displ[ID];
-		getGeometry()->modifyVertex(vertexcoords, ID);
-	}
+	getGeometry()->applyDisplacements(m_displ);
 
 }
 
@@ -643,6 +885,626 @@ MRBF::checkFilter(){
 	}
 }
 
+/*!
+ * Check if the current RBF kernel has compact support, i.e. it vanishes for
+ * normalized distances greater than 1. The check samples the kernel outside the support.
+ * \return true if the kernel has compact support
+ */
+bool
+MRBF::hasCompactSupport(){
+	const double samples[] = {1.0+1.0E-9, 1.001, 1.01, 1.1, 1.5, 2.0, 3.0, 5.0, 10.0, 100.0, 1.0E+4};
+	for(double s : samples){
+		if(evalBasis(s) != 0.0)    return false;
+	}
+	return true;
+}
+
+/*!
+ * Evaluate the RBF displacements on a list of points, using the current weights and support radius.
+ * Active RBF nodes are clustered in a binary tree: for kernels with compact support
+ * only clusters intersecting the support radius of each point are visited; for global kernels
+ * far clusters are approximated with a second order expansion according to the far-field accuracy set.
+ * Evaluation is performed in parallel over the points.
+ * \param[in] points list of evaluation points
+ * \return displacements evaluated on points
+ */
+dvecarr3E
+MRBF::evaluateDisplacements(const dvecarr3E & points){
+
+	int npoints = int(points.size());
+	dvecarr3E result(npoints, darray3E({{0.0, 0.0, 0.0}}));
+	int nfields = std::min(getDataCount(), 3);
+	if(npoints == 0 || nfields <= 0)   return result;
+
+	ivector1D list = getActiveSet();
+	if(list.empty())   return result;
+
+	const double radius = RBF::getSupportRadius();
+	const bool compact = hasCompactSupport();
+	const double theta = compact ? 0.0 : m_farFieldAccuracy;
+
+	dvector2D weights(m_weight.begin(), m_weight.begin() + nfields);
+	std::vector<RBFNodeCluster> tree = buildRBFNodeTree(list, m_node, weights, 16);
+
+	m_log->setPriority(bitpit::log::Verbosity::DEBUG);
+	(*m_log)<<m_name<<" evaluates "<<list.size()<<" RBF nodes on "<<npoints<<" points";
+	if(compact)             (*m_log)<<" using compact support";
+	else if(theta > 0.0)    (*m_log)<<" using far-field accuracy "<<theta;
+	(*m_log)<<std::endl;
+	m_log->setPriority(bitpit::log::Verbosity::NORMAL);
+
+#pragma omp parallel
+	{
+		std::vector<int> stack;
+		stack.reserve(64);
+#pragma omp for schedule(dynamic, 64)
+		for(int ip=0; ip<npoints; ++ip){
+			const darray3E & point = points[ip];
+			darray3E & value = result[ip];
+			stack.push_back(0);
+			while(!stack.empty()){
+				const RBFNodeCluster & cluster = tree[stack.back()];
+				stack.pop_back();
+				double dist = norm2(point - cluster.center);
+				if(compact && dist - cluster.radius >= radius)   continue;
+
+				if(theta > 0.0 && cluster.radius < theta * dist){
+					//second order expansion of the kernel around the cluster center
+					double s = dist / radius;
+					double h = 1.0E-4 * std::max(1.0, s);
+					double basis = evalBasis(s);
+					double bp = evalBasis(s + h);
+					double bm = evalBasis(s - h);
+					double d1 = (bp - bm) / (2.0*h);
+					double d2 = (bp - 2.0*basis + bm) / (h*h);
+					darray3E dir = (cluster.center - point) / dist;
+					for(int f=0; f<nfields; ++f){
+						const std::array<double,6> & q = cluster.quadrupole[f];
+						double qdir = q[0]*dir[0]*dir[0] + q[1]*dir[1]*dir[1] + q[2]*dir[2]*dir[2]
+								+ 2.0*(q[3]*dir[0]*dir[1] + q[4]*dir[0]*dir[2] + q[5]*dir[1]*dir[2]);
+						double qtrace = q[0] + q[1] + q[2];
+						value[f] += basis * cluster.weight[f]
+								+ d1 / radius * dotProduct(dir, cluster.moment[f])
+								+ 0.5 * (d2 / (radius*radius) * qdir + d1 / (radius*dist) * (qtrace - qdir));
+					}
+					continue;
+				}
+
+				if(cluster.left < 0){
+					for(int i=cluster.begin; i<cluster.end; ++i){
+						int node = list[i];
+						double basis = evalBasis(norm2(point - m_node[node]) / radius);
+						for(int f=0; f<nfields; ++f){
+							value[f] += basis * weights[f][node];
+						}
+					}
+				}else{
+					stack.push_back(cluster.left);
+					stack.push_back(cluster.right);
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+/*!
+ * Sample the current RBF kernel on a fixed set of normalized distances, to detect a change of kernel.
+ * \return kernel samples
+ */
+dvector1D
+MRBF::sampleKernel(){
+	const double samples[] = {0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 1.0, 1.5, 3.0};
+	dvector1D result;
+	result.reserve(9);
+	for(double s : samples){
+		result.push_back(evalBasis(s));
+	}
+	return result;
+}
+
+/*!
+ * Check if the cached kernel matrix refers to the current geometry, active RBF nodes,
+ * support radius and kernel.
+ * \return true if the cached kernel matrix can be used
+ */
+bool
+MRBF::isOperatorSync(){
+	if(m_operator.revision == 0 || m_operator.revision != getGeometry()->getRevision())    return false;
+	if(m_operator.radius != RBF::getSupportRadius())   return false;
+	if(m_operator.kernel != sampleKernel())   return false;
+
+	ivector1D list = getActiveSet();
+	if(list != m_operator.active)   return false;
+	for(std::size_t j=0; j<list.size(); ++j){
+		if(m_node[list[j]] != m_operator.nodes[j])    return false;
+	}
+	return true;
+}
+
+/*!
+ * Clean the cached kernel matrix and record the current setup (geometry revision, support radius, kernel,
+ * active RBF nodes) as requested, without evaluating the matrix.
+ */
+void
+MRBF::resetOperator(){
+
+	clearOperatorCache();
+	RBFOperator & op = m_operator;
+	op.revision = getGeometry()->getRevision();
+	op.radius = RBF::getSupportRadius();
+	op.kernel = sampleKernel();
+	op.active = getActiveSet();
+	op.nodes.reserve(op.active.size());
+	for(int node : op.active){
+		op.nodes.push_back(m_node[node]);
+	}
+	op.pending = true;
+}
+
+/*!
+ * Evaluate and cache the kernel matrix between the geometry vertices and the active RBF nodes,
+ * with the current support radius. Kernels with compact support are stored in CSR form, after a first pass
+ * counting the nodes within the support radius of each vertex, visiting the binary tree of node clusters.
+ * Global kernels are stored dense. If the matrix exceeds the memory budget it is not evaluated and
+ * the operator is marked for on-the-fly evaluation. Rows are evaluated in parallel.
+ * \param[in] points coordinates of the geometry vertices, in the order of the coordinates view
+ */
+void
+MRBF::buildOperator(const dvecarr3E & points){
+
+	resetOperator();
+	RBFOperator & op = m_operator;
+	op.pending = false;
+	op.sparse = hasCompactSupport();
+
+	long npoints = long(points.size());
+	long nnodes = long(op.active.size());
+	const double radius = op.radius;
+	const double budget = m_operatorMemory * 1024.0 * 1024.0;
+
+	if(!op.sparse){
+		double memory = double(npoints) * double(nnodes) * sizeof(double);
+		if(memory > budget){
+			op.onTheFly = true;
+			(*m_log)<<m_name<<" : kernel matrix of "<<memory/(1024.0*1024.0)<<" MB exceeds memory budget, RBF evaluated on the fly"<<std::endl;
+			return;
+		}
+		op.vals.resize(npoints*nnodes);
+#pragma omp parallel for schedule(static)
+		for(long ip=0; ip<npoints; ++ip){
+			double * row = op.vals.data() + ip*nnodes;
+			for(long j=0; j<nnodes; ++j){
+				row[j] = evalBasis(norm2(points[ip] - op.nodes[j]) / radius);
+			}
+		}
+	}else{
+		//tree of clusters on the column indices of the active nodes
+		ivector1D list(nnodes);
+		for(long j=0; j<nnodes; ++j)  list[j] = int(j);
+		std::vector<RBFNodeCluster> tree = buildRBFNodeTree(list, op.nodes, dvector2D(), 16);
+
+		//collect the nodes within the support radius of a point, visiting the clusters intersecting it
+		auto visit = [&tree, &list, &op, radius](const darray3E & point, std::vector<int> & stack, ivector1D & cols, dvector1D & dists){
+			cols.clear();
+			dists.clear();
+			if(tree.empty())   return;
+			stack.push_back(0);
+			while(!stack.empty()){
+				const RBFNodeCluster & cluster = tree[stack.back()];
+				stack.pop_back();
+				if(norm2(point - cluster.center) - cluster.radius >= radius)   continue;
+				if(cluster.left < 0){
+					for(int i=cluster.begin; i<cluster.end; ++i){
+						double dist = norm2(point - op.nodes[list[i]]);
+						if(dist < radius){
+							cols.push_back(list[i]);
+							dists.push_back(dist);
+						}
+					}
+				}else{
+					stack.push_back(cluster.left);
+					stack.push_back(cluster.right);
+				}
+			}
+		};
+
+		op.offsets.assign(npoints+1, 0);
+#pragma omp parallel
+		{
+			std::vector<int> stack;
+			ivector1D cols;
+			dvector1D dists;
+			stack.reserve(64);
+#pragma omp for schedule(dynamic, 64)
+			for(long ip=0; ip<npoints; ++ip){
+				visit(points[ip], stack, cols, dists);
+				op.offsets[ip+1] = long(cols.size());
+			}
+		}
+		for(long ip=0; ip<npoints; ++ip){
+			op.offsets[ip+1] += op.offsets[ip];
+		}
+
+		long nnz = op.offsets[npoints];
+		double memory = double(nnz) * (sizeof(int) + sizeof(double)) + double(npoints+1) * sizeof(long);
+		if(memory > budget){
+			livector1D().swap(op.offsets);
+			op.onTheFly = true;
+			(*m_log)<<m_name<<" : kernel matrix of "<<memory/(1024.0*1024.0)<<" MB exceeds memory budget, RBF evaluated on the fly"<<std::endl;
+			return;
+		}
+
+		op.cols.resize(nnz);
+		op.vals.resize(nnz);
+#pragma omp parallel
+		{
+			std::vector<int> stack;
+			ivector1D cols;
+			dvector1D dists;
+			stack.reserve(64);
+#pragma omp for schedule(dynamic, 64)
+			for(long ip=0; ip<npoints; ++ip){
+				visit(points[ip], stack, cols, dists);
+				long pos = op.offsets[ip];
+				for(std::size_t e=0; e<cols.size(); ++e){
+					op.cols[pos+e] = cols[e];
+					op.vals[pos+e] = evalBasis(dists[e] / radius);
+				}
+			}
+		}
+	}
+
+	m_log->setPriority(bitpit::log::Verbosity::DEBUG);
+	(*m_log)<<m_name<<" caches "<<(op.sparse ? "sparse" : "dense")<<" kernel matrix of "<<npoints<<" x "<<nnodes<<", "<<op.vals.size()<<" entries"<<std::endl;
+	m_log->setPriority(bitpit::log::Verbosity::NORMAL);
+}
+
+/*!
+ * Evaluate the RBF displacements on the geometry vertices as product of the cached kernel matrix
+ * and the current weights of the active nodes, for the three displacement components together.
+ * Rows are distributed in parallel; the dense product is blocked on columns, so that the packed weights
+ * of a column block are reused by a block of rows.
+ * \return displacements of the geometry vertices, in the order of the coordinates view
+ */
+dvecarr3E
+MRBF::evaluateOperator(){
+
+	const RBFOperator & op = m_operator;
+	long nnodes = long(op.active.size());
+	long npoints = getGeometry()->getNVertex();
+	dvecarr3E result(npoints, darray3E({{0.0, 0.0, 0.0}}));
+	int nfields = std::min(getDataCount(), 3);
+	if(npoints <= 0 || nnodes == 0 || nfields <= 0)  return result;
+
+	//weights of active nodes packed by column
+	dvector1D w(3*nnodes, 0.0);
+	for(long j=0; j<nnodes; ++j){
+		for(int f=0; f<nfields; ++f){
+			w[3*j+f] = m_weight[f][op.active[j]];
+		}
+	}
+
+	if(op.sparse){
+#pragma omp parallel for schedule(static)
+		for(long ip=0; ip<npoints; ++ip){
+			double v0 = 0.0, v1 = 0.0, v2 = 0.0;
+			for(long e=op.offsets[ip]; e<op.offsets[ip+1]; ++e){
+				const double * wj = w.data() + 3*op.cols[e];
+				double k = op.vals[e];
+				v0 += k*wj[0];
+				v1 += k*wj[1];
+				v2 += k*wj[2];
+			}
+			result[ip] = {{v0, v1, v2}};
+		}
+	}else{
+		const long rowBlock = 64;
+		const long colBlock = 512;
+		long nblocks = (npoints + rowBlock - 1) / rowBlock;
+#pragma omp parallel for schedule(static)
+		for(long ib=0; ib<nblocks; ++ib){
+			long rstart = ib*rowBlock;
+			long rend = std::min(npoints, rstart + rowBlock);
+			for(long cstart=0; cstart<nnodes; cstart+=colBlock){
+				long cend = std::min(nnodes, cstart + colBlock);
+				for(long ip=rstart; ip<rend; ++ip){
+					const double * row = op.vals.data() + ip*nnodes;
+					double v0 = 0.0, v1 = 0.0, v2 = 0.0;
+#pragma omp simd reduction(+:v0,v1,v2)
+					for(long j=cstart; j<cend; ++j){
+						v0 += row[j]*w[3*j];
+						v1 += row[j]*w[3*j+1];
+						v2 += row[j]*w[3*j+2];
+					}
+					result[ip][0] += v0;
+					result[ip][1] += v1;
+					result[ip][2] += v2;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+/*!
+ * Solve the RBF interpolation problem on the active nodes with a restarted GMRES,
+ * right preconditioned with block-Jacobi over clusters of neighbouring nodes.
+ * Kernels with compact support assemble the interpolation matrix in sparse CSR form;
+ * non compact kernels apply it matrix-free. All data fields are solved as a batch,
+ * sharing the operator and the factorized preconditioner blocks.
+ * Resulting weights are stored in m_weight, as done by bitpit::RBF::solve.
+ */
+void
+MRBF::solveKrylov(){
+
+	const int restart = 30;
+	const int maxIterations = 2000;
+	const double tolerance = 1.0E-10;
+
+	int nfields = getDataCount();
+	ivector1D list = getActiveSet();
+	int n = int(list.size());
+
+	m_weight.resize(nfields);
+	for(auto & weight : m_weight){
+		weight.assign(getTotalNodesCount(), 0.0);
+	}
+	if(n == 0 || nfields <= 0)    return;
+
+	const double radius = RBF::getSupportRadius();
+	const bool compact = hasCompactSupport();
+
+	//clusters of nodes: unknown p is referred to node list[p], leaves are contiguous ranges of unknowns.
+	std::vector<RBFNodeCluster> tree = buildRBFNodeTree(list, m_node, dvector2D(), 32);
+
+	//sparse operator for compact kernels
+	ivector1D rowOffset, columns;
+	dvector1D entries;
+	if(compact){
+		std::vector<ivector1D> rowColumns(n);
+		std::vector<dvector1D> rowEntries(n);
+#pragma omp parallel
+		{
+			std::vector<int> stack;
+#pragma omp for schedule(dynamic, 64)
+			for(int p=0; p<n; ++p){
+				const darray3E & point = m_node[list[p]];
+				stack.push_back(0);
+				while(!stack.empty()){
+					const RBFNodeCluster & cluster = tree[stack.back()];
+					stack.pop_back();
+					if(norm2(point - cluster.center) - cluster.radius >= radius)   continue;
+					if(cluster.left < 0){
+						for(int q=cluster.begin; q<cluster.end; ++q){
+							double basis = evalBasis(norm2(point - m_node[list[q]]) / radius);
+							if(basis != 0.0){
+								rowColumns[p].push_back(q);
+								rowEntries[p].push_back(basis);
+							}
+						}
+					}else{
+						stack.push_back(cluster.left);
+						stack.push_back(cluster.right);
+					}
+				}
+			}
+		}
+		rowOffset.resize(n+1, 0);
+		for(int p=0; p<n; ++p){
+			rowOffset[p+1] = rowOffset[p] + int(rowColumns[p].size());
+		}
+		columns.resize(rowOffset[n]);
+		entries.resize(rowOffset[n]);
+		for(int p=0; p<n; ++p){
+			std::copy(rowColumns[p].begin(), rowColumns[p].end(), columns.begin() + rowOffset[p]);
+			std::copy(rowEntries[p].begin(), rowEntries[p].end(), entries.begin() + rowOffset[p]);
+		}
+	}
+
+	//batched operator, vectors are interleaved as [p*nfields + f].
+	auto applyOperator = [&](const dvector1D & in, dvector1D & out){
+#pragma omp parallel for schedule(dynamic, 64)
+		for(int p=0; p<n; ++p){
+			double * result = &out[p*nfields];
+			for(int f=0; f<nfields; ++f)   result[f] = 0.0;
+			if(compact){
+				for(int k=rowOffset[p]; k<rowOffset[p+1]; ++k){
+					const double * value = &in[columns[k]*nfields];
+					for(int f=0; f<nfields; ++f)   result[f] += entries[k] * value[f];
+				}
+			}else{
+				const darray3E & point = m_node[list[p]];
+				for(int q=0; q<n; ++q){
+					double basis = evalBasis(norm2(point - m_node[list[q]]) / radius);
+					const double * value = &in[q*nfields];
+					for(int f=0; f<nfields; ++f)   result[f] += basis * value[f];
+				}
+			}
+		}
+	};
+
+	//block-Jacobi preconditioner, LU factorization of the diagonal block of each leaf cluster.
+	std::vector<int> leaves;
+	for(int k=0; k<int(tree.size()); ++k){
+		if(tree[k].left < 0)    leaves.push_back(k);
+	}
+	int nleaves = int(leaves.size());
+	std::vector<dvector1D> blockLU(nleaves);
+	std::vector<std::vector<lapack_int> > blockPivots(nleaves);
+#pragma omp parallel for schedule(dynamic)
+	for(int b=0; b<nleaves; ++b){
+		const RBFNodeCluster & leaf = tree[leaves[b]];
+		int size = leaf.end - leaf.begin;
+		dvector1D block(size*size);
+		for(int j=0; j<size; ++j){
+			for(int i=0; i<size; ++i){
+				block[j*size+i] = evalBasis(norm2(m_node[list[leaf.begin+i]] - m_node[list[leaf.begin+j]]) / radius);
+			}
+		}
+		std::vector<lapack_int> pivots(size);
+		lapack_int info = LAPACKE_dgetrf(LAPACK_COL_MAJOR, size, size, block.data(), size, pivots.data());
+		//singular blocks (e.g. duplicated nodes) are left unpreconditioned.
+		if(info == 0){
+			blockLU[b].swap(block);
+			blockPivots[b].swap(pivots);
+		}
+	}
+
+	auto applyPreconditioner = [&](const dvector1D & in, dvector1D & out){
+#pragma omp parallel for schedule(dynamic)
+		for(int b=0; b<nleaves; ++b){
+			const RBFNodeCluster & leaf = tree[leaves[b]];
+			int size = leaf.end - leaf.begin;
+			if(blockLU[b].empty()){
+				std::copy(in.begin() + leaf.begin*nfields, in.begin() + leaf.end*nfields, out.begin() + leaf.begin*nfields);
+				continue;
+			}
+			dvector1D rhs(size*nfields);
+			for(int i=0; i<size; ++i){
+				for(int f=0; f<nfields; ++f)   rhs[f*size+i] = in[(leaf.begin+i)*nfields+f];
+			}
+			LAPACKE_dgetrs(LAPACK_COL_MAJOR, 'N', size, nfields, blockLU[b].data(), size, blockPivots[b].data(), rhs.data(), size);
+			for(int i=0; i<size; ++i){
+				for(int f=0; f<nfields; ++f)   out[(leaf.begin+i)*nfields+f] = rhs[f*size+i];
+			}
+		}
+	};
+
+	auto fieldDot = [&](const dvector1D & a, const dvector1D & b, int f){
+		double sum = 0.0;
+#pragma omp parallel for reduction(+:sum)
+		for(int p=0; p<n; ++p)   sum += a[p*nfields+f] * b[p*nfields+f];
+		return sum;
+	};
+
+	//right hand side and initial guess
+	int size = n*nfields;
+	dvector1D rhs(size), x(size, 0.0), r(size), z(size), w(size);
+	dvector1D bnorm(nfields, 0.0);
+	for(int p=0; p<n; ++p){
+		for(int f=0; f<nfields; ++f)   rhs[p*nfields+f] = m_value[f][list[p]];
+	}
+	for(int f=0; f<nfields; ++f)   bnorm[f] = std::sqrt(fieldDot(rhs, rhs, f));
+
+	std::vector<bool> converged(nfields, false);
+	ivector1D iterations(nfields, 0);
+	dvector1D residual(nfields, 0.0);
+	for(int f=0; f<nfields; ++f)   converged[f] = (bnorm[f] == 0.0);
+
+	std::vector<dvector1D> V(restart+1, dvector1D(size, 0.0));
+	std::vector<dvector2D> H(nfields, dvector2D(restart+1, dvector1D(restart, 0.0)));
+	dvector2D cs(nfields, dvector1D(restart, 0.0)), sn(nfields, dvector1D(restart, 0.0)), g(nfields, dvector1D(restart+1, 0.0));
+
+	int iteration = 0;
+	while(iteration < maxIterations){
+
+		//residual of the current solution
+		applyOperator(x, r);
+		for(int k=0; k<size; ++k)   r[k] = rhs[k] - r[k];
+
+		std::vector<bool> active(nfields, false);
+		ivector1D cycleSize(nfields, 0);
+		for(int f=0; f<nfields; ++f){
+			if(converged[f])    continue;
+			double beta = std::sqrt(fieldDot(r, r, f));
+			residual[f] = beta / bnorm[f];
+			if(residual[f] <= tolerance){
+				converged[f] = true;
+				continue;
+			}
+			active[f] = true;
+			std::fill(g[f].begin(), g[f].end(), 0.0);
+			g[f][0] = beta;
+			for(int p=0; p<n; ++p)   V[0][p*nfields+f] = r[p*nfields+f] / beta;
+		}
+		if(std::find(active.begin(), active.end(), true) == active.end())    break;
+		for(int f=0; f<nfields; ++f){
+			if(!active[f]){
+				for(int p=0; p<n; ++p)   V[0][p*nfields+f] = 0.0;
+			}
+		}
+
+		//arnoldi cycle, batched over the active fields
+		for(int j=0; j<restart && iteration<maxIterations; ++j){
+			applyPreconditioner(V[j], z);
+			applyOperator(z, w);
+			++iteration;
+
+			bool running = false;
+			for(int f=0; f<nfields; ++f){
+				if(!active[f])  continue;
+				for(int i=0; i<=j; ++i){
+					H[f][i][j] = fieldDot(w, V[i], f);
+					for(int p=0; p<n; ++p)   w[p*nfields+f] -= H[f][i][j] * V[i][p*nfields+f];
+				}
+				double hnext = std::sqrt(fieldDot(w, w, f));
+				for(int p=0; p<n; ++p)   V[j+1][p*nfields+f] = (hnext > 0.0) ? w[p*nfields+f] / hnext : 0.0;
+
+				for(int i=0; i<j; ++i){
+					double temp = cs[f][i]*H[f][i][j] + sn[f][i]*H[f][i+1][j];
+					H[f][i+1][j] = -sn[f][i]*H[f][i][j] + cs[f][i]*H[f][i+1][j];
+					H[f][i][j] = temp;
+				}
+				double denom = std::sqrt(H[f][j][j]*H[f][j][j] + hnext*hnext);
+				cs[f][j] = (denom > 0.0) ? H[f][j][j] / denom : 1.0;
+				sn[f][j] = (denom > 0.0) ? hnext / denom : 0.0;
+				H[f][j][j] = denom;
+				H[f][j+1][j] = 0.0;
+				g[f][j+1] = -sn[f][j]*g[f][j];
+				g[f][j] = cs[f][j]*g[f][j];
+
+				cycleSize[f] = j+1;
+				iterations[f] = iteration;
+				residual[f] = std::abs(g[f][j+1]) / bnorm[f];
+				if(residual[f] <= tolerance || hnext == 0.0){
+					active[f] = false;
+					for(int p=0; p<n; ++p)   V[j+1][p*nfields+f] = 0.0;
+				}else{
+					running = true;
+				}
+			}
+			if(!running)    break;
+		}
+
+		//update solution: x += M^-1 * V * y, y solving the triangular system H y = g
+		std::fill(w.begin(), w.end(), 0.0);
+		for(int f=0; f<nfields; ++f){
+			int m = cycleSize[f];
+			if(m == 0)  continue;
+			dvector1D y(m);
+			for(int i=m-1; i>=0; --i){
+				double sum = g[f][i];
+				for(int k=i+1; k<m; ++k)   sum -= H[f][i][k] * y[k];
+				y[i] = sum / H[f][i][i];
+			}
+			for(int i=0; i<m; ++i){
+				for(int p=0; p<n; ++p)   w[p*nfields+f] += y[i] * V[i][p*nfields+f];
+			}
+		}
+		applyPreconditioner(w, z);
+		for(int k=0; k<size; ++k)   x[k] += z[k];
+	}
+
+	for(int p=0; p<n; ++p){
+		for(int f=0; f<nfields; ++f)   m_weight[f][list[p]] = x[p*nfields+f];
+	}
+
+	(*m_log)<<m_name<<" : solved "<<(compact ? "sparse" : "matrix-free")<<" RBF system on "<<n<<" nodes";
+	if(compact)   (*m_log)<<" with "<<entries.size()<<" non-zeros";
+	(*m_log)<<std::endl;
+	for(int f=0; f<nfields; ++f){
+		if(!converged[f] && residual[f] > tolerance){
+			(*m_log)<<"warning: "<<m_name<<" : field "<<f<<" not converged after "<<iterations[f]<<" iterations, relative residual "<<residual[f]<<std::endl;
+		}else{
+			m_log->setPriority(bitpit::log::Verbosity::DEBUG);
+			(*m_log)<<m_name<<" : field "<<f<<" converged in "<<iterations[f]<<" iterations, relative residual "<<residual[f]<<std::endl;
+			m_log->setPriority(bitpit::log::Verbosity::NORMAL);
+		}
+	}
+}
+
 /*!
  * Plot Optional results of the class. It plots the RBF control nodes as a point cloud
  * in *.vtu format, for both original/moved control nodes.
@@ -791,6 +1653,46 @@ MRBF::absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name
 			if(value > 0.0)    setTol(value);
 		}
 	};
+
+	if(slotXML.hasOption("FarFieldAccuracy")){
+		input = slotXML.get("FarFieldAccuracy");
+		double value = 0.0;
+		if(!input.empty()){
+			std::stringstream ss(bitpit::utils::string::trim(input));
+			ss >> value;
+		}
+		setFarFieldAccuracy(value);
+	};
+
+	if(slotXML.hasOption("KrylovSolver")){
+		input = slotXML.get("KrylovSolver");
+		bool value = false;
+		if(!input.empty()){
+			std::stringstream ss(bitpit::utils::string::trim(input));
+			ss >> value;
+		}
+		setKrylovSolver(value);
+	};
+
+	if(slotXML.hasOption("OperatorCache")){
+		input = slotXML.get("OperatorCache");
+		bool value = true;
+		if(!input.empty()){
+			std::stringstream ss(bitpit::utils::string::trim(input));
+			ss >> value;
+		}
+		setOperatorCache(value);
+	};
+
+	if(slotXML.hasOption("OperatorCacheMemory")){
+		input = slotXML.get("OperatorCacheMemory");
+		double value = 512.0;
+		if(!input.empty()){
+			std::stringstream ss(bitpit::utils::string::trim(input));
+			ss >> value;
+		}
+		setOperatorCacheMemory(value);
+	};
 }
 
 /*!
@@ -832,6 +1734,26 @@ MRBF::flushSectionXML(bitpit::Config::Section & slotXML, std::string name){
 		ss<<std::scientific<<m_tol;
 		slotXML.set("Tolerance", ss.str());
 	}
+
+	if(m_farFieldAccuracy > 0.0){
+		std::stringstream ss;
+		ss<<std::scientific<<m_farFieldAccuracy;
+		slotXML.set("FarFieldAccuracy", ss.str());
+	}
+
+	if(m_krylov){
+		slotXML.set("KrylovSolver", std::to_string(1));
+	}
+
+	if(!m_useOperator){
+		slotXML.set("OperatorCache", std::to_string(0));
+	}
+
+	if(m_operatorMemory != 512.0){
+		std::stringstream ss;
+		ss<<std::scientific<<m_operatorMemory;
+		slotXML.set("OperatorCacheMemory", ss.str());
+	}
 }
 
 /*!
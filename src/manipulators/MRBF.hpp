@@ -103,10 +103,38 @@ enum class MRBFSol{
  * - <B>SupportRadiusReal</B>: local effective radius of RBF function for each nodes;
  * - <B>RBFShape</B>: shape of RBF function wendlandc2 (1), linear (2), gauss90 (3), gauss95 (4), gauss99 (5);
  * - <B>Tolerance</B>: greedy engine tolerance (meant for mode 2);
+ * - <B>FarFieldAccuracy</B>: opening ratio of the far-field approximation for non compact kernels, 0 for exact evaluation;
+ * - <B>KrylovSolver</B>: boolean 0/1 solve non compact kernels with the iterative solver in mode 1;
+ * - <B>OperatorCache</B>: boolean 0/1 cache the kernel matrix between vertices and nodes in mode 0 (default 1);
+ * - <B>OperatorCacheMemory</B>: memory budget of the cached kernel matrix in MB;
  * 
  *
  * Geometry, filter field, RBF nodes and displacements have to be mandatorily passed through port.
  *
+ * RBF evaluation on geometry vertices is performed in parallel over vertices, visiting
+ * a binary tree of clusters built on the active RBF nodes. For kernels with compact support
+ * (e.g. wendland family, linear) only the clusters intersecting the support radius are visited,
+ * giving exact results. For global kernels every cluster is visited exactly, unless a far-field
+ * accuracy theta > 0 is set: clusters seen from the evaluation point under a ratio
+ * cluster radius/distance lower than theta are evaluated with a second order expansion
+ * of the kernel around the cluster center.
+ *
+ * In MRBFSol::WHOLE mode, kernels with compact support assemble a sparse interpolation matrix, solved
+ * with a block-Jacobi preconditioned GMRES. Non compact kernels are solved with the dense
+ * direct solver of bitpit::RBF, or with the same GMRES in matrix-free form if setKrylovSolver is enabled.
+ * All the displacement components are solved together, sharing the operator and the preconditioner.
+ *
+ * In MRBFSol::NONE mode, where only the weights usually change between executions (e.g. inside an
+ * optimization loop), the kernel matrix between geometry vertices and active RBF nodes is evaluated once
+ * and cached: in sparse CSR form for kernels with compact support, dense for global kernels.
+ * Following executions reduce to a product of the cached matrix with the three weight fields.
+ * The matrix is evaluated only when the same setup (geometry, active nodes, support radius and kernel) is
+ * requested by two consecutive executions; the first one is evaluated on the fly. Hence a support radius
+ * bound to the maximum weight (non positive ratio, the default), which changes with the weights themselves,
+ * never pays for the evaluation of a matrix used once.
+ * If the matrix exceeds the memory budget set with setOperatorCacheMemory, the evaluation falls back to
+ * the on-the-fly engine described above.
+ *
  */
 //TODO study how to manipulate supportRadius of RBF to define a local/global smoothing of RBF
 class MRBF: public BaseManipulation, public bitpit::RBF {
@@ -119,6 +147,30 @@ private:
     double        m_SRRatio;        /**<support Radius ratio */
     dmpvecarr3E    m_displ;        /**<Resulting displacements of geometry vertex.*/
     bool        m_supRIsValue;  /**<True if support radius is defined as absolute value, false if is ratio of bounding box diagonal.*/
+    double      m_farFieldAccuracy; /**<Opening ratio of far-field approximation for non compact kernels, 0 for exact evaluation.*/
+    bool        m_krylov;       /**<True if non compact kernels are solved with the iterative solver in MRBFSol::WHOLE mode.*/
+
+    /*!
+     * \struct RBFOperator
+     * Kernel matrix between geometry vertices and active RBF nodes, cached in MRBFSol::NONE mode.
+     */
+    struct RBFOperator{
+        unsigned long   revision;   /**< revision of the geometry the operator is evaluated on, 0 if not evaluated */
+        double          radius;     /**< support radius the operator is evaluated with */
+        ivector1D       active;     /**< active RBF nodes, one per column */
+        dvecarr3E       nodes;      /**< coordinates of the active RBF nodes */
+        dvector1D       kernel;     /**< samples of the kernel function */
+        bool            pending;    /**< true if the setup has been requested once and the matrix is not evaluated yet */
+        bool            onTheFly;   /**< true if the operator exceeds the memory budget and is not stored */
+        bool            sparse;     /**< true if stored in CSR form */
+        livector1D      offsets;    /**< CSR row offsets, size vertices+1 (sparse form only) */
+        ivector1D       cols;       /**< CSR column of each entry (sparse form only) */
+        dvector1D       vals;       /**< kernel values, CSR entries or dense row-major vertices x nodes */
+    };
+
+    bool        m_useOperator;      /**<True if the kernel matrix is cached in MRBFSol::NONE mode.*/
+    double      m_operatorMemory;   /**<Memory budget of the cached kernel matrix in MB.*/
+    RBFOperator m_operator;         /**<Cached kernel matrix.*/
 
 public:
     MRBF();
@@ -141,6 +193,10 @@ public:
     double            getSupportRadius();
     double            getSupportRadiusValue();
     bool            getIsSupportRadiusValue();
+    double          getFarFieldAccuracy();
+    bool            isKrylovSolver();
+    bool            isOperatorCacheActive();
+    double          getOperatorCacheMemory();
 
     dmpvecarr3E        getDisplacements();
 
@@ -159,6 +215,10 @@ public:
     void            setSupportRadius(double suppR_);
     void            setSupportRadiusValue(double suppR_);
     void             setTol(double tol);
+    void            setFarFieldAccuracy(double theta);
+    void            setKrylovSolver(bool flag);
+    void            setOperatorCache(bool flag);
+    void            setOperatorCacheMemory(double memory);
     void             setDisplacements(dvecarr3E displ);
 
     void 			setFunction(const MRBFBasisFunction & funct);
@@ -166,6 +226,7 @@ public:
 
     void             clear();
     void             clearFilter();
+    void            clearOperatorCache();
 
     void             execute();
     void             apply();
@@ -179,6 +240,14 @@ protected:
     virtual void    plotOptionalResults();
     void            swap(MRBF & x) noexcept;
     void            checkFilter();
+    bool            hasCompactSupport();
+    dvecarr3E       evaluateDisplacements(const dvecarr3E & points);
+    void            solveKrylov();
+    dvector1D       sampleKernel();
+    bool            isOperatorSync();
+    void            resetOperator();
+    void            buildOperator(const dvecarr3E & points);
+    dvecarr3E       evaluateOperator();
 
 };
 
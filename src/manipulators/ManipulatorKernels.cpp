@@ -0,0 +1,129 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#include "ManipulatorKernels.hpp"
+
+namespace mimmo{
+
+namespace manipulatorKernels{
+
+/*!
+ * Copy the coordinates of a block of points to the block buffers.
+ * \param[in] points coordinates of the block points
+ * \param[in,out] block target block, with size already set
+ */
+void
+loadBlock(const darray3E * points, Block & block){
+    long n = block.size;
+    for(long i=0; i<n; ++i){
+        block.x[i] = points[i][0];
+        block.y[i] = points[i][1];
+        block.z[i] = points[i][2];
+    }
+};
+
+/*!
+ * Copy the displacements of the block buffers to a block of points.
+ * \param[in] block source block
+ * \param[out] displ displacements of the block points
+ */
+void
+storeBlock(const Block & block, darray3E * displ){
+    long n = block.size;
+    for(long i=0; i<n; ++i){
+        displ[i][0] = block.dx[i];
+        displ[i][1] = block.dy[i];
+        displ[i][2] = block.dz[i];
+    }
+};
+
+/*!
+ * Transform the block coordinates to a local frame, x = matrix*(x - origin).
+ * \param[in,out] block target block
+ * \param[in] matrix rows of the transformation matrix
+ * \param[in] origin origin of the local frame
+ */
+void
+toFrame(Block & block, const dmatrix33E & matrix, const darray3E & origin){
+    long n = block.size;
+    double * x = block.x;
+    double * y = block.y;
+    double * z = block.z;
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double px = x[i] - origin[0];
+        double py = y[i] - origin[1];
+        double pz = z[i] - origin[2];
+        x[i] = matrix[0][0]*px + matrix[0][1]*py + matrix[0][2]*pz;
+        y[i] = matrix[1][0]*px + matrix[1][1]*py + matrix[1][2]*pz;
+        z[i] = matrix[2][0]*px + matrix[2][1]*py + matrix[2][2]*pz;
+    }
+};
+
+/*!
+ * Transform the block coordinates from a local frame, x = matrix*x + origin.
+ * \param[in,out] block target block
+ * \param[in] matrix rows of the transformation matrix
+ * \param[in] origin origin of the local frame
+ */
+void
+fromFrame(Block & block, const dmatrix33E & matrix, const darray3E & origin){
+    long n = block.size;
+    double * x = block.x;
+    double * y = block.y;
+    double * z = block.z;
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double px = x[i];
+        double py = y[i];
+        double pz = z[i];
+        x[i] = matrix[0][0]*px + matrix[0][1]*py + matrix[0][2]*pz + origin[0];
+        y[i] = matrix[1][0]*px + matrix[1][1]*py + matrix[1][2]*pz + origin[1];
+        z[i] = matrix[2][0]*px + matrix[2][1]*py + matrix[2][2]*pz + origin[2];
+    }
+};
+
+/*!
+ * Add to result the value of a polynomial on a list of points, by Horner scheme.
+ * \param[in] n number of points
+ * \param[in] t points
+ * \param[in] coeffs degree+1 coefficients, from the constant term
+ * \param[in] degree degree of the polynomial
+ * \param[in,out] result polynomial value of each point is added
+ */
+void
+horner(long n, const double * t, const double * coeffs, int degree, double * result){
+    double lead = coeffs[degree];
+#pragma omp simd
+    for(long i=0; i<n; ++i){
+        double val = lead;
+        for(int k=degree-1; k>=0; --k){
+            val = val*t[i] + coeffs[k];
+        }
+        result[i] += val;
+    }
+};
+
+}
+
+}
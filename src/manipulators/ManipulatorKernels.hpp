@@ -0,0 +1,77 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __MANIPULATORKERNELS_HPP__
+#define __MANIPULATORKERNELS_HPP__
+
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "mimmoTypeDef.hpp"
+
+namespace mimmo{
+
+/*!
+ * \brief Block kernels shared by the analytic manipulators.
+ * \ingroup manipulators
+ *
+ * Points are processed in blocks of BLOCK_SIZE, copied to structure-of-arrays buffers
+ * so that the per-point arithmetic of a manipulator runs in vectorizable loops.
+ * Blocks are distributed among the available threads (if mimmo is compiled with OpenMP support).
+ */
+namespace manipulatorKernels{
+
+    const long BLOCK_SIZE = 256;   /**< number of points of a block */
+
+    /*!
+     * \struct Block
+     * Structure-of-arrays buffers of a block of points.
+     */
+    struct Block{
+        long            size;               /**< number of points in the block */
+        const double *  filter;             /**< filter value of each point */
+        double          x[BLOCK_SIZE];      /**< x coordinates */
+        double          y[BLOCK_SIZE];      /**< y coordinates */
+        double          z[BLOCK_SIZE];      /**< z coordinates */
+        double          dx[BLOCK_SIZE];     /**< x displacements */
+        double          dy[BLOCK_SIZE];     /**< y displacements */
+        double          dz[BLOCK_SIZE];     /**< z displacements */
+    };
+
+    void    loadBlock(const darray3E * points, Block & block);
+    void    storeBlock(const Block & block, darray3E * displ);
+
+    void    toFrame(Block & block, const dmatrix33E & matrix, const darray3E & origin);
+    void    fromFrame(Block & block, const dmatrix33E & matrix, const darray3E & origin);
+    void    horner(long n, const double * t, const double * coeffs, int degree, double * result);
+
+    template<typename Kernel>
+    void    forEachBlock(long n, const darray3E * points, const double * filter, darray3E * displ, Kernel & kernel);
+
+}; //end namespace manipulatorKernels
+
+} //end namespace mimmo
+
+#include "ManipulatorKernels.tpp"
+
+#endif /* __MANIPULATORKERNELS_HPP__ */
@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+namespace mimmo{
+
+namespace manipulatorKernels{
+
+/*!
+ * Evaluate a block kernel on a list of points. For each block, coordinates are loaded in
+ * the block buffers, the kernel fills the block displacements and these are stored in displ.
+ * Blocks are distributed among the available threads (if mimmo is compiled with OpenMP support).
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ * \param[in] kernel callable object taking a Block &
+ */
+template<typename Kernel>
+void
+forEachBlock(long n, const darray3E * points, const double * filter, darray3E * displ, Kernel & kernel){
+
+    long nblocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+#pragma omp parallel if(nblocks > 1)
+    {
+        Block block;
+
+#pragma omp for schedule(static)
+        for(long ib=0; ib<nblocks; ++ib){
+            long start = ib*BLOCK_SIZE;
+            block.size = std::min(BLOCK_SIZE, n - start);
+            block.filter = filter + start;
+            loadBlock(points + start, block);
+            kernel(block);
+            storeBlock(block, displ + start);
+        }
+    }
+};
+
+}
+
+}
@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "RotationGeometry.hpp"
+#include "ManipulatorKernels.hpp"
 
 namespace mimmo{
 
@@ -155,7 +156,7 @@ RotationGeometry::setRotation(double alpha){
  */
 void
 RotationGeometry::setFilter(dmpvector1D filter){
-    m_filter = filter;
+    m_filter = std::move(filter);
 }
 
 /*!
@@ -167,6 +168,15 @@ RotationGeometry::getDisplacements(){
     return m_displ;
 };
 
+/*!
+ * Return the filter field set to modulate the displacements of the vertices.
+ * \return filter field
+ */
+dmpvector1D
+RotationGeometry::getFilter(){
+    return m_filter;
+};
+
 /*!Execution command. It saves in "rot"-terms the modified axes and origin, by the
  * rotation conditions. This terms can be recovered and passed by a pin to a child object
  * by the related get-methods.
@@ -188,31 +198,57 @@ RotationGeometry::execute(){
     m_displ.reserve(getGeometry()->getNVertex());
     m_displ.setGeometry(getGeometry());
     
+    const CoordinatesView & coords = m_geometry->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices), displ(nVertices);
+    dvector1D filter(nVertices);
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+        filter[i] = m_filter[coords.ids[i]];
+    }
+    deformPoints(nVertices, points.data(), filter.data(), displ.data());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], displ[i]);
+    }
+};
+
+/*!
+ * Compute the rotation displacements of a list of points, in blocks (see manipulatorKernels).
+ * Used by execute and by FusedDeformation to evaluate the same deformation on given coordinates.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ */
+void
+RotationGeometry::deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ){
+
     //compute coefficients and constant vectors of rodriguez formula
     double a = cos(m_alpha);
     darray3E b =  (1 - cos(m_alpha)) * m_direction;
     double c = sin(m_alpha);
-
-    darray3E point, rotated;
-    long ID;
-    darray3E value;
-    for (const auto & vertex : m_geometry->getVertices()){
-        point = vertex.getCoords();
-        ID = vertex.getId();
-
-        point -= m_origin;
-        //rodrigues formula
-        rotated = a * point +
-                b * dotProduct(m_direction, point) +
-                c * crossProduct(m_direction, point);
-
-        rotated += m_origin;
-        point += m_origin;
-
-        value = (rotated-point)*m_filter[ID];
-        m_displ.insert(ID, value);
-
-    }
+    const darray3E & d = m_direction;
+    const darray3E & o = m_origin;
+
+    auto kernel = [&](manipulatorKernels::Block & block){
+        const double * f = block.filter;
+#pragma omp simd
+        for (long i=0; i<block.size; ++i){
+            double px = block.x[i] - o[0];
+            double py = block.y[i] - o[1];
+            double pz = block.z[i] - o[2];
+            //rodrigues formula
+            double dot = d[0]*px + d[1]*py + d[2]*pz;
+            double rx = a*px + b[0]*dot + c*(d[1]*pz - d[2]*py);
+            double ry = a*py + b[1]*dot + c*(d[2]*px - d[0]*pz);
+            double rz = a*pz + b[2]*dot + c*(d[0]*py - d[1]*px);
+            block.dx[i] = ((rx + o[0]) - (px + o[0]))*f[i];
+            block.dy[i] = ((ry + o[1]) - (py + o[1]))*f[i];
+            block.dz[i] = ((rz + o[2]) - (pz + o[2]))*f[i];
+        }
+    };
+    manipulatorKernels::forEachBlock(n, points, filter, displ, kernel);
 };
 
 /*!
@@ -223,14 +259,7 @@ RotationGeometry::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_displ[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_displ);
 
 }
 
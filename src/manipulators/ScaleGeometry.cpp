@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "ScaleGeometry.hpp"
+#include "ManipulatorKernels.hpp"
 
 namespace mimmo{
 
@@ -139,7 +140,7 @@ ScaleGeometry::setScaling(darray3E scaling){
  */
 void
 ScaleGeometry::setFilter(dmpvector1D filter){
-    m_filter = filter;
+    m_filter = std::move(filter);
 }
 
 /*!
@@ -151,6 +152,23 @@ ScaleGeometry::getDisplacements(){
     return m_displ;
 };
 
+/*!
+ * Return the filter field set to modulate the displacements of the vertices.
+ * \return filter field
+ */
+dmpvector1D
+ScaleGeometry::getFilter(){
+    return m_filter;
+};
+
+/*!
+ * \return true if the center point for scaling is the mean point of the geometry.
+ */
+bool
+ScaleGeometry::isMeanPoint(){
+    return m_meanP;
+};
+
 /*!Execution command. It perform the scaling by computing the displacements
  * of the points of the geometry. It applies a filter field eventually set as input.
  */
@@ -171,25 +189,65 @@ ScaleGeometry::execute(){
     m_displ.reserve(getGeometry()->getNVertex());
     m_displ.setGeometry(getGeometry());
 
-    long ID;
-    darray3E value;
-    //computing centroid
-    int nV = m_geometry->getNVertex();
+    const CoordinatesView & coords = m_geometry->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices), displ(nVertices);
+    dvector1D filter(nVertices);
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+        filter[i] = m_filter[coords.ids[i]];
+    }
+    darray3E center = evalCenter(nVertices, points.data());
+    deformPoints(nVertices, points.data(), filter.data(), center, displ.data());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], displ[i]);
+    }
+};
+
+/*!
+ * Evaluate the center of scaling: the origin set or, if the mean point is used,
+ * the mean of a list of points.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \return center of scaling
+ */
+darray3E
+ScaleGeometry::evalCenter(long n, const darray3E * points){
     darray3E center = m_origin;
     if (m_meanP){
         center.fill(0.0);
-        for (const auto & vertex : m_geometry->getVertices()){
-            center += vertex.getCoords();
+        for (long i=0; i<n; ++i){
+            center += points[i];
         }
-        center /=double(nV);
+        center /=double(n);
     }
-    for (const auto & vertex : m_geometry->getVertices()){
-        ID = vertex.getId();
+    return center;
+};
 
-        darray3E coords = vertex.getCoords();
-        value = (( m_scaling*(coords - center) + center ) - coords) * m_filter[ID] ;
-        m_displ.insert(ID, value);
-    }
+/*!
+ * Compute the scaling displacements of a list of points, in blocks (see manipulatorKernels).
+ * Used by execute and by FusedDeformation to evaluate the same deformation on given coordinates.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[in] center center of scaling, see evalCenter
+ * \param[out] displ displacement of each point
+ */
+void
+ScaleGeometry::deformPoints(long n, const darray3E * points, const double * filter, const darray3E & center, darray3E * displ){
+
+    const darray3E & s = m_scaling;
+    auto kernel = [&](manipulatorKernels::Block & block){
+        const double * f = block.filter;
+#pragma omp simd
+        for (long i=0; i<block.size; ++i){
+            block.dx[i] = (( s[0]*(block.x[i] - center[0]) + center[0] ) - block.x[i]) * f[i];
+            block.dy[i] = (( s[1]*(block.y[i] - center[1]) + center[1] ) - block.y[i]) * f[i];
+            block.dz[i] = (( s[2]*(block.z[i] - center[2]) + center[2] ) - block.z[i]) * f[i];
+        }
+    };
+    manipulatorKernels::forEachBlock(n, points, filter, displ, kernel);
 };
 
 /*!
@@ -200,14 +258,7 @@ ScaleGeometry::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_displ[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_displ);
 
 }
 
@@ -99,9 +99,13 @@ public:
     void        setMeanPoint(bool meanP);
 
     dmpvecarr3E   getDisplacements();
+    dmpvector1D   getFilter();
+    bool          isMeanPoint();
 
     void         execute();
     void         apply();
+    darray3E     evalCenter(long n, const darray3E * points);
+    void         deformPoints(long n, const darray3E * points, const double * filter, const darray3E & center, darray3E * displ);
 
     virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name = "");
     virtual void flushSectionXML(bitpit::Config::Section & slotXML, std::string name= "");
@@ -128,7 +128,7 @@ TranslationGeometry::setTranslation(double alpha){
  */
 void
 TranslationGeometry::setFilter(dmpvector1D filter){
-    m_filter = filter;
+    m_filter = std::move(filter);
 }
 
 /*!
@@ -140,6 +140,15 @@ TranslationGeometry::getDisplacements(){
     return m_displ;
 };
 
+/*!
+ * Return the filter field set to modulate the displacements of the vertices.
+ * \return filter field
+ */
+dmpvector1D
+TranslationGeometry::getFilter(){
+    return m_filter;
+};
+
 /*!Execution command. It perform the translation by computing the displacements
  * of the points of the geometry. It applies a filter field eventually set as input.
  */
@@ -161,12 +170,38 @@ TranslationGeometry::execute(){
     m_displ.reserve(getGeometry()->getNVertex());
     m_displ.setGeometry(getGeometry());
     
-    long ID;
-    darray3E value;
-    for (const auto & vertex : m_geometry->getVertices()){
-        ID = vertex.getId();
-        value = m_alpha*m_direction*m_filter[ID];
-        m_displ.insert(ID, value);
+    const CoordinatesView & coords = m_geometry->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices), displ(nVertices);
+    dvector1D filter(nVertices);
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+        filter[i] = m_filter[coords.ids[i]];
+    }
+    deformPoints(nVertices, points.data(), filter.data(), displ.data());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], displ[i]);
+    }
+};
+
+/*!
+ * Compute the translation displacements of a list of points.
+ * Used by execute and by FusedDeformation to evaluate the same deformation on given coordinates.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ */
+void
+TranslationGeometry::deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ){
+    BITPIT_UNUSED(points);
+    darray3E shift = m_alpha*m_direction;
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<n; ++i){
+        for (int j=0; j<3; ++j){
+            displ[i][j] = shift[j]*filter[i];
+        }
     }
 };
 
@@ -178,14 +213,7 @@ TranslationGeometry::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_displ[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_displ);
 
 }
 
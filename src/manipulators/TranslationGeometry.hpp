@@ -95,9 +95,11 @@ public:
     void        setFilter(dmpvector1D filter);
 
     dmpvecarr3E   getDisplacements();
+    dmpvector1D   getFilter();
 
     void         execute();
     void         apply();
+    void         deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ);
 
     virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name = "");
     virtual void flushSectionXML(bitpit::Config::Section & slotXML, std::string name= "");
@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 #include "TwistGeometry.hpp"
+#include "ManipulatorKernels.hpp"
 
 namespace mimmo{
 
@@ -175,7 +176,7 @@ TwistGeometry::setMaxDistance(double distance){
  */
 void
 TwistGeometry::setFilter(dmpvector1D filter){
-    m_filter = filter;
+    m_filter = std::move(filter);
 }
 
 /*!
@@ -187,6 +188,15 @@ TwistGeometry::getDisplacements(){
     return m_displ;
 };
 
+/*!
+ * Return the filter field set to modulate the displacements of the vertices.
+ * \return filter field
+ */
+dmpvector1D
+TwistGeometry::getFilter(){
+    return m_filter;
+};
+
 /*!Execution command. It saves in "rot"-terms the modified axes and origin, by the
  * twist conditions. This terms can be recovered and passed by a pin to a child object
  * by the related get-methods.
@@ -208,47 +218,77 @@ TwistGeometry::execute(){
     m_displ.reserve(getGeometry()->getNVertex());
     m_displ.setGeometry(getGeometry());
     
-    darray3E point, rotated;
-    long ID;
-    darray3E projected;
-    double distance;
-    //double sign;
-    double rot;
-    darray3E value;
-
-    for (const auto & vertex : m_geometry->getVertices()){
-        point = vertex.getCoords();
-        ID = vertex.getId();
-
-        //signed distance from origin
-        distance = dotProduct((point-m_origin),m_direction);
-
-        //compute coefficients and constant vectors of rodriguez formula
-        rot = std::min(m_alpha, (std::abs(distance)/m_distance)*m_alpha);
-        if (distance < 0) rot = -rot*int(m_sym);
-        double a = cos(rot);
-        darray3E b =  (1 - cos(rot)) * m_direction;
-        double c = sin(rot);
-
-        //project point on axis (local origin)
-        projected = distance*m_direction + m_origin;
-
-
-        point -= projected;
-        //rodrigues formula
-        rotated = a * point +
-                b * dotProduct(m_direction, point) +
-                c * crossProduct(m_direction, point);
-
-        rotated += projected;
-        point += projected;
-
-        value = (rotated-point)*m_filter[ID];
-        m_displ.insert(ID, value);
-
+    const CoordinatesView & coords = m_geometry->getCoordinatesView();
+    long nVertices = coords.size();
+    dvecarr3E points(nVertices), displ(nVertices);
+    dvector1D filter(nVertices);
+#pragma omp parallel for schedule(static)
+    for (long i=0; i<nVertices; ++i){
+        points[i] = coords.getCoords(i);
+        filter[i] = m_filter[coords.ids[i]];
+    }
+    deformPoints(nVertices, points.data(), filter.data(), displ.data());
+    for (long i=0; i<nVertices; ++i){
+        m_displ.insert(coords.ids[i], displ[i]);
     }
 };
 
+/*!
+ * Compute the twist displacements of a list of points, in blocks (see manipulatorKernels).
+ * Used by execute and by FusedDeformation to evaluate the same deformation on given coordinates.
+ * \param[in] n number of points
+ * \param[in] points coordinates of the points
+ * \param[in] filter filter value of each point
+ * \param[out] displ displacement of each point
+ */
+void
+TwistGeometry::deformPoints(long n, const darray3E * points, const double * filter, darray3E * displ){
+
+    const darray3E & d = m_direction;
+    const darray3E & o = m_origin;
+    double alpha = m_alpha;
+    double maxDistance = m_distance;
+    double sym = double(int(m_sym));
+
+    auto kernel = [&](manipulatorKernels::Block & block){
+        const double * f = block.filter;
+#pragma omp simd
+        for (long i=0; i<block.size; ++i){
+
+            //signed distance from origin
+            double distance = (block.x[i] - o[0])*d[0] + (block.y[i] - o[1])*d[1] + (block.z[i] - o[2])*d[2];
+
+            //compute coefficients of rodriguez formula
+            double rot = (std::abs(distance)/maxDistance)*alpha;
+            rot = (rot < alpha) ? rot : alpha;
+            rot = (distance < 0) ? -rot*sym : rot;
+            double a = cos(rot);
+            double bb = (1 - cos(rot));
+            double c = sin(rot);
+
+            //project point on axis (local origin)
+            double prx = distance*d[0] + o[0];
+            double pry = distance*d[1] + o[1];
+            double prz = distance*d[2] + o[2];
+
+            double px = block.x[i] - prx;
+            double py = block.y[i] - pry;
+            double pz = block.z[i] - prz;
+
+            //rodrigues formula
+            double dot = d[0]*px + d[1]*py + d[2]*pz;
+            double rx = a*px + (bb*d[0])*dot + c*(d[1]*pz - d[2]*py);
+            double ry = a*py + (bb*d[1])*dot + c*(d[2]*px - d[0]*pz);
+            double rz = a*pz + (bb*d[2])*dot + c*(d[0]*py - d[1]*px);
+
+            block.dx[i] = ((rx + prx) - (px + prx))*f[i];
+            block.dy[i] = ((ry + pry) - (py + pry))*f[i];
+            block.dz[i] = ((rz + prz) - (pz + prz))*f[i];
+        }
+    };
+    manipulatorKernels::forEachBlock(n, points, filter, displ, kernel);
+};
+
 /*!
  * Directly apply deformation field to target geometry.
  */
@@ -257,14 +297,7 @@ TwistGeometry::apply(){
 
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_displ.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_displ[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_displ);
 
 }
 
@@ -475,7 +475,7 @@ PropagateVectorField::setSlipNormalRatio(double thres){
 void
 PropagateVectorField::setDirichletConditions(dmpvecarr3E bc){
     if (bc.isEmpty()) return;
-    m_bc_dir = bc;
+    m_bc_dir = std::move(bc);
 }
 
 /*!
@@ -528,6 +528,18 @@ void PropagateVectorField::flushSectionXML(bitpit::Config::Section & slotXML, st
 };
 
 
+/*!
+ * Return the geometries involved in the propagation: the ones of the base class
+ * and the slip boundary surface.
+ * \return list of geometries involved in the execution
+ */
+std::vector<MimmoObject*>
+PropagateVectorField::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = PropagateField<3>::getInvolvedGeometries();
+    if(m_slipsurface != NULL)   result.push_back(m_slipsurface);
+    return result;
+};
+
 /*!
  * Clear all data actually stored in the class
  */
@@ -749,14 +761,7 @@ void
 PropagateVectorField::apply(){
     if (getGeometry() == NULL) return;
     if (getGeometry()->isEmpty() || m_field.isEmpty()) return;
-    darray3E vertexcoords;
-    long int ID;
-    for (const auto & vertex : m_geometry->getVertices()){
-        vertexcoords = vertex.getCoords();
-        ID = vertex.getId();
-        vertexcoords += m_field[ID];
-        getGeometry()->modifyVertex(vertexcoords, ID);
-    }
+    getGeometry()->applyDisplacements(m_field);
 }
 
 /*! 
@@ -28,6 +28,18 @@
 #include "system.hpp"
 
 namespace mimmo{
+
+/*!
+ * \enum SmoothingType
+ * \ingroup propagators
+ * \brief Type of sweep performed by the smoothing solver of PropagateField.
+ */
+enum class SmoothingType{
+    SEQUENTIAL = 0,     /**< serial sweep on the nodes in local order, one component after the other, without scaling by the diagonal */
+    GAUSSSEIDEL = 1,    /**< multicolor Gauss-Seidel, nodes of the same color are updated in parallel */
+    JACOBI = 2          /**< relaxed Jacobi, all nodes are updated in parallel from the previous iterate */
+};
+
 /*!
  * \class PropagateField
  * \ingroup propagators
@@ -50,6 +62,24 @@ namespace mimmo{
  * in the second case, bigger volume cell far from dumping surface are forced to move more.
  * Result field is stored in m_field member and returned as data field through ports.
  *
+ * The smoothing solver stores the stencils in CSR arrays, with the NCOMP components of each node
+ * interleaved. The default sequential sweep visits the nodes serially in their local order, one
+ * component after the other, as the original smoother: for a fixed number of steps its result
+ * does not depend on the number of threads. Gauss-Seidel sweeps visit the nodes by colors of the
+ * stencil graph, updating nodes of the same color in parallel; Jacobi sweeps update all nodes in
+ * parallel. Both scale the update by the diagonal coefficient, and give a different field than the
+ * sequential sweep after a fixed number of steps, while they converge to the same solution.
+ * All sweeps can be over/under relaxed through setRelaxation.
+ * Convergence is checked on the maximum absolute update of a sweep.
+ *
+ * The Laplacian solver assembles the NCOMP components as a single block system, with the
+ * components of each node interleaved. The assembled operator and its preconditioner are kept
+ * across executions: if the laplacian operator is unchanged (e.g. only Dirichlet values changed)
+ * only the right-hand-side is updated, if only its coefficients changed the matrix is refilled
+ * in place. The previous solution is used as initial guess of the next solve.
+ * On large meshes the algebraic multigrid preconditioner (see setPreconditioner) keeps the
+ * number of iterations nearly independent of the mesh size.
+ *
  *
  * The xml available parameters, sections and subsections are the following :
  *
@@ -70,6 +100,9 @@ namespace mimmo{
  * - <B>SmoothingSteps</B> : number of steps the Smoother solver need to perform (1 default);
  * - <B>Convergence</B> : convergence flag for smoothing solver;
  * - <B>Tolerance</B> : convergence tolerance for laplacian smoothing and direct solver;
+ * - <B>SmoothingType</B> : sweep of the smoothing solver, 0-sequential, 1-multicolor Gauss-Seidel, 2-relaxed Jacobi (default 0);
+ * - <B>Relaxation</B> : relaxation factor of smoothing solver sweeps (1.0 default);
+ * - <B>Preconditioner</B> : preconditioner of Laplacian solver, 0-ILU, 1-algebraic multigrid (default 0);
  * Geometry, boundary surfaces, boundary condition values
  * for the target geometry have to be mandatorily passed through ports.
  *
@@ -101,9 +134,15 @@ protected:
                                          the stencil during the laplacian computing account of the maximum artificial diffusivity.*/
     bool          m_dumpingActive;  /**< true the dumping control is active, false otherwise.*/
     int           m_dumpingType;    /**< 0 distance-control, 1-volume control*/
+    SmoothingType m_smoothingType;  /**< type of sweep of the smoothing solver*/
+    double        m_relaxation;     /**< relaxation factor of the smoothing solver sweeps*/
+    KSPPreconditioner m_preconditioner; /**< preconditioner of the laplacian solver*/
     
     
     std::unique_ptr<mimmo::SystemSolver> m_solver; /**! linear system solver for laplace */
+    std::size_t   m_solverPattern;  /**< fingerprint of the non-zero pattern of the laplacian operator cached in m_solver*/
+    std::size_t   m_solverValues;   /**< fingerprint of the coefficients of the laplacian operator cached in m_solver*/
+    dvector1D     m_solution;       /**< last laplacian solution with interleaved components, initial guess of the next solve*/
 
 public:
 
@@ -129,7 +168,13 @@ public:
     void    setDecayFactor(double decay);
     void    setConvergence(bool convergence);
     void    setTolerance(double tol);
-    
+    void    setSmoothingType(SmoothingType type);
+    void    setSmoothingType(int type);
+    void    setRelaxation(double omega);
+    void    setPreconditioner(KSPPreconditioner type);
+    void    setPreconditioner(int type);
+
+    std::vector<MimmoObject*> getInvolvedGeometries();
     
     //XML utilities from reading writing settings to file
     virtual void absorbSectionXML(const bitpit::Config::Section & slotXML, std::string name="");
@@ -159,6 +204,18 @@ protected:
                            ivector2D &stencils,
                            dvector2D &weights);
 
+    void computeSmoothingOperator(ivector2D &stencils,
+                                  dvector2D &weights,
+                                  ivector1D &rowOffset,
+                                  ivector1D &columns,
+                                  dvector1D &values,
+                                  dvector1D &diagonal);
+
+    void computeNodeColors(const ivector1D &rowOffset,
+                           const ivector1D &columns,
+                           ivector1D &colorOffset,
+                           ivector1D &nodes);
+
 
 private:
     virtual bool checkBoundariesCoherence() = 0;
@@ -220,6 +277,9 @@ private:
  * - <B>SmoothingSteps</B> : number of steps the Smoother solver need to perform (1 default);
  * - <B>Convergence</B> : convergence flag for smoothing solver;
  * - <B>Tolerance</B> : convergence tolerance for laplacian smoothing and direct solver;
+ * - <B>SmoothingType</B> : sweep of the smoothing solver, 0-sequential, 1-multicolor Gauss-Seidel, 2-relaxed Jacobi (default 0);
+ * - <B>Relaxation</B> : relaxation factor of smoothing solver sweeps (1.0 default);
+ * - <B>Preconditioner</B> : preconditioner of Laplacian solver, 0-ILU, 1-algebraic multigrid (default 0);
  
  * Geometry, boundary surfaces, boundary condition values
  * for the target geometry have to be mandatorily passed through ports.
@@ -329,6 +389,9 @@ private:
  * - <B>SmoothingSteps</B> : number of steps the Smoother solver need to perform (1 default);
  * - <B>Convergence</B> : convergence flag for smoothing solver;
  * - <B>Tolerance</B> : convergence tolerance for laplacian smoothing and direct solver;
+ * - <B>SmoothingType</B> : sweep of the smoothing solver, 0-sequential, 1-multicolor Gauss-Seidel, 2-relaxed Jacobi (default 0);
+ * - <B>Relaxation</B> : relaxation factor of smoothing solver sweeps (1.0 default);
+ * - <B>Preconditioner</B> : preconditioner of Laplacian solver, 0-ILU, 1-algebraic multigrid (default 0);
  *
  * Proper fo the class:
  * - <B>MultiStep</B> : got deformation in a finite number of substep of solution;
@@ -368,6 +431,8 @@ public:
     void    setDirichletConditions(dmpvecarr3E bc);
     
     void    setSolverMultiStep(unsigned int sstep);
+
+    std::vector<MimmoObject*> getInvolvedGeometries();
     
     //execute
     void        execute();
@@ -24,6 +24,7 @@
 
 #include "customOperators.hpp"
 #include "SkdTreeUtils.hpp"
+#include <chrono>
 
 namespace mimmo{
 
@@ -59,6 +60,13 @@ void PropagateField<NCOMP>::setDefaults(){
     this->m_plateau = 0.0;
     this->m_dumpingActive = false;
     this->m_dumpingType = 0;
+    this->m_smoothingType = SmoothingType::SEQUENTIAL;
+    this->m_relaxation = 1.0;
+    this->m_preconditioner = KSPPreconditioner::DEFAULT;
+    this->m_solver.reset();
+    this->m_solverPattern = 0;
+    this->m_solverValues = 0;
+    this->m_solution.clear();
 }
 
 /*!
@@ -91,6 +99,9 @@ PropagateField<NCOMP>::PropagateField(const PropagateField<NCOMP> & other):BaseM
     this->m_plateau      = other.m_plateau;
     this->m_dumpingActive= other.m_dumpingActive;
     this->m_dumpingType = other.m_dumpingType;
+    this->m_smoothingType = other.m_smoothingType;
+    this->m_relaxation   = other.m_relaxation;
+    this->m_preconditioner = other.m_preconditioner;
 };
 
 /*!
@@ -116,6 +127,13 @@ void PropagateField<NCOMP>::swap(PropagateField<NCOMP> & x) noexcept {
     std::swap(this->m_plateau, x.m_plateau);
     std::swap(this->m_dumpingActive, x.m_dumpingActive);
     std::swap(this->m_dumpingType, x.m_dumpingType);
+    std::swap(this->m_smoothingType, x.m_smoothingType);
+    std::swap(this->m_relaxation, x.m_relaxation);
+    std::swap(this->m_preconditioner, x.m_preconditioner);
+    std::swap(this->m_solver, x.m_solver);
+    std::swap(this->m_solverPattern, x.m_solverPattern);
+    std::swap(this->m_solverValues, x.m_solverValues);
+    this->m_solution.swap(x.m_solution);
     this->BaseManipulation::swap(x);
 }
 
@@ -284,6 +302,57 @@ void PropagateField<NCOMP>::setTolerance(double tol){
     m_tol = tol;
 }
 
+/*!
+ * It sets the type of sweep performed by the smoothing solver.
+ * \param[in] type sequential, multicolor Gauss-Seidel or relaxed Jacobi.
+ */
+template <std::size_t NCOMP>
+void PropagateField<NCOMP>::setSmoothingType(SmoothingType type){
+    m_smoothingType = type;
+}
+
+/*!
+ * It sets the type of sweep performed by the smoothing solver.
+ * \param[in] type 0-sequential, 1-multicolor Gauss-Seidel, 2-relaxed Jacobi.
+ */
+template <std::size_t NCOMP>
+void PropagateField<NCOMP>::setSmoothingType(int type){
+    type = std::max(0, std::min(2, type));
+    setSmoothingType(static_cast<SmoothingType>(type));
+}
+
+/*!
+ * It sets the relaxation factor of the smoothing solver sweeps. Values greater than 1
+ * over-relax the update, values lower than 1 under-relax it.
+ * \param[in] omega relaxation factor in (0,2).
+ */
+template <std::size_t NCOMP>
+void PropagateField<NCOMP>::setRelaxation(double omega){
+    if(omega <= 0.0 || omega >= 2.0)   return;
+    m_relaxation = omega;
+}
+
+/*!
+ * It sets the preconditioner of the Krylov solver used by the Laplacian solver.
+ * The algebraic multigrid preconditioner is suggested on large meshes, where the number of iterations
+ * with ILU grows with the mesh size.
+ * \param[in] type preconditioner type.
+ */
+template <std::size_t NCOMP>
+void PropagateField<NCOMP>::setPreconditioner(KSPPreconditioner type){
+    m_preconditioner = type;
+}
+
+/*!
+ * It sets the preconditioner of the Krylov solver used by the Laplacian solver.
+ * \param[in] type 0-ILU, 1-algebraic multigrid.
+ */
+template <std::size_t NCOMP>
+void PropagateField<NCOMP>::setPreconditioner(int type){
+    type = std::max(0, std::min(1, type));
+    setPreconditioner(static_cast<KSPPreconditioner>(type));
+}
+
 
 /*!
  * It sets infos reading from a XML bitpit::Config::section.
@@ -355,6 +424,39 @@ void PropagateField<NCOMP>::absorbSectionXML(const bitpit::Config::Section & slo
         setTolerance(value);
     }
 
+    if(slotXML.hasOption("SmoothingType")){
+        std::string input = slotXML.get("SmoothingType");
+        input = bitpit::utils::string::trim(input);
+        int value = 0;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss >> value;
+        }
+        setSmoothingType(value);
+    }
+
+    if(slotXML.hasOption("Relaxation")){
+        std::string input = slotXML.get("Relaxation");
+        input = bitpit::utils::string::trim(input);
+        double value = 1.0;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss >> value;
+        }
+        setRelaxation(value);
+    }
+
+    if(slotXML.hasOption("Preconditioner")){
+        std::string input = slotXML.get("Preconditioner");
+        input = bitpit::utils::string::trim(input);
+        int value = 0;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss >> value;
+        }
+        setPreconditioner(value);
+    }
+
     if(slotXML.hasOption("Dumping")){
         std::string input = slotXML.get("Dumping");
         input = bitpit::utils::string::trim(input);
@@ -434,6 +536,9 @@ void PropagateField<NCOMP>::flushSectionXML(bitpit::Config::Section & slotXML, s
     slotXML.set("SmoothingSteps",std::to_string(m_sstep));
     slotXML.set("Convergence",std::to_string(int(m_convergence)));
     slotXML.set("Tolerance",std::to_string(m_tol));
+    slotXML.set("SmoothingType",std::to_string(static_cast<int>(m_smoothingType)));
+    slotXML.set("Relaxation",std::to_string(m_relaxation));
+    slotXML.set("Preconditioner",std::to_string(static_cast<int>(m_preconditioner)));
     slotXML.set("Dumping", std::to_string(int(m_dumpingActive)));
     if(m_dumpingActive){
         slotXML.set("DumpingInnerDistance",std::to_string(m_plateau));
@@ -445,6 +550,20 @@ void PropagateField<NCOMP>::flushSectionXML(bitpit::Config::Section & slotXML, s
 };
 
 
+/*!
+ * Return the geometries involved in the propagation: the bulk geometry and
+ * the Dirichlet and dumping boundary surfaces.
+ * \return list of geometries involved in the execution
+ */
+template <std::size_t NCOMP>
+std::vector<MimmoObject*>
+PropagateField<NCOMP>::getInvolvedGeometries(){
+    std::vector<MimmoObject*> result = BaseManipulation::getInvolvedGeometries();
+    if(m_bsurface != NULL)  result.push_back(m_bsurface);
+    if(m_dsurface != NULL)  result.push_back(m_dsurface);
+    return result;
+};
+
 /*!
  * Restore data as in class default construction.
  */
@@ -551,10 +670,16 @@ PropagateField<NCOMP>::computeDumpingFunction(){
 
 
 /*!
- * It applies a smoothing filter for a defined number of step.
+ * It applies a smoothing filter for a defined number of step, or until convergence
+ * if the convergence flag is active.
+ * Stencils are converted in CSR arrays with interleaved components (see computeSmoothingOperator).
+ * Each sweep is a sequential, a multicolor Gauss-Seidel or a Jacobi iteration, according to the
+ * smoothing type set, relaxed with the current relaxation factor. The sequential sweep reproduces
+ * the update of the original smoother, visiting the rows in the order of the stencils.
  * \param[in] nstep desired number of smoothing steps
  * \param[in] stencils stencil-ids of laplace operator on target mesh nodes
  * \param[in] weights  associated to stencils
+ * \param[in] rhs right-hand-side of laplacian linear system
  * \param[in] dataInv map of local node indexing of stencils vs global mesh node indexing.
  *                    If map is empty, the method itself provides its evaluation from class target mesh.
  * \param[out] field resulting field after smoothing
@@ -570,7 +695,6 @@ PropagateField<NCOMP>::solveSmoothing(int nstep,
 {
     long ID;
     int ind;
-    field.clear();
 
     //initialize field
     field.clear();
@@ -578,56 +702,106 @@ PropagateField<NCOMP>::solveSmoothing(int nstep,
         ID = vertex.getId();
         field.insert(ID, std::array<double, NCOMP>({}));
     }
-    
-    //found maxval in rhs for normalization purposes
-    double maxval = 0.0;
-    for (const auto & val : rhs){
-        maxval = std::max(maxval, val);
+
+    ivector1D rowOffset, columns;
+    dvector1D values, diagonal;
+    computeSmoothingOperator(stencils, weights, rowOffset, columns, values, diagonal);
+
+    const int nrows = NCOMP*m_np;
+    const double omega = m_relaxation;
+
+    //interleaved right-hand-side and initial guess
+    dvector1D b(nrows);
+    for (int i=0; i<m_np; ++i){
+        for (int icomp=0; icomp<int(NCOMP); ++icomp){
+            b[i*NCOMP + icomp] = rhs[i + icomp*m_np];
+        }
     }
-    
-    dvector1D guess = rhs;
-    
+    dvector1D guess = b;
+    dvector1D previous;
+
+    ivector1D colorOffset, nodes;
+    if (m_smoothingType == SmoothingType::GAUSSSEIDEL){
+        computeNodeColors(rowOffset, columns, colorOffset, nodes);
+    }else if (m_smoothingType == SmoothingType::JACOBI){
+        previous.resize(nrows);
+    }
+    int ncolors = std::max(0, int(colorOffset.size()) - 1);
+
     (*m_log)<< m_name <<" starts field propagation."<<std::endl;
-    
-    for (int istep = 0; istep < nstep; istep++){
+    if (m_smoothingType == SmoothingType::SEQUENTIAL){
+        (*m_log)<< m_name <<" sequential smoothing."<<std::endl;
+    }else if (m_smoothingType == SmoothingType::GAUSSSEIDEL){
+        (*m_log)<< m_name <<" Gauss-Seidel smoothing on "<<ncolors<<" colors."<<std::endl;
+    }else{
+        (*m_log)<< m_name <<" Jacobi smoothing."<<std::endl;
+    }
 
-        if (!m_convergence) (*m_log)<<m_name << " smoothing step : " << istep+1 << " / " << nstep <<std::endl;
+    //no sweep for nstep == 0; with convergence check, sweeps go on until the residual drops below the tolerance.
+    int istep = 0;
+    while (istep < nstep){
 
         double maxdiff = 0.0;
-        for (int locId=0; locId<NCOMP*m_np; ++locId){
-
-            double delta = 0.0;
-            std::size_t sizeStencil = stencils[locId].size();
-            for (std::size_t i=0; i<sizeStencil; ++i){
-                delta += -1.0*guess[stencils[locId][i]]*weights[locId][i];
+        if (m_smoothingType == SmoothingType::SEQUENTIAL){
+            for (int icomp=0; icomp<int(NCOMP); ++icomp){
+                for (int i=0; i<m_np; ++i){
+                    int row = i*NCOMP + icomp;
+                    double delta = 0.0;
+                    for (int j=rowOffset[row]; j<rowOffset[row+1]; ++j){
+                        delta += -1.0*guess[columns[j]]*values[j];
+                    }
+                    delta += b[row];
+                    delta *= omega;
+                    guess[row] += delta;
+                    maxdiff = std::max(maxdiff, std::abs(delta));
+                }
             }
-            delta += rhs[locId];
-            guess[locId] += delta;
-            
-            if (m_convergence){
-                maxdiff = std::max(maxdiff, delta);
+        }else if (m_smoothingType == SmoothingType::GAUSSSEIDEL){
+            for (int icolor=0; icolor<ncolors; ++icolor){
+#pragma omp parallel for schedule(static) reduction(max:maxdiff)
+                for (int k=colorOffset[icolor]; k<colorOffset[icolor+1]; ++k){
+                    for (int row=nodes[k]*NCOMP; row<(nodes[k]+1)*int(NCOMP); ++row){
+                        double delta = b[row];
+                        for (int j=rowOffset[row]; j<rowOffset[row+1]; ++j){
+                            delta -= values[j]*guess[columns[j]];
+                        }
+                        delta *= omega / diagonal[row];
+                        guess[row] += delta;
+                        maxdiff = std::max(maxdiff, std::abs(delta));
+                    }
+                }
             }
-        }//end for vertex
-
-        if (m_convergence) (*m_log)<< m_name<<" residual : " << maxdiff <<std::endl;
+        }else{
+            previous.swap(guess);
+#pragma omp parallel for schedule(static) reduction(max:maxdiff)
+            for (int row=0; row<nrows; ++row){
+                double delta = b[row];
+                for (int j=rowOffset[row]; j<rowOffset[row+1]; ++j){
+                    delta -= values[j]*previous[columns[j]];
+                }
+                delta *= omega / diagonal[row];
+                guess[row] = previous[row] + delta;
+                maxdiff = std::max(maxdiff, std::abs(delta));
+            }
+        }
+        ++istep;
 
-        //convergence
         if (m_convergence){
-            if (maxdiff <= m_tol)
-                istep = nstep;
-            else{
-                nstep = istep+2;
-            }
+            (*m_log)<< m_name<<" residual : " << maxdiff <<std::endl;
+            if (maxdiff <= m_tol) break;
+            nstep = istep + 1;
+        }else{
+            (*m_log)<<m_name << " smoothing step : " << istep << " / " << nstep <<std::endl;
         }
     }// end step
 
     (*m_log)<< m_name<<" ends field propagation."<<std::endl;
 
     for (auto vertex : getGeometry()->getVertices()){
-        for (int icomp=0; icomp<NCOMP; ++icomp ){ 
-            ID = vertex.getId();
-            ind = dataInv[ID];
-            field[ID][icomp] = guess[ind + icomp*m_np];
+        ID = vertex.getId();
+        ind = dataInv[ID];
+        for (int icomp=0; icomp<int(NCOMP); ++icomp ){
+            field[ID][icomp] = guess[ind*NCOMP + icomp];
         }
     }
     
@@ -635,9 +809,142 @@ PropagateField<NCOMP>::solveSmoothing(int nstep,
     field.setGeometry(getGeometry());
 }
 
+/*!
+ * Convert laplacian stencils in CSR arrays for the smoothing solver. Rows and columns are
+ * renumbered interleaving the components, i.e. the unknown ind + icomp*m_np of the stencils
+ * becomes ind*NCOMP + icomp, so that the components of a node are stored contiguously.
+ * Diagonal coefficients are stored also apart; missing diagonals are assumed unitary.
+ *
+ * \param[in] stencils stencil-ids of laplace operator on target mesh nodes
+ * \param[in] weights  associated to stencils
+ * \param[out] rowOffset offset of each row in columns/values arrays (size NCOMP*m_np+1)
+ * \param[out] columns interleaved column index of each coefficient
+ * \param[out] values coefficients of the operator
+ * \param[out] diagonal diagonal coefficients of each interleaved row
+ */
+template<std::size_t NCOMP>
+void
+PropagateField<NCOMP>::computeSmoothingOperator(ivector2D &stencils,
+                                                dvector2D &weights,
+                                                ivector1D &rowOffset,
+                                                ivector1D &columns,
+                                                dvector1D &values,
+                                                dvector1D &diagonal)
+{
+    const int nrows = NCOMP*m_np;
+    auto interleave = [this](int index){
+        return (index % m_np)*int(NCOMP) + index / m_np;
+    };
+
+    rowOffset.assign(nrows+1, 0);
+    for (int row=0; row<nrows; ++row){
+        rowOffset[interleave(row)+1] = int(stencils[row].size());
+    }
+    for (int row=0; row<nrows; ++row){
+        rowOffset[row+1] += rowOffset[row];
+    }
+
+    columns.resize(rowOffset[nrows]);
+    values.resize(rowOffset[nrows]);
+    diagonal.assign(nrows, 1.0);
+#pragma omp parallel for schedule(static)
+    for (int row=0; row<nrows; ++row){
+        int irow = interleave(row);
+        int pos = rowOffset[irow];
+        std::size_t sizeStencil = stencils[row].size();
+        for (std::size_t i=0; i<sizeStencil; ++i){
+            int icol = interleave(stencils[row][i]);
+            columns[pos] = icol;
+            values[pos] = weights[row][i];
+            if (icol == irow && weights[row][i] != 0.0)  diagonal[irow] = weights[row][i];
+            ++pos;
+        }
+    }
+}
+
+/*!
+ * Greedy coloring of the graph of mesh nodes induced by the smoothing operator, so that
+ * nodes of the same color do not appear in each other stencils. The graph is symmetrized,
+ * since boundary stencils may not reference their neighbours.
+ *
+ * \param[in] rowOffset offset of each interleaved row in columns array
+ * \param[in] columns interleaved column index of each coefficient
+ * \param[out] colorOffset offset of each color in nodes array (size number of colors+1)
+ * \param[out] nodes local node indices sorted by color
+ */
+template<std::size_t NCOMP>
+void
+PropagateField<NCOMP>::computeNodeColors(const ivector1D &rowOffset,
+                                         const ivector1D &columns,
+                                         ivector1D &colorOffset,
+                                         ivector1D &nodes)
+{
+    //symmetric node adjacency in CSR form
+    ivector1D adjOffset(m_np+1, 0);
+    for (int row=0; row<int(NCOMP)*m_np; ++row){
+        int inode = row / NCOMP;
+        for (int j=rowOffset[row]; j<rowOffset[row+1]; ++j){
+            int jnode = columns[j] / NCOMP;
+            if (jnode == inode) continue;
+            ++adjOffset[inode+1];
+            ++adjOffset[jnode+1];
+        }
+    }
+    for (int i=0; i<m_np; ++i){
+        adjOffset[i+1] += adjOffset[i];
+    }
+    ivector1D adjacency(adjOffset[m_np]);
+    ivector1D fill(adjOffset.begin(), adjOffset.end()-1);
+    for (int row=0; row<int(NCOMP)*m_np; ++row){
+        int inode = row / NCOMP;
+        for (int j=rowOffset[row]; j<rowOffset[row+1]; ++j){
+            int jnode = columns[j] / NCOMP;
+            if (jnode == inode) continue;
+            adjacency[fill[inode]++] = jnode;
+            adjacency[fill[jnode]++] = inode;
+        }
+    }
+
+    //greedy coloring, first color not used by already colored neighbours
+    ivector1D color(m_np, -1);
+    ivector1D mark;
+    int ncolors = 0;
+    for (int i=0; i<m_np; ++i){
+        for (int j=adjOffset[i]; j<adjOffset[i+1]; ++j){
+            int c = color[adjacency[j]];
+            if (c >= 0) mark[c] = i;
+        }
+        int c = 0;
+        while (c < ncolors && mark[c] == i) ++c;
+        if (c == ncolors){
+            ++ncolors;
+            mark.push_back(-1);
+        }
+        color[i] = c;
+    }
+
+    //nodes sorted by color
+    colorOffset.assign(ncolors+1, 0);
+    for (int i=0; i<m_np; ++i){
+        ++colorOffset[color[i]+1];
+    }
+    for (int c=0; c<ncolors; ++c){
+        colorOffset[c+1] += colorOffset[c];
+    }
+    nodes.resize(m_np);
+    fill.assign(colorOffset.begin(), colorOffset.end()-1);
+    for (int i=0; i<m_np; ++i){
+        nodes[fill[color[i]]++] = i;
+    }
+}
+
 /*!
  * It solves the laplacian problem. Stencils, weights and rhs must be already corrected to 
  * account of boundary condition of the problem. See calculateStencilsLaplace and calculateRHSLaplace method.
+ * The NCOMP components are solved as a single block system with interleaved unknowns.
+ * The system assembled is cached in the class: following calls with the same laplacian operator
+ * only update the right-hand-side, calls with the same non-zero pattern refill the matrix coefficients.
+ * The solution of the previous call is the initial guess of the iterative solver.
  * 
  * \param[in] stencils stencil-ids of laplace operator on target mesh nodes
  * \param[in] weights  associated to stencils
@@ -661,39 +968,96 @@ PropagateField<NCOMP>::solveLaplace(ivector2D &stencils,
         field.insert(ID, std::array<double, NCOMP>({}));
     }
 
+    //block system with interleaved components
+    ivector1D rowOffset, columns;
+    dvector1D values, diagonal;
+    computeSmoothingOperator(stencils, weights, rowOffset, columns, values, diagonal);
+
+    const int nrows = NCOMP*m_np;
+    ivector2D blockStencils(nrows);
+    dvector2D blockWeights(nrows);
+    dvector1D blockRhs(nrows);
+    for (int row=0; row<nrows; ++row){
+        blockStencils[row].assign(columns.begin() + rowOffset[row], columns.begin() + rowOffset[row+1]);
+        blockWeights[row].assign(values.begin() + rowOffset[row], values.begin() + rowOffset[row+1]);
+    }
+    for (int i=0; i<m_np; ++i){
+        for (int icomp=0; icomp<int(NCOMP); ++icomp){
+            blockRhs[i*NCOMP + icomp] = rhs[i + icomp*m_np];
+        }
+    }
+
+    //fingerprints (FNV-1a) of the operator, to detect if the cached system can be reused
+    auto fingerprint = [](const unsigned char * data, std::size_t size, std::size_t hash){
+        for (std::size_t i=0; i<size; ++i){
+            hash = (hash ^ data[i]) * std::size_t(1099511628211ULL);
+        }
+        return hash;
+    };
+    std::size_t pattern = std::size_t(14695981039346656037ULL);
+    pattern = fingerprint(reinterpret_cast<const unsigned char *>(rowOffset.data()), rowOffset.size()*sizeof(int), pattern);
+    pattern = fingerprint(reinterpret_cast<const unsigned char *>(columns.data()), columns.size()*sizeof(int), pattern);
+    std::size_t coefficients = fingerprint(reinterpret_cast<const unsigned char *>(values.data()), values.size()*sizeof(double), pattern);
+
     // Create the system for solving the pressure
-    m_solver = std::unique_ptr<mimmo::SystemSolver>(new mimmo::SystemSolver(false));
+    if (!m_solver){
+        m_solver = std::unique_ptr<mimmo::SystemSolver>(new mimmo::SystemSolver(false));
+    }
 
     // Initialize the system
     KSPOptions &solverOptions = m_solver->getKSPOptions();
+    bool preconditionerChanged = (solverOptions.preconditioner != m_preconditioner);
     solverOptions.nullspace = false;
     solverOptions.rtol      = m_tol;
     solverOptions.subrtol   = m_tol;
+    solverOptions.preconditioner = m_preconditioner;
 
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    if (!m_solver->isInitialized() || pattern != m_solverPattern || m_solver->getBlockSize() != int(NCOMP) || preconditionerChanged){
+        (*m_log)<< m_name <<" assembles laplacian operator."<<std::endl;
+        m_solver->setBlockSize(NCOMP);
 #if ENABLE_MPI==1
-        m_solver->initialize(stencils, weights, rhs, ghosts);
+        m_solver->initialize(blockStencils, blockWeights, blockRhs, ghosts);
 #else
-        m_solver->initialize(stencils, weights, rhs);
+        m_solver->initialize(blockStencils, blockWeights, blockRhs);
 #endif
+        m_solution.clear();
+    }else if (coefficients != m_solverValues){
+        (*m_log)<< m_name <<" updates laplacian operator coefficients."<<std::endl;
+        m_solver->update(blockStencils, blockWeights, blockRhs);
+    }else{
+        (*m_log)<< m_name <<" reuses cached laplacian operator."<<std::endl;
+    }
+    m_solverPattern = pattern;
+    m_solverValues = coefficients;
 
-    // Solve the system
-    m_solver->solve();
+    // Solve the system, starting from the previous solution
+    if (int(m_solution.size()) != nrows){
+        m_solution.assign(nrows, 0.0);
+    }
+    std::chrono::time_point<std::chrono::steady_clock> setup = std::chrono::steady_clock::now();
+    m_solver->solve(m_solution, blockRhs);
+    std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+
+    const KSPStatus & status = m_solver->getKSPStatus();
+    (*m_log)<< m_name <<" laplacian solver iterations : "<<status.its<<std::endl;
+    (*m_log)<< m_name <<" laplacian solver setup time : "<<std::chrono::duration<double>(setup - start).count()
+            <<" s, solve time : "<<std::chrono::duration<double>(end - setup).count()<<" s"<<std::endl;
+    if (status.convergence < 0){
+        (*m_log)<<"warning: "<< m_name <<" laplacian solver not converged, reason : "<<int(status.convergence)<<std::endl;
+    }
 
     // Get the solution
-    const double *solution = m_solver->getSolutionRawReadPtr();
-
     long ID;
     int ind;
     for (auto vertex : getGeometry()->getVertices()){
-        for (int icomp=0; icomp<NCOMP; ++icomp ){ 
-            ID = vertex.getId();
-            ind = dataInv[ID];
-            field[ID][icomp] = solution[ind + icomp*m_np];
+        ID = vertex.getId();
+        ind = dataInv[ID];
+        for (int icomp=0; icomp<int(NCOMP); ++icomp ){
+            field[ID][icomp] = m_solution[ind*NCOMP + icomp];
         }
     }
 
-    // Clear the solver
-    m_solver->clear();
     field.setDataLocation(MPVLocation::POINT);
     field.setGeometry(getGeometry());
 }
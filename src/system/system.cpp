@@ -24,6 +24,7 @@
 
 //TODO PARALLEL !  DON'T CONSIDER CODE IN ENABLE_MPI (from gloria) !!
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
@@ -69,7 +70,7 @@ SystemSolver::SystemSolver(MPI_Comm communicator, bool debug)
 #else
 SystemSolver::SystemSolver(bool debug)
 #endif
-: m_initialized(false), m_pivotType(PIVOT_NONE)
+: m_initialized(false), m_pivotType(PIVOT_NONE), m_blockSize(1)
 {
     // Add debug options
     if (debug) {
@@ -111,6 +112,9 @@ SystemSolver::SystemSolver(bool debug)
  */
 SystemSolver::~SystemSolver()
 {
+    // Free the PETSc objects of the system, before PETSc is finalized
+    clear();
+
     // Decrease the number of instances
     --m_nInstances;
 
@@ -200,6 +204,67 @@ void SystemSolver::initialize(localivector2D &stencils, localdvector2D &weights,
     m_initialized = true;
 }
 
+/*!
+ * Update the values of an initialized system, keeping the Krylov solver and the
+ * matrix structure. The preconditioner is rebuilt on the new values at the next solve.
+ * If the system is not initialized or it is reordered by pivoting, the system is
+ * initialized again from scratch.
+ *
+ * \param stencils are the stencils that define the matrix, they must have the same
+ * non-zero pattern used in initialization
+ * \param weights are the new matrix coefficients
+ * \param rhs is the new right-hand-side
+ */
+void SystemSolver::update(localivector2D &stencils, localdvector2D &weights, localdvector1D &rhs)
+{
+    if (!m_initialized || getPivotType() != PIVOT_NONE) {
+#if ENABLE_MPI==1
+        throw std::runtime_error("Update of not initialized or pivoted systems is not supported in parallel.");
+#else
+        initialize(stencils, weights, rhs, getPivotType());
+        return;
+#endif
+    }
+
+    MatZeroEntries(m_A);
+    std::unordered_map<long, double>().swap(m_A_rhs);
+    matrixFill(stencils, weights, rhs);
+
+    KSPSetOperators(m_KSP, m_A, m_A);
+}
+
+/*!
+ * Check if the system is initialized.
+ *
+ * \result True if the system is initialized.
+ */
+bool SystemSolver::isInitialized() const
+{
+    return m_initialized;
+}
+
+/*!
+ * Set the block size of the system, i.e. the number of coupled unknowns stored
+ * contiguously for each node. The number of rows of the system has to be a multiple
+ * of the block size. The block size is used in the next initialization.
+ *
+ * \param blockSize is the block size
+ */
+void SystemSolver::setBlockSize(int blockSize)
+{
+    m_blockSize = std::max(1, blockSize);
+}
+
+/*!
+ * Get the block size of the system.
+ *
+ * \result The block size.
+ */
+int SystemSolver::getBlockSize() const
+{
+    return m_blockSize;
+}
+
 /*!
  * Solve the system
  */
@@ -228,6 +293,10 @@ void SystemSolver::solve()
         vectorsReorder(PETSC_FALSE);
     }
 
+    // Apply the current tolerances, they may be changed through getKSPOptions
+    // after the initialization of the Krylov solver
+    KSPSetTolerances(m_KSP, m_KSPOptions.rtol, PETSC_DEFAULT, 1e10, m_KSPOptions.maxits);
+
     // Solve the system
     m_KSPStatus.error = KSPSolve(m_KSP, m_rhs, m_solution);
 
@@ -333,7 +402,11 @@ void SystemSolver::matrixInit(localivector2D &stencils)
 #if ENABLE_MPI == 1
     MatCreateAIJ(m_communicator, nRows, nRows, PETSC_DETERMINE, PETSC_DETERMINE, 0, d_nnz.data(), 0, o_nnz.data(), &m_A);
 #else
-    MatCreateSeqAIJ(PETSC_COMM_SELF, nRows, nRows, 0, d_nnz.data(), &m_A);
+    MatCreate(PETSC_COMM_SELF, &m_A);
+    MatSetSizes(m_A, nRows, nRows, nRows, nRows);
+    MatSetType(m_A, MATSEQAIJ);
+    MatSetBlockSize(m_A, m_blockSize);
+    MatSeqAIJSetPreallocation(m_A, 0, d_nnz.data());
 #endif
 }
 
@@ -425,6 +498,8 @@ void SystemSolver::vectorsInit()
 #else
     VecCreateSeq(PETSC_COMM_SELF, nColumns, &m_solution);
     VecCreateSeq(PETSC_COMM_SELF, nRows, &m_rhs);
+    VecSetBlockSize(m_solution, m_blockSize);
+    VecSetBlockSize(m_rhs, m_blockSize);
 #endif
 }
 
@@ -461,6 +536,7 @@ void SystemSolver::vectorsFill(std::vector<double> &solution, std::vector<double
     VecGetArray(m_rhs, &raw_rhs);
     for (int i = 0; i < nRows; ++i) {
         raw_rhs[i] = rhs[i];
+        m_A_rhs[i] = rhs[i];
     }
     VecRestoreArray(m_rhs, &raw_rhs);
 
@@ -708,7 +784,13 @@ void SystemSolver::KSPInit()
 
     PC preconditioner;
     KSPGetPC(m_KSP, &preconditioner);
-    if (nProcessors > 1) {
+    if (m_KSPOptions.preconditioner == KSPPreconditioner::AMG) {
+        // Smoothed aggregation multigrid, the block size of the matrix is used
+        // to aggregate the coupled unknowns of each node.
+        PCSetType(preconditioner, PCGAMG);
+        PCGAMGSetType(preconditioner, PCGAMGAGG);
+        PCGAMGSetNSmooths(preconditioner, m_KSPOptions.mgsmooths);
+    } else if (nProcessors > 1) {
         PCSetType(preconditioner, PCASM);
         PCASMSetOverlap(preconditioner, m_KSPOptions.overlap);
     } else {
@@ -719,7 +801,7 @@ void SystemSolver::KSPInit()
     KSPSetUp(m_KSP);
 
     // Set ASM sub block preconditioners
-    if (nProcessors > 1) {
+    if (nProcessors > 1 && m_KSPOptions.preconditioner != KSPPreconditioner::AMG) {
         KSP *subksp;
         PC subpc;
         PetscInt nlocal, first;
@@ -735,6 +817,8 @@ void SystemSolver::KSPInit()
 
 /*!
  * Get a reference to the options associated to the Kryolov solver.
+ * Changes of rtol and maxits are applied at the next solve, the other
+ * options at the next initialization.
  *
  * \return A reference to the options associated to the Kryolov solver.
  */
@@ -40,6 +40,16 @@ typedef std::vector<std::vector<int>>  localivector2D;   /**< mimmo custom typed
 typedef std::vector<std::vector<double>>  localdvector2D;   /**< mimmo custom typedef*/
 typedef std::vector<double>  localdvector1D;   /**< mimmo custom typedef*/
 
+/*!
+ * \enum KSPPreconditioner
+ * \ingroup system
+ * \brief Preconditioner of the PETSc Krylov solver.
+ */
+enum class KSPPreconditioner {
+    DEFAULT = 0,    /**< ILU in serial, ASM with ILU sub-blocks in parallel */
+    AMG = 1         /**< PETSc smoothed aggregation algebraic multigrid (GAMG) */
+};
+
 /*!
  * \struct KSPOptions
  * \ingroup system
@@ -54,10 +64,13 @@ struct KSPOptions {
     PetscScalar rtol;
     PetscScalar subrtol;
     bool nullspace;
+    KSPPreconditioner preconditioner;
+    PetscInt mgsmooths;
 
     KSPOptions()
     : restart(50), levels(1), overlap(0), sublevels(4),
-      maxits(10000), rtol(1.e-13), subrtol(1.e-13), nullspace(false)
+      maxits(10000), rtol(1.e-13), subrtol(1.e-13), nullspace(false),
+      preconditioner(KSPPreconditioner::DEFAULT), mgsmooths(1)
     {
     }
 };
@@ -114,9 +127,14 @@ public:
     void initialize(localivector2D &stencils, localdvector2D &weights,
             localdvector1D &rhs, PivotType pivotType = PIVOT_NONE);
 #endif
+    void update(localivector2D &stencils, localdvector2D &weights, localdvector1D &rhs);
     void solve();
     void solve(std::vector<double> &solution, std::vector<double> &rhs);
 
+    bool isInitialized() const;
+    void setBlockSize(int blockSize);
+    int  getBlockSize() const;
+
     void dump(const std::string &directory, const std::string &prefix = "") const;
 
     PivotType getPivotType();
@@ -143,6 +161,7 @@ private:
 
     bool m_initialized;
     PivotType m_pivotType;
+    int m_blockSize;
 
     MPI_Comm m_communicator;
 
@@ -24,6 +24,8 @@
 #include "ControlDeformExtSurface.hpp"
 #include "SkdTreeUtils.hpp"
 #include <cmath>
+#include <functional>
+#include <sys/stat.h>
 
 namespace mimmo{
 
@@ -33,6 +35,8 @@ namespace mimmo{
 ControlDeformExtSurface::ControlDeformExtSurface(){
     m_name = "mimmo.ControlDeformExtSurface";
     m_cellBackground = 50;
+    m_useDistanceCache = false;
+    m_distanceCacheBand = 5;
     m_allowed.insert((FileType::_from_string("STL"))._to_integral());
     m_allowed.insert((FileType::_from_string("SURFVTU"))._to_integral());
     m_allowed.insert((FileType::_from_string("NAS"))._to_integral());
@@ -47,6 +51,8 @@ ControlDeformExtSurface::ControlDeformExtSurface(const bitpit::Config::Section &
 
     m_name = "mimmo.ControlDeformExtSurface";
     m_cellBackground = 50;
+    m_useDistanceCache = false;
+    m_distanceCacheBand = 5;
     m_allowed.insert((FileType::_from_string("STL"))._to_integral());
     m_allowed.insert((FileType::_from_string("SURFVTU"))._to_integral());
     m_allowed.insert((FileType::_from_string("NAS"))._to_integral());
@@ -66,12 +72,16 @@ ControlDeformExtSurface::ControlDeformExtSurface(const bitpit::Config::Section &
 ControlDeformExtSurface::~ControlDeformExtSurface(){};
 
 /*!Copy constructor of ControlDeformExtSurface. Deformation field referred to geometry 
- * and result violation field are not copied.
+ * and result violation field are not copied. Cached constraint distance fields are shared.
  */
 ControlDeformExtSurface::ControlDeformExtSurface(const ControlDeformExtSurface & other):BaseManipulation(other){
     m_allowed = other.m_allowed;
     m_geolist = other.m_geolist;
     m_cellBackground = other.m_cellBackground;
+    m_useDistanceCache = other.m_useDistanceCache;
+    m_distanceCacheDir = other.m_distanceCacheDir;
+    m_distanceCacheBand = other.m_distanceCacheBand;
+    m_distanceCache = other.m_distanceCache;
 };
 
 /*!
@@ -92,6 +102,10 @@ void ControlDeformExtSurface::swap(ControlDeformExtSurface & x) noexcept
     std::swap(m_allowed, x.m_allowed);
     std::swap(m_geolist, x.m_geolist);
     std::swap(m_cellBackground, x.m_cellBackground);
+    std::swap(m_useDistanceCache, x.m_useDistanceCache);
+    std::swap(m_distanceCacheDir, x.m_distanceCacheDir);
+    std::swap(m_distanceCacheBand, x.m_distanceCacheBand);
+    std::swap(m_distanceCache, x.m_distanceCache);
 //     std::swap(m_violationField, x.m_violationField);
 //     std::swap(m_defField, x.m_defField);
     m_violationField.swap(x.m_violationField);
@@ -165,6 +179,30 @@ ControlDeformExtSurface::getBackgroundDetails(){
     return m_cellBackground;
 }
 
+/*!
+ * \return true if constraint distance fields are cached across executions.
+ */
+bool
+ControlDeformExtSurface::isDistanceCacheActive(){
+    return m_useDistanceCache;
+}
+
+/*!
+ * \return directory where constraint distance fields are persisted (empty if not persisted).
+ */
+std::string
+ControlDeformExtSurface::getDistanceCacheDir(){
+    return m_distanceCacheDir;
+}
+
+/*!
+ * \return width of the narrow band of constraint distance fields, in number of background cells.
+ */
+int
+ControlDeformExtSurface::getDistanceCacheBand(){
+    return m_distanceCacheBand;
+}
+
 /*!
  * Set the deformative field associated to each point of the target geometry. 
  * Field resize occurs in execution, if point dimension between field and geoemetry does not match.
@@ -174,7 +212,7 @@ void
 ControlDeformExtSurface::setDefField(dmpvecarr3E field){
     m_defField.clear();
     m_violationField.clear();
-    m_defField = field;
+    m_defField = std::move(field);
 };
 
 /*!
@@ -208,6 +246,41 @@ ControlDeformExtSurface::setBackgroundDetails(int nCell){
     m_cellBackground = std::fmax(2, nCell);
 }
 
+/*!
+ * Activate/deactivate caching of constraint geometries and of their signed distance fields.
+ * If active, each constraint file is read once and its signed distance is sampled on a narrow band
+ * cartesian grid, whose spacing is the diagonal of the constraint bounding box divided by
+ * the number of cells set in setBackgroundDetails(). Distances of deformed points are then
+ * interpolated on the field, falling back on exact evaluation out of the band or close to the constraint.
+ * If not active, constraints are read and evaluated from scratch at each execution.
+ * \param[in] active true to activate the cache (default false).
+ */
+void
+ControlDeformExtSurface::setDistanceCache(bool active){
+    m_useDistanceCache = active;
+}
+
+/*!
+ * Set a directory where constraint distance fields are written, and reloaded by following runs
+ * as long as the constraint file (path, size and modification time) and the grid parameters are unchanged.
+ * An empty directory keeps fields in memory only.
+ * \param[in] dir directory of persisted distance fields.
+ */
+void
+ControlDeformExtSurface::setDistanceCacheDir(std::string dir){
+    m_distanceCacheDir = dir;
+}
+
+/*!
+ * Set the width of the narrow band of constraint distance fields, in number of background cells.
+ * Deformed points farther than the band from a constraint are evaluated exactly.
+ * \param[in] nCells band width in background cells (minimum 2, default 5).
+ */
+void
+ControlDeformExtSurface::setDistanceCacheBand(int nCells){
+    m_distanceCacheBand = std::max(2, nCells);
+}
+
 
 /*!
  * Return the actual list of external geometry files selected as constraint to check your deformation.
@@ -263,6 +336,7 @@ void     ControlDeformExtSurface::addFile(std::string file, double tol, FileType
 void
 ControlDeformExtSurface::removeFile(std::string file){
     if(m_geolist.count(file) >0)    m_geolist.erase(file);
+    m_distanceCache.erase(file);
 };
 
 /*!
@@ -271,6 +345,7 @@ ControlDeformExtSurface::removeFile(std::string file){
 void
 ControlDeformExtSurface::removeFiles(){
     m_geolist.clear();
+    m_distanceCache.clear();
 };
 
 /*!
@@ -283,6 +358,10 @@ ControlDeformExtSurface::clear(){
     m_violationField.clear();
     BaseManipulation::clear();
     m_cellBackground = 50;
+    m_useDistanceCache = false;
+    m_distanceCache.clear();
+    m_distanceCacheDir.clear();
+    m_distanceCacheBand = 5;
 };
 
 /*!Execution command. Calculate violation value and store it in the class member m_violationField
@@ -345,13 +424,24 @@ ControlDeformExtSurface::execute(){
 
     //***************************************************************
 
-    //read external surfaces*****************************************
+    //collect external surfaces, from the distance cache or reading them*
     std::vector<std::unique_ptr<MimmoGeometry> > extgeo;
+    std::vector<std::shared_ptr<DistanceCache> > caches;
     dvector1D tols;
-    readGeometries(extgeo, tols);
+    if(m_useDistanceCache){
+        for(const auto & geoinfo : m_geolist){
+            std::shared_ptr<DistanceCache> cache = getDistanceCache(geoinfo.first, geoinfo.second.second);
+            if(!cache)  continue;
+            caches.push_back(cache);
+            tols.push_back(geoinfo.second.first);
+        }
+    }else{
+        readGeometries(extgeo, tols);
+    }
+    std::size_t nExtGeo = m_useDistanceCache ? caches.size() : extgeo.size();
     //***************************************************************
 
-    if(extgeo.size() < 1) {
+    if(nExtGeo < 1) {
         throw std::runtime_error (m_name + " : read of all external geometries failed. Empty valid constraint geometries list.");
     }
 
@@ -382,14 +472,20 @@ ControlDeformExtSurface::execute(){
         }
     }
     //***************************************************************
-    int counterExtGeo =0;
     // start examining all external geometries***********************
-    for(const auto &gg : extgeo){
+    for(std::size_t counterExtGeo=0; counterExtGeo<nExtGeo; ++counterExtGeo){
 
         //check constraints properties ******************************
-        MimmoObject * local = gg->getGeometry();
+        DistanceCache * cache = m_useDistanceCache ? caches[counterExtGeo].get() : nullptr;
+        MimmoObject * local = cache ? cache->geometry->getGeometry() : extgeo[counterExtGeo]->getGeometry();
         if(!(local->isSkdTreeSync()))    local->buildSkdTree();
-        bool checkOpen = local->isClosedLoop();
+        bool checkOpen = cache ? cache->closedLoop : local->isClosedLoop();
+
+        //signed distances, interpolated on the cached distance field if any, exact otherwise
+        auto signedDistances = [&](const dvecarr3E & targets, double initRadius) -> dvector1D {
+            if(cache)   return evaluateCachedSignedDistance(targets, *cache, initRadius);
+            return evaluateSignedDistance(targets, local, initRadius);
+        };
 
         double dist;
         double radius, radius_old;
@@ -430,9 +526,9 @@ ControlDeformExtSurface::execute(){
         double nReq = double(dim[0]+1)*double(dim[1]+1)*double(dim[2]+1);
         double nAva = 0.8*nDFS;
 
-        if( nReq > nAva){
+        if(cache || nReq > nAva){
 
-            //going to use direct evaluation.
+            //going to use cached distance fields or direct evaluation.
 
             radius = distBary;
             radius_old = radius;
@@ -440,12 +536,10 @@ ControlDeformExtSurface::execute(){
 
             //get the actual sign of distance of the undeformed cloud w.r.t constraints
             if(checkOpen){
+                dvector1D distOR = signedDistances(pointsOR, radius);
                 count = 0;
-                for(auto &p : pointsOR){
-                    dist = evaluateSignedDistance(p, local, id, normal, radius);
-                    if(radius < 1.0E-12)    radius = radius_old;
-                    else                     radius_old = radius;
-                    if(dist < 0.0)    refsigns[count] = -1.0;
+                for(double val : distOR){
+                    if(val < 0.0)    refsigns[count] = -1.0;
                     count++;
                 }
             }else{
@@ -456,13 +550,9 @@ ControlDeformExtSurface::execute(){
             }
 
             //evaluate distance of the deformation cloud w.r.t. constraints
-            count = 0;
-            for(auto &p : points){
-                dist = evaluateSignedDistance(p, local, id, normal, radius);
-                if(radius < 1.0E-12)    radius = radius_old;
-                else                     radius_old = radius;
-                violationField[count] = -1.0*refsigns[count]*dist;
-                count++;
+            dvector1D distDef = signedDistances(points, radius);
+            for(count=0; count<(int)distDef.size(); ++count){
+                violationField[count] = -1.0*refsigns[count]*distDef[count];
             }
 
         }else{
@@ -484,14 +574,7 @@ ControlDeformExtSurface::execute(){
 
             radius = 0.5*norm2(span);
             radius_old = radius;
-            count = 0;
-            for(auto &p : background_points){
-                dist = evaluateSignedDistance(p, local, id, normal, radius);
-                if(radius < 1.0E-12)    radius = radius_old;
-                else                     radius_old = radius;
-                background_LS[count] = dist;
-                count++;
-            }
+            background_LS = evaluateSignedDistance(background_points, local, radius);
 
             //interpolate on background to obtain distances
 
@@ -544,7 +627,6 @@ ControlDeformExtSurface::execute(){
             val = std::fmax(val, (violationField[ii] + tols[counterExtGeo]));
             ++ii;
         }
-        ++counterExtGeo;
     }
 
     m_violationField.setGeometry(getGeometry());
@@ -618,6 +700,34 @@ ControlDeformExtSurface::absorbSectionXML(const bitpit::Config::Section & slotXM
         setBackgroundDetails(value);
     }
 
+    if(slotXML.hasOption("DistanceCache")){
+        std::string input = slotXML.get("DistanceCache");
+        input = bitpit::utils::string::trim(input);
+        bool value = false;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss >> value;
+        }
+        setDistanceCache(value);
+    }
+
+    if(slotXML.hasOption("DistanceCacheDir")){
+        std::string input = slotXML.get("DistanceCacheDir");
+        input = bitpit::utils::string::trim(input);
+        setDistanceCacheDir(input);
+    }
+
+    if(slotXML.hasOption("DistanceCacheBand")){
+        std::string input = slotXML.get("DistanceCacheBand");
+        input = bitpit::utils::string::trim(input);
+        int value = 5;
+        if(!input.empty()){
+            std::stringstream ss(input);
+            ss >> value;
+        }
+        setDistanceCacheBand(value);
+    }
+
 };
 
 /*!
@@ -652,6 +762,11 @@ ControlDeformExtSurface::flushSectionXML(bitpit::Config::Section & slotXML, std:
     }
 
     slotXML.set("BGDetails", std::to_string(m_cellBackground));
+    slotXML.set("DistanceCache", std::to_string(int(m_useDistanceCache)));
+    if(!m_distanceCacheDir.empty()){
+        slotXML.set("DistanceCacheDir", m_distanceCacheDir);
+    }
+    slotXML.set("DistanceCacheBand", std::to_string(m_distanceCacheBand));
 
 };
 
@@ -670,19 +785,8 @@ ControlDeformExtSurface::readGeometries(std::vector<std::unique_ptr<MimmoGeometr
     int counter = 0;
     for(auto & geoinfo : m_geolist){
 
-        svector1D info = extractInfo(geoinfo.first);
-        std::unique_ptr<MimmoGeometry> geo (new MimmoGeometry());
-        geo->setIOMode(IOMode::READ);
-        geo->setDir(info[0]);
-        geo->setFilename(info[1]);
-        geo->setFileType(geoinfo.second.second);
-        geo->setBuildSkdTree(true);
-        geo->execute();
-
-        if(geo->getGeometry()->getNVertex() == 0 || geo->getGeometry()->getNCells() == 0 || !geo->getGeometry()->isSkdTreeSupported()){
-            (*m_log)<<"warning: failed to read geometry in ControlDeformExtSurface::readGeometries. Skipping file..."<<std::endl;
-        }else{
-            if (!geo->getGeometry()->areAdjacenciesBuilt()) geo->getGeometry()->getPatch()->buildAdjacencies();
+        std::unique_ptr<MimmoGeometry> geo = readGeometry(geoinfo.first, geoinfo.second.second);
+        if(geo){
             extGeo[counter] = std::move(geo);
             tols[counter] = geoinfo.second.first;
             ++counter;
@@ -693,6 +797,130 @@ ControlDeformExtSurface::readGeometries(std::vector<std::unique_ptr<MimmoGeometr
     tols.resize(counter);
 };
 
+/*!
+ * Read a single external constraint geometry from file, building its SkdTree and adjacencies.
+ * \param[in] file   path to the geometry file
+ * \param[in] format type of file as integer (see FileType enum)
+ * \return unique pointer to the MimmoGeometry read, null if the read failed
+ */
+std::unique_ptr<MimmoGeometry>
+ControlDeformExtSurface::readGeometry(const std::string & file, int format){
+
+    svector1D info = extractInfo(file);
+    std::unique_ptr<MimmoGeometry> geo (new MimmoGeometry());
+    geo->setIOMode(IOMode::READ);
+    geo->setDir(info[0]);
+    geo->setFilename(info[1]);
+    geo->setFileType(format);
+    geo->setBuildSkdTree(true);
+    geo->execute();
+
+    if(geo->getGeometry()->getNVertex() == 0 || geo->getGeometry()->getNCells() == 0 || !geo->getGeometry()->isSkdTreeSupported()){
+        (*m_log)<<"warning: failed to read geometry in ControlDeformExtSurface::readGeometries. Skipping file..."<<std::endl;
+        return std::unique_ptr<MimmoGeometry>(nullptr);
+    }
+    if (!geo->getGeometry()->areAdjacenciesBuilt()) geo->getGeometry()->getPatch()->buildAdjacencies();
+    return geo;
+};
+
+/*!
+ * Get the cached constraint geometry and signed distance field of an external file.
+ * The cache entry is identified by path, size and modification time of the file and by the
+ * parameters of the distance field; if no valid entry exists, the geometry is read and the field
+ * is loaded from the cache directory, if any, or built and then written to it.
+ * \param[in] file   path to the geometry file
+ * \param[in] format type of file as integer (see FileType enum)
+ * \return shared pointer to the cache entry, null if the read of the geometry failed
+ */
+std::shared_ptr<ControlDeformExtSurface::DistanceCache>
+ControlDeformExtSurface::getDistanceCache(const std::string & file, int format){
+
+    std::string key;
+    {
+        struct stat info;
+        std::stringstream ss;
+        ss<<file<<"|"<<format<<"|"<<m_cellBackground<<"|"<<m_distanceCacheBand;
+        if(stat(file.c_str(), &info) == 0){
+            ss<<"|"<<(long long)info.st_size<<"|"<<(long long)info.st_mtime;
+        }
+        key = ss.str();
+    }
+
+    auto it = m_distanceCache.find(file);
+    if(it != m_distanceCache.end() && it->second->key == key){
+        return it->second;
+    }
+    m_distanceCache.erase(file);
+
+    std::unique_ptr<MimmoGeometry> geo = readGeometry(file, format);
+    if(!geo)    return std::shared_ptr<DistanceCache>(nullptr);
+
+    std::shared_ptr<DistanceCache> cache(new DistanceCache());
+    cache->key = key;
+    cache->geometry = std::move(geo);
+    MimmoObject * local = cache->geometry->getGeometry();
+    cache->closedLoop = local->isClosedLoop();
+
+    std::string cachefile;
+    if(!m_distanceCacheDir.empty()){
+        svector1D info = extractInfo(file);
+        cachefile = m_distanceCacheDir + "/" + info[1] + "_" + std::to_string(std::hash<std::string>()(file)) + ".sdf";
+    }
+
+    if(cachefile.empty() || !cache->field.read(cachefile, key)){
+        darray3E bbMin, bbMax;
+        local->getBoundingBox(bbMin, bbMax);
+        double dh = norm2(bbMax - bbMin)/(double)m_cellBackground;
+        cache->field.build(local, dh, m_distanceCacheBand*dh);
+        (*m_log)<<m_name<<" : built distance field of "<<file<<" with "<<cache->field.getNodeCount()<<" band nodes"<<std::endl;
+        if(!cachefile.empty() && !cache->field.write(cachefile, key)){
+            (*m_log)<<"warning: "<<m_name<<" failed to write distance field file "<<cachefile<<std::endl;
+        }
+    }
+
+    m_distanceCache[file] = cache;
+    return cache;
+};
+
+/*!
+ * Evaluate signed distances of a list of points from a cached constraint. Distances are
+ * interpolated on the constraint distance field concurrently; points the field cannot
+ * serve are evaluated exactly with a batched SkdTree search.
+ * \param[in] points     3D target points
+ * \param[in] cache      cached constraint
+ * \param[in] initRadius guess initial distance for exact evaluations.
+ * \return signed distances from the constraint surface.
+ */
+dvector1D
+ControlDeformExtSurface::evaluateCachedSignedDistance(const dvecarr3E &points, DistanceCache & cache, double initRadius){
+
+    long nP = points.size();
+    dvector1D dist(nP, 0.0);
+    std::vector<char> served(nP, 0);
+
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<nP; ++i){
+        served[i] = char(cache.field.interpolate(points[i], dist[i]));
+    }
+
+    dvecarr3E exactPoints;
+    livector1D exactPos;
+    for(long i=0; i<nP; ++i){
+        if(!served[i]){
+            exactPoints.push_back(points[i]);
+            exactPos.push_back(i);
+        }
+    }
+
+    if(!exactPoints.empty()){
+        dvector1D exact = evaluateSignedDistance(exactPoints, cache.geometry->getGeometry(), initRadius);
+        for(std::size_t i=0; i<exactPos.size(); ++i){
+            dist[exactPos[i]] = exact[i];
+        }
+    }
+    return dist;
+};
+
 /*!
  * Extract root dir/filename/tag from an absolute file pattern
  * \return dir/filename/tag
@@ -754,6 +982,36 @@ ControlDeformExtSurface::evaluateSignedDistance(darray3E &point, mimmo::MimmoObj
     return dist;
 }
 
+/*!
+ * Batched evaluation of Signed Distance for a list of points from given SkdTree of a open/closed
+ * geometry 3D surface. Points are evaluated in spatially coherent order through skdTreeUtils::signedDistance;
+ * points with no simplex found in the initial radius are evaluated singularly, increasing the radius.
+ *
+ * \param[in] points 3D target points
+ * \param[in] geo    target geometry w/ SkdTree in it
+ * \param[in] initRadius guess initial distance.
+ *
+ * \return signed distances from target surface.
+ */
+dvector1D
+ControlDeformExtSurface::evaluateSignedDistance(const dvecarr3E &points, mimmo::MimmoObject * geo, double initRadius){
+
+    if(!geo->isSkdTreeSync())    geo->buildSkdTree();
+
+    livector1D ids;
+    dvecarr3E normals;
+    dvector1D dist = skdTreeUtils::signedDistance(points, geo->getSkdTree(), ids, normals, initRadius);
+
+    for(std::size_t i=0; i<points.size(); ++i){
+        if(dist[i] == 1.0E+18){
+            darray3E point = points[i];
+            double radius = initRadius;
+            dist[i] = evaluateSignedDistance(point, geo, ids[i], normals[i], radius);
+        }
+    }
+    return dist;
+}
+
 /*!
  * Plot optional results in execution, that is the violation distance field on current deformed geometry.
  * Reimeplemented from BaseManipulation::plotOptionalResults;
@@ -26,6 +26,8 @@
 
 #include "BaseManipulation.hpp"
 #include "MimmoGeometry.hpp"
+#include "NarrowBandDistanceField.hpp"
+#include <memory>
 
 namespace mimmo{
 
@@ -90,9 +92,19 @@ namespace mimmo{
  *              ... \n
  *           \</Files\> </tt> \n
  * - <B>BGDetails</B>: OPTIONAL define spacing of background grid, dividing diagonal of box containing geometries by this int factor;
+ * - <B>DistanceCache</B>: OPTIONAL boolean 0/1, cache constraint geometries and their narrow band signed distance fields across executions (default 0);
+ * - <B>DistanceCacheDir</B>: OPTIONAL directory where distance fields are persisted, empty to keep them in memory only (default empty);
+ * - <B>DistanceCacheBand</B>: OPTIONAL width of the narrow band of distance fields, in number of background grid cells (default 5);
  *
  * Geometry and deformation field have to be mandatorily passed through port.
  *
+ * When distance caching is active, each constraint geometry is read once and a signed distance
+ * field is built on a sparse narrow band background grid (see NarrowBandDistanceField), with spacing
+ * defined by BGDetails w.r.t. the constraint bounding box. Following executions reuse geometry and field,
+ * which can be persisted to disk and reloaded as long as the constraint file and the grid parameters do not change.
+ * Distances are interpolated on the field; points out of the band, or too close to the constraint, are
+ * evaluated exactly.
+ *
  */
 class ControlDeformExtSurface: public BaseManipulation{
 private:
@@ -101,6 +113,23 @@ private:
     dmpvecarr3E                    m_defField;     /**<Deformation field*/
     int                         m_cellBackground; /**< Number of cells N to determine background grid spacing */
     std::unordered_set<int>        m_allowed; /**< list of currently file format supported by the class*/
+
+    /*!
+     * \struct DistanceCache
+     * Cached constraint geometry with its distance field.
+     */
+    struct DistanceCache{
+        std::string                     key;        /**< identifier of source file and field parameters */
+        std::unique_ptr<MimmoGeometry>  geometry;   /**< constraint geometry */
+        bool                            closedLoop; /**< true if the constraint geometry is a closed loop */
+        NarrowBandDistanceField         field;      /**< signed distance field of the constraint */
+    };
+
+    bool                        m_useDistanceCache;     /**< true to cache constraint distance fields */
+    std::string                 m_distanceCacheDir;     /**< directory of persisted distance fields */
+    int                         m_distanceCacheBand;    /**< width of the narrow band in background cells */
+    std::unordered_map<std::string, std::shared_ptr<DistanceCache> > m_distanceCache; /**< cached constraints, by file */
+
 public:
     ControlDeformExtSurface();
     ControlDeformExtSurface(const bitpit::Config::Section & rootXML);
@@ -115,10 +144,16 @@ public:
     dmpvector1D                                getViolationField();
     double                                     getToleranceWithinViolation(std::string);
     int                                     getBackgroundDetails();
+    bool                                    isDistanceCacheActive();
+    std::string                             getDistanceCacheDir();
+    int                                     getDistanceCacheBand();
 
     void    setDefField(dmpvecarr3E field);
     void     setGeometry(MimmoObject * geo);
     void     setBackgroundDetails(int nCell=50);
+    void     setDistanceCache(bool active);
+    void     setDistanceCacheDir(std::string dir);
+    void     setDistanceCacheBand(int nCells);
     const     std::unordered_map<std::string, std::pair<double, int> > &     getFiles() const;
     void    setFiles(std::unordered_map<std::string,std::pair<double, int> > list );
     void     addFile(std::string file, double tol, int format);
@@ -139,8 +174,12 @@ protected:
 
 private:
     void readGeometries(std::vector<std::unique_ptr<MimmoGeometry> > & extGeo, std::vector<double> & tols);
+    std::unique_ptr<MimmoGeometry> readGeometry(const std::string & file, int format);
+    std::shared_ptr<DistanceCache> getDistanceCache(const std::string & file, int format);
+    dvector1D evaluateCachedSignedDistance(const dvecarr3E &points, DistanceCache & cache, double initRadius);
     svector1D extractInfo(std::string file);
     double evaluateSignedDistance(darray3E &point, mimmo::MimmoObject * geo, long & id, darray3E & normal, double &initRadius);
+    dvector1D evaluateSignedDistance(const dvecarr3E &points, mimmo::MimmoObject * geo, double initRadius);
     void writeLog();
 };
 
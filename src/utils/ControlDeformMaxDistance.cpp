@@ -143,7 +143,7 @@ void
 ControlDeformMaxDistance::setDefField(dmpvecarr3E field){
     m_defField.clear();
     m_violationField.clear();
-    m_defField = field;
+    m_defField = std::move(field);
 };
 
 /*! Set limit distance d of the constraint surface. Must be a positive definite value (>= 0).
@@ -0,0 +1,437 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include "NarrowBandDistanceField.hpp"
+#include "SkdTreeUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unistd.h>
+
+namespace mimmo{
+
+/*!
+ * Identifier of the binary file format of the field.
+ */
+static const char NARROWBAND_MAGIC[8] = {'M','I','M','M','O','S','D','F'};
+
+/*!
+ * Version of the binary file format of the field.
+ */
+static const uint32_t NARROWBAND_VERSION = 1;
+
+/*!
+ * Default constructor
+ */
+NarrowBandDistanceField::NarrowBandDistanceField(){
+    m_origin.fill(0.0);
+    m_spacing = 0.0;
+    m_dim.fill(0);
+    m_bandWidth = 0.0;
+}
+
+/*!
+ * \return true if the field has no nodes.
+ */
+bool
+NarrowBandDistanceField::isEmpty() const{
+    return m_values.empty();
+}
+
+/*!
+ * \return spacing of the grid.
+ */
+double
+NarrowBandDistanceField::getSpacing() const{
+    return m_spacing;
+}
+
+/*!
+ * \return width of the narrow band.
+ */
+double
+NarrowBandDistanceField::getBandWidth() const{
+    return m_bandWidth;
+}
+
+/*!
+ * \return number of stored band nodes.
+ */
+long
+NarrowBandDistanceField::getNodeCount() const{
+    return long(m_values.size());
+}
+
+/*!
+ * \return index of a node of the grid.
+ * \param[in] i node position along x
+ * \param[in] j node position along y
+ * \param[in] k node position along z
+ */
+long
+NarrowBandDistanceField::nodeIndex(long i, long j, long k) const{
+    return (i*m_dim[1] + j)*m_dim[2] + k;
+}
+
+/*!
+ * \return coordinates of a node of the grid.
+ * \param[in] index index of the node
+ */
+darray3E
+NarrowBandDistanceField::nodeCoords(long index) const{
+    long k = index % m_dim[2];
+    long j = (index / m_dim[2]) % m_dim[1];
+    long i = index / (m_dim[1]*m_dim[2]);
+    return {{m_origin[0] + double(i)*m_spacing, m_origin[1] + double(j)*m_spacing, m_origin[2] + double(k)*m_spacing}};
+}
+
+/*!
+ * Build the field of a surface. Previous contents are cleared.
+ * \param[in] surface target surface, of type 1
+ * \param[in] spacing spacing of the grid
+ * \param[in] bandWidth width of the narrow band, at least equal to spacing
+ */
+void
+NarrowBandDistanceField::build(MimmoObject * surface, double spacing, double bandWidth){
+
+    if(surface == nullptr || surface->isEmpty() || surface->getType() != 1){
+        throw std::runtime_error("NarrowBandDistanceField : a non empty surface geometry is needed to build the field");
+    }
+    if(!(spacing > 0.0)){
+        throw std::runtime_error("NarrowBandDistanceField : invalid grid spacing");
+    }
+    if(!surface->isSkdTreeSync())    surface->buildSkdTree();
+
+    m_values.clear();
+    m_spacing = spacing;
+    m_bandWidth = std::max(bandWidth, spacing);
+
+    //grid wrapping the surface bounding box, enlarged by the band and a cell.
+    const CoordinatesView & view = surface->getCoordinatesView();
+    darray3E bbMin, bbMax;
+    {
+        auto rx = std::minmax_element(view.x.begin(), view.x.end());
+        auto ry = std::minmax_element(view.y.begin(), view.y.end());
+        auto rz = std::minmax_element(view.z.begin(), view.z.end());
+        bbMin = {{*rx.first, *ry.first, *rz.first}};
+        bbMax = {{*rx.second, *ry.second, *rz.second}};
+    }
+    double offset = m_bandWidth + m_spacing;
+    for(int j=0; j<3; ++j){
+        m_origin[j] = bbMin[j] - offset;
+        m_dim[j] = long(std::ceil((bbMax[j] - bbMin[j] + 2.0*offset)/m_spacing)) + 1;
+    }
+
+    //seed nodes, closer than a cell diagonal to the bounding box of a surface cell.
+    double seedDistance = std::sqrt(3.0)*m_spacing;
+    livector1D cellIds;
+    cellIds.reserve(surface->getNCells());
+    for(const auto & cell : surface->getCells()){
+        cellIds.push_back(cell.getId());
+    }
+    long nCells = long(cellIds.size());
+    livector1D seeds;
+    bitpit::PatchKernel * patch = surface->getPatch();
+#pragma omp parallel
+    {
+        livector1D localSeeds;
+#pragma omp for schedule(dynamic, 256) nowait
+        for(long c=0; c<nCells; ++c){
+            bitpit::ConstProxyVector<long> vertexIds = patch->getCell(cellIds[c]).getVertexIds();
+            darray3E cMin = patch->getVertexCoords(vertexIds[0]);
+            darray3E cMax = cMin;
+            for(long idV : vertexIds){
+                const darray3E & coords = patch->getVertexCoords(idV);
+                for(int j=0; j<3; ++j){
+                    cMin[j] = std::min(cMin[j], coords[j]);
+                    cMax[j] = std::max(cMax[j], coords[j]);
+                }
+            }
+            std::array<long,3> first, last;
+            for(int j=0; j<3; ++j){
+                first[j] = std::max(0L, long(std::ceil((cMin[j] - seedDistance - m_origin[j])/m_spacing)));
+                last[j] = std::min(m_dim[j] - 1, long(std::floor((cMax[j] + seedDistance - m_origin[j])/m_spacing)));
+            }
+            for(long i=first[0]; i<=last[0]; ++i){
+                for(long j=first[1]; j<=last[1]; ++j){
+                    for(long k=first[2]; k<=last[2]; ++k){
+                        localSeeds.push_back(nodeIndex(i,j,k));
+                    }
+                }
+            }
+        }
+#pragma omp critical
+        seeds.insert(seeds.end(), localSeeds.begin(), localSeeds.end());
+    }
+    std::sort(seeds.begin(), seeds.end());
+    seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+
+    //exact signed distances of seeds
+    dvecarr3E seedCoords(seeds.size());
+    for(std::size_t i=0; i<seeds.size(); ++i){
+        seedCoords[i] = nodeCoords(seeds[i]);
+    }
+    livector1D ids;
+    dvecarr3E normals;
+    dvector1D seedValues = skdTreeUtils::signedDistance(seedCoords, surface->getSkdTree(), ids, normals, 2.0*seedDistance);
+    for(std::size_t i=0; i<seeds.size(); ++i){
+        if(std::abs(seedValues[i]) <= seedDistance)  m_values[seeds[i]] = seedValues[i];
+    }
+
+    //fast marching outward from seeds, on the magnitude of the distance.
+    typedef std::pair<double, long> TrialNode;
+    std::priority_queue<TrialNode, std::vector<TrialNode>, std::greater<TrialNode> > heap;
+    std::unordered_map<long,double> trial;
+    double h2 = m_spacing*m_spacing;
+
+    auto update = [&](long index){
+        long k = index % m_dim[2];
+        long j = (index / m_dim[2]) % m_dim[1];
+        long i = index / (m_dim[1]*m_dim[2]);
+        std::array<long,3> node = {{i, j, k}};
+        double known[3];
+        int nKnown = 0;
+        double sign = 1.0, closest = std::numeric_limits<double>::max();
+        for(int dir=0; dir<3; ++dir){
+            double best = std::numeric_limits<double>::max();
+            for(long step=-1; step<=1; step+=2){
+                std::array<long,3> neigh = node;
+                neigh[dir] += step;
+                if(neigh[dir] < 0 || neigh[dir] >= m_dim[dir])  continue;
+                auto it = m_values.find(nodeIndex(neigh[0], neigh[1], neigh[2]));
+                if(it == m_values.end())    continue;
+                double magnitude = std::abs(it->second);
+                if(magnitude < best)    best = magnitude;
+                if(magnitude < closest){
+                    closest = magnitude;
+                    sign = (it->second < 0.0) ? -1.0 : 1.0;
+                }
+            }
+            if(best < std::numeric_limits<double>::max())   known[nKnown++] = best;
+        }
+        if(nKnown == 0) return;
+        for(int a=1; a<nKnown; ++a){
+            for(int b=a; b>0 && known[b] < known[b-1]; --b)  std::swap(known[b], known[b-1]);
+        }
+
+        //first order upwind solution of |grad u| = 1
+        double u = known[0] + m_spacing;
+        if(nKnown > 1 && u > known[1]){
+            double sum = known[0] + known[1];
+            double disc = 2.0*h2 - (known[0] - known[1])*(known[0] - known[1]);
+            u = 0.5*(sum + std::sqrt(std::max(disc, 0.0)));
+            if(nKnown > 2 && u > known[2]){
+                sum += known[2];
+                double sumsq = known[0]*known[0] + known[1]*known[1] + known[2]*known[2];
+                disc = sum*sum - 3.0*(sumsq - h2);
+                u = (sum + std::sqrt(std::max(disc, 0.0)))/3.0;
+            }
+        }
+
+        auto it = trial.find(index);
+        if(it == trial.end() || u < std::abs(it->second)){
+            trial[index] = sign*u;
+            heap.push(std::make_pair(u, index));
+        }
+    };
+
+    auto updateNeighbours = [&](long index){
+        long k = index % m_dim[2];
+        long j = (index / m_dim[2]) % m_dim[1];
+        long i = index / (m_dim[1]*m_dim[2]);
+        std::array<long,3> node = {{i, j, k}};
+        for(int dir=0; dir<3; ++dir){
+            for(long step=-1; step<=1; step+=2){
+                std::array<long,3> neigh = node;
+                neigh[dir] += step;
+                if(neigh[dir] < 0 || neigh[dir] >= m_dim[dir])  continue;
+                long neighIndex = nodeIndex(neigh[0], neigh[1], neigh[2]);
+                if(m_values.count(neighIndex) == 0) update(neighIndex);
+            }
+        }
+    };
+
+    livector1D frozen;
+    frozen.reserve(m_values.size());
+    for(const auto & val : m_values)    frozen.push_back(val.first);
+    std::sort(frozen.begin(), frozen.end());
+    for(long index : frozen)    updateNeighbours(index);
+
+    while(!heap.empty()){
+        TrialNode top = heap.top();
+        heap.pop();
+        auto it = trial.find(top.second);
+        //stale entries of nodes already accepted or updated later
+        if(it == trial.end() || std::abs(it->second) != top.first)  continue;
+        if(top.first > m_bandWidth)    break;
+        m_values[top.second] = it->second;
+        trial.erase(it);
+        updateNeighbours(top.second);
+    }
+}
+
+/*!
+ * Interpolate the field in a point.
+ * \param[in] point target point
+ * \param[out] value interpolated signed distance, if interpolation is possible
+ * \return false if the point is out of the band or too close to the surface to be interpolated.
+ */
+bool
+NarrowBandDistanceField::interpolate(const darray3E & point, double & value) const{
+
+    if(m_values.empty())    return false;
+
+    std::array<long,3> cell;
+    darray3E t;
+    for(int j=0; j<3; ++j){
+        double local = (point[j] - m_origin[j])/m_spacing;
+        if(!(local >= 0.0))    return false;
+        cell[j] = long(local);
+        if(cell[j] >= m_dim[j] - 1)    return false;
+        t[j] = local - double(cell[j]);
+    }
+
+    double seedDistance = std::sqrt(3.0)*m_spacing;
+    double corners[8];
+    for(int c=0; c<8; ++c){
+        auto it = m_values.find(nodeIndex(cell[0] + (c>>2 & 1), cell[1] + (c>>1 & 1), cell[2] + (c & 1)));
+        if(it == m_values.end() || std::abs(it->second) < seedDistance)   return false;
+        corners[c] = it->second;
+    }
+
+    value = 0.0;
+    for(int c=0; c<8; ++c){
+        double w = ((c>>2 & 1) ? t[0] : 1.0 - t[0]) * ((c>>1 & 1) ? t[1] : 1.0 - t[1]) * ((c & 1) ? t[2] : 1.0 - t[2]);
+        value += w*corners[c];
+    }
+    return true;
+}
+
+/*!
+ * Write the field to a binary file. The field is written to a temporary file, then moved to
+ * its final path, so that blocks sharing a file concurrently never read a partial one.
+ * \param[in] filename path of the file
+ * \param[in] key identifier of the field, checked in reading
+ * \return false if the file cannot be written.
+ */
+bool
+NarrowBandDistanceField::write(const std::string & filename, const std::string & key) const{
+
+    //temporary name unique among the processes and threads sharing the cache directory.
+    std::string tmpname = filename + ".tmp" + std::to_string(long(getpid())) + "_"
+                        + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::ofstream out(tmpname, std::ios::binary);
+    if(!out.is_open())  return false;
+
+    livector1D nodes;
+    nodes.reserve(m_values.size());
+    for(const auto & val : m_values)    nodes.push_back(val.first);
+    std::sort(nodes.begin(), nodes.end());
+
+    uint64_t keySize = key.size(), nNodes = nodes.size();
+    out.write(NARROWBAND_MAGIC, sizeof(NARROWBAND_MAGIC));
+    out.write(reinterpret_cast<const char *>(&NARROWBAND_VERSION), sizeof(NARROWBAND_VERSION));
+    out.write(reinterpret_cast<const char *>(&keySize), sizeof(keySize));
+    out.write(key.data(), keySize);
+    out.write(reinterpret_cast<const char *>(m_origin.data()), 3*sizeof(double));
+    out.write(reinterpret_cast<const char *>(&m_spacing), sizeof(double));
+    out.write(reinterpret_cast<const char *>(m_dim.data()), 3*sizeof(long));
+    out.write(reinterpret_cast<const char *>(&m_bandWidth), sizeof(double));
+    out.write(reinterpret_cast<const char *>(&nNodes), sizeof(nNodes));
+    dvector1D values(nNodes);
+    for(std::size_t i=0; i<nNodes; ++i)  values[i] = m_values.at(nodes[i]);
+    out.write(reinterpret_cast<const char *>(nodes.data()), nNodes*sizeof(long));
+    out.write(reinterpret_cast<const char *>(values.data()), nNodes*sizeof(double));
+    out.close();
+    if(!out.good() || std::rename(tmpname.c_str(), filename.c_str()) != 0){
+        std::remove(tmpname.c_str());
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Read the field from a binary file. Previous contents are replaced only if reading succeeds.
+ * \param[in] filename path of the file
+ * \param[in] key identifier of the field, to be matched by the one stored in file
+ * \return false if the file does not exist, is not valid or its key does not match.
+ */
+bool
+NarrowBandDistanceField::read(const std::string & filename, const std::string & key){
+
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if(!in.is_open())   return false;
+    std::streamoff fileSize = in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t keySize = 0, nNodes = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&keySize), sizeof(keySize));
+    if(!in.good() || std::memcmp(magic, NARROWBAND_MAGIC, sizeof(magic)) != 0 || version != NARROWBAND_VERSION || keySize != key.size()){
+        return false;
+    }
+    std::string fileKey(keySize, ' ');
+    in.read(&fileKey[0], keySize);
+    if(!in.good() || fileKey != key)    return false;
+
+    darray3E origin;
+    double spacing, bandWidth;
+    std::array<long,3> dim;
+    in.read(reinterpret_cast<char *>(origin.data()), 3*sizeof(double));
+    in.read(reinterpret_cast<char *>(&spacing), sizeof(double));
+    in.read(reinterpret_cast<char *>(dim.data()), 3*sizeof(long));
+    in.read(reinterpret_cast<char *>(&bandWidth), sizeof(double));
+    in.read(reinterpret_cast<char *>(&nNodes), sizeof(nNodes));
+    if(!in.good())  return false;
+    //nodes have to fit in the rest of the file before being allocated.
+    std::streamoff position = in.tellg();
+    if(position < 0 || fileSize < position || nNodes > uint64_t(fileSize - position) / (sizeof(long) + sizeof(double))){
+        return false;
+    }
+    livector1D nodes(nNodes);
+    dvector1D values(nNodes);
+    in.read(reinterpret_cast<char *>(nodes.data()), nNodes*sizeof(long));
+    in.read(reinterpret_cast<char *>(values.data()), nNodes*sizeof(double));
+    if(!in.good())  return false;
+
+    m_origin = origin;
+    m_spacing = spacing;
+    m_dim = dim;
+    m_bandWidth = bandWidth;
+    m_values.clear();
+    m_values.reserve(nNodes);
+    for(std::size_t i=0; i<nNodes; ++i)  m_values[nodes[i]] = values[i];
+    return true;
+}
+
+}
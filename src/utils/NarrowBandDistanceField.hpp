@@ -0,0 +1,79 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+#ifndef __NARROWBANDDISTANCEFIELD_HPP__
+#define __NARROWBANDDISTANCEFIELD_HPP__
+
+#include "MimmoObject.hpp"
+
+namespace mimmo{
+
+/*!
+ * \class NarrowBandDistanceField
+ * \ingroup utils
+ * \brief NarrowBandDistanceField is a signed distance field of a surface, sampled on the nodes of a
+ * sparse cartesian grid within a narrow band around the surface.
+ *
+ * The field is built in two steps:
+ * - nodes closer than a cell diagonal to the surface are evaluated exactly with skdTreeUtils::signedDistance;
+ * - the remaining nodes of the band are evaluated by fast marching, solving the eikonal equation
+ *   with first order upwind differences outward from the exact nodes, up to the band width.
+ *
+ * Only band nodes are stored. The field is evaluated in a point by trilinear interpolation of
+ * the nodes of the grid cell containing it; interpolation is refused, so that the caller
+ * can fall back on an exact evaluation, if the cell is not entirely within the band or has
+ * a node closer than a cell diagonal to the surface, where the interpolation error is largest.
+ *
+ * The field can be written to and read from a binary file, tagged by a key identifying
+ * the source surface and the build parameters.
+ */
+class NarrowBandDistanceField{
+
+public:
+    NarrowBandDistanceField();
+
+    void        build(MimmoObject * surface, double spacing, double bandWidth);
+    bool        isEmpty() const;
+    double      getSpacing() const;
+    double      getBandWidth() const;
+    long        getNodeCount() const;
+
+    bool        interpolate(const darray3E & point, double & value) const;
+
+    bool        read(const std::string & filename, const std::string & key);
+    bool        write(const std::string & filename, const std::string & key) const;
+
+private:
+    darray3E                        m_origin;       /**< origin of the grid */
+    double                          m_spacing;      /**< spacing of the grid */
+    std::array<long,3>              m_dim;          /**< number of nodes of the grid in each direction */
+    double                          m_bandWidth;    /**< width of the narrow band */
+    std::unordered_map<long,double> m_values;       /**< signed distance of band nodes */
+
+    long        nodeIndex(long i, long j, long k) const;
+    darray3E    nodeCoords(long index) const;
+};
+
+}
+
+#endif /* __NARROWBANDDISTANCEFIELD_HPP__ */
@@ -145,12 +145,7 @@ ProjectCloud::execute(){
     if(!getGeometry()->isSkdTreeSync())    getGeometry()->buildSkdTree();
 
     //project points on surface.
-    int counter = 0;
-    m_proj.resize(m_points.size());
-    for(auto &val : m_points){
-        m_proj[counter]= skdTreeUtils::projectPoint(&val, getGeometry()->getSkdTree());
-        ++counter;
-    }
+    m_proj = skdTreeUtils::projectPoints(m_points, getGeometry()->getSkdTree());
     return;
 };
 
@@ -35,6 +35,7 @@
 #include "mimmo_iogeneric.hpp"
 
 #include "ControlDeformExtSurface.hpp"
+#include "NarrowBandDistanceField.hpp"
 #include "ControlDeformMaxDistance.hpp"
 #include "CreateSeedsOnSurface.hpp"
 #include "ProjectCloud.hpp"
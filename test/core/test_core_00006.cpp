@@ -0,0 +1,167 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00006
+ * Testing data exchange between ports: shared handles vs binary streaming
+ */
+
+class SenderA: public BaseManipulation{
+public:
+    dmpvecarr3E m_field;
+
+    SenderA(){};
+    virtual ~SenderA(){};
+    dmpvecarr3E getField(){ return m_field;};
+    void buildPorts(){
+        PortManager::instance().addPort(M_GDISPLS, MC_MPVECARR3, MD_FLOAT,"test_core_00006.cpp");
+        bool built = true;
+        built = built && createPortOut<dmpvecarr3E, SenderA>(this, &SenderA::getField, M_GDISPLS);
+        m_arePortsBuilt = built;
+    };
+    void execute(){};
+};
+
+class ReceiverB: public BaseManipulation{
+public:
+    dmpvecarr3E m_field;
+
+    ReceiverB(){};
+    virtual ~ReceiverB(){};
+    void setField(dmpvecarr3E field){ m_field = std::move(field);};
+    void buildPorts(){
+        PortManager::instance().addPort(M_GDISPLS, MC_MPVECARR3, MD_FLOAT,"test_core_00006.cpp");
+        bool built = true;
+        built = built && createPortIn<dmpvecarr3E, ReceiverB>(this, &ReceiverB::setField, M_GDISPLS);
+        m_arePortsBuilt = built;
+    };
+    void execute(){};
+};
+
+// =================================================================================== //
+
+bool checkField(dmpvecarr3E & target, dmpvecarr3E & reference){
+    bool check = (target.size() == reference.size());
+    check = check && (target.getGeometry() == reference.getGeometry());
+    check = check && (target.getDataLocation() == reference.getDataLocation());
+    for(auto it = reference.begin(); it != reference.end() && check; ++it){
+        check = check && target.exists(it.getId()) && (target[it.getId()] == *it);
+    }
+    return check;
+}
+
+int test6() {
+
+    MimmoObject * obj = new MimmoObject();
+    SenderA * objA = new SenderA();
+    ReceiverB * objB = new ReceiverB();
+    ReceiverB * objC = new ReceiverB();
+
+    objA->m_field.setGeometry(obj);
+    objA->m_field.setDataLocation(MPVLocation::POINT);
+    darray3E val;
+    for(long i=0; i<1000; ++i){
+        val = {{double(i), -0.5*i, 1.0}};
+        objA->m_field.insert(2*i+1, val);
+    }
+
+    bool check = addPin(objA, objB, M_GDISPLS, M_GDISPLS);
+    check = check && addPin(objA, objC, M_GDISPLS, M_GDISPLS);
+    if(!check){
+        std::cout<<"Failed getting connections"<<std::endl;
+        delete objA; delete objB; delete objC; delete obj;
+        return 1;
+    }
+
+    Chain * c0 = new Chain();
+    c0->addObject(objA);
+    c0->addObject(objB);
+    c0->addObject(objC);
+
+    //shared handle exchange
+    setPortStreaming(false);
+    c0->exec(false);
+    check = checkField(objB->m_field, objA->m_field) && checkField(objC->m_field, objA->m_field);
+    if(!check){
+        std::cout<<"Failed direct data exchange between ports"<<std::endl;
+    }else{
+        std::cout<<"Successfull direct data exchange between ports"<<std::endl;
+    }
+
+    //binary streamed exchange
+    objB->m_field.clear();
+    objC->m_field.clear();
+    setPortStreaming(true);
+    c0->exec(false);
+    setPortStreaming(false);
+    bool checkS = checkField(objB->m_field, objA->m_field) && checkField(objC->m_field, objA->m_field);
+    if(!checkS){
+        std::cout<<"Failed streamed data exchange between ports"<<std::endl;
+    }else{
+        std::cout<<"Successfull streamed data exchange between ports"<<std::endl;
+    }
+
+    delete c0;
+    delete objA;
+    delete objB;
+    delete objC;
+    delete obj;
+
+    return int(!(check && checkS));
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test6() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00006 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
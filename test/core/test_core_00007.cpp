@@ -0,0 +1,171 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00007
+ * Testing parallel execution of a chain: independent branches run on
+ * different workers and give the same results of the serial execution
+ */
+
+class ScaleValue: public BaseManipulation{
+public:
+    double m_value;
+    double m_factor;
+
+    ScaleValue(double factor){ m_value = 0.0; m_factor = factor;};
+    virtual ~ScaleValue(){};
+    void setValue(double value){ m_value = value;};
+    double getValue(){ return m_value;};
+    void buildPorts(){
+        bool built = true;
+        built = built && createPortIn<double, ScaleValue>(this, &ScaleValue::setValue, M_VALUED);
+        built = built && createPortOut<double, ScaleValue>(this, &ScaleValue::getValue, M_VALUED);
+        m_arePortsBuilt = built;
+    };
+    void execute(){
+        m_value *= m_factor;
+    };
+};
+
+class SumValues: public BaseManipulation{
+public:
+    double m_value1;
+    double m_value2;
+    double m_sum;
+
+    SumValues(){ m_value1 = 0.0; m_value2 = 0.0; m_sum = 0.0;};
+    virtual ~SumValues(){};
+    void setValue1(double value){ m_value1 = value;};
+    void setValue2(double value){ m_value2 = value;};
+    void buildPorts(){
+        bool built = true;
+        built = built && createPortIn<double, SumValues>(this, &SumValues::setValue1, M_VALUED);
+        built = built && createPortIn<double, SumValues>(this, &SumValues::setValue2, M_VALUED2);
+        m_arePortsBuilt = built;
+    };
+    void execute(){
+        m_sum = m_value1 + m_value2;
+    };
+};
+
+// =================================================================================== //
+
+int test7() {
+
+    //two diamonds source -> (left, right) -> sum, independent each other.
+    std::vector<ScaleValue*> sources, lefts, rights;
+    std::vector<SumValues*> sums;
+    Chain * c0 = new Chain();
+    bool check = true;
+    for(int i=0; i<2; ++i){
+        sources.push_back(new ScaleValue(1.0));
+        lefts.push_back(new ScaleValue(2.0));
+        rights.push_back(new ScaleValue(3.0));
+        sums.push_back(new SumValues());
+        sources[i]->m_value = double(i+1);
+
+        check = check && addPin(sources[i], lefts[i], M_VALUED, M_VALUED);
+        check = check && addPin(sources[i], rights[i], M_VALUED, M_VALUED);
+        check = check && addPin(lefts[i], sums[i], M_VALUED, M_VALUED);
+        check = check && addPin(rights[i], sums[i], M_VALUED, M_VALUED2);
+
+        c0->addObject(sums[i]);
+        c0->addObject(rights[i]);
+        c0->addObject(lefts[i]);
+        c0->addObject(sources[i]);
+    }
+    if(!check){
+        std::cout<<"Failed getting connections"<<std::endl;
+    }
+
+    //serial execution
+    c0->exec(false);
+    std::vector<double> serial;
+    for(int i=0; i<2; ++i){
+        serial.push_back(sums[i]->m_sum);
+        check = check && (serial[i] == 5.0*(i+1));
+        sums[i]->m_sum = 0.0;
+    }
+    if(!check){
+        std::cout<<"Failed serial execution of the chain"<<std::endl;
+    }
+
+    //parallel execution
+    c0->setNumThreads(4);
+    c0->exec(false);
+    bool checkP = (c0->getNumThreads() == 4);
+    for(int i=0; i<2; ++i){
+        checkP = checkP && (sums[i]->m_sum == serial[i]);
+    }
+    if(!checkP){
+        std::cout<<"Failed parallel execution of the chain"<<std::endl;
+    }else{
+        std::cout<<"Successfull parallel execution of the chain"<<std::endl;
+    }
+
+    delete c0;
+    for(int i=0; i<2; ++i){
+        delete sources[i];
+        delete lefts[i];
+        delete rights[i];
+        delete sums[i];
+    }
+
+    return int(!(check && checkP));
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test7() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00007 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,169 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00008
+ * Testing refit of MimmoObject skdTree after vertex-only modifications,
+ * and rebuild after cells deleted directly on the patch
+ */
+
+/*!
+ * Creating a plane surface triangular mesh z=0, on [0,1]x[0,1].
+ *
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ */
+void createPlane(MimmoObject * mesh){
+
+    int n = 10;
+    double dx = 1.0/double(n);
+    for(int i=0; i<=n; ++i){
+        for(int j=0; j<=n; ++j){
+            mesh->addVertex({{i*dx, j*dx, 0.0}}, (n+1)*i + j);
+        }
+    }
+    livector1D conn(3);
+    long cC = 0;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<n; ++j){
+            conn[0] = (n+1)*i + j;
+            conn[1] = (n+1)*(i+1) + j;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+            conn[0] = (n+1)*(i+1) + j;
+            conn[1] = (n+1)*(i+1) + j+1;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+        }
+    }
+}
+
+// =================================================================================== //
+
+int test8() {
+
+    MimmoObject * mesh = new MimmoObject();
+    createPlane(mesh);
+    mesh->buildSkdTree();
+
+    //move the plane to z = 0.5 and stretch it to [0,2] along x
+    for(const auto & vertex : mesh->getVertices()){
+        darray3E coords = vertex.getCoords();
+        coords[0] *= 2.0;
+        coords[2] = 0.5;
+        mesh->modifyVertex(coords, vertex.getId());
+    }
+
+    bool check = !mesh->isSkdTreeSync() && mesh->isSkdTreeTopologySync();
+    if(!check){
+        std::cout<<"Failed tracking of vertex-only modifications"<<std::endl;
+    }
+
+    //refit
+    bitpit::PatchSkdTree * tree = mesh->getSkdTree();
+    darray3E boxMin = tree->getNode(0).getBoxMin();
+    darray3E boxMax = tree->getNode(0).getBoxMax();
+    check = check && mesh->isSkdTreeSync();
+    check = check && (std::abs(boxMax[0] - 2.0) < 1.0e-12) && (std::abs(boxMin[2] - 0.5) < 1.0e-12) && (std::abs(boxMax[2] - 0.5) < 1.0e-12);
+
+    //distances from the refitted tree
+    dvecarr3E points;
+    for(int i=0; i<20; ++i){
+        points.push_back({{0.1*i, 0.05*i, 0.5 + 0.1*(i-10)}});
+    }
+    livector1D ids;
+    dvector1D dist = skdTreeUtils::distance(points, tree, ids, 1.0e+18);
+    for(std::size_t i=0; i<points.size(); ++i){
+        check = check && (std::abs(dist[i] - std::abs(points[i][2] - 0.5)) < 1.0e-10);
+    }
+
+    //cells deleted directly on the patch are not tracked: the tree is built again, not refitted
+    livector1D toDelete;
+    for(const auto & cell : mesh->getCells()){
+        bool beyond = true;
+        for(long idV : cell.getVertexIds()){
+            beyond = beyond && (mesh->getVertexCoords(idV)[0] > 1.0 + 1.0e-12);
+        }
+        if(beyond)  toDelete.push_back(cell.getId());
+    }
+    for(long idC : toDelete){
+        mesh->getPatch()->deleteCell(idC);
+    }
+    for(const auto & vertex : mesh->getVertices()){
+        darray3E coords = vertex.getCoords();
+        coords[2] = 0.2;
+        mesh->modifyVertex(coords, vertex.getId());
+    }
+    tree = mesh->getSkdTree();
+    boxMin = tree->getNode(0).getBoxMin();
+    boxMax = tree->getNode(0).getBoxMax();
+    check = check && !toDelete.empty();
+    check = check && (std::abs(boxMax[0] - 1.0) < 1.0e-12) && (std::abs(boxMin[2] - 0.2) < 1.0e-12);
+    dvecarr3E probe(1, darray3E({{1.5, 0.5, 0.2}}));
+    dist = skdTreeUtils::distance(probe, tree, ids, 1.0e+18);
+    check = check && (std::abs(dist[0] - 0.5) < 1.0e-10);
+
+    if(!check){
+        std::cout<<"Failed refit of skdTree"<<std::endl;
+    }else{
+        std::cout<<"Successfull refit of skdTree"<<std::endl;
+    }
+
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test8() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00008 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,141 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00009
+ * Testing structure-of-arrays coordinates view of MimmoObject
+ */
+
+/*!
+ * Check the view against the vertices of the mesh.
+ *
+ * \param[in] mesh pointer to a MimmoObject mesh.
+ * \return true if the view is coherent with the mesh vertices.
+ */
+bool checkView(MimmoObject * mesh){
+
+    const CoordinatesView & view = mesh->getCoordinatesView();
+    bool check = (view.size() == mesh->getNVertex());
+    long pos = 0;
+    for(const auto & vertex : mesh->getVertices()){
+        if(!check) break;
+        check = check && (view.ids[pos] == vertex.getId());
+        check = check && (view.index.at(vertex.getId()) == pos);
+        check = check && (norm2(view.getCoords(pos) - vertex.getCoords()) < 1.0e-14);
+        ++pos;
+    }
+    return check;
+}
+
+// =================================================================================== //
+
+int test9() {
+
+    MimmoObject * mesh = new MimmoObject(3);
+    int n = 10;
+    for(int i=0; i<n; ++i){
+        mesh->addVertex({{double(i), 0.0, 0.0}}, 10*i);
+    }
+
+    bool check = checkView(mesh) && mesh->isCoordinatesViewSync();
+    if(!check){
+        std::cout<<"Failed building of coordinates view"<<std::endl;
+    }
+
+    //vertex-only modifications
+    mesh->modifyVertex({{0.0, 1.0, 0.0}}, 0);
+    check = check && !mesh->isCoordinatesViewSync();
+    MimmoPiercedVector<darray3E> displ;
+    for(const auto & vertex : mesh->getVertices()){
+        displ.insert(vertex.getId(), {{0.0, 0.0, 0.5}});
+    }
+    mesh->getCoordinatesView();
+    mesh->applyDisplacements(displ);
+    check = check && mesh->isCoordinatesViewSync() && checkView(mesh);
+    if(!check){
+        std::cout<<"Failed update of coordinates view after vertex modifications"<<std::endl;
+    }
+
+    //topology modifications
+    mesh->addVertex({{0.0, 0.0, 3.0}}, 1000);
+    check = check && !mesh->isCoordinatesViewSync() && checkView(mesh);
+    if(!check){
+        std::cout<<"Failed update of coordinates view after vertex insertion"<<std::endl;
+    }
+
+    //write-back
+    CoordinatesView & view = mesh->editCoordinatesView();
+    for(long i=0; i<view.size(); ++i){
+        view.z[i] = -1.0;
+    }
+    check = check && mesh->commitCoordinatesView();
+    check = check && !mesh->isKdTreeSync() && checkView(mesh);
+    for(const auto & vertex : mesh->getVertices()){
+        check = check && (vertex.getCoords()[2] == -1.0);
+    }
+
+    if(!check){
+        std::cout<<"Failed write-back of coordinates view"<<std::endl;
+    }else{
+        std::cout<<"Successfull test of coordinates view"<<std::endl;
+    }
+
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test9() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00009 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
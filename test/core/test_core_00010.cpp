@@ -0,0 +1,167 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include "mimmo_core.hpp"
+#include <exception>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <zlib.h>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00010
+ * Testing direct reading of zlib compressed, raw appended *.vtu files with VTUGridReader
+ */
+
+/*!
+ * Append a data array to the raw appended section of a vtu file, compressed with zlib in
+ * blocks of 16 bytes. Header type is UInt32.
+ *
+ * \param[in] values values of the array
+ * \param[in,out] appended raw appended section
+ * \return offset of the array in the appended section
+ */
+template<typename T>
+std::size_t appendCompressed(const std::vector<T> & values, std::string & appended){
+
+    std::size_t offset = appended.size();
+    const char * raw = reinterpret_cast<const char *>(values.data());
+    uint32_t nbytes = uint32_t(values.size()*sizeof(T));
+    uint32_t blockSize = 16;
+    uint32_t nBlocks = (nbytes + blockSize - 1) / blockSize;
+    uint32_t lastSize = nbytes % blockSize;
+
+    std::vector<uint32_t> header = {nBlocks, blockSize, lastSize};
+    std::string blocks;
+    for(uint32_t i=0; i<nBlocks; ++i){
+        uLong size = std::min(blockSize, nbytes - i*blockSize);
+        uLongf compressedSize = compressBound(size);
+        std::vector<Bytef> compressed(compressedSize);
+        compress(compressed.data(), &compressedSize, reinterpret_cast<const Bytef *>(raw + i*blockSize), size);
+        header.push_back(uint32_t(compressedSize));
+        blocks.append(reinterpret_cast<const char *>(compressed.data()), compressedSize);
+    }
+    appended.append(reinterpret_cast<const char *>(header.data()), header.size()*sizeof(uint32_t));
+    appended.append(blocks);
+    return offset;
+}
+
+// =================================================================================== //
+
+int test10() {
+
+    //a triangle and a quad sharing an edge, with labels and PIDs
+    std::vector<double>  points = {0.,0.,0., 1.,0.,0., 1.,1.,0., 0.,1.,0., 2.,0.,0., 2.,1.,0.};
+    std::vector<int64_t> connectivity = {0,1,3, 1,4,5,2};
+    std::vector<int32_t> offsets = {3,7};
+    std::vector<uint8_t> types = {5,9};
+    std::vector<int32_t> pids = {1,2};
+    std::vector<int64_t> vertexIndex = {10,11,12,13,14,15};
+
+    std::string appended;
+    std::stringstream xml;
+    xml<<"<?xml version=\"1.0\"?>"<<std::endl;
+    xml<<"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt32\" compressor=\"vtkZLibDataCompressor\">"<<std::endl;
+    xml<<"<UnstructuredGrid>"<<std::endl<<"<Piece NumberOfPoints=\"6\" NumberOfCells=\"2\">"<<std::endl;
+    xml<<"<PointData>"<<std::endl;
+    xml<<"<DataArray type=\"Int64\" Name=\"vertexIndex\" format=\"appended\" offset=\""<<appendCompressed(vertexIndex, appended)<<"\"/>"<<std::endl;
+    xml<<"</PointData>"<<std::endl<<"<CellData>"<<std::endl;
+    xml<<"<DataArray type=\"Int32\" Name=\"PID\" format=\"appended\" offset=\""<<appendCompressed(pids, appended)<<"\"/>"<<std::endl;
+    xml<<"</CellData>"<<std::endl<<"<Points>"<<std::endl;
+    xml<<"<DataArray type=\"Float64\" Name=\"Points\" NumberOfComponents=\"3\" format=\"appended\" offset=\""<<appendCompressed(points, appended)<<"\"/>"<<std::endl;
+    xml<<"</Points>"<<std::endl<<"<Cells>"<<std::endl;
+    xml<<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"appended\" offset=\""<<appendCompressed(connectivity, appended)<<"\"/>"<<std::endl;
+    xml<<"<DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\""<<appendCompressed(offsets, appended)<<"\"/>"<<std::endl;
+    xml<<"<DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\""<<appendCompressed(types, appended)<<"\"/>"<<std::endl;
+    xml<<"</Cells>"<<std::endl<<"</Piece>"<<std::endl<<"</UnstructuredGrid>"<<std::endl;
+    xml<<"<AppendedData encoding=\"raw\">"<<std::endl<<"_";
+
+    {
+        std::ofstream out("./compressedGrid.vtu", std::ios::binary);
+        out<<xml.str()<<appended<<std::endl<<"</AppendedData>"<<std::endl<<"</VTKFile>"<<std::endl;
+    }
+
+    MimmoObject * mesh = new MimmoObject(1);
+    VTUGridStreamer streamer;
+    VTUGridReader reader(".", "compressedGrid", streamer, *(mesh->getPatch()));
+    reader.read();
+
+    bool check = (mesh->getNVertex() == 6) && (mesh->getNCells() == 2);
+    for(std::size_t i=0; i<vertexIndex.size() && check; ++i){
+        darray3E coords = mesh->getVertexCoords(vertexIndex[i]);
+        check = check && (coords[0] == points[3*i]) && (coords[1] == points[3*i+1]) && (coords[2] == points[3*i+2]);
+    }
+    if(check){
+        long nQuads = 0;
+        for(const auto & cell : mesh->getCells()){
+            bool quad = (cell.getType() == bitpit::ElementType::QUAD);
+            nQuads += long(quad);
+            check = check && (cell.getPID() == (quad ? 2 : 1));
+            check = check && (cell.getVertexId(0) == (quad ? 11 : 10));
+        }
+        check = check && (nQuads == 1);
+    }
+
+    if(!check){
+        std::cout<<"Failed reading of compressed appended vtu grid"<<std::endl;
+    }else{
+        std::cout<<"Successfull reading of compressed appended vtu grid"<<std::endl;
+    }
+
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test10() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00010 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,104 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00011
+ * Testing merge of coincident vertices and removal of orphan vertices with MimmoObject::cleanGeometry
+ */
+
+// =================================================================================== //
+
+int test11() {
+
+    //two parts of a strip of quads, sharing duplicated vertices along x = 1, plus an orphan vertex.
+    MimmoObject * mesh = new MimmoObject(1);
+    mesh->addVertex({{0.0, 0.0, 0.0}}, 0);
+    mesh->addVertex({{1.0, 0.0, 0.0}}, 1);
+    mesh->addVertex({{1.0, 1.0, 0.0}}, 2);
+    mesh->addVertex({{0.0, 1.0, 0.0}}, 3);
+    mesh->addVertex({{1.0, 0.0, 0.0}}, 4);
+    mesh->addVertex({{2.0, 0.0, 0.0}}, 5);
+    mesh->addVertex({{2.0, 1.0, 0.0}}, 6);
+    mesh->addVertex({{1.0, 1.0, 0.0}}, 7);
+    mesh->addVertex({{5.0, 5.0, 5.0}}, 8);
+
+    mesh->addConnectedCell({0,1,2,3}, bitpit::ElementType::QUAD, 1, 0);
+    mesh->addConnectedCell({4,5,6,7}, bitpit::ElementType::QUAD, 2, 1);
+    mesh->setPIDName(1, "left");
+    mesh->setPIDName(2, "right");
+
+    bool check = mesh->cleanGeometry();
+    check = check && (mesh->getNVertex() == 6) && (mesh->getNCells() == 2);
+    check = check && !mesh->getVertices().exists(4) && !mesh->getVertices().exists(7) && !mesh->getVertices().exists(8);
+    if(check){
+        livector1D conn = mesh->getCellConnectivity(1);
+        check = (conn.size() == 4) && (conn[0] == 1) && (conn[1] == 5) && (conn[2] == 6) && (conn[3] == 2);
+    }
+    check = check && (mesh->getCells()[0].getPID() == 1) && (mesh->getCells()[1].getPID() == 2);
+    check = check && (mesh->getPIDTypeListWNames()[1] == "left") && (mesh->getPIDTypeListWNames()[2] == "right");
+
+    if(!check){
+        std::cout<<"Failed cleaning of geometry"<<std::endl;
+    }else{
+        std::cout<<"Successfull cleaning of geometry"<<std::endl;
+    }
+
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test11() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00011 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,137 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+#include <random>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00012
+ * Testing batch classification of points and cells in BasicShape, against one-by-one inclusion tests
+ */
+
+// =================================================================================== //
+
+int test12() {
+
+    std::vector<std::unique_ptr<BasicShape> > shapes;
+    shapes.emplace_back(new Cube({{0.1, 0.0, -0.1}}, {{1.5, 0.8, 1.2}}));
+    shapes.emplace_back(new Cylinder({{0.0, 0.1, 0.0}}, {{0.9, 1.5*M_PI, 1.4}}));
+    shapes.emplace_back(new Sphere({{0.0, 0.0, 0.1}}, {{1.1, 0.75*M_PI, 0.6*M_PI}}));
+    shapes.emplace_back(new Wedge({{0.0, 0.0, 0.0}}, {{1.0, 1.0, 1.0}}));
+    shapes[1]->setInfLimits(0.2, 0);
+    shapes[1]->setInfLimits(0.3*M_PI, 1);
+    shapes[2]->setInfLimits(0.5*M_PI, 1);
+    shapes[2]->setInfLimits(0.2*M_PI, 2);
+    for(auto & shape : shapes){
+        shape->setRefSystem(2, darray3E({{0.0, 0.6, 0.8}}));
+    }
+
+    std::mt19937 gen(12);
+    std::uniform_real_distribution<double> coord(-1.5, 1.5);
+    dvecarr3E points(20000);
+    for(auto & p : points){
+        p = {{coord(gen), coord(gen), coord(gen)}};
+    }
+
+    //triangulated grid on the plane z = 0.05, crossing all the shapes.
+    MimmoObject * mesh = new MimmoObject(1);
+    int n = 40;
+    for(int j=0; j<=n; ++j){
+        for(int i=0; i<=n; ++i){
+            mesh->addVertex(darray3E({{-1.5+3.0*i/n, -1.5+3.0*j/n, 0.05}}), j*(n+1)+i);
+        }
+    }
+    long idC = 0;
+    for(int j=0; j<n; ++j){
+        for(int i=0; i<n; ++i){
+            long v0 = j*(n+1)+i;
+            mesh->addConnectedCell({v0, v0+1, v0+n+2}, bitpit::ElementType::TRIANGLE, idC++);
+            mesh->addConnectedCell({v0, v0+n+2, v0+n+1}, bitpit::ElementType::TRIANGLE, idC++);
+        }
+    }
+
+    bool check = true;
+    for(auto & shape : shapes){
+
+        std::vector<uint8_t> mask = shape->classifyPoints(points);
+        livector1D included = shape->includeCloudPoints(points);
+        livector1D excluded = shape->excludeCloudPoints(points);
+        long counter = 0;
+        for(std::size_t i=0; i<points.size(); ++i){
+            bool expected = shape->isPointIncluded(points[i]);
+            check = check && (bool(mask[i]) == expected);
+            counter += long(expected);
+        }
+        check = check && (long(included.size()) == counter) && (long(excluded.size()) == long(points.size()) - counter);
+
+        livector1D cells = shape->includeGeometry(mesh->getPatch());
+        livector1D treeCells = shape->includeGeometry(mesh);
+        std::sort(cells.begin(), cells.end());
+        std::sort(treeCells.begin(), treeCells.end());
+        long cellCounter = 0;
+        for(const auto & cell : mesh->getCells()){
+            cellCounter += long(shape->isSimplexIncluded(mesh->getPatch(), cell.getId()));
+        }
+        check = check && (long(cells.size()) == cellCounter) && (cells == treeCells);
+
+        std::cout<<"shape "<<int(shape->getShapeType())<<" : "<<counter<<" points, "<<cellCounter<<" cells included"<<std::endl;
+    }
+
+    delete mesh;
+    std::cout<<"test passed :" <<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test12() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00012 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
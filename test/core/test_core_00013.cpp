@@ -0,0 +1,157 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+#include <fstream>
+#include <sstream>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00013
+ * Testing the Profiler: recorded blocks and size of the data exchanged by ports,
+ * either streamed or passed through shared handle
+ */
+
+class PointsSource: public BaseManipulation{
+public:
+    dvecarr3E m_points;
+
+    PointsSource(){ m_points.resize(1000, {{1.0, 2.0, 3.0}});};
+    virtual ~PointsSource(){};
+    dvecarr3E getPoints(){ return m_points;};
+    void buildPorts(){
+        bool built = true;
+        built = built && createPortOut<dvecarr3E, PointsSource>(this, &PointsSource::getPoints, M_DISPLS);
+        m_arePortsBuilt = built;
+    };
+    void execute(){};
+};
+
+class PointsSink: public BaseManipulation{
+public:
+    dvecarr3E m_points;
+
+    PointsSink(){};
+    virtual ~PointsSink(){};
+    void setPoints(dvecarr3E points){ m_points = std::move(points);};
+    void buildPorts(){
+        bool built = true;
+        built = built && createPortIn<dvecarr3E, PointsSink>(this, &PointsSink::setPoints, M_DISPLS);
+        m_arePortsBuilt = built;
+    };
+    void execute(){};
+};
+
+// =================================================================================== //
+
+/*!
+ * Execute source and sink with active profiler and return the bytes exchanged by the source port.
+ */
+long profilePorts(PointsSource * source, PointsSink * sink, bool streaming, bool & check){
+
+    setPortStreaming(streaming);
+    Profiler & profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setActive(true);
+    source->exec();
+    sink->exec();
+    profiler.setActive(false);
+
+    std::vector<BlockProfile> blocks = profiler.getBlocks();
+    check = check && (blocks.size() == 2);
+    check = check && (sink->m_points.size() == source->m_points.size());
+    if(blocks.empty() || blocks[0].ports.size() != 1)    return -1;
+    check = check && (blocks[0].name == source->getName()) && (blocks[0].ports[0].receivers == 1);
+    return blocks[0].ports[0].bytes;
+}
+
+int test13() {
+
+    PointsSource * source = new PointsSource();
+    PointsSink * sink = new PointsSink();
+    bool check = addPin(source, sink, M_DISPLS, M_DISPLS);
+    if(!check){
+        std::cout<<"Failed getting connections"<<std::endl;
+    }
+
+    long streamed = profilePorts(source, sink, true, check);
+    long shared = profilePorts(source, sink, false, check);
+    std::cout<<"bytes streamed: "<<streamed<<", passed through shared handle: "<<shared<<std::endl;
+    check = check && (streamed >= long(3*sizeof(double)*source->m_points.size())) && (shared == streamed);
+
+    //no profiling, no size evaluation of shared data
+    source->exec();
+    check = check && (source->getPortsOut()[M_DISPLS]->getStreamedBytes() == 0);
+    check = check && Profiler::instance().getBlocks().size() == 2;
+
+    //summary labels cpu time and memory as process totals
+    Profiler::instance().writeSummary("profile_00013.json");
+    std::ifstream in("profile_00013.json");
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string summary = ss.str();
+    check = check && (summary.find("\"processCPU\"") != std::string::npos);
+    check = check && (summary.find("\"processPeakRSSDeltaKB\"") != std::string::npos);
+    check = check && (summary.find("\"bytes\": " + std::to_string(shared)) != std::string::npos);
+
+    Profiler::instance().clear();
+    setPortStreaming(false);
+    delete source;
+    delete sink;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test13() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00013 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
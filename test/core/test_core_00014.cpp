@@ -0,0 +1,161 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00014
+ * Testing batched queries of skdTreeUtils against single point queries
+ */
+
+/*!
+ * Creating a wavy surface triangular mesh z = 0.1*sin(2*pi*x)*cos(2*pi*y), on [0,1]x[0,1].
+ *
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ */
+void createWavySurface(MimmoObject * mesh){
+
+    int n = 30;
+    double dx = 1.0/double(n);
+    for(int i=0; i<=n; ++i){
+        for(int j=0; j<=n; ++j){
+            double z = 0.1*std::sin(2.0*M_PI*i*dx)*std::cos(2.0*M_PI*j*dx);
+            mesh->addVertex({{i*dx, j*dx, z}}, (n+1)*i + j);
+        }
+    }
+    livector1D conn(3);
+    long cC = 0;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<n; ++j){
+            conn[0] = (n+1)*i + j;
+            conn[1] = (n+1)*(i+1) + j;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+            conn[0] = (n+1)*(i+1) + j;
+            conn[1] = (n+1)*(i+1) + j+1;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+        }
+    }
+}
+
+// =================================================================================== //
+
+int test14() {
+
+    MimmoObject * mesh = new MimmoObject();
+    createWavySurface(mesh);
+    mesh->buildAdjacencies();
+    mesh->buildSkdTree();
+    bitpit::PatchSkdTree * tree = mesh->getSkdTree();
+
+    //points above and below the surface, more than a batch block, in random order
+    dvecarr3E points;
+    for(int i=0; i<1500; ++i){
+        double t = double(i);
+        points.push_back({{0.5 + 0.6*std::sin(1.7*t), 0.5 + 0.6*std::sin(2.9*t + 0.3), 0.3*std::sin(0.37*t + 1.1)}});
+    }
+    //points lying on the surface, to be located
+    dvecarr3E onSurface;
+    for(const auto & cell : mesh->getCells()){
+        onSurface.push_back(mesh->getPatch()->evalCellCentroid(cell.getId()));
+    }
+
+    double radius = 0.5;
+    livector1D ids, idsSigned;
+    dvecarr3E normals;
+    dvector1D dist = skdTreeUtils::distance(points, tree, ids, radius);
+    dvector1D sdist = skdTreeUtils::signedDistance(points, tree, idsSigned, normals, radius);
+    dvecarr3E proj = skdTreeUtils::projectPoints(points, tree);
+    livector1D located = skdTreeUtils::locatePointsOnPatch(onSurface, *tree);
+
+    bool check = (dist.size() == points.size()) && (located.size() == onSurface.size());
+    double maxdiff = 0.0;
+    int nfound = 0;
+    for(std::size_t i=0; i<points.size(); ++i){
+        long id;
+        darray3E normal;
+        double r = radius;
+        double single = skdTreeUtils::distance(&points[i], tree, id, r);
+        r = radius;
+        double singleSigned = skdTreeUtils::signedDistance(&points[i], tree, id, normal, r);
+        darray3E singleProj = skdTreeUtils::projectPoint(&points[i], tree);
+
+        check = check && ((single >= 1.0e+18) == (dist[i] >= 1.0e+18));
+        check = check && ((std::abs(singleSigned) >= 1.0e+18) == (std::abs(sdist[i]) >= 1.0e+18));
+        if(single < 1.0e+18){
+            maxdiff = std::max(maxdiff, std::abs(single - dist[i]));
+            maxdiff = std::max(maxdiff, std::abs(singleSigned - sdist[i]));
+            ++nfound;
+        }
+        maxdiff = std::max(maxdiff, norm2(singleProj - proj[i]));
+    }
+    for(std::size_t i=0; i<onSurface.size(); ++i){
+        check = check && (located[i] == skdTreeUtils::locatePointOnPatch(onSurface[i], *tree));
+    }
+    check = check && (nfound > 0) && (maxdiff < 1.0e-12);
+
+    std::cout<<"points found in radius: "<<nfound<<" max difference: "<<maxdiff<<std::endl;
+    if(!check){
+        std::cout<<"Failed batched queries of skdTree"<<std::endl;
+    }else{
+        std::cout<<"Successfull batched queries of skdTree"<<std::endl;
+    }
+
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test14() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00014 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,191 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00015
+ * Testing one-pass displacement of MimmoObject vertices with applyDisplacements
+ */
+
+/*!
+ * Creating a plane surface triangular mesh z=0, on [0,1]x[0,1].
+ *
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ */
+void createPlane(MimmoObject * mesh){
+
+    int n = 10;
+    double dx = 1.0/double(n);
+    for(int i=0; i<=n; ++i){
+        for(int j=0; j<=n; ++j){
+            mesh->addVertex({{i*dx, j*dx, 0.0}}, (n+1)*i + j);
+        }
+    }
+    livector1D conn(3);
+    long cC = 0;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<n; ++j){
+            conn[0] = (n+1)*i + j;
+            conn[1] = (n+1)*(i+1) + j;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+            conn[0] = (n+1)*(i+1) + j;
+            conn[1] = (n+1)*(i+1) + j+1;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+        }
+    }
+}
+
+/*!
+ * Displacement assigned to a vertex in the test.
+ */
+darray3E displacement(long id){
+    double t = double(id);
+    return {{0.1*std::sin(t), 0.2*std::cos(t), 0.3 + 0.01*t}};
+}
+
+// =================================================================================== //
+
+int test15() {
+
+    MimmoObject * mesh = new MimmoObject();
+    createPlane(mesh);
+    mesh->buildSkdTree();
+
+    std::unordered_map<long, darray3E> original;
+    for(const auto & vertex : mesh->getVertices()){
+        original[vertex.getId()] = vertex.getCoords();
+    }
+
+    //synchronize the coordinates view, it has to be moved along with the vertices
+    mesh->getCoordinatesView();
+    unsigned long revision = mesh->getRevision();
+
+    //partial field, inserted in reverse order of the geometry vertices (every third vertex)
+    dmpvecarr3E partial(mesh, MPVLocation::POINT);
+    livector1D vids = mesh->getVertices().getIds();
+    for(auto it = vids.rbegin(); it != vids.rend(); ++it){
+        if(*it % 3 == 0)    partial.insert(*it, displacement(*it));
+    }
+
+    double scale = 0.5;
+    bool check = mesh->applyDisplacements(partial, scale);
+    for(const auto & vertex : mesh->getVertices()){
+        long id = vertex.getId();
+        darray3E expected = original[id];
+        if(id % 3 == 0)     expected += scale*displacement(id);
+        check = check && (norm2(vertex.getCoords() - expected) < 1.0e-14);
+    }
+    if(!check){
+        std::cout<<"Failed displacement of vertices with a partial field"<<std::endl;
+    }
+
+    //search trees and revision
+    bool checkState = !mesh->isSkdTreeSync() && mesh->isSkdTreeTopologySync() && !mesh->isKdTreeSync();
+    checkState = checkState && (mesh->getRevision() != revision);
+
+    //the coordinates view has followed the vertices without being rebuilt
+    checkState = checkState && mesh->isCoordinatesViewSync();
+    const CoordinatesView & view = mesh->getCoordinatesView();
+    for(long i=0; i<view.size(); ++i){
+        checkState = checkState && (norm2(view.getCoords(i) - mesh->getVertexCoords(view.ids[i])) == 0.0);
+    }
+    if(!checkState){
+        std::cout<<"Failed tracking of geometry state after displacement"<<std::endl;
+    }
+    check = check && checkState;
+
+    //full field aligned with the geometry vertices, bringing them back to their original position
+    dmpvecarr3E full(mesh, MPVLocation::POINT);
+    for(const auto & vertex : mesh->getVertices()){
+        long id = vertex.getId();
+        full.insert(id, original[id] - vertex.getCoords());
+    }
+    bool checkFull = mesh->applyDisplacements(full);
+    for(const auto & vertex : mesh->getVertices()){
+        checkFull = checkFull && (norm2(vertex.getCoords() - original[vertex.getId()]) < 1.0e-14);
+    }
+    if(!checkFull){
+        std::cout<<"Failed displacement of vertices with a full field"<<std::endl;
+    }
+    check = check && checkFull;
+
+    //the refitted tree sees the restored plane
+    bitpit::PatchSkdTree * tree = mesh->getSkdTree();
+    check = check && mesh->isSkdTreeSync();
+    check = check && (std::abs(tree->getNode(0).getBoxMin()[2]) < 1.0e-12) && (std::abs(tree->getNode(0).getBoxMax()[2]) < 1.0e-12);
+
+    //nothing to move on an empty geometry
+    MimmoObject * empty = new MimmoObject();
+    dmpvecarr3E emptyField(empty, MPVLocation::POINT);
+    emptyField.insert(0, {{1.0, 0.0, 0.0}});
+    bool checkEmpty = !empty->applyDisplacements(emptyField);
+    if(!checkEmpty){
+        std::cout<<"Failed displacement of an empty geometry"<<std::endl;
+    }
+    check = check && checkEmpty;
+
+    if(check){
+        std::cout<<"Successfull displacement of vertices"<<std::endl;
+    }
+
+    delete empty;
+    delete mesh;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test15() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00015 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,233 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "mimmo_core.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*
+ * Test 00016
+ * Testing narrow band distances of vertices and cell centers w.r.t. a surface,
+ * against a brute force evaluation.
+ */
+
+/*!
+ * Creating a plane surface triangular mesh z=0, on [0,1]x[0,1].
+ *
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ * \param[in] n number of subdivisions along each side.
+ */
+void createPlane(MimmoObject * mesh, int n){
+
+    double dx = 1.0/double(n);
+    for(int i=0; i<=n; ++i){
+        for(int j=0; j<=n; ++j){
+            mesh->addVertex({{i*dx, j*dx, 0.0}}, (n+1)*i + j);
+        }
+    }
+    livector1D conn(3);
+    long cC = 0;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<n; ++j){
+            conn[0] = (n+1)*i + j;
+            conn[1] = (n+1)*(i+1) + j;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+            conn[0] = (n+1)*(i+1) + j;
+            conn[1] = (n+1)*(i+1) + j+1;
+            conn[2] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, cC++);
+        }
+    }
+}
+
+/*!
+ * Creating a tilted quad surface z = 0.3*(x+y) - 0.6 on [-1,2]x[-1,2].
+ *
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ * \param[in] n number of subdivisions along each side.
+ */
+void createTilted(MimmoObject * mesh, int n){
+
+    double dx = 3.0/double(n);
+    for(int i=0; i<=n; ++i){
+        for(int j=0; j<=n; ++j){
+            double x = -1.0 + i*dx, y = -1.0 + j*dx;
+            mesh->addVertex({{x, y, 0.3*(x+y) - 0.6}}, (n+1)*i + j);
+        }
+    }
+    livector1D conn(4);
+    long cC = 0;
+    for(int i=0; i<n; ++i){
+        for(int j=0; j<n; ++j){
+            conn[0] = (n+1)*i + j;
+            conn[1] = (n+1)*(i+1) + j;
+            conn[2] = (n+1)*(i+1) + j+1;
+            conn[3] = (n+1)*i + j+1;
+            mesh->addConnectedCell(conn, bitpit::ElementType::QUAD, cC++);
+        }
+    }
+}
+
+/*!
+ * Exact distance of a point from the unit square [0,1]x[0,1] at z=0.
+ */
+double squareDistance(const darray3E & p){
+    double dx = std::max({0.0, -p[0], p[0] - 1.0});
+    double dy = std::max({0.0, -p[1], p[1] - 1.0});
+    return std::sqrt(dx*dx + dy*dy + p[2]*p[2]);
+}
+
+/*!
+ * Compare narrow band distances with the brute force ones.
+ * Entries whose brute force distance lies too close to the band width are not checked.
+ *
+ * \param[in] distList narrow band distances
+ * \param[in] brute brute force distances of all the entries
+ * \param[in] maxdist band width
+ * \return true if the two sets match
+ */
+bool compareBand(bitpit::PiercedVector<double> & distList, std::unordered_map<long,double> & brute, double maxdist){
+    bool check = true;
+    long nInside = 0;
+    for(const auto & touple : brute){
+        long id = touple.first;
+        double d = touple.second;
+        if(std::abs(d - maxdist) < 1.0e-9)    continue;
+        bool inside = (d < maxdist);
+        check = check && (distList.exists(id) == inside);
+        if(inside){
+            ++nInside;
+            check = check && (std::abs(distList[id] - d) < 1.0e-12);
+        }
+    }
+    return check && (nInside > 0) && (nInside < long(brute.size()));
+}
+
+// =================================================================================== //
+
+int test16() {
+
+    MimmoObject * surface = new MimmoObject(1);
+    createPlane(surface, 24);
+
+    //cloud of points spanning a box much larger than the band around the surface
+    MimmoObject * cloud = new MimmoObject(3);
+    int np = 30;
+    long idV = 0;
+    for(int i=0; i<np; ++i){
+        for(int j=0; j<np; ++j){
+            for(int k=0; k<np; ++k){
+                double x = -1.0 + 3.0*(i + 0.37*std::sin(double(idV)))/double(np-1);
+                double y = -1.0 + 3.0*(j + 0.29*std::cos(double(idV)))/double(np-1);
+                double z = -1.0 + 2.0*(k + 0.41*std::sin(3.0*double(idV)))/double(np-1);
+                cloud->addVertex({{x, y, z}}, idV++);
+            }
+        }
+    }
+
+    bool check = true;
+    for(double maxdist : {0.05, 0.2, 0.6}){
+        std::unordered_map<long,double> brute;
+        for(const auto & vertex : cloud->getVertices()){
+            brute[vertex.getId()] = squareDistance(vertex.getCoords());
+        }
+        bitpit::PiercedVector<double> distList;
+        cloud->getVerticesNarrowBandToExtSurface(*surface, maxdist, distList);
+        bool checkBand = compareBand(distList, brute, maxdist);
+
+        livector1D idList;
+        cloud->getVerticesNarrowBandToExtSurface(*surface, maxdist, idList);
+        checkBand = checkBand && (long(idList.size()) == long(distList.size()));
+        for(long id : idList){
+            checkBand = checkBand && distList.exists(id);
+        }
+        if(!checkBand){
+            std::cout<<"Failed narrow band of vertices, width "<<maxdist<<std::endl;
+        }
+        check = check && checkBand;
+    }
+
+    //cell centers of a tilted surface crossing the target one
+    MimmoObject * tilted = new MimmoObject(1);
+    createTilted(tilted, 40);
+    for(double maxdist : {0.1, 0.5}){
+        std::unordered_map<long,double> brute;
+        for(const auto & cell : tilted->getCells()){
+            long id = cell.getId();
+            brute[id] = squareDistance(tilted->getPatch()->evalCellCentroid(id));
+        }
+        bitpit::PiercedVector<double> distList;
+        tilted->getCellsNarrowBandToExtSurface(*surface, maxdist, distList);
+        bool checkBand = compareBand(distList, brute, maxdist);
+
+        livector1D idList;
+        tilted->getCellsNarrowBandToExtSurface(*surface, maxdist, idList);
+        checkBand = checkBand && (long(idList.size()) == long(distList.size()));
+        if(!checkBand){
+            std::cout<<"Failed narrow band of cell centers, width "<<maxdist<<std::endl;
+        }
+        check = check && checkBand;
+    }
+
+    if(check){
+        std::cout<<"Successfull narrow band distances"<<std::endl;
+    }
+
+    delete tilted;
+    delete cloud;
+    delete surface;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test16() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_core_00016 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
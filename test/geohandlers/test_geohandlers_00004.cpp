@@ -0,0 +1,194 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_geohandlers.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Create a structured triangulation of the unit square with n x n cells, at height z.
+ */
+MimmoObject * createSquare(int n, double z){
+    MimmoObject * mesh = new MimmoObject(1);
+    long counter = 0;
+    for(int j=0; j<=n; ++j){
+        for(int i=0; i<=n; ++i){
+            mesh->addVertex({{double(i)/n, double(j)/n, z}}, counter);
+            ++counter;
+        }
+    }
+    long cellId = 0;
+    livector1D conn(3);
+    for(int j=0; j<n; ++j){
+        for(int i=0; i<n; ++i){
+            long v0 = j*(n+1) + i;
+            conn = {v0, v0+1, v0+n+2};
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, 0, cellId++);
+            conn = {v0, v0+n+2, v0+n+1};
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, 0, cellId++);
+        }
+    }
+    mesh->buildAdjacencies();
+    return mesh;
+}
+
+/*!
+ * Sorted ids of the cells of a geometry.
+ */
+livector1D cellIds(MimmoObject * mesh){
+    livector1D ids;
+    if(mesh == NULL)    return ids;
+    for(const auto & cell : mesh->getCells()){
+        ids.push_back(cell.getId());
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/*!
+ * Execute with nthreads workers a chain of selections and extractions sharing the same
+ * geometries, built from scratch with no search tree. Return the selected cells and the
+ * extracted vertices of each block.
+ */
+std::vector<livector1D> runSelections(int nthreads){
+
+    MimmoObject * target = createSquare(40, 0.0);
+    MimmoObject * mapping = createSquare(40, 0.01);
+    MimmoObject * other = createSquare(30, 0.0);
+
+    std::vector<GenericSelection*> selections;
+    selections.push_back(new SelectionByBox({{0.4, 0.4, 0.0}}, {{0.4, 0.4, 0.2}}, target));
+    selections.push_back(new SelectionByBox({{0.4, 0.4, 0.0}}, {{0.4, 0.4, 0.2}}, target));
+    selections.back()->setDual(true);
+    SelectionBySphere * sphere = new SelectionBySphere();
+    sphere->setOrigin({{0.7, 0.7, 0.0}});
+    sphere->setSpan({{0.25, 2.0*M_PI, M_PI}});
+    sphere->setGeometry(target);
+    selections.push_back(sphere);
+    SelectionByMapping * map = new SelectionByMapping();
+    map->setGeometry(target);
+    map->addMappingGeometry(mapping);
+    map->setTolerance(0.02);
+    selections.push_back(map);
+    selections.push_back(new SelectionByBox({{0.5, 0.5, 0.0}}, {{0.3, 0.3, 0.2}}, other));
+
+    dmpvector1D field(target);
+    for(const auto & vertex : target->getVertices()){
+        field.insert(vertex.getId(), 1.0);
+    }
+    ExtractScalarField * extract = new ExtractScalarField();
+    extract->setGeometry(mapping);
+    extract->setField(field);
+    extract->setMode(ExtractMode::MAPPING);
+    extract->setTolerance(0.02);
+
+    Chain * chain = new Chain();
+    for(GenericSelection * sel : selections){
+        chain->addObject(sel);
+    }
+    chain->addObject(extract);
+    chain->setNumThreads(nthreads);
+    chain->exec(false);
+
+    std::vector<livector1D> results;
+    for(GenericSelection * sel : selections){
+        results.push_back(cellIds(sel->getPatch()));
+    }
+    results.push_back(extract->getExtractedField().getIds());
+    std::sort(results.back().begin(), results.back().end());
+
+    delete chain;
+    for(GenericSelection * sel : selections){
+        delete sel;
+    }
+    delete extract;
+    delete target;
+    delete mapping;
+    delete other;
+
+    return results;
+}
+
+/*!
+ * Testing parallel execution of a chain of selection blocks working on the same geometry,
+ * against its serial execution.
+ */
+int test4() {
+
+    //inputs are set directly, not through ports
+    setExpertMode(true);
+
+    std::vector<livector1D> serial = runSelections(1);
+    bool check = true;
+    for(std::size_t i=0; i<serial.size(); ++i){
+        check = check && !serial[i].empty();
+    }
+    if(!check){
+        std::cout<<"Failed serial execution: empty selection"<<std::endl;
+    }
+
+    for(int run=0; run<5; ++run){
+        std::vector<livector1D> parallel = runSelections(4);
+        check = check && (parallel == serial);
+    }
+    if(!check){
+        std::cout<<"Failed parallel execution of the selections"<<std::endl;
+    }
+
+    std::cout<<"test passed :"<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test4() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_geohandlers_00004 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
@@ -0,0 +1,187 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_iogeneric.hpp"
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <limits>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+
+
+// =================================================================================== //
+/*!
+ * Converting a file to the native binary format with MimmoGeometry and reading it back.
+ */
+int test4() {
+
+    MimmoGeometry * converter = new MimmoGeometry();
+    converter->setIOMode(IOMode::CONVERT);
+    converter->setReadDir("geodata");
+    converter->setReadFilename("prism");
+    converter->setReadFileType(FileType::STL);
+    converter->setWriteDir(".");
+    converter->setWriteFilename("prism_binary");
+    converter->setWriteFileType(FileType::MIMMOBIN);
+    converter->setBuildSkdTree(true);
+    converter->exec();
+
+    MimmoGeometry * reader = new MimmoGeometry();
+    reader->setIOMode(IOMode::READ);
+    reader->setReadDir(".");
+    reader->setReadFilename("prism_binary");
+    reader->setReadFileType(FileType::MIMMOBIN);
+    reader->exec();
+
+    MimmoObject * original = converter->getGeometry();
+    MimmoObject * geometry = reader->getGeometry();
+    bool check = geometry->getNCells() == original->getNCells();
+    check = check && geometry->getNVertex() == original->getNVertex();
+    check = check && geometry->getPIDTypeList() == original->getPIDTypeList();
+    for(const auto & vertex : original->getVertices()){
+        if(!check) break;
+        check = check && geometry->getVertices().exists(vertex.getId());
+        check = check && (norm2(geometry->getVertexCoords(vertex.getId()) - vertex.getCoords()) < 1.0e-14);
+    }
+    for(const auto & cell : original->getCells()){
+        if(!check) break;
+        check = check && geometry->getCells().exists(cell.getId());
+        check = check && (geometry->getCellConnectivity(cell.getId()) == original->getCellConnectivity(cell.getId()));
+        check = check && (geometry->getCells()[cell.getId()].getPID() == cell.getPID());
+    }
+
+    BinaryGeometryFile file;
+    check = check && file.open("./prism_binary.binmimmo");
+    check = check && file.hasSkdTree();
+    check = check && (file.getSkdNodes()[0].cellEnd - file.getSkdNodes()[0].cellBegin == uint64_t(original->getNCells()));
+
+    //materialization resets the geometry to the stored type
+    MimmoObject * volume = new MimmoObject(2);
+    file.materialize(*volume);
+    check = check && (volume->getType() == original->getType()) && (volume->getNCells() == original->getNCells());
+    delete volume;
+
+    //corrupted files are rejected on opening
+    BinaryGeometryFile::Header header = file.getHeader();
+    file.close();
+    std::string bytes;
+    {
+        std::ifstream in("./prism_binary.binmimmo", std::ios::in | std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto openCorrupted = [](const std::string & data){
+        {
+            std::ofstream out("./prism_corrupted.binmimmo", std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(data.data(), data.size());
+        }
+        BinaryGeometryFile corrupted;
+        return corrupted.open("./prism_corrupted.binmimmo");
+    };
+
+    //section sizes overflowing from header counts
+    std::string overflow = bytes;
+    BinaryGeometryFile::Header hugeHeader = header;
+    hugeHeader.nVertices = std::numeric_limits<uint64_t>::max() / 2;
+    std::memcpy(&overflow[0], &hugeHeader, sizeof(BinaryGeometryFile::Header));
+    bool checkCorrupted = !openCorrupted(overflow);
+
+    //connectivity offsets not in order
+    std::string unordered = bytes;
+    uint64_t * offsets = reinterpret_cast<uint64_t *>(&unordered[header.offsets[BinaryGeometryFile::CONNOFFSETS]]);
+    offsets[1] = offsets[2] + 1;
+    checkCorrupted = checkCorrupted && !openCorrupted(unordered);
+
+    //valid sections with invalid contents are rejected on materialization
+    auto materializeCorrupted = [&](const std::string & data){
+        if(!openCorrupted(data))    return false;
+        BinaryGeometryFile corrupted;
+        corrupted.open("./prism_corrupted.binmimmo");
+        MimmoObject target;
+        try{
+            corrupted.materialize(target);
+        }catch(std::runtime_error & e){
+            return false;
+        }
+        return true;
+    };
+
+    //connectivity referring to a missing vertex
+    std::string missing = bytes;
+    int64_t * connectivity = reinterpret_cast<int64_t *>(&missing[header.offsets[BinaryGeometryFile::CONNECTIVITY]]);
+    connectivity[0] = std::numeric_limits<int64_t>::max();
+    checkCorrupted = checkCorrupted && !materializeCorrupted(missing);
+
+    //cells stored for a point cloud
+    std::string cloud = bytes;
+    BinaryGeometryFile::Header cloudHeader = header;
+    cloudHeader.type = 3;
+    std::memcpy(&cloud[0], &cloudHeader, sizeof(BinaryGeometryFile::Header));
+    checkCorrupted = checkCorrupted && !materializeCorrupted(cloud);
+    if(!checkCorrupted){
+        std::cout<<"Failed rejection of corrupted files"<<std::endl;
+    }
+    check = check && checkCorrupted;
+
+    std::cout<<"test4 passed :"<<check<<std::endl;
+
+    delete converter;
+    delete reader;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+	
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Calling mimmo Test routines*/
+        int val =1;
+        try{
+            val = test4() ;
+        }
+        
+        catch(std::exception & e){
+            std::cout<<"test_iogeneric_00004 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+	
+	return val;
+}
@@ -0,0 +1,227 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_iogeneric.hpp"
+#include <cstring>
+#include <exception>
+#include <fstream>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+
+
+// =================================================================================== //
+/*!
+ * Write an ascii STL file with two solids, "base" and "lid", of two triangles each,
+ * sharing the vertices of the unit square at z=0 and z=1 respectively.
+ */
+void writeMultiSolid(const std::string & filename){
+    std::ofstream out(filename);
+    for(int s=0; s<2; ++s){
+        std::string name = (s == 0) ? "base" : "lid";
+        std::string z = std::to_string(s);
+        out<<"solid "<<name<<"\n";
+        out<<"  facet normal 0 0 1\n    outer loop\n";
+        out<<"      vertex 0 0 "<<z<<"\n      vertex 1 0 "<<z<<"\n      vertex 1 1 "<<z<<"\n";
+        out<<"    endloop\n  endfacet\n";
+        out<<"  facet normal 0 0 1\n    outer loop\n";
+        out<<"      vertex 0 0 "<<z<<"\n      vertex 1 1 "<<z<<"\n      vertex 0 1 "<<z<<"\n";
+        out<<"    endloop\n  endfacet\n";
+        out<<"endsolid "<<name<<"\n";
+    }
+}
+
+/*!
+ * Check the PIDs and their names of the geometry read from the file of writeMultiSolid.
+ */
+bool checkMultiSolid(MimmoObject * geometry){
+    bool check = (geometry->getNCells() == 4) && (geometry->getNVertex() == 8);
+    check = check && (geometry->getPIDTypeList() == std::unordered_set<long>({0, 1}));
+    check = check && (geometry->getPIDTypeListWNames()[0] == "base");
+    check = check && (geometry->getPIDTypeListWNames()[1] == "lid");
+    for(const auto & cell : geometry->getCells()){
+        long pid = cell.getPID();
+        for(long id : cell.getVertexIds()){
+            check = check && (geometry->getVertexCoords(id)[2] == double(pid));
+        }
+    }
+    return check;
+}
+
+/*!
+ * Reading STL files with an ambiguous format or no facets.
+ */
+bool checkDetection(){
+
+    //binary file whose header starts with "solid"
+    {
+        std::ofstream out("./solid_header.stl", std::ios::out | std::ios::binary);
+        char header[80] = {};
+        std::strncpy(header, "solid exported as binary", sizeof(header)-1);
+        out.write(header, sizeof(header));
+        uint32_t nFacets = 1;
+        out.write(reinterpret_cast<const char *>(&nFacets), sizeof(nFacets));
+        float record[12] = {0,0,1, 0,0,0, 1,0,0, 0,1,0};
+        uint16_t attribute = 0;
+        out.write(reinterpret_cast<const char *>(record), sizeof(record));
+        out.write(reinterpret_cast<const char *>(&attribute), sizeof(attribute));
+    }
+    StlInterface stl;
+    MimmoObject * binary = new MimmoObject(1);
+    bool check = stl.read("./solid_header.stl", *binary);
+    check = check && (binary->getNCells() == 1) && (binary->getNVertex() == 3);
+    delete binary;
+    if(!check){
+        std::cout<<"Failed reading of binary STL with solid header"<<std::endl;
+    }
+
+    //ascii file with no facets
+    {
+        std::ofstream out("./no_facets.stl");
+        out<<"solid empty\nendsolid empty\n";
+    }
+    MimmoObject * empty = new MimmoObject(1);
+    bool checkEmpty = !stl.read("./no_facets.stl", *empty);
+    delete empty;
+    if(!checkEmpty){
+        std::cout<<"Failed rejection of STL with no facets"<<std::endl;
+    }
+    return check && checkEmpty;
+}
+
+/*!
+ * Writing ascii/binary STL files with MimmoGeometry and reading them back.
+ */
+int test5() {
+
+    MimmoGeometry * reader = new MimmoGeometry();
+    reader->setIOMode(IOMode::READ);
+    reader->setReadDir("geodata");
+    reader->setReadFilename("prism");
+    reader->setReadFileType(FileType::STL);
+    reader->exec();
+    MimmoObject * original = reader->getGeometry();
+
+    bool check = true;
+    for(int codex=0; codex<2; ++codex){
+        MimmoGeometry * writer = new MimmoGeometry();
+        writer->setIOMode(IOMode::WRITE);
+        writer->setWriteDir(".");
+        writer->setWriteFilename("prism_codex"+std::to_string(codex));
+        writer->setWriteFileType(FileType::STL);
+        writer->setCodex(codex == 1);
+        writer->setMultiSolidSTL(codex == 0);
+        writer->setGeometry(original);
+        writer->exec();
+
+        MimmoGeometry * rereader = new MimmoGeometry();
+        rereader->setIOMode(IOMode::READ);
+        rereader->setReadDir(".");
+        rereader->setReadFilename("prism_codex"+std::to_string(codex));
+        rereader->setReadFileType(FileType::STL);
+        rereader->exec();
+
+        check = check && (rereader->getGeometry()->getNCells() == original->getNCells());
+        check = check && (rereader->getGeometry()->getNVertex() == original->getNVertex());
+
+        delete writer;
+        delete rereader;
+    }
+
+    if(!check){
+        std::cout<<"Failed rereading of written STL files"<<std::endl;
+    }
+
+    //multi-solid ascii file, read and written back as multi-solid
+    writeMultiSolid("./multisolid.stl");
+    MimmoGeometry * multiReader = new MimmoGeometry();
+    multiReader->setIOMode(IOMode::READ);
+    multiReader->setReadDir(".");
+    multiReader->setReadFilename("multisolid");
+    multiReader->setReadFileType(FileType::STL);
+    multiReader->exec();
+    bool checkMulti = checkMultiSolid(multiReader->getGeometry());
+
+    MimmoGeometry * multiWriter = new MimmoGeometry();
+    multiWriter->setIOMode(IOMode::WRITE);
+    multiWriter->setWriteDir(".");
+    multiWriter->setWriteFilename("multisolid_written");
+    multiWriter->setWriteFileType(FileType::STL);
+    multiWriter->setCodex(false);
+    multiWriter->setMultiSolidSTL(true);
+    multiWriter->setGeometry(multiReader->getGeometry());
+    multiWriter->exec();
+
+    MimmoObject * multiWritten = new MimmoObject(1);
+    StlInterface stl;
+    checkMulti = checkMulti && stl.read("./multisolid_written.stl", *multiWritten);
+    checkMulti = checkMulti && checkMultiSolid(multiWritten);
+    if(!checkMulti){
+        std::cout<<"Failed PIDs and names of multi-solid STL"<<std::endl;
+    }
+    check = check && checkMulti;
+    delete multiWritten;
+    delete multiWriter;
+    delete multiReader;
+
+    check = check && checkDetection();
+
+    std::cout<<"test5 passed :"<<check<<std::endl;
+
+    delete reader;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+	
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Calling mimmo Test routines*/
+        int val =1;
+        try{
+            val = test5() ;
+        }
+        
+        catch(std::exception & e){
+            std::cout<<"test_iogeneric_00005 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+	
+	return val;
+}
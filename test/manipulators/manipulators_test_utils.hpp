@@ -0,0 +1,68 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#ifndef __MANIPULATORS_TEST_UTILS_HPP__
+#define __MANIPULATORS_TEST_UTILS_HPP__
+
+#include "mimmo_manipulators.hpp"
+
+/*!
+ * Create a structured triangulation of the unit square with n x n cells.
+ */
+inline mimmo::MimmoObject * createSquare(int n){
+    mimmo::MimmoObject * mesh = new mimmo::MimmoObject(1);
+    long counter = 0;
+    for(int j=0; j<=n; ++j){
+        for(int i=0; i<=n; ++i){
+            mesh->addVertex({{double(i)/n, double(j)/n, 0.0}}, counter);
+            ++counter;
+        }
+    }
+    long cellId = 0;
+    livector1D conn(3);
+    for(int j=0; j<n; ++j){
+        for(int i=0; i<n; ++i){
+            long v0 = j*(n+1) + i;
+            conn = {v0, v0+1, v0+n+2};
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, 0, cellId++);
+            conn = {v0, v0+n+2, v0+n+1};
+            mesh->addConnectedCell(conn, bitpit::ElementType::TRIANGLE, 0, cellId++);
+        }
+    }
+    return mesh;
+}
+
+/*!
+ * Max difference between two displacement fields on the same vertices.
+ */
+inline double maxDifference(dmpvecarr3E & a, dmpvecarr3E & b){
+    if(a.size() != b.size())    return 1.0E+18;
+    double maxdiff = 0.0;
+    for(auto it = a.begin(); it != a.end(); ++it){
+        if(!b.exists(it.getId()))   return 1.0E+18;
+        maxdiff = std::max(maxdiff, norm2(*it - b[it.getId()]));
+    }
+    return maxdiff;
+}
+
+#endif /* __MANIPULATORS_TEST_UTILS_HPP__ */
@@ -0,0 +1,130 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Max difference between MRBF displacements and brute force RBF evaluation.
+ */
+double compareWithBruteForce(MRBF * mrbf, MimmoObject * mesh){
+    dmpvecarr3E displ = mrbf->getDisplacements();
+    double maxdiff = 0.0;
+    for(const auto & vertex : mesh->getVertices()){
+        dvector1D ref = mrbf->evalRBF(vertex.getCoords());
+        darray3E val = displ[vertex.getId()];
+        for(int j=0; j<3; ++j){
+            maxdiff = std::max(maxdiff, std::abs(val[j] - ref[j]));
+        }
+    }
+    return maxdiff;
+}
+
+/*!
+ * Testing RBF evaluation engine of MRBF on compact and global kernels.
+ */
+int test4() {
+
+    MimmoObject * mesh = createSquare(40);
+
+    dvecarr3E rbfpoints, rbfdispls;
+    for(int j=0; j<20; ++j){
+        for(int i=0; i<20; ++i){
+            rbfpoints.push_back({{(i+0.5)/20.0, (j+0.5)/20.0, 0.1}});
+            rbfdispls.push_back({{0.01*std::sin(double(i)), 0.01*std::cos(double(j)), 0.001*(i-j)}});
+        }
+    }
+
+    MRBF * mrbf = new MRBF();
+    //evaluation engine on the fly, not the cached kernel matrix
+    mrbf->setOperatorCache(false);
+    mrbf->setGeometry(mesh);
+    mrbf->setNode(rbfpoints);
+    mrbf->setDisplacements(rbfdispls);
+    mrbf->setSupportRadiusValue(0.15);
+    mrbf->setFunction(bitpit::RBFBasisFunction::WENDLANDC2);
+    mrbf->exec();
+    double diffCompact = compareWithBruteForce(mrbf, mesh);
+
+    mrbf->setFunction(MRBFBasisFunction::HEAVISIDE10);
+    mrbf->setSupportRadiusValue(0.5);
+    mrbf->exec();
+    double diffExact = compareWithBruteForce(mrbf, mesh);
+
+    double maxval = 0.0;
+    for(const auto & val : mrbf->getDisplacements()){
+        maxval = std::max(maxval, norm2(val));
+    }
+
+    mrbf->setFarFieldAccuracy(0.2);
+    mrbf->exec();
+    double diffFar = compareWithBruteForce(mrbf, mesh);
+
+    std::cout<<"compact support error: "<<diffCompact<<std::endl;
+    std::cout<<"global kernel error: "<<diffExact<<std::endl;
+    std::cout<<"far-field relative error: "<<diffFar/maxval<<std::endl;
+
+    bool check = (diffCompact < 1.0E-12) && (diffExact < 1.0E-12) && (diffFar < 2.0E-2*maxval);
+
+    delete mrbf;
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int val = 1;
+        try{
+            /**<Calling mimmo Test routines*/
+            val = test4() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00004 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
@@ -0,0 +1,104 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Testing interpolation of MRBF in MRBFSol::WHOLE mode with the sparse iterative solver.
+ */
+int test5() {
+
+    MimmoObject * mesh = createSquare(30);
+
+    //rbf nodes on a subset of mesh vertices
+    dvecarr3E rbfpoints, rbfdispls;
+    livector1D rbfIds;
+    for(int j=0; j<=30; j+=2){
+        for(int i=0; i<=30; i+=2){
+            rbfIds.push_back(j*31 + i);
+            rbfpoints.push_back(mesh->getVertexCoords(rbfIds.back()));
+            rbfdispls.push_back({{0.01*std::sin(0.3*i), 0.01*std::cos(0.3*j), 0.002*(i-j)}});
+        }
+    }
+
+    MRBF * mrbf = new MRBF();
+    mrbf->setMode(MRBFSol::WHOLE);
+    mrbf->setGeometry(mesh);
+    mrbf->setNode(rbfpoints);
+    mrbf->setDisplacements(rbfdispls);
+    mrbf->setSupportRadiusValue(0.25);
+    mrbf->setFunction(bitpit::RBFBasisFunction::WENDLANDC2);
+    mrbf->exec();
+
+    dmpvecarr3E displ = mrbf->getDisplacements();
+    double maxdiff = 0.0;
+    for(std::size_t i=0; i<rbfIds.size(); ++i){
+        maxdiff = std::max(maxdiff, norm2(displ[rbfIds[i]] - rbfdispls[i]));
+    }
+    std::cout<<"interpolation error on nodes: "<<maxdiff<<std::endl;
+
+    bool check = (maxdiff < 1.0E-8);
+
+    delete mrbf;
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int val = 1;
+        try{
+            /**<Calling mimmo Test routines*/
+            val = test5() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00005 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
@@ -0,0 +1,212 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <random>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Corrupt a weight matrix file written by FFDLattice.
+ * \param[in] filename name of the file
+ * \param[in] mode 0 to point the first entry to a node out of the lattice,
+ *             1 to swap the first two row offsets, 2 to truncate the file
+ */
+void corruptWeightFile(const std::string & filename, int mode){
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    std::size_t header = 8 + sizeof(uint32_t) + 4*sizeof(uint64_t);
+    uint64_t nRows;
+    std::memcpy(&nRows, data.data() + header - 2*sizeof(uint64_t), sizeof(nRows));
+    std::size_t offsets = header + nRows*sizeof(long);
+    std::size_t cols = offsets + (nRows+1)*sizeof(long);
+
+    if(mode == 0){
+        int col = 1000000;
+        std::memcpy(data.data() + cols, &col, sizeof(col));
+    }else if(mode == 1){
+        long first, second;
+        std::memcpy(&first, data.data() + offsets + sizeof(long), sizeof(long));
+        std::memcpy(&second, data.data() + offsets + 2*sizeof(long), sizeof(long));
+        std::memcpy(data.data() + offsets + sizeof(long), &second, sizeof(long));
+        std::memcpy(data.data() + offsets + 2*sizeof(long), &first, sizeof(long));
+    }else{
+        data.resize(data.size()/2);
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    out.write(data.data(), data.size());
+}
+
+// =================================================================================== //
+/*!
+ * Testing FFDLattice -> weight matrix mode against direct evaluation, for repeated
+ * deformations of the same geometry and after a geometry change.
+ */
+int test6() {
+
+    //create a wavy surface of triangles
+    MimmoObject * mesh = new MimmoObject(1);
+    int nx = 20;
+    long counter = 0;
+    for(int j=0; j<=nx; ++j){
+        for(int i=0; i<=nx; ++i){
+            double x = double(i)/double(nx);
+            double y = double(j)/double(nx);
+            mesh->addVertex({{x, y, 0.1*std::sin(2.0*M_PI*x)*std::cos(2.0*M_PI*y)}}, counter);
+            ++counter;
+        }
+    }
+    counter = 0;
+    for(int j=0; j<nx; ++j){
+        for(int i=0; i<nx; ++i){
+            long v0 = j*(nx+1) + i;
+            livector1D conn1 = {v0, v0+1, v0+nx+2};
+            livector1D conn2 = {v0, v0+nx+2, v0+nx+1};
+            mesh->addConnectedCell(conn1, bitpit::ElementType::TRIANGLE, 0, counter++);
+            mesh->addConnectedCell(conn2, bitpit::ElementType::TRIANGLE, 0, counter++);
+        }
+    }
+
+    FFDLattice * direct = new FFDLattice();
+    FFDLattice * matrix = new FFDLattice();
+    for(FFDLattice * latt : {direct, matrix}){
+        latt->setGeometry(mesh);
+        latt->setShape(mimmo::ShapeType::CUBE);
+        latt->setOrigin({{0.5, 0.5, 0.0}});
+        latt->setSpan({{0.8, 0.8, 0.4}});
+        latt->setDimension(iarray3E({{5, 5, 4}}));
+        latt->setDegrees(iarray3E({{2, 2, 2}}));
+    }
+    matrix->setWeightMatrix(true);
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-0.05, 0.05);
+    int nNodes = 5*5*4;
+
+    bool check = true;
+    for(int design=0; design<3; ++design){
+
+        //a geometry change invalidates the weight matrix
+        if(design == 2){
+            mesh->modifyVertex({{0.5, 0.5, 0.05}}, (nx/2)*(nx+1) + nx/2);
+        }
+
+        dvecarr3E displ(nNodes);
+        for(auto & val : displ){
+            val = {{dist(gen), dist(gen), dist(gen)}};
+        }
+        direct->setDisplacements(displ);
+        matrix->setDisplacements(displ);
+        direct->exec();
+        matrix->exec();
+
+        dmpvecarr3E defDirect = direct->getDeformation();
+        dmpvecarr3E defMatrix = matrix->getDeformation();
+        double diff = maxDifference(defDirect, defMatrix);
+        std::cout<<"design "<<design<<" max difference: "<<diff<<std::endl;
+        check = check && (diff < 1.0E-12);
+    }
+
+    //weight matrix persisted to file, reread, and evaluated again when the file is corrupted
+    dvecarr3E displ(nNodes);
+    for(auto & val : displ){
+        val = {{dist(gen), dist(gen), dist(gen)}};
+    }
+    direct->setDisplacements(displ);
+    direct->exec();
+    dmpvecarr3E defDirect = direct->getDeformation();
+
+    std::string filename = "ffd_weights.bin";
+    for(int mode=-1; mode<3; ++mode){
+        if(mode >= 0)   corruptWeightFile(filename, mode);
+        FFDLattice * persisted = new FFDLattice(*matrix);
+        persisted->setWeightMatrixFile(filename);
+        persisted->setDisplacements(displ);
+        persisted->exec();
+        dmpvecarr3E defPersisted = persisted->getDeformation();
+        double diff = maxDifference(defDirect, defPersisted);
+        std::cout<<"weight matrix file, corruption "<<mode<<" max difference: "<<diff<<std::endl;
+        check = check && (diff < 1.0E-12);
+        delete persisted;
+    }
+    //a file rewritten after a corruption is read back
+    {
+        FFDLattice * persisted = new FFDLattice(*matrix);
+        persisted->setWeightMatrixFile(filename);
+        persisted->setDisplacements(displ);
+        persisted->exec();
+        dmpvecarr3E defPersisted = persisted->getDeformation();
+        check = check && (maxDifference(defDirect, defPersisted) < 1.0E-12);
+        delete persisted;
+    }
+
+    delete direct;
+    delete matrix;
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val =1;
+        try{
+            val = test6() ;
+        }
+
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00006 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,178 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Testing cached kernel matrix of MRBF in MRBFSol::NONE mode, on compact and global kernels,
+ * against on-the-fly evaluation, for successive weights and after a change of nodes and support radius.
+ * The default support radius, bound to the maximum weight, is tested as well.
+ */
+
+/*!
+ * Weights of the RBF nodes for a design.
+ */
+dvecarr3E designWeights(std::size_t nNodes, int design){
+    dvecarr3E rbfdispls(nNodes);
+    for(std::size_t i=0; i<nNodes; ++i){
+        double t = double(i + 7*design);
+        rbfdispls[i] = {{0.01*std::sin(t), 0.01*std::cos(1.3*t), 0.005*std::sin(0.7*t)}};
+    }
+    return rbfdispls;
+}
+
+int test7() {
+
+    MimmoObject * mesh = createSquare(40);
+
+    dvecarr3E rbfpoints;
+    for(int j=0; j<15; ++j){
+        for(int i=0; i<15; ++i){
+            rbfpoints.push_back({{(i+0.5)/15.0, (j+0.5)/15.0, 0.05}});
+        }
+    }
+
+    MRBF * cached = new MRBF();
+    MRBF * direct = new MRBF();
+    direct->setOperatorCache(false);
+    for(MRBF * mrbf : {cached, direct}){
+        mrbf->setGeometry(mesh);
+        mrbf->setNode(rbfpoints);
+    }
+
+    bool check = true;
+    int design = 0;
+    for(int kernel=0; kernel<2; ++kernel){
+        for(MRBF * mrbf : {cached, direct}){
+            if(kernel == 0){
+                mrbf->setFunction(bitpit::RBFBasisFunction::WENDLANDC2);
+                mrbf->setSupportRadiusValue(0.2);
+            }else{
+                mrbf->setFunction(MRBFBasisFunction::HEAVISIDE10);
+                mrbf->setSupportRadiusValue(0.5);
+            }
+        }
+        for(int iter=0; iter<4; ++iter){
+            //move a node in the last designs
+            if(iter == 2){
+                rbfpoints[7] = {{0.5, 0.5, 0.1}};
+                cached->setNode(rbfpoints);
+                direct->setNode(rbfpoints);
+            }
+            dvecarr3E rbfdispls = designWeights(rbfpoints.size(), design);
+            cached->setDisplacements(rbfdispls);
+            direct->setDisplacements(rbfdispls);
+            cached->exec();
+            direct->exec();
+
+            dmpvecarr3E displCached = cached->getDisplacements();
+            dmpvecarr3E displDirect = direct->getDisplacements();
+            double maxdiff = maxDifference(displCached, displDirect);
+            std::cout<<"kernel "<<kernel<<" design "<<iter<<" max difference: "<<maxdiff<<std::endl;
+            check = check && (maxdiff < 1.0E-12);
+            ++design;
+        }
+    }
+
+    //kernel matrix exceeding memory budget, evaluated on the fly (requested twice to trigger its evaluation)
+    cached->setOperatorCacheMemory(0.01);
+    cached->exec();
+    cached->exec();
+    direct->exec();
+    {
+        dmpvecarr3E displCached = cached->getDisplacements();
+        dmpvecarr3E displDirect = direct->getDisplacements();
+        double maxdiff = maxDifference(displCached, displDirect);
+        std::cout<<"memory budget exceeded, max difference: "<<maxdiff<<std::endl;
+        check = check && (maxdiff < 1.0E-12);
+    }
+
+    //default support radius, bound to the maximum weight: each design changes the radius,
+    //then the same design is executed twice.
+    MRBF * defCached = new MRBF();
+    MRBF * defDirect = new MRBF();
+    defDirect->setOperatorCache(false);
+    for(MRBF * mrbf : {defCached, defDirect}){
+        mrbf->setGeometry(mesh);
+        mrbf->setNode(rbfpoints);
+    }
+    for(int iter=0; iter<4; ++iter){
+        dvecarr3E rbfdispls = designWeights(rbfpoints.size(), (iter < 3) ? design + iter : design + 2);
+        defCached->setDisplacements(rbfdispls);
+        defDirect->setDisplacements(rbfdispls);
+        defCached->exec();
+        defDirect->exec();
+
+        dmpvecarr3E displCached = defCached->getDisplacements();
+        dmpvecarr3E displDirect = defDirect->getDisplacements();
+        double maxdiff = maxDifference(displCached, displDirect);
+        std::cout<<"default radius design "<<iter<<" max difference: "<<maxdiff<<std::endl;
+        check = check && (maxdiff < 1.0E-12);
+    }
+
+    delete defCached;
+    delete defDirect;
+    delete cached;
+    delete direct;
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int val = 1;
+        try{
+            /**<Calling mimmo Test routines*/
+            val = test7() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00007 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
@@ -0,0 +1,247 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include <algorithm>
+#include <exception>
+#include <random>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Create a wavy surface of triangles on the unit square.
+ */
+MimmoObject * createWavy(){
+
+    MimmoObject * mesh = new MimmoObject(1);
+    int nx = 30;
+    long counter = 0;
+    for(int j=0; j<=nx; ++j){
+        for(int i=0; i<=nx; ++i){
+            double x = double(i)/double(nx);
+            double y = double(j)/double(nx);
+            mesh->addVertex({{x, y, 0.1*std::sin(2.0*M_PI*x)*std::cos(2.0*M_PI*y)}}, counter);
+            ++counter;
+        }
+    }
+    counter = 0;
+    for(int j=0; j<nx; ++j){
+        for(int i=0; i<nx; ++i){
+            long v0 = j*(nx+1) + i;
+            livector1D conn1 = {v0, v0+1, v0+nx+2};
+            livector1D conn2 = {v0, v0+nx+2, v0+nx+1};
+            mesh->addConnectedCell(conn1, bitpit::ElementType::TRIANGLE, 0, counter++);
+            mesh->addConnectedCell(conn2, bitpit::ElementType::TRIANGLE, 0, counter++);
+        }
+    }
+    return mesh;
+}
+
+/*!
+ * Testing FusedDeformation -> a chain of manipulators evaluated in a single pass and applied
+ * against the same chain executed and applied block by block; chain read by block names.
+ */
+int test8() {
+
+    MimmoObject * mesh = createWavy();
+    MimmoObject * fusedMesh = createWavy();
+
+    //filter field growing along x
+    dmpvector1D filter(mesh, MPVLocation::POINT);
+    for(const auto & vertex : mesh->getVertices()){
+        filter.insert(vertex.getId(), vertex.getCoords()[0]);
+    }
+
+    TranslationGeometry * translation = new TranslationGeometry();
+    translation->setDirection({{0.0, 0.0, 1.0}});
+    translation->setTranslation(0.1);
+    translation->setFilter(filter);
+
+    RotationGeometry * rotation = new RotationGeometry();
+    rotation->setAxis({{0.5, 0.5, 0.0}}, {{0.0, 0.0, 1.0}});
+    rotation->setRotation(0.2);
+
+    FFDLattice * lattice = new FFDLattice();
+    lattice->setShape(mimmo::ShapeType::CUBE);
+    lattice->setOrigin({{0.5, 0.5, 0.1}});
+    lattice->setSpan({{0.7, 0.7, 0.6}});
+    lattice->setDimension(iarray3E({{5, 5, 4}}));
+    lattice->setDegrees(iarray3E({{2, 2, 2}}));
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> dist(-0.05, 0.05);
+    dvecarr3E displ(5*5*4);
+    for(auto & val : displ){
+        val = {{dist(gen), dist(gen), dist(gen)}};
+    }
+    lattice->setDisplacements(displ);
+
+    ScaleGeometry * scale = new ScaleGeometry();
+    scale->setScaling({{1.1, 0.9, 1.2}});
+    scale->setMeanPoint(true);
+    scale->setFilter(filter);
+
+    TwistGeometry * twist = new TwistGeometry();
+    twist->setAxis({{0.5, 0.5, 0.0}}, {{1.0, 0.0, 0.0}});
+    twist->setTwist(0.3);
+    twist->setMaxDistance(0.5);
+    twist->setSym(true);
+
+    BendGeometry * bend = new BendGeometry();
+    bend->setDegree(2, 0, 2);
+    bend->setCoeffs(2, 0, dvector1D({0.0, 0.05, -0.1}));
+
+    std::vector<BaseManipulation*> chain = {translation, rotation, lattice, scale, twist, bend};
+
+    //fused evaluation on its own copy of the geometry, then applied
+    FusedDeformation * fused = new FusedDeformation();
+    fused->setGeometry(fusedMesh);
+    for(BaseManipulation * manipulator : chain){
+        fused->addManipulator(manipulator);
+    }
+    fused->exec();
+    dmpvecarr3E fusedDispl = fused->getDisplacements();
+
+    std::unordered_map<long, darray3E> expected;
+    for(const auto & vertex : fusedMesh->getVertices()){
+        expected[vertex.getId()] = vertex.getCoords() + fusedDispl[vertex.getId()];
+    }
+    fused->apply();
+
+    //sequential chain, applying each deformation
+    for(BaseManipulation * manipulator : chain){
+        manipulator->setGeometry(mesh);
+        manipulator->setApply(true);
+        manipulator->exec();
+    }
+
+    double diff = 0.0;
+    double maxDispl = 0.0;
+    bool identical = true;
+    for(const auto & vertex : mesh->getVertices()){
+        long id = vertex.getId();
+        diff = std::max(diff, norm2(vertex.getCoords() - expected[id]));
+        maxDispl = std::max(maxDispl, norm2(fusedDispl[id]));
+        //applied fused chain and sequential chain move vertices with the same operations
+        identical = identical && (vertex.getCoords() == fusedMesh->getVertexCoords(id));
+    }
+    std::cout<<"max displacement: "<<maxDispl<<" max difference: "<<diff<<" identical applied coordinates: "<<identical<<std::endl;
+    bool check = (diff < 1.0E-12) && (maxDispl > 1.0E-02) && identical;
+
+    //chain declared by block names, as in the XML dictionary
+    std::unordered_map<std::string, BaseManipulation*> blocks = {{"translate", translation}, {"ffd", lattice}, {"bend", bend}};
+    bitpit::Config config;
+    auto & slot = config.addSection("fused");
+    slot.set("ClassName", "mimmo.FusedDeformation");
+    slot.set("Stages", " ffd  translate bend ");
+    FusedDeformation * named = new FusedDeformation(slot);
+    named->resolveStages(blocks);
+    std::vector<BaseManipulation*> stages = named->getManipulators();
+    bool checkNames = (stages == std::vector<BaseManipulation*>({lattice, translation, bend}));
+    bitpit::Config flushed;
+    auto & flushedSlot = flushed.addSection("fused");
+    named->flushSectionXML(flushedSlot);
+    checkNames = checkNames && (flushedSlot.get("Stages") == "ffd translate bend");
+    named->setStageNames({"ffd", "missing"});
+    bool missing = false;
+    try{
+        named->resolveStages(blocks);
+    }catch(std::runtime_error & e){
+        missing = true;
+    }
+    checkNames = checkNames && missing;
+    //stage geometries are involved by the fused block
+    named->setStageNames({"ffd", "translate", "bend"});
+    named->resolveStages(blocks);
+    std::vector<MimmoObject*> involved = named->getInvolvedGeometries();
+    checkNames = checkNames && (std::find(involved.begin(), involved.end(), mesh) != involved.end());
+    //connected stages are not scheduled by the workflow: rejected
+    mimmo::pin::addPin(rotation, bend, M_GEOM, M_GEOM);
+    bool connected = false;
+    try{
+        named->resolveStages(blocks);
+    }catch(std::runtime_error & e){
+        connected = true;
+    }
+    mimmo::pin::removeAllPins(rotation, bend);
+    checkNames = checkNames && connected;
+    std::cout<<"stages by name: "<<checkNames<<std::endl;
+    check = check && checkNames;
+
+    //an empty chain gives null displacements
+    FusedDeformation * empty = new FusedDeformation();
+    empty->setGeometry(mesh);
+    empty->exec();
+    dmpvecarr3E emptyDispl = empty->getDisplacements();
+    bool checkEmpty = (long(emptyDispl.size()) == mesh->getNVertex());
+    for(const auto & val : emptyDispl){
+        checkEmpty = checkEmpty && (norm2(val) == 0.0);
+    }
+    check = check && checkEmpty;
+
+    delete empty;
+    delete named;
+    delete fused;
+    for(BaseManipulation * manipulator : chain){
+        delete manipulator;
+    }
+    delete fusedMesh;
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val =1;
+        try{
+            val = test8() ;
+        }
+
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00008 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,286 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Set non uniform nodal weights and displacements of a built lattice.
+ */
+void setLatticeField(FFDLattice * latt){
+
+    iarray3E dim = latt->getDimension();
+
+    for(int k=0; k<dim[2]; ++k){
+        for(int j=0; j<dim[1]; ++j){
+            for(int i=0; i<dim[0]; ++i){
+                latt->setNodalWeight(1.0 + 0.3*std::sin(double(i + 2*j + 3*k)), i, j, k);
+            }
+        }
+    }
+    dvecarr3E displ(latt->getNNodes());
+    for(std::size_t i=0; i<displ.size(); ++i){
+        double t = double(i);
+        displ[i] = {{0.05*std::sin(t), 0.04*std::cos(1.7*t), 0.03*std::sin(2.3*t)}};
+    }
+    latt->setDisplacements(displ);
+    latt->build();
+}
+
+/*!
+ * Create a lattice with given shape, dimensions and degrees, with non uniform nodal weights
+ * and displacements.
+ */
+FFDLattice * createLattice(ShapeType type, darray3E span, iarray3E dim, iarray3E deg){
+
+    FFDLattice * latt = new FFDLattice();
+    latt->setShape(type);
+    latt->setOrigin({{0.0, 0.0, 0.0}});
+    latt->setSpan(span);
+    latt->setDimension(dim);
+    latt->setDegrees(deg);
+    latt->build();
+    setLatticeField(latt);
+    return latt;
+}
+
+/*!
+ * Create a lattice with given shape, coordinate type in all directions and degrees, with non uniform
+ * nodal weights and displacements.
+ */
+FFDLattice * createLattice(ShapeType type, CoordType coordType, iarray3E deg){
+
+    darray3E span = {{1.2, 1.2, 1.2}};
+    if(type == ShapeType::CYLINDER) span = {{0.6, 2.0*M_PI, 1.2}};
+    if(type == ShapeType::SPHERE)   span = {{0.6, 2.0*M_PI, M_PI}};
+
+    FFDLattice * latt = new FFDLattice();
+    latt->setShape(type);
+    latt->setOrigin({{0.0, 0.0, 0.0}});
+    latt->setSpan(span);
+    latt->setDimension(iarray3E({{6, 9, 7}}));
+    latt->setDegrees(deg);
+    latt->setCoordType({{coordType, coordType, coordType}});
+    latt->build();
+    setLatticeField(latt);
+    return latt;
+}
+
+/*!
+ * Create a cloud of n points spread in the box [-0.5,0.5]^3.
+ */
+dvecarr3E createCloud(int n){
+    dvecarr3E points(n);
+    for(int i=0; i<n; ++i){
+        double t = double(i);
+        points[i] = {{0.5*std::sin(1.3*t), 0.5*std::sin(2.1*t + 0.4), 0.5*std::sin(0.7*t + 1.1)}};
+    }
+    return points;
+}
+
+/*!
+ * Max difference between the batched evaluation of a lattice on the points included in it
+ * and the single point evaluation.
+ */
+double compareEvaluators(FFDLattice * latt, const dvecarr3E & cloud){
+
+    livector1D list = latt->getShape()->includeCloudPoints(cloud);
+    long n = list.size();
+    if(n == 0)  return 1.0E+18;
+
+    dvecarr3E points(n);
+    for(long i=0; i<n; ++i){
+        points[i] = cloud[list[i]];
+    }
+    dvector1D filter(n, 1.0);
+    dvecarr3E batched(n);
+    latt->deformPoints(n, points.data(), filter.data(), batched.data());
+
+    double maxdiff = 0.0;
+    for(long i=0; i<n; ++i){
+        darray3E single = latt->apply(points[i]);
+        maxdiff = std::max(maxdiff, norm2(batched[i] - single));
+    }
+    return maxdiff;
+}
+
+/*!
+ * Max difference between the deformation of a geometry entirely included in a lattice
+ * and the single point evaluation on its vertices.
+ */
+double compareOnGeometry(FFDLattice * latt){
+
+    //unit square centered in the origin
+    MimmoObject * mesh = createSquare(30);
+    for(const auto & vertex : mesh->getVertices()){
+        darray3E coords = vertex.getCoords();
+        coords[0] -= 0.5;
+        coords[1] -= 0.5;
+        mesh->modifyVertex(coords, vertex.getId());
+    }
+
+    latt->setGeometry(mesh);
+    latt->execute();
+    dmpvecarr3E displ = latt->getDisplacements();
+
+    double maxdiff = 0.0;
+    if(long(displ.size()) != mesh->getNVertex())    maxdiff = 1.0E+18;
+    for(const auto & vertex : mesh->getVertices()){
+        darray3E coords = vertex.getCoords();
+        if(!displ.exists(vertex.getId())){
+            maxdiff = 1.0E+18;
+            continue;
+        }
+        maxdiff = std::max(maxdiff, norm2(displ[vertex.getId()] - latt->apply(coords)));
+    }
+
+    latt->unsetGeometry();
+    delete mesh;
+    return maxdiff;
+}
+
+/*!
+ * Count the coordinates whose knot interval, found by FFDLattice::getKnotInterval, differs from
+ * the one found by a linear search on the knots structure of the lattice. Coordinates are
+ * sampled on the knots, between them and out of their range.
+ */
+int checkKnotIntervals(FFDLattice * latt){
+
+    int nFailed = 0;
+    for(int dir=0; dir<3; ++dir){
+        dvector1D knots;
+        ivector1D mapEff;
+        latt->returnKnotsStructure(dir, knots, mapEff);
+        int size = knots.size();
+
+        dvector1D coords;
+        double range = knots[size-1] - knots[0];
+        coords.push_back(knots[0] - 0.1*range);
+        coords.push_back(knots[size-1] + 0.1*range);
+        for(int i=0; i<size; ++i){
+            coords.push_back(knots[i]);
+            if(i < size-1){
+                for(int s=1; s<4; ++s){
+                    coords.push_back(knots[i] + 0.25*s*(knots[i+1] - knots[i]));
+                }
+            }
+        }
+
+        for(double coord : coords){
+            //real index of the interval: last knot not above coord, within [0, size-2]
+            int mid = size-2;
+            while(mid > 0 && coord < knots[mid])   --mid;
+            //theoretical index: last one mapped to the real index
+            int expected = -1;
+            for(int i=0; i<int(mapEff.size()); ++i){
+                if(mapEff[i] == mid)    expected = i;
+            }
+            if(latt->getKnotInterval(coord, dir) != expected)  ++nFailed;
+        }
+    }
+    return nFailed;
+}
+
+/*!
+ * Testing the blocked evaluation of FFDLattice on lists of points, against the single point
+ * evaluation, on a cloud and on the vertices of a geometry. Degrees above 4 use the generic
+ * blocked evaluator, on more points than a block; degrees 1 to 4 use the fixed degree evaluators,
+ * tested together with the search of knot intervals for each shape and coordinate type.
+ */
+int test9() {
+
+    dvecarr3E cloud = createCloud(2000);
+    bool check = true;
+
+    std::vector<iarray3E> degrees = {{{5,6,5}}, {{6,5,7}}, {{5,2,6}}};
+    for(iarray3E deg : degrees){
+        FFDLattice * latt = createLattice(ShapeType::CUBE, {{1.2, 1.2, 1.2}}, {{9,8,10}}, deg);
+        double maxdiff = compareEvaluators(latt, cloud);
+        std::cout<<"degrees "<<deg[0]<<" "<<deg[1]<<" "<<deg[2]<<" max difference: "<<maxdiff<<std::endl;
+        check = check && (maxdiff < 1.0E-12);
+        maxdiff = compareOnGeometry(latt);
+        std::cout<<"degrees "<<deg[0]<<" "<<deg[1]<<" "<<deg[2]<<" max difference on geometry: "<<maxdiff<<std::endl;
+        check = check && (maxdiff < 1.0E-12);
+        delete latt;
+    }
+
+    //fixed degree evaluators and knot intervals, for each shape, coordinate type and degree
+    std::vector<ShapeType> shapes = {ShapeType::CUBE, ShapeType::CYLINDER, ShapeType::SPHERE};
+    std::vector<CoordType> coordTypes = {CoordType::UNCLAMPED, CoordType::CLAMPED, CoordType::PERIODIC, CoordType::SYMMETRIC};
+    for(ShapeType shape : shapes){
+        for(CoordType coordType : coordTypes){
+            for(int deg=1; deg<=4; ++deg){
+                iarray3E degs = {{deg, 1 + deg%4, 5 - deg}};
+                FFDLattice * latt = createLattice(shape, coordType, degs);
+                int nFailed = checkKnotIntervals(latt);
+                double maxdiff = compareEvaluators(latt, cloud);
+                bool checkCase = (nFailed == 0) && (maxdiff < 1.0E-12);
+                if(!checkCase){
+                    std::cout<<"shape "<<int(shape)<<" coordinate type "<<int(coordType)<<" degrees "<<degs[0]<<" "<<degs[1]<<" "<<degs[2]
+                             <<" : wrong knot intervals "<<nFailed<<", max difference: "<<maxdiff<<std::endl;
+                }
+                check = check && checkCase;
+                delete latt;
+            }
+        }
+    }
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int val = 1;
+        try{
+            /**<Calling mimmo Test routines*/
+            val = test9() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00009 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
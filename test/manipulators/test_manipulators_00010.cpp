@@ -0,0 +1,341 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_manipulators.hpp"
+#include "manipulators_test_utils.hpp"
+#include <exception>
+#include <functional>
+#include <random>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*!
+ * Reference displacement of a point with given filter value.
+ */
+typedef std::function<darray3E(const darray3E &, double)> ReferenceLaw;
+
+// =================================================================================== //
+/*!
+ * Reference rotation of a point around an axis, by Rodrigues formula.
+ */
+darray3E rotateAround(const darray3E & point, const darray3E & origin, const darray3E & direction, double alpha){
+    darray3E work = point - origin;
+    darray3E rotated = std::cos(alpha) * work
+                     + (1.0 - std::cos(alpha)) * dotProduct(direction, work) * direction
+                     + std::sin(alpha) * crossProduct(direction, work);
+    return rotated + origin;
+}
+
+/*!
+ * Reference polynomial bending law, by plain powers of the coordinates:
+ * displacement j is the sum over z of coeffs[j][z][k] * x_z^k, k up to degree[j][z].
+ */
+darray3E bendLaw(const darray3E & point, const umatrix33E & degree, const dmat33Evec & coeffs, double filter){
+    darray3E value;
+    value.fill(0.0);
+    for(int j=0; j<3; ++j){
+        for(int z=0; z<3; ++z){
+            if(degree[j][z] == 0)   continue;
+            for(int k=0; k<=int(degree[j][z]); ++k){
+                double coeff = (k < int(coeffs[j][z].size())) ? coeffs[j][z][k] : 0.0;
+                value[j] += std::pow(point[z], double(k)) * coeff * filter;
+            }
+        }
+    }
+    return value;
+}
+
+/*!
+ * Max difference between computed displacements and the reference law on a list of points.
+ */
+double compareLaw(long n, const darray3E * points, const double * filter, const darray3E * displ, const ReferenceLaw & law){
+    double maxdiff = 0.0;
+    for(long i=0; i<n; ++i){
+        maxdiff = std::max(maxdiff, norm2(displ[i] - law(points[i], filter[i])));
+    }
+    return maxdiff;
+}
+
+/*!
+ * Gather coordinates, filter and displacements of the vertices of a mesh.
+ */
+void gatherMesh(MimmoObject * mesh, dmpvector1D & filterField, dmpvecarr3E displField,
+                dvecarr3E & points, dvector1D & filter, dvecarr3E & displ){
+    points.clear();
+    filter.clear();
+    displ.clear();
+    for(const auto & vertex : mesh->getVertices()){
+        long id = vertex.getId();
+        points.push_back(vertex.getCoords());
+        filter.push_back(filterField[id]);
+        displ.push_back(displField.exists(id) ? displField[id] : darray3E({{1.0E+18, 1.0E+18, 1.0E+18}}));
+    }
+}
+
+/*!
+ * Testing the block kernels of the analytic manipulators -> displacements of deformPoints,
+ * on a point cloud not multiple of the block size, and of execute, on a curved surface,
+ * against the reference per-vertex formulas.
+ */
+int test10() {
+
+    //point cloud with a partial last block and a filter with null values
+    long n = 1000;
+    std::mt19937 gen(25);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    dvecarr3E cloud(n);
+    dvector1D cloudFilter(n);
+    for(long i=0; i<n; ++i){
+        cloud[i] = {{dist(gen), dist(gen), dist(gen)}};
+        cloudFilter[i] = (i % 7 == 0) ? 0.0 : 0.5*(1.0 + dist(gen));
+    }
+    dvecarr3E cloudDispl(n);
+
+    //curved surface and its filter field
+    MimmoObject * mesh = createSquare(30);
+    for(const auto & vertex : mesh->getVertices()){
+        darray3E coords = vertex.getCoords();
+        coords[2] = 0.3*std::sin(3.0*coords[0])*std::cos(2.0*coords[1]);
+        mesh->modifyVertex(coords, vertex.getId());
+    }
+    dmpvector1D filterField(mesh, MPVLocation::POINT);
+    for(const auto & vertex : mesh->getVertices()){
+        filterField.insert(vertex.getId(), 0.5 + 0.5*vertex.getCoords()[0]);
+    }
+    dvecarr3E meshPoints, meshDispl;
+    dvector1D meshFilter;
+
+    double tol = 1.0E-12;
+    bool check = true;
+    auto report = [&](const std::string & name, double cloudDiff, double meshDiff){
+        std::cout<<name<<" : max difference deformPoints "<<cloudDiff<<", execute "<<meshDiff<<std::endl;
+        check = check && (cloudDiff < tol) && (meshDiff < tol);
+    };
+
+    darray3E origin = {{0.2, -0.1, 0.3}};
+    darray3E direction = {{1.0, 2.0, -0.5}};
+    direction = direction / norm2(direction);
+
+    //rotation
+    {
+        double alpha = 0.7;
+        RotationGeometry * rotation = new RotationGeometry();
+        rotation->setAxis(origin, direction);
+        rotation->setRotation(alpha);
+        rotation->setFilter(filterField);
+        ReferenceLaw law = [&](const darray3E & p, double f) -> darray3E {
+            return (rotateAround(p, origin, direction, alpha) - p) * f;
+        };
+        rotation->deformPoints(n, cloud.data(), cloudFilter.data(), cloudDispl.data());
+        double cloudDiff = compareLaw(n, cloud.data(), cloudFilter.data(), cloudDispl.data(), law);
+        rotation->setGeometry(mesh);
+        rotation->exec();
+        gatherMesh(mesh, filterField, rotation->getDisplacements(), meshPoints, meshFilter, meshDispl);
+        double meshDiff = compareLaw(meshPoints.size(), meshPoints.data(), meshFilter.data(), meshDispl.data(), law);
+        report("rotation", cloudDiff, meshDiff);
+        delete rotation;
+    }
+
+    //twist, with and without symmetry
+    for(bool sym : {false, true}){
+        double alpha = 0.9;
+        double maxDistance = 0.6;
+        TwistGeometry * twist = new TwistGeometry();
+        twist->setAxis(origin, direction);
+        twist->setTwist(alpha);
+        twist->setMaxDistance(maxDistance);
+        twist->setSym(sym);
+        twist->setFilter(filterField);
+        ReferenceLaw law = [&](const darray3E & p, double f) -> darray3E {
+            double distance = dotProduct(p - origin, direction);
+            double rot = std::min(alpha, std::abs(distance)/maxDistance*alpha);
+            if(distance < 0.0)  rot = sym ? -rot : 0.0;
+            darray3E projected = distance*direction + origin;
+            return (rotateAround(p, projected, direction, rot) - p) * f;
+        };
+        twist->deformPoints(n, cloud.data(), cloudFilter.data(), cloudDispl.data());
+        double cloudDiff = compareLaw(n, cloud.data(), cloudFilter.data(), cloudDispl.data(), law);
+        twist->setGeometry(mesh);
+        twist->exec();
+        gatherMesh(mesh, filterField, twist->getDisplacements(), meshPoints, meshFilter, meshDispl);
+        double meshDiff = compareLaw(meshPoints.size(), meshPoints.data(), meshFilter.data(), meshDispl.data(), law);
+        report(sym ? "twist symmetric" : "twist", cloudDiff, meshDiff);
+        delete twist;
+    }
+
+    //scale, about a given origin and about the mean point
+    for(bool meanP : {false, true}){
+        darray3E scaling = {{1.3, 0.8, 1.1}};
+        ScaleGeometry * scale = new ScaleGeometry();
+        scale->setScaling(scaling);
+        scale->setOrigin(origin);
+        scale->setMeanPoint(meanP);
+        scale->setFilter(filterField);
+        darray3E center;
+        ReferenceLaw law = [&](const darray3E & p, double f) -> darray3E {
+            darray3E scaled;
+            for(int j=0; j<3; ++j){
+                scaled[j] = scaling[j]*(p[j] - center[j]) + center[j];
+            }
+            return (scaled - p) * f;
+        };
+        auto meanOf = [](const dvecarr3E & points) -> darray3E {
+            darray3E mean = {{0.0, 0.0, 0.0}};
+            for(const darray3E & p : points)    mean += p;
+            return mean / double(points.size());
+        };
+        center = meanP ? meanOf(cloud) : origin;
+        darray3E cloudCenter = scale->evalCenter(n, cloud.data());
+        scale->deformPoints(n, cloud.data(), cloudFilter.data(), cloudCenter, cloudDispl.data());
+        double cloudDiff = std::max(norm2(cloudCenter - center),
+                                    compareLaw(n, cloud.data(), cloudFilter.data(), cloudDispl.data(), law));
+        scale->setGeometry(mesh);
+        scale->exec();
+        gatherMesh(mesh, filterField, scale->getDisplacements(), meshPoints, meshFilter, meshDispl);
+        center = meanP ? meanOf(meshPoints) : origin;
+        double meshDiff = compareLaw(meshPoints.size(), meshPoints.data(), meshFilter.data(), meshDispl.data(), law);
+        report(meanP ? "scale mean point" : "scale", cloudDiff, meshDiff);
+        delete scale;
+    }
+
+    //translation
+    {
+        double alpha = 0.35;
+        TranslationGeometry * translation = new TranslationGeometry();
+        translation->setDirection({{1.0, 2.0, -0.5}});
+        translation->setTranslation(alpha);
+        translation->setFilter(filterField);
+        ReferenceLaw law = [&](const darray3E & p, double f) -> darray3E {
+            BITPIT_UNUSED(p);
+            return alpha * direction * f;
+        };
+        translation->deformPoints(n, cloud.data(), cloudFilter.data(), cloudDispl.data());
+        double cloudDiff = compareLaw(n, cloud.data(), cloudFilter.data(), cloudDispl.data(), law);
+        translation->setGeometry(mesh);
+        translation->exec();
+        gatherMesh(mesh, filterField, translation->getDisplacements(), meshPoints, meshFilter, meshDispl);
+        double meshDiff = compareLaw(meshPoints.size(), meshPoints.data(), meshFilter.data(), meshDispl.data(), law);
+        report("translation", cloudDiff, meshDiff);
+        delete translation;
+    }
+
+    //bend, in the absolute frame and in a local frame
+    for(bool local : {false, true}){
+        umatrix33E degree;
+        dmat33Evec coeffs;
+        for(int j=0; j<3; ++j){
+            for(int z=0; z<3; ++z){
+                degree[j][z] = 0;
+                coeffs[j][z].clear();
+            }
+        }
+        degree[0][1] = 3;
+        coeffs[0][1] = {0.01, -0.05, 0.1, 0.07};
+        degree[1][0] = 2;
+        coeffs[1][0] = {0.0, 0.08, -0.12};
+        //fewer coefficients than the degree: missing ones are null
+        degree[2][2] = 4;
+        coeffs[2][2] = {0.02, 0.1, -0.06};
+        degree[2][0] = 1;
+        coeffs[2][0] = {0.0, 0.04};
+
+        //local frame: axes rotated around the axis direction, origin displaced
+        dmatrix33E axes;
+        axes[0] = {{1.0, 0.0, 0.0}};
+        axes[1] = {{0.0, 1.0, 0.0}};
+        axes[2] = {{0.0, 0.0, 1.0}};
+        if(local){
+            for(int j=0; j<3; ++j){
+                axes[j] = rotateAround(axes[j], {{0.0, 0.0, 0.0}}, direction, 0.6);
+            }
+        }
+
+        BendGeometry * bend = new BendGeometry();
+        bend->setDegree(degree);
+        bend->setCoeffs(coeffs);
+        if(local){
+            bend->setOrigin(origin);
+            bend->setRefSystem(axes);
+        }
+        bend->setFilter(filterField);
+        ReferenceLaw law = [&](const darray3E & p, double f) -> darray3E {
+            if(!local)  return bendLaw(p, degree, coeffs, f);
+            //local coordinates are the projections on the axes of the frame
+            darray3E localP;
+            for(int j=0; j<3; ++j){
+                localP[j] = dotProduct(p - origin, axes[j]);
+            }
+            darray3E value = bendLaw(localP, degree, coeffs, f);
+            darray3E deformed = origin;
+            for(int j=0; j<3; ++j){
+                deformed += (localP[j] + value[j]) * axes[j];
+            }
+            return deformed - p;
+        };
+        bend->deformPoints(n, cloud.data(), cloudFilter.data(), cloudDispl.data());
+        double cloudDiff = compareLaw(n, cloud.data(), cloudFilter.data(), cloudDispl.data(), law);
+        bend->setGeometry(mesh);
+        bend->exec();
+        gatherMesh(mesh, filterField, bend->getDisplacements(), meshPoints, meshFilter, meshDispl);
+        double meshDiff = compareLaw(meshPoints.size(), meshPoints.data(), meshFilter.data(), meshDispl.data(), law);
+        report(local ? "bend local frame" : "bend", cloudDiff, meshDiff);
+        delete bend;
+    }
+
+    delete mesh;
+
+    std::cout<<"test passed: "<<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int val = 1;
+        try{
+            /**<Calling mimmo Test routines*/
+            val = test10() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_manipulators_00010 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+
+	return val;
+}
@@ -0,0 +1,112 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#ifndef __PROPAGATORS_TEST_UTILS_HPP__
+#define __PROPAGATORS_TEST_UTILS_HPP__
+
+#include "mimmo_propagators.hpp"
+
+/*!
+ * Unique id of the vertex (i,j,k) of a structured block with n x n x nz cells.
+ */
+inline long blockVertexId(int n, int i, int j, int k){
+    return long(k)*(n+1)*(n+1) + long(j)*(n+1) + i;
+}
+
+/*!
+ * Create a structured hexahedral mesh of the unit cube with n x n x nz cells.
+ */
+inline mimmo::MimmoObject * createBlock(int n, int nz){
+    mimmo::MimmoObject * mesh = new mimmo::MimmoObject(2);
+    for(int k=0; k<=nz; ++k){
+        for(int j=0; j<=n; ++j){
+            for(int i=0; i<=n; ++i){
+                mesh->addVertex({{double(i)/n, double(j)/n, double(k)/nz}}, blockVertexId(n,i,j,k));
+            }
+        }
+    }
+    long cellId = 0;
+    livector1D conn(8);
+    for(int k=0; k<nz; ++k){
+        for(int j=0; j<n; ++j){
+            for(int i=0; i<n; ++i){
+                conn = {blockVertexId(n,i,j,k), blockVertexId(n,i+1,j,k), blockVertexId(n,i+1,j+1,k), blockVertexId(n,i,j+1,k),
+                        blockVertexId(n,i,j,k+1), blockVertexId(n,i+1,j,k+1), blockVertexId(n,i+1,j+1,k+1), blockVertexId(n,i,j+1,k+1)};
+                mesh->addConnectedCell(conn, bitpit::ElementType::HEXAHEDRON, 0, cellId++);
+            }
+        }
+    }
+    return mesh;
+}
+
+/*!
+ * Create the bottom (z=0) and top (z=1) faces of the block of createBlock as a quad surface,
+ * sharing the vertex ids of the block.
+ */
+inline mimmo::MimmoObject * createBlockCaps(mimmo::MimmoObject * block, int n, int nz){
+    mimmo::MimmoObject * caps = new mimmo::MimmoObject(1);
+    long cellId = 0;
+    livector1D conn(4);
+    for(int k : {0, nz}){
+        for(int j=0; j<=n; ++j){
+            for(int i=0; i<=n; ++i){
+                long id = blockVertexId(n,i,j,k);
+                caps->addVertex(block->getVertexCoords(id), id);
+            }
+        }
+        for(int j=0; j<n; ++j){
+            for(int i=0; i<n; ++i){
+                conn = {blockVertexId(n,i,j,k), blockVertexId(n,i+1,j,k), blockVertexId(n,i+1,j+1,k), blockVertexId(n,i,j+1,k)};
+                caps->addConnectedCell(conn, bitpit::ElementType::QUAD, 0, cellId++);
+            }
+        }
+    }
+    return caps;
+}
+
+/*!
+ * Dirichlet conditions on the caps of the block equal to the height of the vertex.
+ * The harmonic field on the block is then the height itself.
+ */
+inline dmpvector1D heightConditions(mimmo::MimmoObject * caps){
+    dmpvector1D bc(caps, mimmo::MPVLocation::POINT);
+    for(const auto & vertex : caps->getVertices()){
+        bc.insert(vertex.getId(), vertex.getCoords()[2]);
+    }
+    return bc;
+}
+
+/*!
+ * Max difference of a field on the block from the height of its vertices.
+ */
+inline double maxHeightError(mimmo::MimmoObject * block, dmpvector1D & field){
+    if(long(field.size()) != block->getNVertex())   return 1.0E+18;
+    double maxdiff = 0.0;
+    for(const auto & vertex : block->getVertices()){
+        if(!field.exists(vertex.getId()))   return 1.0E+18;
+        maxdiff = std::max(maxdiff, std::abs(field[vertex.getId()] - vertex.getCoords()[2]));
+    }
+    return maxdiff;
+}
+
+#endif /* __PROPAGATORS_TEST_UTILS_HPP__ */
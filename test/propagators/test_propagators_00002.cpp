@@ -0,0 +1,213 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_propagators.hpp"
+#include "propagators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Smooth the height conditions on the block with the smoothing solver of PropagateScalarField.
+ * A non positive number of steps runs the solver until convergence.
+ */
+dmpvector1D smoothBlock(MimmoObject * block, MimmoObject * caps, SmoothingType type, bool setType, int nstep, double omega = 1.0){
+
+    PropagateScalarField * prop = new PropagateScalarField();
+    prop->setGeometry(block);
+    prop->setDirichletBoundarySurface(caps);
+    prop->setDirichletConditions(heightConditions(caps));
+    prop->setSolver(false);
+    if(setType)     prop->setSmoothingType(type);
+    prop->setRelaxation(omega);
+    if(nstep > 0){
+        prop->setSmoothingSteps(nstep);
+    }else{
+        prop->setConvergence(true);
+        prop->setTolerance(1.0E-10);
+    }
+    prop->exec();
+
+    dmpvector1D field = prop->getPropagatedField();
+    delete prop;
+    return field;
+}
+
+/*!
+ * Reference of the original smoother on the block: starting from the boundary conditions,
+ * each step updates in place every free vertex, in local order, with the average of its
+ * edge neighbours weighted with the inverse of their distance.
+ */
+dmpvector1D referenceSmoothing(MimmoObject * block, int n, int nz, int nstep){
+
+    liimap dataInv = block->getMapDataInv();
+    int np = block->getNVertex();
+    dvector1D guess(np, 0.0);
+    std::vector<livector1D> neighs(np);
+    std::vector<dvector1D> wgts(np);
+    for(int k=0; k<=nz; ++k){
+        for(int j=0; j<=n; ++j){
+            for(int i=0; i<=n; ++i){
+                long id = blockVertexId(n,i,j,k);
+                int ind = dataInv[id];
+                if(k == 0 || k == nz){
+                    guess[ind] = block->getVertexCoords(id)[2];
+                    continue;
+                }
+                std::vector<std::array<int,3> > ijk = {{{i-1,j,k}}, {{i+1,j,k}}, {{i,j-1,k}}, {{i,j+1,k}}, {{i,j,k-1}}, {{i,j,k+1}}};
+                double sum = 0.0;
+                for(const auto & nb : ijk){
+                    if(nb[0] < 0 || nb[0] > n || nb[1] < 0 || nb[1] > n)   continue;
+                    long idn = blockVertexId(n,nb[0],nb[1],nb[2]);
+                    double w = 1.0/norm2(block->getVertexCoords(idn) - block->getVertexCoords(id));
+                    neighs[ind].push_back(dataInv[idn]);
+                    wgts[ind].push_back(w);
+                    sum += w;
+                }
+                wgts[ind] /= sum;
+            }
+        }
+    }
+
+    for(int istep=0; istep<nstep; ++istep){
+        for(int ind=0; ind<np; ++ind){
+            if(neighs[ind].empty())     continue;
+            double val = 0.0;
+            for(std::size_t j=0; j<neighs[ind].size(); ++j){
+                val += wgts[ind][j]*guess[neighs[ind][j]];
+            }
+            guess[ind] = val;
+        }
+    }
+
+    dmpvector1D field(block, MPVLocation::POINT);
+    for(const auto & vertex : block->getVertices()){
+        field.insert(vertex.getId(), guess[dataInv[vertex.getId()]]);
+    }
+    return field;
+}
+
+/*!
+ * Max difference between two fields on the same vertices.
+ */
+double maxDifference(dmpvector1D & a, dmpvector1D & b){
+    if(a.size() != b.size())    return 1.0E+18;
+    double maxdiff = 0.0;
+    for(auto it = a.begin(); it != a.end(); ++it){
+        if(!b.exists(it.getId()))   return 1.0E+18;
+        maxdiff = std::max(maxdiff, std::abs(*it - b[it.getId()]));
+    }
+    return maxdiff;
+}
+
+/*!
+ * Testing the sweeps of the smoothing solver of PropagateScalarField.
+ * The default sweep reproduces the original smoother for a fixed number of steps,
+ * all sweeps converge to the harmonic field.
+ */
+int test2() {
+
+    //inputs are set directly, not through ports
+    setExpertMode(true);
+
+    int n = 4, nz = 8, nstep = 7;
+    MimmoObject * block = createBlock(n, nz);
+    MimmoObject * caps = createBlockCaps(block, n, nz);
+
+    //default sweep
+    PropagateScalarField * prop = new PropagateScalarField();
+    bitpit::Config config;
+    bitpit::Config::Section & slot = config.addSection("propagator");
+    prop->flushSectionXML(slot);
+    bool check = (slot.get("SmoothingType") == "0");
+    delete prop;
+    if(!check){
+        std::cout<<"Failed default smoothing type"<<std::endl;
+    }
+
+    dmpvector1D fieldDefault = smoothBlock(block, caps, SmoothingType::SEQUENTIAL, false, nstep);
+    dmpvector1D fieldSequential = smoothBlock(block, caps, SmoothingType::SEQUENTIAL, true, nstep);
+    dmpvector1D fieldReference = referenceSmoothing(block, n, nz, nstep);
+    double diff = maxDifference(fieldDefault, fieldSequential);
+    double diffRef = maxDifference(fieldDefault, fieldReference);
+    std::cout<<"sequential sweep, "<<nstep<<" steps: difference from original smoother "<<diffRef<<std::endl;
+    check = check && (diff == 0.0) && (diffRef < 1.0E-14);
+    //the field is not converged yet after few steps
+    check = check && (maxHeightError(block, fieldDefault) > 1.0E-3);
+    if(!check){
+        std::cout<<"Failed sequential sweep for a fixed number of steps"<<std::endl;
+    }
+
+    //all sweeps converge to the height of the vertices
+    std::vector<std::pair<SmoothingType, double> > sweeps = {
+        {SmoothingType::SEQUENTIAL, 1.0}, {SmoothingType::GAUSSSEIDEL, 1.0},
+        {SmoothingType::GAUSSSEIDEL, 1.5}, {SmoothingType::JACOBI, 0.8}};
+    for(const auto & sweep : sweeps){
+        dmpvector1D field = smoothBlock(block, caps, sweep.first, true, 0, sweep.second);
+        double err = maxHeightError(block, field);
+        std::cout<<"sweep "<<int(sweep.first)<<", relaxation "<<sweep.second<<": error at convergence "<<err<<std::endl;
+        check = check && (err < 1.0E-6);
+    }
+    if(!check){
+        std::cout<<"Failed convergence of smoothing sweeps"<<std::endl;
+    }
+
+    std::cout<<"test passed :"<<check<<std::endl;
+
+    delete caps;
+    delete block;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test2() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_propagators_00002 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
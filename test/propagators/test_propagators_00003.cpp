@@ -0,0 +1,117 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_propagators.hpp"
+#include "propagators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Testing repeated executions of the Laplacian solver of PropagateScalarField on the same
+ * operator with different tolerances: the cached solver has to apply the tolerance of
+ * each execution.
+ */
+int test3() {
+
+    //inputs are set directly, not through ports
+    setExpertMode(true);
+
+    int n = 8, nz = 24;
+    MimmoObject * block = createBlock(n, nz);
+    MimmoObject * caps = createBlockCaps(block, n, nz);
+
+    PropagateScalarField * prop = new PropagateScalarField();
+    prop->setGeometry(block);
+    prop->setDirichletBoundarySurface(caps);
+    prop->setDirichletConditions(heightConditions(caps));
+    prop->setSolver(true);
+
+    //loose tolerance
+    prop->setTolerance(1.0E-02);
+    prop->exec();
+    dmpvector1D fieldLoose = prop->getPropagatedField();
+    double errLoose = maxHeightError(block, fieldLoose);
+
+    //same operator, tight tolerance
+    prop->setTolerance(1.0E-12);
+    prop->exec();
+    dmpvector1D fieldTight = prop->getPropagatedField();
+    double errTight = maxHeightError(block, fieldTight);
+
+    std::cout<<"error with tolerance 1e-2 : "<<errLoose<<", with tolerance 1e-12 : "<<errTight<<std::endl;
+    bool check = (errTight < 1.0E-8) && (errTight <= errLoose);
+    if(!check){
+        std::cout<<"Failed update of the Laplacian solver tolerance"<<std::endl;
+    }
+
+    //loose tolerance again, starting from the converged solution
+    prop->setTolerance(1.0E-02);
+    prop->exec();
+    dmpvector1D fieldAgain = prop->getPropagatedField();
+    double errAgain = maxHeightError(block, fieldAgain);
+    check = check && (errAgain < 1.0E-8);
+    if(!check){
+        std::cout<<"Failed restart of the Laplacian solver from the previous solution"<<std::endl;
+    }
+
+    std::cout<<"test passed :"<<check<<std::endl;
+
+    delete prop;
+    delete caps;
+    delete block;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test3() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_propagators_00003 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
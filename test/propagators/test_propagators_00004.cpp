@@ -0,0 +1,145 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+
+#include "mimmo_propagators.hpp"
+#include "propagators_test_utils.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Solve the scalar height problem on the block with the Laplacian solver and the given preconditioner.
+ * \return max error from the height of the vertices
+ */
+double solveScalar(PropagateScalarField * prop, MimmoObject * block, KSPPreconditioner type){
+    prop->setPreconditioner(type);
+    prop->exec();
+    dmpvector1D field = prop->getPropagatedField();
+    return maxHeightError(block, field);
+}
+
+/*!
+ * Testing the algebraic multigrid preconditioner of the Laplacian solver of PropagateField,
+ * on a scalar problem, switching preconditioner on the same block, and on a vector problem
+ * solved as a block system.
+ */
+int test4() {
+
+    //inputs are set directly, not through ports
+    setExpertMode(true);
+
+    int n = 8, nz = 24;
+    MimmoObject * block = createBlock(n, nz);
+    MimmoObject * caps = createBlockCaps(block, n, nz);
+
+    //scalar field
+    PropagateScalarField * prop = new PropagateScalarField();
+    prop->setGeometry(block);
+    prop->setDirichletBoundarySurface(caps);
+    prop->setDirichletConditions(heightConditions(caps));
+    prop->setSolver(true);
+    prop->setTolerance(1.0E-12);
+
+    double errDefault = solveScalar(prop, block, KSPPreconditioner::DEFAULT);
+    double errAMG = solveScalar(prop, block, KSPPreconditioner::AMG);
+    double errBack = solveScalar(prop, block, KSPPreconditioner::DEFAULT);
+    std::cout<<"scalar field error, ILU : "<<errDefault<<", AMG : "<<errAMG<<", ILU again : "<<errBack<<std::endl;
+    bool check = (errDefault < 1.0E-8) && (errAMG < 1.0E-8) && (errBack < 1.0E-8);
+    if(!check){
+        std::cout<<"Failed scalar propagation with algebraic multigrid"<<std::endl;
+    }
+
+    //vector field, each component proportional to the height
+    darray3E factors = {{0.1, -0.2, 0.3}};
+    dmpvecarr3E bc(caps, MPVLocation::POINT);
+    for(const auto & vertex : caps->getVertices()){
+        bc.insert(vertex.getId(), vertex.getCoords()[2]*factors);
+    }
+    PropagateVectorField * propv = new PropagateVectorField();
+    propv->setGeometry(block);
+    propv->setDirichletBoundarySurface(caps);
+    propv->setDirichletConditions(bc);
+    propv->setSolver(true);
+    propv->setTolerance(1.0E-12);
+    propv->setPreconditioner(KSPPreconditioner::AMG);
+    propv->exec();
+
+    dmpvecarr3E field = propv->getPropagatedField();
+    double errVector = (long(field.size()) == block->getNVertex()) ? 0.0 : 1.0E+18;
+    for(const auto & vertex : block->getVertices()){
+        if(!field.exists(vertex.getId())){
+            errVector = 1.0E+18;
+            continue;
+        }
+        errVector = std::max(errVector, norm2(field[vertex.getId()] - vertex.getCoords()[2]*factors));
+    }
+    std::cout<<"vector field error, AMG : "<<errVector<<std::endl;
+    bool checkVector = (errVector < 1.0E-8);
+    if(!checkVector){
+        std::cout<<"Failed vector propagation with algebraic multigrid"<<std::endl;
+    }
+    check = check && checkVector;
+
+    //solvers are deleted together, PETSc is finalized with the last one
+    delete propv;
+    delete prop;
+
+    std::cout<<"test passed :"<<check<<std::endl;
+
+    delete caps;
+    delete block;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+
+#if ENABLE_MPI==1
+    MPI::Init(argc, argv);
+
+    {
+#endif
+        /**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test4() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_propagators_00004 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+    }
+
+    MPI::Finalize();
+#endif
+
+    return val;
+}
@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "utils_test_utils.hpp"
+#include <exception>
+#include <random>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+// =================================================================================== //
+/*!
+ * Test: testing NarrowBandDistanceField build, interpolation and file roundtrip.
+ */
+int test4() {
+
+    MimmoObject * sphere = new MimmoObject();
+    if(!createSphere(sphere)){
+        delete sphere;
+        return 1;
+    }
+
+    double h = 0.05;
+    NarrowBandDistanceField field;
+    field.build(sphere, h, 5*h);
+    bool check = !field.isEmpty();
+
+    check = check && field.write("sphere.sdf", "sphere");
+    NarrowBandDistanceField loaded;
+    check = check && !loaded.read("sphere.sdf", "other");
+    check = check && loaded.read("sphere.sdf", "sphere");
+    check = check && (loaded.getNodeCount() == field.getNodeCount());
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> coord(-1.3, 1.3);
+    double maxerr = 0.0;
+    long nInterp = 0;
+    for(int i=0; i<20000; ++i){
+        darray3E p = {{coord(gen), coord(gen), coord(gen)}};
+        double value, stored;
+        if(!field.interpolate(p, value))   continue;
+        ++nInterp;
+        check = check && loaded.interpolate(p, stored) && (stored == value);
+        double exact = norm2(p) - 1.0;
+        check = check && (value*exact > 0.0);
+        maxerr = std::max(maxerr, std::abs(value - exact));
+    }
+    check = check && (nInterp > 0) && (maxerr < 0.2*h);
+
+    std::cout<<"interpolated points : "<<nInterp<<", max error : "<<maxerr<<std::endl;
+
+    delete sphere;
+    std::cout<<"test passed :" <<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+	
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test4() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_utils_00004 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+	
+	return val;
+}
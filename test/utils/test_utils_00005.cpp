@@ -0,0 +1,140 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#include "utils_test_utils.hpp"
+#include "mimmo_iogeneric.hpp"
+#include <exception>
+using namespace std;
+using namespace bitpit;
+using namespace mimmo;
+
+/*!
+ * Evaluate the violation field of a deformed geometry w.r.t. a constraint file.
+ * \param[in] geo deformable geometry
+ * \param[in] field deformation field of the geometry
+ * \param[in] file constraint file
+ * \param[in] cached true to use the distance cache
+ * \param[out] violation violation value
+ * \return violation field
+ */
+dmpvector1D evalViolation(MimmoObject * geo, dmpvecarr3E & field, const std::string & file, bool cached, double & violation){
+    ControlDeformExtSurface * control = new ControlDeformExtSurface();
+    control->setGeometry(geo);
+    control->setDefField(field);
+    control->addFile(file, 0.0, FileType::STL);
+    control->setDistanceCache(cached);
+    control->exec();
+    dmpvector1D result = control->getViolationField();
+    violation = control->getViolation();
+    delete control;
+    return result;
+}
+
+// =================================================================================== //
+/*!
+ * Test: testing ControlDeformExtSurface violation with and without distance cache.
+ */
+int test5() {
+
+    //constraint: unit sphere written to file
+    MimmoObject * sphere = new MimmoObject();
+    bool check = createSphere(sphere);
+    MimmoGeometry * writer = new MimmoGeometry();
+    writer->setIOMode(IOMode::WRITE);
+    writer->setWriteDir(".");
+    writer->setWriteFilename("utils_sphere");
+    writer->setWriteFileType(FileType::STL);
+    writer->setGeometry(sphere);
+    writer->exec();
+    delete writer;
+    std::string file = "./utils_sphere.stl";
+
+    //deformable geometry: inner sphere inflated beyond the constraint on part of its vertices
+    MimmoObject * inner = new MimmoObject();
+    check = check && createSphere(inner, 0.5, 10, 20);
+    dmpvecarr3E field(inner, MPVLocation::POINT);
+    for(const auto & vertex : inner->getVertices()){
+        long id = vertex.getId();
+        field.insert(id, (0.4 + 0.8*std::abs(std::sin(double(id))))*vertex.getCoords());
+    }
+
+    ControlDeformExtSurface * defaults = new ControlDeformExtSurface();
+    check = check && !defaults->isDistanceCacheActive();
+    delete defaults;
+
+    double violation, violationCached;
+    dmpvector1D exact = evalViolation(inner, field, file, false, violation);
+    dmpvector1D cached = evalViolation(inner, field, file, true, violationCached);
+
+    //interpolation error of the distance field is bounded by a fraction of its spacing
+    double h = 2.0*std::sqrt(3.0)/50.0;
+    double maxerr = 0.0;
+    long nPositive = 0;
+    check = check && (long(exact.size()) == inner->getNVertex()) && (cached.size() == exact.size());
+    for(const auto & vertex : inner->getVertices()){
+        long id = vertex.getId();
+        check = check && exact.exists(id) && cached.exists(id);
+        if(!check)  break;
+        maxerr = std::max(maxerr, std::abs(exact[id] - cached[id]));
+        if(exact[id] > 0.0) ++nPositive;
+    }
+    check = check && (maxerr < 0.5*h) && (std::abs(violation - violationCached) < 0.5*h);
+    check = check && (nPositive > 0) && (nPositive < long(exact.size())) && (violation > 0.0);
+
+    std::cout<<"violation : "<<violation<<", cached violation : "<<violationCached<<", max difference : "<<maxerr<<std::endl;
+
+    delete inner;
+    delete sphere;
+    std::cout<<"test passed :" <<check<<std::endl;
+    return int(!check);
+}
+
+// =================================================================================== //
+
+int main( int argc, char *argv[] ) {
+
+	BITPIT_UNUSED(argc);
+	BITPIT_UNUSED(argv);
+	
+#if ENABLE_MPI==1
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Calling mimmo Test routines*/
+        int val = 1;
+        try{
+            val = test5() ;
+        }
+        catch(std::exception & e){
+            std::cout<<"test_utils_00005 exited with an error of type : "<<e.what()<<std::endl;
+            return 1;
+        }
+#if ENABLE_MPI==1
+	}
+
+	MPI::Finalize();
+#endif
+	
+	return val;
+}
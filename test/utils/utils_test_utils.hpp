@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------------*\
+ * 
+ *  mimmo
+ *
+ *  Copyright (C) 2015-2017 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of mimmo.
+ *
+ *  mimmo is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  mimmo is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with mimmo. If not, see <http://www.gnu.org/licenses/>.
+ *
+ \ *---------------------------------------------------------------------------*/
+#ifndef __UTILS_TEST_UTILS_HPP__
+#define __UTILS_TEST_UTILS_HPP__
+
+#include "mimmo_utils.hpp"
+#include <cmath>
+
+/*!
+ * Fill a MimmoObject with a triangulated sphere centered in the origin, made of nt parallel
+ * bands and np meridians.
+ * \param[in,out] mesh pointer to a MimmoObject mesh to fill.
+ * \param[in] radius radius of the sphere
+ * \param[in] nt number of parallel bands
+ * \param[in] np number of meridians
+ * \return true if successfully created mesh
+ */
+inline bool createSphere(mimmo::MimmoObject * mesh, double radius = 1.0, int nt = 40, int np = 80){
+
+    long cV = 0;
+    darray3E north = {{0.0,0.0,radius}}, south = {{0.0,0.0,-radius}};
+    mesh->addVertex(north, cV++);
+    for(int a=1; a<nt; ++a){
+        double th = M_PI*double(a)/double(nt);
+        for(int b=0; b<np; ++b){
+            double ph = 2.0*M_PI*double(b)/double(np);
+            darray3E point = {{std::sin(th)*std::cos(ph), std::sin(th)*std::sin(ph), std::cos(th)}};
+            mesh->addVertex(radius*point, cV++);
+        }
+    }
+    mesh->addVertex(south, cV++);
+
+    long last = cV-1;
+    long cC = 0;
+    bitpit::ElementType eltype = bitpit::ElementType::TRIANGLE;
+    for(int b=0; b<np; ++b){
+        mesh->addConnectedCell({0, 1+b, 1+(b+1)%np}, eltype, cC++);
+        long l = 1 + (nt-2)*np;
+        mesh->addConnectedCell({last, l+(b+1)%np, l+b}, eltype, cC++);
+    }
+    for(int a=0; a<nt-2; ++a){
+        for(int b=0; b<np; ++b){
+            long i0 = 1+a*np+b, i1 = 1+a*np+(b+1)%np, i2 = 1+(a+1)*np+b, i3 = 1+(a+1)*np+(b+1)%np;
+            mesh->addConnectedCell({i0, i2, i3}, eltype, cC++);
+            mesh->addConnectedCell({i0, i3, i1}, eltype, cC++);
+        }
+    }
+
+    mesh->buildAdjacencies();
+    mesh->buildSkdTree();
+    return (mesh->getNVertex() == 2+(nt-1)*np) && (mesh->getNCells() == 2*np*(nt-1));
+}
+
+#endif /* __UTILS_TEST_UTILS_HPP__ */